@@ -54,6 +54,7 @@ cpp_examples = [
     ("80211e-txop --simulationTime=1 --verifyResults=1", "True", "True"),
     ("wifi-multi-tos --simulationTime=1 --nWifi=16 --useRts=1 --useShortGuardInterval=1", "True", "True"),
     ("wifi-tcp", "True", "True"),
+    ("wifi-dense-ap-benchmark --nStations=10 --simulationTime=0.1", "True", "False"),
     ("wifi-pcf --simulationTime=1 --withData=0", "True", "True"),
     ("wifi-pcf --simulationTime=1 --withData=1 --trafficDirection=upstream", "True", "True"),
     ("wifi-pcf --simulationTime=1 --withData=1 --trafficDirection=downstream", "True", "True"),
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/ssid.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/udp-client-server-helper.h"
+#include "ns3/udp-server.h"
+
+// This example serves as a benchmark for the MAC bookkeeping of an access
+// point serving many stations (remote station manager lookups, per-receiver
+// queue operations, block ack agreements).
+//
+// A single 802.11n AP serves nStations stations placed on a circle around it.
+// Each station receives a downlink UDP flow from the AP (and, optionally,
+// sends an uplink UDP flow to the AP). The flows are started once the
+// stations are associated.
+//
+// The program outputs the number of stations, the wall clock time taken by
+// Simulator::Run and the aggregate goodput:
+//
+//   stations   wall(ms)   goodput(Mbit/s)
+//
+// Example usage:
+//
+//   ./waf --run "wifi-dense-ap-benchmark --nStations=200 --simulationTime=2"
+//
+// The --ampduAbstraction option allows to compare the wall clock time with
+// the one obtained when each A-MPDU is handed to the PHY as a single packet.
+// The --fanOutThreads option sets the number of threads computing the
+// received power at the receivers of each transmission.
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WifiDenseApBenchmark");
+
+int main (int argc, char *argv[])
+{
+  uint32_t nStations = 100;
+  double simulationTime = 1; //seconds
+  double radius = 5; //meters
+  uint32_t payloadSize = 1472; //bytes
+  double interval = 0.01; //seconds between two packets of a flow
+  bool uplink = false;
+  std::string manager = "ns3::IdealWifiManager";
+  bool ampduAbstraction = false;
+  uint32_t fanOutThreads = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nStations", "Number of stations associated with the AP", nStations);
+  cmd.AddValue ("simulationTime", "Duration of the traffic phase in seconds", simulationTime);
+  cmd.AddValue ("radius", "Distance in meters between the AP and the stations", radius);
+  cmd.AddValue ("payloadSize", "UDP payload size in bytes", payloadSize);
+  cmd.AddValue ("interval", "Interval in seconds between two packets of a flow", interval);
+  cmd.AddValue ("uplink", "Add an uplink flow for each station", uplink);
+  cmd.AddValue ("manager", "Remote station manager type", manager);
+  cmd.AddValue ("ampduAbstraction", "Send each A-MPDU to the PHY as a single packet", ampduAbstraction);
+  cmd.AddValue ("fanOutThreads", "Number of threads computing the received power", fanOutThreads);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::RegularWifiMac::AmpduAbstraction", BooleanValue (ampduAbstraction));
+  Config::SetDefault ("ns3::YansWifiChannel::FanOutThreads", UintegerValue (fanOutThreads));
+
+  NodeContainer wifiStaNodes;
+  wifiStaNodes.Create (nStations);
+  NodeContainer wifiApNode;
+  wifiApNode.Create (1);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  wifi.SetRemoteStationManager (manager);
+
+  WifiMacHelper mac;
+  Ssid ssid = Ssid ("dense-ap");
+  mac.SetType ("ns3::StaWifiMac",
+               "Ssid", SsidValue (ssid));
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, wifiStaNodes);
+
+  mac.SetType ("ns3::ApWifiMac",
+               "Ssid", SsidValue (ssid));
+  NetDeviceContainer apDevice = wifi.Install (phy, mac, wifiApNode);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+                                 "rho", DoubleValue (radius));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiStaNodes);
+  Ptr<ListPositionAllocator> apPosition = CreateObject<ListPositionAllocator> ();
+  apPosition->Add (Vector (0.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (apPosition);
+  mobility.Install (wifiApNode);
+
+  InternetStackHelper stack;
+  stack.Install (wifiApNode);
+  stack.Install (wifiStaNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer staInterfaces = address.Assign (staDevices);
+  Ipv4InterfaceContainer apInterface = address.Assign (apDevice);
+
+  // leave one second for the stations to associate
+  double startTime = 1.0;
+  double stopTime = startTime + simulationTime;
+  uint16_t port = 9;
+
+  ApplicationContainer serverApps;
+  ApplicationContainer clientApps;
+  UdpServerHelper server (port);
+  UdpClientHelper client;
+  client.SetAttribute ("MaxPackets", UintegerValue (4294967295u));
+  client.SetAttribute ("Interval", TimeValue (Seconds (interval)));
+  client.SetAttribute ("PacketSize", UintegerValue (payloadSize));
+
+  serverApps.Add (server.Install (wifiStaNodes));
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      client.SetAttribute ("RemoteAddress", AddressValue (staInterfaces.GetAddress (i)));
+      client.SetAttribute ("RemotePort", UintegerValue (port));
+      clientApps.Add (client.Install (wifiApNode));
+    }
+  if (uplink)
+    {
+      serverApps.Add (server.Install (wifiApNode));
+      client.SetAttribute ("RemoteAddress", AddressValue (apInterface.GetAddress (0)));
+      clientApps.Add (client.Install (wifiStaNodes));
+    }
+  serverApps.Start (Seconds (0.0));
+  serverApps.Stop (Seconds (stopTime));
+  clientApps.Start (Seconds (startTime));
+  clientApps.Stop (Seconds (stopTime));
+
+  Simulator::Stop (Seconds (stopTime));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t wallMs = clock.End ();
+
+  uint64_t rxBytes = 0;
+  for (uint32_t i = 0; i < serverApps.GetN (); i++)
+    {
+      rxBytes += payloadSize * DynamicCast<UdpServer> (serverApps.Get (i))->GetReceived ();
+    }
+  Simulator::Destroy ();
+
+  std::cout << "stations" << "\t" << "wall(ms)" << "\t" << "goodput(Mbit/s)" << std::endl;
+  std::cout << nStations << "\t\t" << wallMs << "\t\t"
+            << (rxBytes * 8) / (simulationTime * 1000000.0) << std::endl;
+
+  return 0;
+}
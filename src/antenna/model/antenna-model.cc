@@ -32,6 +32,7 @@ NS_OBJECT_ENSURE_REGISTERED (AntennaModel);
 
 
 AntennaModel::AntennaModel ()
+  : m_patternVersion (0)
 {
 }
 
@@ -49,6 +50,18 @@ AntennaModel::GetTypeId ()
   return tid;
 }
 
+uint32_t
+AntennaModel::GetPatternVersion (void) const
+{
+  return m_patternVersion;
+}
+
+void
+AntennaModel::NotifyPatternChanged (void)
+{
+  ++m_patternVersion;
+}
+
 
 
 }
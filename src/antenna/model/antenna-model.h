@@ -66,6 +66,29 @@ public:
    */
   virtual double GetGainDb (Angles a) = 0;
 
+  /**
+   * Users caching the values returned by GetGainDb (e.g., the spectrum
+   * channels) compare this value with the one they saw when filling
+   * their cache to detect that the radiation pattern has changed.
+   *
+   * \return a counter which is incremented every time a parameter of the
+   * radiation pattern is changed
+   */
+  uint32_t GetPatternVersion (void) const;
+
+protected:
+
+  /**
+   * Notify that a parameter of the radiation pattern has changed. Each
+   * antenna model is expected to call this method from the setters of
+   * all the attributes affecting the value returned by GetGainDb.
+   */
+  void NotifyPatternChanged (void);
+
+private:
+
+  uint32_t m_patternVersion; //!< incremented by NotifyPatternChanged
+
 };
 
 
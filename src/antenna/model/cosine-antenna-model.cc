@@ -56,7 +56,8 @@ CosineAntennaModel::GetTypeId ()
     .AddAttribute ("MaxGain",
                    "The gain (dB) at the antenna boresight (the direction of maximum gain)",
                    DoubleValue (0.0),
-                   MakeDoubleAccessor (&CosineAntennaModel::m_maxGain),
+                   MakeDoubleAccessor (&CosineAntennaModel::SetMaxGain,
+                                       &CosineAntennaModel::GetMaxGain),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -69,6 +70,7 @@ CosineAntennaModel::SetBeamwidth (double beamwidthDegrees)
   m_beamwidthRadians = DegreesToRadians (beamwidthDegrees);
   m_exponent = -3.0 / (20 * std::log10 (std::cos (m_beamwidthRadians / 4.0)));
   NS_LOG_LOGIC (this << " m_exponent = " << m_exponent);
+  NotifyPatternChanged ();
 }
 
 double
@@ -82,6 +84,7 @@ CosineAntennaModel::SetOrientation (double orientationDegrees)
 {
   NS_LOG_FUNCTION (this << orientationDegrees);
   m_orientationRadians = DegreesToRadians (orientationDegrees);
+  NotifyPatternChanged ();
 }
 
 double
@@ -90,6 +93,20 @@ CosineAntennaModel::GetOrientation () const
   return RadiansToDegrees (m_orientationRadians);
 }
 
+void
+CosineAntennaModel::SetMaxGain (double maxGainDb)
+{
+  NS_LOG_FUNCTION (this << maxGainDb);
+  m_maxGain = maxGainDb;
+  NotifyPatternChanged ();
+}
+
+double
+CosineAntennaModel::GetMaxGain () const
+{
+  return m_maxGain;
+}
+
 double 
 CosineAntennaModel::GetGainDb (Angles a)
 {
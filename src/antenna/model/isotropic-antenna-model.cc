@@ -44,7 +44,8 @@ IsotropicAntennaModel::GetTypeId ()
     .AddAttribute ("Gain",
                    "The gain of the antenna in dB",
                    DoubleValue (0),
-                   MakeDoubleAccessor (&IsotropicAntennaModel::m_gainDb),
+                   MakeDoubleAccessor (&IsotropicAntennaModel::SetGain,
+                                       &IsotropicAntennaModel::GetGain),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -55,6 +56,20 @@ IsotropicAntennaModel::IsotropicAntennaModel ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+IsotropicAntennaModel::SetGain (double gainDb)
+{
+  NS_LOG_FUNCTION (this << gainDb);
+  m_gainDb = gainDb;
+  NotifyPatternChanged ();
+}
+
+double
+IsotropicAntennaModel::GetGain () const
+{
+  return m_gainDb;
+}
+
 double 
 IsotropicAntennaModel::GetGainDb (Angles a)
 {
@@ -43,6 +43,10 @@ public:
   // inherited from AntennaModel
   virtual double GetGainDb (Angles a);
 
+  // attribute getters/setters
+  void SetGain (double gainDb);
+  double GetGain () const;
+
 protected:
 
   /**
@@ -56,7 +56,8 @@ ParabolicAntennaModel::GetTypeId ()
     .AddAttribute ("MaxAttenuation",
                    "The maximum attenuation (dB) of the antenna radiation pattern.",
                    DoubleValue (20.0),
-                   MakeDoubleAccessor (&ParabolicAntennaModel::m_maxAttenuation),
+                   MakeDoubleAccessor (&ParabolicAntennaModel::SetMaxAttenuation,
+                                       &ParabolicAntennaModel::GetMaxAttenuation),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -67,6 +68,7 @@ ParabolicAntennaModel::SetBeamwidth (double beamwidthDegrees)
 { 
   NS_LOG_FUNCTION (this << beamwidthDegrees);
   m_beamwidthRadians = DegreesToRadians (beamwidthDegrees);
+  NotifyPatternChanged ();
 }
 
 double
@@ -80,6 +82,7 @@ ParabolicAntennaModel::SetOrientation (double orientationDegrees)
 {
   NS_LOG_FUNCTION (this << orientationDegrees);
   m_orientationRadians = DegreesToRadians (orientationDegrees);
+  NotifyPatternChanged ();
 }
 
 double
@@ -88,6 +91,20 @@ ParabolicAntennaModel::GetOrientation () const
   return RadiansToDegrees (m_orientationRadians);
 }
 
+void
+ParabolicAntennaModel::SetMaxAttenuation (double maxAttenuationDb)
+{
+  NS_LOG_FUNCTION (this << maxAttenuationDb);
+  m_maxAttenuation = maxAttenuationDb;
+  NotifyPatternChanged ();
+}
+
+double
+ParabolicAntennaModel::GetMaxAttenuation () const
+{
+  return m_maxAttenuation;
+}
+
 double 
 ParabolicAntennaModel::GetGainDb (Angles a)
 {
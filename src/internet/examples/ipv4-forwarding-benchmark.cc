@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// This program measures the cost of forwarding IPv4 packets, as a function
+// of the number of routers crossed.
+//
+// For each number of routers, a chain of nodes linked by SimpleNetDevices
+// (without data rate limit) is built, with the routes computed by the
+// global routing, and a UDP socket of the first node sends nPackets
+// packets, spread over nDestinations addresses of the last node (with one
+// additional static route per destination on each router, as in a
+// routing table of realistic size). With checksum enabled, the routers
+// verify and update the IPv4 header checksum, and the UDP checksum is
+// computed by the sender and verified by the receiver.
+//
+// The output displays, for each number of routers, the wall clock time and
+// the average time spent per packet and router (the cost of the sender
+// and of the receiver is shared among the routers):
+//
+//   routers   wall(ms)   us/fwd
+//
+// Example usage:
+//
+//   ./waf --run "ipv4-forwarding-benchmark --routers=1,4,16 --forwardingCache=1"
+//   ./waf --run "ipv4-forwarding-benchmark --routers=1,4,16 --checksum=1"
+//
+
+#include "ns3/abort.h"
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Count a received packet
+ * \param received the number of received packets
+ * \param socket the receiving socket
+ */
+void
+Receive (uint64_t *received, Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      (*received)++;
+    }
+}
+
+/**
+ * Send a packet
+ * \param socket the sending socket
+ * \param destination the destination address
+ * \param packetSize the packet size
+ */
+void
+SendPacket (Ptr<Socket> socket, Ipv4Address destination, uint32_t packetSize)
+{
+  socket->SendTo (Create<Packet> (packetSize), 0, InetSocketAddress (destination, 9));
+}
+
+/**
+ * Schedule the sending of packets, one per microsecond
+ * \param socket the sending socket
+ * \param destinations the destination addresses
+ * \param nPackets the number of packets
+ * \param packetSize the packet size
+ */
+void
+SchedulePackets (Ptr<Socket> socket, const std::vector<Ipv4Address> &destinations,
+                 uint32_t nPackets, uint32_t packetSize)
+{
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      Simulator::ScheduleWithContext (socket->GetNode ()->GetId (), MicroSeconds (i), &SendPacket,
+                                      socket, destinations[i % destinations.size ()], packetSize);
+    }
+}
+
+/**
+ * Run the benchmark for a given number of routers
+ * \param nRouters the number of routers
+ * \param nPackets the number of packets
+ * \param nDestinations the number of destination addresses
+ * \param packetSize the packet size
+ * \param forwardingCacheSize the ForwardingCacheSize of the nodes
+ * \return the number of forwarding operations and the wall clock time in milliseconds
+ */
+std::pair<uint64_t, int64_t>
+RunBenchmark (uint32_t nRouters, uint32_t nPackets, uint32_t nDestinations,
+              uint32_t packetSize, uint32_t forwardingCacheSize)
+{
+  NodeContainer nodes;
+  nodes.Create (nRouters + 2);
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.0");
+  for (uint32_t i = 0; i + 1 < nodes.GetN (); i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices;
+      for (uint32_t j = i; j <= i + 1; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetChannel (channel);
+          nodes.Get (j)->AddDevice (device);
+          devices.Add (device);
+        }
+      address.Assign (devices);
+      address.NewNetwork ();
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // The destinations are additional addresses of the last node, reached by
+  // static routes on the routers
+  Ptr<Node> sinkNode = nodes.Get (nodes.GetN () - 1);
+  Ptr<Ipv4> sinkIpv4 = sinkNode->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper staticRouting;
+  std::vector<Ipv4Address> destinations;
+  for (uint32_t d = 0; d < nDestinations; d++)
+    {
+      Ipv4Address destination (Ipv4Address ("172.16.0.0").Get () + d + 1);
+      sinkIpv4->AddAddress (1, Ipv4InterfaceAddress (destination, Ipv4Mask ("255.255.255.255")));
+      destinations.push_back (destination);
+      for (uint32_t i = 0; i <= nRouters; i++)
+        {
+          Ptr<Ipv4> ipv4 = nodes.Get (i)->GetObject<Ipv4> ();
+          Ptr<Ipv4StaticRouting> routing = staticRouting.GetStaticRouting (ipv4);
+          uint32_t interface = (i == 0) ? 1 : 2;
+          Ipv4Address gateway = ipv4->GetAddress (interface, 0).GetLocal ();
+          gateway.Set (gateway.Get () + 1);
+          routing->AddHostRouteTo (destination, gateway, interface);
+        }
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->GetObject<Ipv4> ()->SetAttribute ("ForwardingCacheSize", UintegerValue (forwardingCacheSize));
+    }
+
+  uint64_t received = 0;
+  Ptr<Socket> sink = Socket::CreateSocket (sinkNode, UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeBoundCallback (&Receive, &received));
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+
+  // The ARP resolutions are done before the measure
+  SchedulePackets (source, destinations, nDestinations, packetSize);
+  Simulator::Run ();
+  received = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  SchedulePackets (source, destinations, nPackets, packetSize);
+  Simulator::Run ();
+  int64_t wallMs = clock.End ();
+
+  NS_ABORT_MSG_UNLESS (received == nPackets, "Lost packets: " << nPackets - received);
+  Simulator::Destroy ();
+  return std::make_pair (uint64_t (nPackets) * nRouters, wallMs);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string routers = "1,4,16";
+  uint32_t nPackets = 20000;
+  uint32_t nDestinations = 100;
+  uint32_t packetSize = 1000;
+  uint32_t forwardingCacheSize = 0;
+  bool checksum = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("routers", "Comma separated list of numbers of routers", routers);
+  cmd.AddValue ("nPackets", "Number of packets sent", nPackets);
+  cmd.AddValue ("nDestinations", "Number of destination addresses", nDestinations);
+  cmd.AddValue ("packetSize", "Size of the UDP payload, in bytes", packetSize);
+  cmd.AddValue ("forwardingCache", "Max number of entries of the forwarding cache (0 to disable)", forwardingCacheSize);
+  cmd.AddValue ("checksum", "Enable the checksums", checksum);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (checksum));
+
+  std::cout << "routers" << "\t" << "wall(ms)" << "\t" << "us/fwd" << std::endl;
+  std::istringstream iss (routers);
+  std::string token;
+  while (std::getline (iss, token, ','))
+    {
+      uint32_t nRouters = static_cast<uint32_t> (std::stoul (token));
+      std::pair<uint64_t, int64_t> result = RunBenchmark (nRouters, nPackets, nDestinations,
+                                                          packetSize, forwardingCacheSize);
+      std::cout << nRouters << "\t" << result.second << "\t\t"
+                << (result.second * 1000.0) / result.first << std::endl;
+    }
+  return 0;
+}
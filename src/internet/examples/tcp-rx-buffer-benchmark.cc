@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// This program measures the cost of the reassembly performed by a TCP
+// receiver (TcpRxBuffer), as a function of the number of segments in the
+// receive window, when segments are lost.
+//
+// For each window size, the program repeats the following round:
+// - window segments are sent; one segment every lossInterval is lost, the
+//   others are stored out of order, and the SACK list of the ACK is built;
+// - the retransmissions are received from the last to the first, so that
+//   each of them fills a hole and makes the list of blocks change;
+// - the application reads the whole window at once.
+//
+// With realData, the segments carry real bytes instead of virtual ones, so
+// that concatenating them on extraction copies them.
+//
+// The output displays, for each window size, the wall clock time and the
+// average time spent per segment received:
+//
+//   window   wall(ms)   us/segment
+//
+// Example usage:
+//
+//   ./waf --run "tcp-rx-buffer-benchmark --windows=1000,4000,16000 --realData=1"
+//
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-rx-buffer.h"
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Run the benchmark for a given window size
+ * \param window the number of segments in the receive window
+ * \param nRounds the number of rounds
+ * \param lossInterval one segment every lossInterval is lost
+ * \param segmentSize the segment size
+ * \param realData whether the segments carry real bytes
+ * \return the number of segments received and the wall clock time in milliseconds
+ */
+std::pair<uint64_t, int64_t>
+RunBenchmark (uint32_t window, uint32_t nRounds, uint32_t lossInterval,
+              uint32_t segmentSize, bool realData)
+{
+  Ptr<TcpRxBuffer> rxBuffer = CreateObject<TcpRxBuffer> ();
+  rxBuffer->SetNextRxSequence (SequenceNumber32 (1));
+  rxBuffer->SetMaxBufferSize (window * segmentSize);
+
+  std::vector<uint8_t> payload (segmentSize, 0x5a);
+  uint64_t nSegments = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t round = 0; round < nRounds; round++)
+    {
+      SequenceNumber32 head = rxBuffer->NextRxSequence ();
+      std::vector<SequenceNumber32> lost;
+      TcpHeader tcph;
+      for (uint32_t i = 0; i < window; i++)
+        {
+          SequenceNumber32 seq = head + i * segmentSize;
+          if (i % lossInterval == 0)
+            {
+              lost.push_back (seq);
+              continue;
+            }
+          tcph.SetSequenceNumber (seq);
+          rxBuffer->Add (realData ? Create<Packet> (&payload[0], segmentSize)
+                                  : Create<Packet> (segmentSize), tcph);
+          rxBuffer->GetSackList ();
+          nSegments++;
+        }
+      for (std::vector<SequenceNumber32>::reverse_iterator it = lost.rbegin (); it != lost.rend (); ++it)
+        {
+          tcph.SetSequenceNumber (*it);
+          rxBuffer->Add (realData ? Create<Packet> (&payload[0], segmentSize)
+                                  : Create<Packet> (segmentSize), tcph);
+          rxBuffer->GetSackList ();
+          nSegments++;
+        }
+      Ptr<Packet> p = rxBuffer->Extract (window * segmentSize);
+      NS_ASSERT (p && p->GetSize () == window * segmentSize);
+      NS_ASSERT (rxBuffer->Size () == 0);
+    }
+  int64_t wallMs = clock.End ();
+
+  Simulator::Destroy ();
+  return std::make_pair (nSegments, wallMs);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string windows = "1000,4000,16000";
+  uint32_t nRounds = 2;
+  uint32_t lossInterval = 100;
+  uint32_t segmentSize = 1448;
+  bool realData = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("windows", "Comma separated list of window sizes, in segments", windows);
+  cmd.AddValue ("nRounds", "Number of rounds per window size", nRounds);
+  cmd.AddValue ("lossInterval", "One segment every lossInterval is lost", lossInterval);
+  cmd.AddValue ("segmentSize", "Segment size, in bytes", segmentSize);
+  cmd.AddValue ("realData", "Segments carry real bytes instead of virtual ones", realData);
+  cmd.Parse (argc, argv);
+
+  std::cout << "window" << "\t" << "wall(ms)" << "\t" << "us/segment" << std::endl;
+  std::istringstream iss (windows);
+  std::string token;
+  while (std::getline (iss, token, ','))
+    {
+      uint32_t window = static_cast<uint32_t> (std::stoul (token));
+      std::pair<uint64_t, int64_t> result = RunBenchmark (window, nRounds, lossInterval,
+                                                          segmentSize, realData);
+      std::cout << window << "\t" << result.second << "\t\t"
+                << (result.second * 1000.0) / result.first << std::endl;
+    }
+  return 0;
+}
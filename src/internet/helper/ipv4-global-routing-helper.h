@@ -84,6 +84,17 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes that were previously installed after a change
+   * of the topology, like RecomputeRoutingTables(), but recomputing only
+   * the shortest path trees of the nodes affected by the change.
+   *
+   * The first call recomputes all the routes, and records the shortest path
+   * tree of every node, so that the later calls can update them.
+   *
+   * \see GlobalRouteManagerImpl::UpdateRoutes
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
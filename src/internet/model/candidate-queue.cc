@@ -51,22 +51,24 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::Before);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_nextOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +96,13 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  c.order = m_nextOrder++;
+  m_candidates.push_back (c);
+  m_positions[vNew] = m_candidates.size () - 1;
+  m_vertices.insert (std::make_pair (vNew->GetVertexId (), vNew));
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +114,20 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  m_positions.erase (v);
+  std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash>::iterator i = m_vertices.find (v->GetVertexId ());
+  if (i != m_vertices.end () && i->second == v)
+    {
+      m_vertices.erase (i);
+    }
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +140,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,15 +161,10 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash>::const_iterator i = m_vertices.find (addr);
+  if (i != m_vertices.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return i->second;
     }
 
   return 0;
@@ -164,11 +175,93 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i-- > 0; )
+    {
+      SiftDown (i);
+    }
+  NS_LOG_LOGIC ("After reordering the CandidateQueue");
+  NS_LOG_LOGIC (*this);
+}
+
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::unordered_map<const SPFVertex*, uint32_t>::const_iterator i = m_positions.find (v);
+  NS_ASSERT_MSG (i != m_positions.end (), "Vertex not in the CandidateQueue");
+  uint32_t position = i->second;
+  m_candidates[position].order = m_nextOrder++;
+  SiftUp (position);
+  SiftDown (m_positions[v]);
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+bool
+CandidateQueue::Before (const Candidate &c1, const Candidate &c2)
+{
+  if (CompareSPFVertex (c1.vertex, c2.vertex))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (c2.vertex, c1.vertex))
+    {
+      return false;
+    }
+  return c1.order < c2.order;
+}
+
+void
+CandidateQueue::Place (uint32_t i, const Candidate &c)
+{
+  m_candidates[i] = c;
+  m_positions[c.vertex] = i;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!Before (c, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (i, m_candidates[parent]);
+      i = parent;
+    }
+  Place (i, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  uint32_t n = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * i + 1;
+      if (child >= n)
+        {
+          break;
+        }
+      if (child + 1 < n && Before (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!Before (m_candidates[child], c))
+        {
+          break;
+        }
+      Place (i, m_candidates[child]);
+      i = child;
+    }
+  Place (i, c);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
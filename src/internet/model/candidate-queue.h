@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,11 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap, indexed by vertex and by vertex ID, so that
+ * Push (), Pop () and Reorder () of a vertex take logarithmic time and
+ * Find () constant time.  Vertices of equal rank are popped in the order
+ * in which they were pushed (or reordered), like in a sorted list.
  */
 class CandidateQueue
 {
@@ -154,6 +160,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Reorders the Candidate Queue after the value of the field
+ * m_distanceFromRoot of one of its vertices changed.
+ *
+ * The vertex is then ranked after the other vertices of equal rank, as if
+ * it was pushed again.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance changed.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +202,46 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /// A vertex of the heap
+  struct Candidate
+  {
+    SPFVertex *vertex; //!< the vertex
+    uint64_t order;    //!< the order in which the vertex was pushed or reordered
+  };
+
+/**
+ * \brief return true if c1 should be popped before c2
+ *
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool Before (const Candidate &c1, const Candidate &c2);
+
+/**
+ * \brief Store a candidate at a position of the heap
+ * \param i the position
+ * \param c the candidate
+ */
+  void Place (uint32_t i, const Candidate &c);
+
+/**
+ * \brief Move a candidate towards the top of the heap
+ * \param i the position of the candidate
+ */
+  void SiftUp (uint32_t i);
+
+/**
+ * \brief Move a candidate towards the bottom of the heap
+ * \param i the position of the candidate
+ */
+  void SiftDown (uint32_t i);
+
+  typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  std::unordered_map<const SPFVertex*, uint32_t> m_positions; //!< position of the candidates in the heap
+  std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash> m_vertices; //!< candidates by vertex ID
+  uint64_t m_nextOrder; //!< order of the next candidate pushed or reordered
 
   /**
    * \brief Stream insertion operator.
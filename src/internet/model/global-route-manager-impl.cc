@@ -26,6 +26,7 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <iterator>
 #include <iostream>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -446,6 +447,8 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_linkDataIndex.clear ();
+  m_stubNetworkIndex.clear ();
 }
 
 void
@@ -470,7 +473,37 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      std::pair<LSDBMap_t::iterator, bool> inserted = m_database.insert (LSDBPair_t (addr, lsa));
+      if (!inserted.second)
+        {
+          return;
+        }
+//
+// Index the StubNetwork link records by network, and the TransitNetwork link
+// records by LinkData.  If several LSAs have the same LinkData, the first
+// one in the database order is found.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              uint32_t mask = lr->GetLinkData ().Get ();
+              m_stubNetworkIndex.insert (std::make_pair (lr->GetLinkId ().CombineMask (Ipv4Mask (mask)),
+                                                         std::make_pair (mask, LSDBMap_t::const_iterator (inserted.first))));
+              continue;
+            }
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<std::unordered_map<Ipv4Address, LSDBMap_t::const_iterator, Ipv4AddressHash>::iterator, bool> indexed =
+            m_linkDataIndex.insert (std::make_pair (lr->GetLinkData (), LSDBMap_t::const_iterator (inserted.first)));
+          if (!indexed.second && addr < indexed.first->second->first)
+            {
+              indexed.first->second = inserted.first;
+            }
+        }
     }
 }
 
@@ -495,13 +528,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,24 +541,106 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the LinkData of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  std::unordered_map<Ipv4Address, LSDBMap_t::const_iterator, Ipv4AddressHash>::const_iterator i =
+    m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      return i->second->second;
+    }
+  return 0;
+}
+
+void
+GlobalRouteManagerLSDB::GetStubNetworkLSAs (Ipv4Address network, Ipv4Mask mask, std::vector<GlobalRoutingLSA*>& lsas) const
+{
+  NS_LOG_FUNCTION (this << network << mask);
+  lsas.clear ();
+  typedef std::unordered_multimap<Ipv4Address, std::pair<uint32_t, LSDBMap_t::const_iterator>, Ipv4AddressHash>::const_iterator StubNetworkIndexCI;
+  std::pair<StubNetworkIndexCI, StubNetworkIndexCI> range = m_stubNetworkIndex.equal_range (network);
+  for (StubNetworkIndexCI i = range.first; i != range.second; i++)
+    {
+      if (i->second.first == mask.Get ())
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          lsas.push_back (i->second.second->second);
+        }
+    }
+}
+
+/**
+ * \brief Compare the contents of two Link State Advertisements
+ * \param a an LSA
+ * \param b another LSA
+ * \returns true if the LSAs have the same type, link state ID, advertising
+ * router, network mask, link records and attached routers
+ */
+static bool
+IsSameLSA (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || !a->GetNetworkLSANetworkMask ().IsEqual (b->GetNetworkLSANetworkMask ())
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerLSDB::GetChangedLSAs (const GlobalRouteManagerLSDB& other, std::vector<Ipv4Address>& changed) const
+{
+  NS_LOG_FUNCTION (this << &other);
+//
+// Both databases are sorted by link state ID: walk them side by side.
+//
+  changed.clear ();
+  LSDBMap_t::const_iterator i = m_database.begin ();
+  LSDBMap_t::const_iterator j = other.m_database.begin ();
+  while (i != m_database.end () || j != other.m_database.end ())
+    {
+      if (j == other.m_database.end () || (i != m_database.end () && i->first < j->first))
+        {
+          changed.push_back (i->first);
+          i++;
+        }
+      else if (i == m_database.end () || j->first < i->first)
+        {
+          changed.push_back (j->first);
+          j++;
+        }
+      else
+        {
+          if (!IsSameLSA (i->second, j->second))
             {
-              return temp;
+              changed.push_back (i->first);
             }
+          i++;
+          j++;
         }
     }
-  return 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -539,7 +651,9 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfrootNode (NodeList::End ()),
+    m_recordSPFTrees (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -565,6 +679,30 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
   m_lsdb = lsdb;
 }
 
+void
+GlobalRouteManagerImpl::DeleteNodeRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
 {
@@ -572,26 +710,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteNodeRoutes (*i);
     }
+  m_recordSPFTrees = false;
+  m_spfTrees.clear ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -700,6 +822,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  m_spfTrees.clear ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -730,6 +853,555 @@ GlobalRouteManagerImpl::InitializeRoutes ()
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+/**
+ * \brief Get the edges of the SPF graph from a vertex, as followed by
+ * GlobalRouteManagerImpl::SPFNext ()
+ *
+ * \param lsdb the routing database
+ * \param id the ID of the vertex
+ * \param edges the IDs of the destinations of the edges with their metrics,
+ * sorted
+ */
+static void
+GetSPFEdges (const GlobalRouteManagerLSDB* lsdb, Ipv4Address id,
+             std::vector<std::pair<Ipv4Address, uint32_t> >& edges)
+{
+  edges.clear ();
+  GlobalRoutingLSA *lsa = lsdb->GetLSA (id);
+  if (lsa == 0)
+    {
+      return;
+    }
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
+            {
+              edges.push_back (std::make_pair (l->GetLinkId (), (uint32_t) l->GetMetric ()));
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+        {
+          GlobalRoutingLSA *w_lsa = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (i));
+          if (w_lsa)
+            {
+              edges.push_back (std::make_pair (w_lsa->GetLinkStateId (), (uint32_t) 0));
+            }
+        }
+    }
+  std::sort (edges.begin (), edges.end ());
+}
+
+/// A route of the root to an address or a network of a vertex of the SPF tree
+struct SPFVertexRoute
+{
+  bool host;           //!< true for a host route, false for a network route
+  Ipv4Address dest;    //!< the destination address or network
+  uint32_t mask;       //!< the network mask
+  Ipv4Address nextHop; //!< the next hop
+  int32_t interface;   //!< the outgoing interface
+};
+
+/**
+ * \brief Order the destinations of the routes to the vertices of the SPF tree
+ * \param a a route
+ * \param b another route
+ * \returns true if the destination of a is before the one of b
+ */
+static bool
+SPFVertexRouteDestLess (const SPFVertexRoute& a, const SPFVertexRoute& b)
+{
+  if (a.host != b.host)
+    {
+      return a.host < b.host;
+    }
+  if (a.dest != b.dest)
+    {
+      return a.dest < b.dest;
+    }
+  return a.mask < b.mask;
+}
+
+/**
+ * \brief Order the routes to the vertices of the SPF tree by destination
+ * \param a a route, with the ID of its vertex
+ * \param b another route, with the ID of its vertex
+ * \returns true if the destination of a is before the one of b
+ */
+static bool
+SPFDestLess (const std::pair<SPFVertexRoute, Ipv4Address>& a, const std::pair<SPFVertexRoute, Ipv4Address>& b)
+{
+  return SPFVertexRouteDestLess (a.first, b.first);
+}
+
+/**
+ * \brief Compare two routes to the vertices of the SPF tree
+ * \param a a route
+ * \param b another route
+ * \returns true if the routes are the same
+ */
+static bool
+SPFVertexRouteEqual (const SPFVertexRoute& a, const SPFVertexRoute& b)
+{
+  return a.host == b.host && a.dest == b.dest && a.mask == b.mask
+         && a.nextHop == b.nextHop && a.interface == b.interface;
+}
+
+/**
+ * \brief Add a route to an address or a network of a vertex through each of
+ * its root exit directions
+ *
+ * \param route the destination of the route
+ * \param exits the root exit directions of the vertex
+ * \param routes the routes
+ */
+static void
+AddSPFVertexRoutes (SPFVertexRoute route, const std::vector<SPFVertex::NodeExit_t>& exits,
+                    std::vector<SPFVertexRoute>& routes)
+{
+  for (uint32_t i = 0; i < exits.size (); i++)
+    {
+      if (exits[i].second >= 0)
+        {
+          route.nextHop = exits[i].first;
+          route.interface = exits[i].second;
+          routes.push_back (route);
+        }
+    }
+}
+
+/**
+ * \brief Get the routes to the addresses and networks of a vertex, in the
+ * order in which they are added by GlobalRouteManagerImpl::SPFIntraAddRouter (),
+ * GlobalRouteManagerImpl::SPFIntraAddTransit () and
+ * GlobalRouteManagerImpl::SPFIntraAddStub ()
+ *
+ * \param lsa the LSA of the vertex, or 0 if the vertex is not in the tree
+ * \param exits the root exit directions of the vertex
+ * \param routes the routes
+ */
+static void
+GetSPFVertexRoutes (const GlobalRoutingLSA* lsa, const std::vector<SPFVertex::NodeExit_t>& exits,
+                    std::vector<SPFVertexRoute>& routes)
+{
+  routes.clear ();
+  if (lsa == 0)
+    {
+      return;
+    }
+  SPFVertexRoute route;
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              route.host = true;
+              route.dest = l->GetLinkData ();
+              route.mask = 0xffffffff;
+              AddSPFVertexRoutes (route, exits, routes);
+            }
+        }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              route.host = false;
+              route.mask = l->GetLinkData ().Get ();
+              route.dest = l->GetLinkId ().CombineMask (Ipv4Mask (route.mask));
+              AddSPFVertexRoutes (route, exits, routes);
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      route.host = false;
+      route.mask = lsa->GetNetworkLSANetworkMask ().Get ();
+      route.dest = lsa->GetLinkStateId ().CombineMask (Ipv4Mask (route.mask));
+      AddSPFVertexRoutes (route, exits, routes);
+    }
+}
+
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_recordSPFTrees)
+    {
+      NS_LOG_LOGIC ("No recorded shortest path trees, computing all the routes");
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      m_recordSPFTrees = true;
+      InitializeRoutes ();
+      return;
+    }
+//
+// Build the new routing database, keeping the one of the recorded trees.
+//
+  GlobalRouteManagerLSDB* oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  if (oldLsdb->GetNumExtLSAs () > 0 || m_lsdb->GetNumExtLSAs () > 0)
+    {
+      NS_LOG_LOGIC ("External LSAs, computing all the routes");
+      for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+        {
+          DeleteNodeRoutes (*i);
+        }
+      delete oldLsdb;
+      InitializeRoutes ();
+      return;
+    }
+  std::vector<Ipv4Address> changed;
+  m_lsdb->GetChangedLSAs (*oldLsdb, changed);
+  NS_LOG_LOGIC (changed.size () << " LSAs changed");
+  if (changed.empty ())
+    {
+      delete oldLsdb;
+      return;
+    }
+//
+// Find the changed vertices and edges of the SPF graph.  The edges from a
+// network are found through the LSAs of its attached routers, so that the
+// edges of the networks of the changed routers are compared too.
+//
+  std::vector<SPFChange_t> vertices;
+  std::vector<Ipv4Address> sources (changed);
+  for (std::vector<Ipv4Address>::const_iterator i = changed.begin (); i != changed.end (); i++)
+    {
+      GlobalRoutingLSA *lsas[2] = { oldLsdb->GetLSA (*i), m_lsdb->GetLSA (*i) };
+      vertices.push_back (std::make_pair (*i, lsas[0] == 0 || lsas[1] == 0
+                                          || lsas[0]->GetLSType () != lsas[1]->GetLSType ()));
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          if (lsas[j] == 0 || lsas[j]->GetLSType () != GlobalRoutingLSA::RouterLSA)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < lsas[j]->GetNLinkRecords (); k++)
+            {
+              GlobalRoutingLinkRecord *l = lsas[j]->GetLinkRecord (k);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  sources.push_back (l->GetLinkId ());
+                }
+            }
+        }
+    }
+  std::sort (sources.begin (), sources.end ());
+  sources.erase (std::unique (sources.begin (), sources.end ()), sources.end ());
+  std::vector<SPFEdge_t> removedEdges;
+  std::vector<SPFEdge_t> addedEdges;
+  std::vector<std::pair<Ipv4Address, uint32_t> > oldEdges;
+  std::vector<std::pair<Ipv4Address, uint32_t> > newEdges;
+  std::vector<std::pair<Ipv4Address, uint32_t> > edges;
+  for (std::vector<Ipv4Address>::const_iterator i = sources.begin (); i != sources.end (); i++)
+    {
+      GetSPFEdges (oldLsdb, *i, oldEdges);
+      GetSPFEdges (m_lsdb, *i, newEdges);
+      edges.clear ();
+      std::set_difference (oldEdges.begin (), oldEdges.end (), newEdges.begin (), newEdges.end (),
+                           std::back_inserter (edges));
+      for (uint32_t j = 0; j < edges.size (); j++)
+        {
+          removedEdges.push_back (std::make_pair (*i, edges[j]));
+        }
+      edges.clear ();
+      std::set_difference (newEdges.begin (), newEdges.end (), oldEdges.begin (), oldEdges.end (),
+                           std::back_inserter (edges));
+      for (uint32_t j = 0; j < edges.size (); j++)
+        {
+          addedEdges.push_back (std::make_pair (*i, edges[j]));
+        }
+    }
+  NS_LOG_LOGIC (removedEdges.size () << " edges removed, " << addedEdges.size () << " edges added");
+//
+// Update the routes to the changed vertices of the unaffected trees.  For
+// the affected trees, compute the SPF again without adding the routes, and
+// update the routes to the vertices whose LSA or root exit directions
+// changed.  The SPF of a router whose own LSA changed, or of a stub router,
+// is computed again from scratch.
+//
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr || node->GetSystemId () != systemId)
+        {
+          continue;
+        }
+      Ipv4Address root = rtr->GetRouterId ();
+      std::unordered_map<Ipv4Address, SPFTree, Ipv4AddressHash>::iterator tree = m_spfTrees.find (root);
+      if (!rtr->GetNumLSAs ())
+        {
+          if (tree != m_spfTrees.end ())
+            {
+              DeleteNodeRoutes (node);
+              m_spfTrees.erase (tree);
+            }
+          continue;
+        }
+      if (tree != m_spfTrees.end ()
+          && !IsSPFTreeAffected (tree->second, vertices, removedEdges, addedEdges))
+        {
+          UpdateSPFTreeRoutes (rtr->GetRoutingProtocol (), root, tree->second, 0, changed, oldLsdb);
+          continue;
+        }
+      if (tree != m_spfTrees.end () && !tree->second.stub
+          && !std::binary_search (changed.begin (), changed.end (), root))
+        {
+          SPFTree oldTree;
+          oldTree.vertices.swap (tree->second.vertices);
+          SPFCalculate (root, false);
+          const SPFTree &newTree = m_spfTrees[root];
+          if (!newTree.stub)
+            {
+              UpdateSPFTreeRoutes (rtr->GetRoutingProtocol (), root, oldTree, &newTree, changed, oldLsdb);
+              continue;
+            }
+        }
+      NS_LOG_LOGIC ("Computing the SPF of router " << root);
+      DeleteNodeRoutes (node);
+      SPFCalculate (root);
+    }
+  delete oldLsdb;
+}
+
+bool
+GlobalRouteManagerImpl::IsSPFTreeAffected (const SPFTree& tree,
+                                           const std::vector<SPFChange_t>& vertices,
+                                           const std::vector<SPFEdge_t>& removedEdges,
+                                           const std::vector<SPFEdge_t>& addedEdges) const
+{
+  NS_LOG_FUNCTION (this);
+  std::unordered_map<Ipv4Address, SPFTreeVertex, Ipv4AddressHash>::const_iterator from;
+  std::unordered_map<Ipv4Address, SPFTreeVertex, Ipv4AddressHash>::const_iterator to;
+  for (std::vector<SPFChange_t>::const_iterator i = vertices.begin (); i != vertices.end (); i++)
+    {
+      from = tree.vertices.find (i->first);
+      if (from != tree.vertices.end () && (from->second.direct || i->second))
+        {
+          return true;
+        }
+    }
+  if (tree.stub)
+    {
+      return false;
+    }
+//
+// A removed edge on a shortest path removes a parent of its destination.
+//
+  for (std::vector<SPFEdge_t>::const_iterator i = removedEdges.begin (); i != removedEdges.end (); i++)
+    {
+      from = tree.vertices.find (i->first);
+      to = tree.vertices.find (i->second.first);
+      if (from != tree.vertices.end () && to != tree.vertices.end ()
+          && from->second.distance + i->second.second == to->second.distance)
+        {
+          return true;
+        }
+    }
+//
+// An added edge from the tree reaches a new vertex, or makes a shorter or
+// equal cost path.
+//
+  for (std::vector<SPFEdge_t>::const_iterator i = addedEdges.begin (); i != addedEdges.end (); i++)
+    {
+      from = tree.vertices.find (i->first);
+      if (from == tree.vertices.end ())
+        {
+          continue;
+        }
+      to = tree.vertices.find (i->second.first);
+      if (to == tree.vertices.end ()
+          || from->second.distance + i->second.second <= to->second.distance)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::UpdateSPFTreeRoutes (Ptr<Ipv4GlobalRouting> gr, Ipv4Address root,
+                                             const SPFTree& oldTree, const SPFTree* newTree,
+                                             const std::vector<Ipv4Address>& changed,
+                                             const GlobalRouteManagerLSDB* oldLsdb)
+{
+  NS_LOG_FUNCTION (this << gr << root << newTree << oldLsdb);
+  std::unordered_map<Ipv4Address, SPFTreeVertex, Ipv4AddressHash>::const_iterator oldVertex;
+  std::unordered_map<Ipv4Address, SPFTreeVertex, Ipv4AddressHash>::const_iterator newVertex;
+//
+// Find the vertices whose LSA or root exit directions changed.
+//
+  std::vector<Ipv4Address> ids;
+  if (newTree == 0)
+    {
+      newTree = &oldTree;
+      for (std::vector<Ipv4Address>::const_iterator i = changed.begin (); i != changed.end (); i++)
+        {
+          oldVertex = oldTree.vertices.find (*i);
+          if (oldVertex != oldTree.vertices.end ())
+            {
+              NS_ASSERT (!oldVertex->second.direct);
+              ids.push_back (*i);
+            }
+        }
+    }
+  else
+    {
+      for (oldVertex = oldTree.vertices.begin (); oldVertex != oldTree.vertices.end (); oldVertex++)
+        {
+          Ipv4Address id = oldVertex->first;
+          if (id == root)
+            {
+              continue;
+            }
+          newVertex = newTree->vertices.find (id);
+          if (newVertex == newTree->vertices.end ()
+              || std::binary_search (changed.begin (), changed.end (), id)
+              || oldVertex->second.exits != newVertex->second.exits)
+            {
+              ids.push_back (id);
+            }
+        }
+      for (newVertex = newTree->vertices.begin (); newVertex != newTree->vertices.end (); newVertex++)
+        {
+          if (newVertex->first != root && oldTree.vertices.find (newVertex->first) == oldTree.vertices.end ())
+            {
+              ids.push_back (newVertex->first);
+            }
+        }
+    }
+//
+// Find the destinations whose routes changed, with the vertices which have
+// routes to them.
+//
+  static const std::vector<SPFVertex::NodeExit_t> noExits;
+  const SPFTree *trees[2] = { &oldTree, newTree };
+  const GlobalRouteManagerLSDB *lsdbs[2] = { oldLsdb, m_lsdb };
+  std::vector<SPFVertexRoute> routes[2];
+  std::vector<std::pair<SPFVertexRoute, Ipv4Address> > dests;
+  for (std::vector<Ipv4Address>::const_iterator i = ids.begin (); i != ids.end (); i++)
+    {
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          oldVertex = trees[k]->vertices.find (*i);
+          if (oldVertex == trees[k]->vertices.end ())
+            {
+              GetSPFVertexRoutes (0, noExits, routes[k]);
+            }
+          else
+            {
+              GetSPFVertexRoutes (lsdbs[k]->GetLSA (*i), oldVertex->second.exits, routes[k]);
+            }
+        }
+      if (routes[0].size () == routes[1].size ()
+          && std::equal (routes[0].begin (), routes[0].end (), routes[1].begin (), SPFVertexRouteEqual))
+        {
+          continue;
+        }
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          for (std::vector<SPFVertexRoute>::const_iterator r = routes[k].begin (); r != routes[k].end (); r++)
+            {
+              dests.push_back (std::make_pair (*r, *i));
+            }
+        }
+    }
+  std::sort (dests.begin (), dests.end (), SPFDestLess);
+//
+// Remove all the routes to each destination, and add them again in the
+// order of SPFCalculate (): the routes to a transit network first, then the
+// routes through the routers with a stub link record to it, in the order of
+// SPFProcessStubs (), each through the root exit directions in order.
+//
+  std::vector<Ipv4Address> vertices;
+  std::vector<GlobalRoutingLSA*> lsas;
+  std::vector<std::pair<std::pair<bool, uint32_t>, Ipv4Address> > ranks;
+  for (uint32_t i = 0; i < dests.size (); )
+    {
+      const SPFVertexRoute &dest = dests[i].first;
+      vertices.clear ();
+      for (; i < dests.size () && !SPFVertexRouteDestLess (dest, dests[i].first); i++)
+        {
+          vertices.push_back (dests[i].second);
+        }
+      if (!dest.host)
+        {
+          for (uint32_t k = 0; k < 2; k++)
+            {
+              lsdbs[k]->GetStubNetworkLSAs (dest.dest, Ipv4Mask (dest.mask), lsas);
+              for (std::vector<GlobalRoutingLSA*>::const_iterator l = lsas.begin (); l != lsas.end (); l++)
+                {
+                  vertices.push_back ((*l)->GetLinkStateId ());
+                }
+            }
+        }
+      std::sort (vertices.begin (), vertices.end ());
+      vertices.erase (std::unique (vertices.begin (), vertices.end ()), vertices.end ());
+      ranks.clear ();
+      for (std::vector<Ipv4Address>::const_iterator v = vertices.begin (); v != vertices.end (); v++)
+        {
+          oldVertex = oldTree.vertices.find (*v);
+          if (oldVertex != oldTree.vertices.end ())
+            {
+              GetSPFVertexRoutes (oldLsdb->GetLSA (*v), oldVertex->second.exits, routes[0]);
+              for (std::vector<SPFVertexRoute>::const_iterator r = routes[0].begin (); r != routes[0].end (); r++)
+                {
+                  if (SPFVertexRouteDestLess (*r, dest) || SPFVertexRouteDestLess (dest, *r))
+                    {
+                      continue;
+                    }
+                  if (r->host)
+                    {
+                      gr->RemoveHostRouteTo (r->dest, r->nextHop, r->interface);
+                    }
+                  else
+                    {
+                      gr->RemoveNetworkRouteTo (r->dest, Ipv4Mask (r->mask), r->nextHop, r->interface);
+                    }
+                }
+            }
+          newVertex = newTree->vertices.find (*v);
+          if (newVertex != newTree->vertices.end ())
+            {
+              bool transit = m_lsdb->GetLSA (*v)->GetLSType () == GlobalRoutingLSA::NetworkLSA;
+              ranks.push_back (std::make_pair (std::make_pair (!transit, newVertex->second.stubOrder), *v));
+            }
+        }
+      std::sort (ranks.begin (), ranks.end ());
+      for (uint32_t j = 0; j < ranks.size (); j++)
+        {
+          newVertex = newTree->vertices.find (ranks[j].second);
+          GetSPFVertexRoutes (m_lsdb->GetLSA (ranks[j].second), newVertex->second.exits, routes[1]);
+          for (std::vector<SPFVertexRoute>::const_iterator r = routes[1].begin (); r != routes[1].end (); r++)
+            {
+              if (SPFVertexRouteDestLess (*r, dest) || SPFVertexRouteDestLess (dest, *r))
+                {
+                  continue;
+                }
+              if (r->host)
+                {
+                  gr->AddHostRouteTo (r->dest, r->nextHop, r->interface);
+                }
+              else
+                {
+                  gr->AddNetworkRouteTo (r->dest, Ipv4Mask (r->mask), r->nextHop, r->interface);
+                }
+            }
+        }
+    }
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -960,7 +1632,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1124,7 +1796,8 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
         }
       else 
         {
-          w->SetRootExitDirection (v->GetRootExitDirection ());
+// The network may be reached through several equal cost paths
+          w->InheritAllRootExitDirections (v);
         }
     }
   else 
@@ -1339,9 +2012,9 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root, bool addRoutes)
 {
-  NS_LOG_FUNCTION (this << root);
+  NS_LOG_FUNCTION (this << root << addRoutes);
 
   SPFVertex *v;
 //
@@ -1366,9 +2039,38 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+//
+// The routes are written to the node of the root.  Find it once for all
+// rather than every time a route is added.
+//
+  m_spfrootNode = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == root)
+        {
+          m_spfrootNode = i;
+          break;
+        }
+    }
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
+//
+// Record the tree for UpdateRoutes ().  The root exit directions of the
+// vertices depend on the LSA of the root, which is recorded as adjacent to
+// itself.
+//
+  SPFTree *tree = 0;
+  if (m_recordSPFTrees)
+    {
+      tree = &m_spfTrees[root];
+      tree->stub = false;
+      tree->vertices.clear ();
+      SPFTreeVertex &vertex = tree->vertices[root];
+      vertex.distance = 0;
+      vertex.direct = true;
+    }
 
 //
 // Optimize SPF calculation, for ns-3.
@@ -1380,6 +2082,22 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (tree)
+        {
+//
+// The default route depends on the LSAs of the root and of its neighbor only.
+//
+          tree->stub = true;
+          GlobalRoutingLSA *rlsa = m_spfroot->GetLSA ();
+          for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+            {
+              GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
+              if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  tree->vertices[l->GetLinkId ()].direct = true;
+                }
+            }
+        }
       delete m_spfroot;
       return;
     }
@@ -1438,6 +2156,30 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
       SPFVertexAddParent (v);
 //
+// The distance and root exit directions of the vertex are final.  They
+// depend on its LSA if it is adjacent to the root, directly or through a
+// network.
+//
+      if (tree)
+        {
+          SPFTreeVertex &vertex = tree->vertices[v->GetVertexId ()];
+          vertex.distance = v->GetDistanceFromRoot ();
+          vertex.direct = false;
+          SPFVertex *parent;
+          for (uint32_t i = 0; (parent = v->GetParent (i)) != 0; i++)
+            {
+              if (parent == m_spfroot
+                  || (parent->GetVertexType () == SPFVertex::VertexNetwork && parent->GetParent () == m_spfroot))
+                {
+                  vertex.direct = true;
+                }
+            }
+          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+            {
+              vertex.exits.push_back (v->GetRootExitDirection (i));
+            }
+        }
+//
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
 // find all equal-cost paths. 
@@ -1465,6 +2207,10 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // through its point-to-point links, adding a *host* route to the local IP
 // address (at the <v> side) for each of those links.
 //
+      if (!addRoutes)
+        {
+          continue;
+        }
       if (v->GetVertexType () == SPFVertex::VertexRouter)
         {
           SPFIntraAddRouter (v);
@@ -1486,8 +2232,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     }  // end for loop
 
 // Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
-  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+  if (addRoutes || tree)
+    {
+      uint32_t order = 0;
+      SPFProcessStubs (m_spfroot, addRoutes, tree, order);
+    }
+  for (uint32_t i = 0; addRoutes && i < m_lsdb->GetNumExtLSAs (); i++)
     {
       m_spfroot->ClearVertexProcessed ();
       GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
@@ -1502,6 +2252,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootNode = NodeList::End ();
 }
 
 void
@@ -1562,9 +2313,10 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  SPFCalculate () already found it, so start
+// the walk there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode; 
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1666,11 +2418,16 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v, bool addRoutes, SPFTree* tree, uint32_t& order)
 {
-  NS_LOG_FUNCTION (this << v);
+  NS_LOG_FUNCTION (this << v << addRoutes << tree << order);
   NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  if (tree)
+    {
+      tree->vertices[v->GetVertexId ()].stubOrder = order;
+    }
+  order++;
+  if (addRoutes && v->GetVertexType () == SPFVertex::VertexRouter)
     {
       GlobalRoutingLSA *rlsa = v->GetLSA ();
       NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
@@ -1692,7 +2449,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
-          SPFProcessStubs (v->GetChild (i));
+          SPFProcessStubs (v->GetChild (i), addRoutes, tree, order);
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1731,9 +2488,10 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  SPFCalculate () already found it, so start
+// the walk there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode; 
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1855,9 +2613,10 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
 // Walk the list of nodes in the system looking for the one corresponding to
 // the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// building the routing table.  SPFCalculate () already found it, so start
+// the walk there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode; 
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1946,9 +2705,10 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  SPFCalculate () already found it, so start
+// the walk there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode; 
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -2091,9 +2851,10 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  SPFCalculate () already found it, so start
+// the walk there.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode; 
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
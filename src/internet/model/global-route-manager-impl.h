@@ -27,9 +27,11 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/node-list.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -641,6 +643,16 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Look up the Link State Advertisements with a StubNetwork link
+ * record to the given network.
+ *
+ * @param network the network address
+ * @param mask the network mask
+ * @param lsas the LSAs
+ */
+  void GetStubNetworkLSAs (Ipv4Address network, Ipv4Mask mask, std::vector<GlobalRoutingLSA*>& lsas) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -674,12 +686,30 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Find the Link State Advertisements that differ from those of
+   * another database.
+   *
+   * The LSAs are compared by link state ID: an LSA of one database that is
+   * not in the other one, or whose contents (type, advertising router,
+   * network mask, link records and attached routers) differ, is changed.
+   * The External LSAs are not compared.
+   *
+   * @param other the other database
+   * @param changed the link state IDs of the changed LSAs, in increasing order
+   */
+  void GetChangedLSAs (const GlobalRouteManagerLSDB& other, std::vector<Ipv4Address>& changed) const;
+
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  /// index of the Link State Advertisements by the LinkData field of their TransitNetwork link records
+  std::unordered_map<Ipv4Address, LSDBMap_t::const_iterator, Ipv4AddressHash> m_linkDataIndex;
+  /// index of the network masks and Link State Advertisements by the network of their StubNetwork link records
+  std::unordered_multimap<Ipv4Address, std::pair<uint32_t, LSDBMap_t::const_iterator>, Ipv4AddressHash> m_stubNetworkIndex;
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -735,6 +765,37 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after a change of the topology, recomputing
+ * the shortest path trees affected by the change only
+ *
+ * The first call deletes the routes and computes them again like
+ * DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes (), recording the distance and root exit directions of
+ * the vertices of the shortest path tree of every router.
+ *
+ * The later calls build a new routing database and compare it with the
+ * previous one.  The changed Link State Advertisements affect the tree of a
+ * router if they add or remove an edge on a shortest path, or make a
+ * shorter or equal cost path (dynamic SPF, in the spirit of Ramalingam and
+ * Reps), or if they change a vertex adjacent to the root, whose root exit
+ * directions depend on its LSA.  The SPF is computed again for the routers
+ * whose tree is affected only, without adding the routes: the routes to
+ * the vertices whose LSA or root exit directions changed are updated, and
+ * the others are kept.  The SPF of a router whose own LSA changed is
+ * computed from scratch.  In the unaffected trees, the distances and root
+ * exit directions of the vertices do not change, so that only the routes
+ * to the addresses and networks of the changed vertices are updated.
+ *
+ * When the routes to an address or a network change, all the routes to it
+ * are removed and added again in the order of a complete computation, so
+ * that the first of several routes to the same destination is the same.
+ * The External LSAs are not tracked: if there are any, all the routes are
+ * computed again.
+ * DeleteGlobalRoutes () stops the recording.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +827,74 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /// A vertex of a recorded shortest path tree
+  struct SPFTreeVertex
+  {
+    uint32_t distance; //!< the distance from the root
+    bool direct;       //!< whether the root exit directions depend on the LSA of the vertex
+    std::vector<SPFVertex::NodeExit_t> exits; //!< the root exit directions
+    uint32_t stubOrder; //!< the rank of the vertex in SPFProcessStubs (), which adds the stub routes
+  };
+
+  /// A recorded shortest path tree
+  struct SPFTree
+  {
+    bool stub; //!< whether the root is a stub node, with a default route only
+    std::unordered_map<Ipv4Address, SPFTreeVertex, Ipv4AddressHash> vertices; //!< the vertices, by vertex ID
+  };
+
+  /// An edge of the SPF graph: the ID of its source, and the ID of its destination with its metric
+  typedef std::pair<Ipv4Address, std::pair<Ipv4Address, uint32_t> > SPFEdge_t;
+  /// A changed vertex of the SPF graph: its ID, and whether it was added, removed or changed type
+  typedef std::pair<Ipv4Address, bool> SPFChange_t;
+
+  /**
+   * \brief Delete the global routes of a node
+   * \param node the node
+   */
+  void DeleteNodeRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Test whether the shortest path tree of a router is affected by a
+   * change of the routing database.
+   *
+   * \param tree the recorded shortest path tree
+   * \param vertices the changed vertices
+   * \param removedEdges the removed edges
+   * \param addedEdges the added edges
+   * \returns true if the SPF must be computed again
+   */
+  bool IsSPFTreeAffected (const SPFTree& tree,
+                          const std::vector<SPFChange_t>& vertices,
+                          const std::vector<SPFEdge_t>& removedEdges,
+                          const std::vector<SPFEdge_t>& addedEdges) const;
+
+  /**
+   * \brief Update the routes of a router to the addresses and networks of
+   * the vertices of its shortest path tree.
+   *
+   * All the routes to an address or a network whose routes changed are
+   * removed, and added again in the order of SPFCalculate ().
+   *
+   * \param gr the routing protocol of the router
+   * \param root the router ID of the router
+   * \param oldTree the previous shortest path tree
+   * \param newTree the new shortest path tree, or 0 if the distances and root
+   * exit directions of the vertices did not change
+   * \param changed the link state IDs of the changed LSAs, in increasing order
+   * \param oldLsdb the previous routing database
+   */
+  void UpdateSPFTreeRoutes (Ptr<Ipv4GlobalRouting> gr, Ipv4Address root,
+                            const SPFTree& oldTree, const SPFTree* newTree,
+                            const std::vector<Ipv4Address>& changed,
+                            const GlobalRouteManagerLSDB* oldLsdb);
+
   SPFVertex* m_spfroot; //!< the root node
+  NodeList::Iterator m_spfrootNode; //!< the node of the root, or NodeList::End ()
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_recordSPFTrees; //!< whether the shortest path trees are recorded, for UpdateRoutes ()
+  /// the recorded shortest path trees, by router ID of the root
+  std::unordered_map<Ipv4Address, SPFTree, Ipv4AddressHash> m_spfTrees;
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -786,8 +913,10 @@ private:
    *
    * Equivalent to quagga ospf_spf_calculate
    * \param root the root node
+   * \param addRoutes whether to add the routes to the vertices; if false,
+   * the tree is recorded only (but the default route of a stub node is added)
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (Ipv4Address root, bool addRoutes = true);
 
   /**
    * \brief Process Stub nodes
@@ -797,8 +926,12 @@ private:
    * broadcast interfaces for which no neighboring router can be found
    *
    * \param v vertex to be processed
+   * \param addRoutes whether to add the routes to the stub networks
+   * \param tree the tree whose vertices are ranked in the processing order,
+   * or 0
+   * \param order the rank of the vertex, incremented for every processed vertex
    */
-  void SPFProcessStubs (SPFVertex* v);
+  void SPFProcessStubs (SPFVertex* v, bool addRoutes, SPFTree* tree, uint32_t& order);
 
   /**
    * \brief Process Autonomous Systems (AS) External LSA
@@ -65,6 +65,14 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after a change of the topology, recomputing
+ * the shortest path trees affected by the change only
+ *
+ * @see GlobalRouteManagerImpl::UpdateRoutes
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -24,6 +24,7 @@
 #ifndef IP_L4_PROTOCOL_H
 #define IP_L4_PROTOCOL_H
 
+#include <list>
 #include "ns3/object.h"
 #include "ns3/callback.h"
 #include "ipv4-header.h"
@@ -137,6 +138,22 @@ public:
                             Ipv6Address payloadSource, Ipv6Address payloadDestination,
                             const uint8_t payload[8]);
 
+  /**
+   * \brief Called from lower-level layers to split a super-segment into the
+   * segments it stands for.
+   *
+   * The IPv4 layer calls this method when a super-segment (see
+   * SuperSegmentTag) must be sent through a device whose MTU cannot carry
+   * it. The default implementation does not split anything.
+   *
+   * \param p the super-segment, starting with the header of this protocol
+   * \param header IPv4 Header information
+   * \param segments the segments, each starting with the header of this protocol
+   * \returns true if the super-segment has been split
+   */
+  virtual bool SplitSuperSegment (Ptr<const Packet> p, Ipv4Header const &header,
+                                  std::list<Ptr<Packet> > &segments) const;
+
   /**
    * \brief callback to send packets over IPv4
    */
@@ -22,6 +22,7 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 
 namespace ns3 {
@@ -45,24 +46,83 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   m_endPoints.clear ();
 }
 
+Ipv4EndPointDemux::EndPointKey::EndPointKey (Ipv4Address localAddress, uint16_t localPort,
+                                              Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    localPort (localPort),
+    peerAddress (peerAddress),
+    peerPort (peerPort)
+{
+}
+
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::EndPointKey::operator== (const EndPointKey &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::EndPointKeyHash::operator() (const EndPointKey &key) const
+{
+  uint64_t h = (static_cast<uint64_t> (key.localAddress.Get ()) << 32) | key.peerAddress.Get ();
+  h ^= ((static_cast<uint64_t> (key.localPort) << 16) | key.peerPort) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 29;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 32;
+  return static_cast<size_t> (h);
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_positions[endPoint] = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_ports[endPoint->GetLocalPort ()]++;
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+}
+
+void
+Ipv4EndPointDemux::AddToIndex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  m_index[key].push_back (endPoint);
+}
+
+void
+Ipv4EndPointDemux::RemoveFromIndex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  std::unordered_map<EndPointKey, std::vector<Ipv4EndPoint *>, EndPointKeyHash>::iterator it = m_index.find (key);
+  NS_ASSERT (it != m_index.end ());
+  std::vector<Ipv4EndPoint *> &endPoints = it->second;
+  endPoints.erase (std::find (endPoints.begin (), endPoints.end (), endPoint));
+  if (endPoints.empty ())
     {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
+      m_index.erase (it);
     }
-  return false;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
@@ -86,7 +146,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -102,7 +162,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -125,7 +185,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,21 +196,22 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<EndPointKey, std::vector<Ipv4EndPoint *>, EndPointKeyHash>::const_iterator it =
+    m_index.find (EndPointKey (localAddress, localPort, peerAddress, peerPort));
+  if (it != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      for (std::vector<Ipv4EndPoint *>::const_iterator i = it->second.begin (); i != it->second.end (); i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -161,15 +222,20 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, EndPointsI>::iterator position = m_positions.find (endPoint);
+  if (position == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  RemoveFromIndex (endPoint);
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  if (--port->second == 0)
+    {
+      m_ports.erase (port);
     }
+  m_endPoints.erase (position->second);
+  m_positions.erase (position);
+  delete endPoint;
 }
 
 /*
@@ -190,48 +256,24 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
 }
 
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv4EndPointDemux::EndPoints
-Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
-                           Ipv4Address saddr, uint16_t sport,
-                           Ptr<Ipv4Interface> incomingInterface)
+void
+Ipv4EndPointDemux::LookupIndex (const EndPointKey &key, Ptr<Ipv4Interface> incomingInterface, EndPoints &endPoints)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-  
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  NS_LOG_FUNCTION (this << key.localAddress << key.localPort << key.peerAddress << key.peerPort);
+  std::unordered_map<EndPointKey, std::vector<Ipv4EndPoint *>, EndPointKeyHash>::const_iterator it = m_index.find (key);
+  if (it == m_index.end ())
+    {
+      return;
+    }
+  for (std::vector<Ipv4EndPoint *>::const_iterator i = it->second.begin (); i != it->second.end (); i++)
     {
       Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-
       if (!endP->IsRxEnabled ())
         {
           NS_LOG_LOGIC ("Skipping endpoint " << &endP
                         << " because endpoint can not receive packets");
           continue;
         }
-
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -243,86 +285,71 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
+      endPoints.push_back (endP);
+    }
+}
 
-      bool localAddressMatchesExact = false;
-      bool localAddressIsAny = false;
-      bool localAddressIsSubnetAny = false;
-
-      // We have 3 cases:
-      // 1) Exact local / destination address match
-      // 2) Local endpoint bound to Any -> matches anything
-      // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
-
-      if (endP->GetLocalAddress () == daddr)
-        {
-          // Case 1:
-          localAddressMatchesExact = true;
-        }
-      else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
-        {
-          // Case 2:
-          localAddressIsAny = true;
-        }
-      else
-        {
-          // Case 3:
-          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-            {
-              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-
-              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
-              if (endP->GetLocalAddress () == addrNetpart)
-                {
-                  NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
-
-                  Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
-                  if (addrNetpart == daddrNetPart)
-                    {
-                      localAddressIsSubnetAny = true;
-                    }
-                }
-            }
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
+                           Ipv4Address saddr, uint16_t sport,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
+  
+  EndPoints retval1; // Matches exact on local port, wildcards on others
+  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
+  EndPoints retval3; // Matches all but local address
+  EndPoints retval4; // Exact match on all 4
 
-          // if no match here, keep looking
-          if (!localAddressIsSubnetAny)
-            continue;
-        }
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
 
-      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+  // The local address of an endpoint matches in 3 cases:
+  // 1) Exact local / destination address match
+  // 2) Local endpoint bound to Any -> matches anything
+  // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  // and its remote address and port either match exactly or are wildcards.
+  // Only the four-tuples of these combinations are looked up in the index.
 
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
+  // All 4 match - this is the case of an open TCP connection, for example.
+  LookupIndex (EndPointKey (daddr, dport, saddr, sport), incomingInterface, retval4);
+  // Only local port and local address matches exactly - Not yet opened connection
+  LookupIndex (EndPointKey (daddr, dport, Ipv4Address::GetAny (), 0), incomingInterface, retval2);
 
-      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
+  std::vector<Ipv4Address> wildCards;
+  if (daddr != Ipv4Address::GetAny ())
+    {
+      // Case 2:
+      wildCards.push_back (Ipv4Address::GetAny ());
+    }
+  if (incomingInterface)
+    {
+      // Case 3:
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
 
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-          NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-          NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-          NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval1.push_back (endP);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart != daddr && addrNetpart != Ipv4Address::GetAny ()
+              && daddr.CombineMask (addr.GetMask ()) == addrNetpart
+              && std::find (wildCards.begin (), wildCards.end (), addrNetpart) == wildCards.end ())
+            {
+              NS_LOG_LOGIC ("Looking up SubnetDirectedAny " << addrNetpart << "/" << addr.GetMask ().GetPrefixLength ());
+              wildCards.push_back (addrNetpart);
+            }
         }
     }
+  for (std::vector<Ipv4Address>::const_iterator i = wildCards.begin (); i != wildCards.end (); i++)
+    {
+      // All but local address - no idea what this case could be.
+      LookupIndex (EndPointKey (*i, dport, saddr, sport), incomingInterface, retval3);
+      // Only local port matches exactly - Endpoint open to "any" connection
+      LookupIndex (EndPointKey (*i, dport, Ipv4Address::GetAny (), 0), incomingInterface, retval1);
+    }
 
   // Here we find the most exact match
   EndPoints retval;
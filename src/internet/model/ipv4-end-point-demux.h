@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are also indexed in a hash table by their four-tuple, where
+ * the listening endpoints have a wildcard peer address and port, so that
+ * Lookup () only examines the endpoints whose four-tuple can match the
+ * packet, rather than all of them.  The number of endpoints per local port
+ * is counted, so that the ephemeral ports are allocated in constant time.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +174,75 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint.
+   */
+  struct EndPointKey
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress the local address
+     * \param localPort the local port
+     * \param peerAddress the peer address
+     * \param peerPort the peer port
+     */
+    EndPointKey (Ipv4Address localAddress, uint16_t localPort,
+                 Ipv4Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the other four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator== (const EndPointKey &other) const;
+
+    Ipv4Address localAddress; //!< the local address
+    uint16_t localPort;       //!< the local port
+    Ipv4Address peerAddress;  //!< the peer address
+    uint16_t peerPort;        //!< the peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct EndPointKeyHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param key the four-tuple
+     * \returns the hash
+     */
+    size_t operator() (const EndPointKey &key) const;
+  };
+
+  /**
+   * \brief Add an allocated endpoint to the list, the index and the ports.
+   * \param endPoint the endpoint
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Index an endpoint by its current four-tuple.
+   * \param endPoint the endpoint
+   */
+  void AddToIndex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the index, before its four-tuple changes.
+   * \param endPoint the endpoint
+   */
+  void RemoveFromIndex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Find the endpoints with a four-tuple which can receive packets
+   * from an interface.
+   * \param key the four-tuple
+   * \param incomingInterface the incoming interface
+   * \param endPoints the list to append the endpoints to
+   */
+  void LookupIndex (const EndPointKey &key, Ptr<Ipv4Interface> incomingInterface, EndPoints &endPoints);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +269,20 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+  /**
+   * \brief The IPv4 end points by four-tuple.
+   */
+  std::unordered_map<EndPointKey, std::vector<Ipv4EndPoint *>, EndPointKeyHash> m_index;
+
+  /**
+   * \brief The position of each IPv4 end point in the list.
+   */
+  std::unordered_map<Ipv4EndPoint *, EndPointsI> m_positions;
+
+  /**
+   * \brief The number of IPv4 end points of each local port in use.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } // namespace ns3
@@ -17,6 +17,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -53,13 +54,19 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("IncrementalRouteUpdates",
+                   "Set to true if you want the interface notification events to update only the shortest path trees affected by the change, rather than recompute all the global routes (see GlobalRouteManager::UpdateRoutes)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_incrementalRouteUpdates),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_incrementalRouteUpdates (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +87,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostIndex.Add (route);
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -90,6 +99,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostIndex.Add (route);
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -105,6 +116,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkIndex.Add (route);
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -118,6 +131,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkIndex.Add (route);
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -133,102 +148,88 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_ASexternalIndex.Add (route);
+  NotifyRoutingTableChange ();
 }
 
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+/**
+ * \brief Compare the insertion order of two routes
+ * \param a a route
+ * \param b another route
+ * \return true if a was added before b
+ */
+static bool
+RouteAddedBefore (const Ipv4RoutingTableIndex::Route &a, const Ipv4RoutingTableIndex::Route &b)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  return a.order < b.order;
+}
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+void
+Ipv4GlobalRouting::CollectRoutes (const Ipv4RoutingTableIndex::Matches &matches, Ptr<NetDevice> oif)
+{
+  m_candidates.clear ();
+  for (Ipv4RoutingTableIndex::Matches::const_iterator i = matches.begin (); i != matches.end (); i++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (Ipv4RoutingTableIndex::Routes::const_iterator j = i->routes->begin (); j != i->routes->end (); j++)
         {
-          if (oif != 0)
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (j->entry->GetInterface ()))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          m_candidates.push_back (*j);
         }
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  if (matches.size () > 1)
+    {
+      // the routes of each network are in insertion order, and the orders
+      // are unique: an unstable sort, which does not allocate, is enough
+      std::sort (m_candidates.begin (), m_candidates.end (), RouteAddedBefore);
+    }
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << dest);
+  Ptr<Ipv4Route> rtentry = 0;
+  // the available routes that bring packets to their destination are
+  // stored in m_candidates, in the order in which they were added
+
+  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+  CollectRoutes (m_hostIndex.Lookup (dest), oif);
+  if (m_candidates.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
-        {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
-            {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
-            }
-        }
+      CollectRoutes (m_networkIndex.Lookup (dest), oif);
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (m_candidates.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      // only the first matching external route is considered
+      CollectRoutes (m_ASexternalIndex.Lookup (dest), oif);
+      if (m_candidates.size () > 1)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
-            {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
-            }
+          m_candidates.resize (1);
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (m_candidates.size () > 0 ) // if route(s) is found
     {
+      NS_LOG_LOGIC ("Found " << m_candidates.size () << " global routes");
       // pick up one of the routes uniformly at random if random
       // ECMP routing is enabled, or always select the first route
       // consistently if random ECMP routing is disabled
       uint32_t selectIndex;
       if (m_randomEcmpRouting)
         {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+          selectIndex = m_rand->GetInteger (0, m_candidates.size ()-1);
         }
       else 
         {
           selectIndex = 0;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
+      Ipv4RoutingTableEntry* route = m_candidates.at (selectIndex).entry; 
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
@@ -319,8 +320,10 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostIndex.Remove (*i);
               delete *i;
               m_hostRoutes.erase (i);
+              NotifyRoutingTableChange ();
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
               return;
             }
@@ -336,8 +339,10 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkIndex.Remove (*j);
           delete *j;
           m_networkRoutes.erase (j);
+          NotifyRoutingTableChange ();
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -352,8 +357,10 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          m_ASexternalIndex.Remove (*k);
           delete *k;
           m_ASexternalRoutes.erase (k);
+          NotifyRoutingTableChange ();
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -362,6 +369,49 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+void
+Ipv4GlobalRouting::RemoveHostRouteTo (Ipv4Address dest,
+                                      Ipv4Address nextHop,
+                                      uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << dest << nextHop << interface);
+  for (HostRoutesI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      if ((*i)->GetDest () == dest && (*i)->GetGateway () == nextHop
+          && (*i)->GetInterface () == interface)
+        {
+          m_hostIndex.Remove (*i);
+          delete *i;
+          m_hostRoutes.erase (i);
+          NotifyRoutingTableChange ();
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "No host route to " << dest << " via " << nextHop << " on interface " << interface);
+}
+
+void
+Ipv4GlobalRouting::RemoveNetworkRouteTo (Ipv4Address network,
+                                         Ipv4Mask networkMask,
+                                         Ipv4Address nextHop,
+                                         uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
+  for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      if ((*j)->GetDestNetwork () == network && (*j)->GetDestNetworkMask ().IsEqual (networkMask)
+          && (*j)->GetGateway () == nextHop && (*j)->GetInterface () == interface)
+        {
+          m_networkIndex.Remove (*j);
+          delete *j;
+          m_networkRoutes.erase (j);
+          NotifyRoutingTableChange ();
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "No network route to " << network << "/" << networkMask << " via " << nextHop << " on interface " << interface);
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -392,6 +442,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostIndex.Clear ();
+  m_networkIndex.Clear ();
+  m_ASexternalIndex.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -451,6 +504,13 @@ Ipv4GlobalRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Uni
   *os << std::endl;
 }
 
+bool
+Ipv4GlobalRouting::IsForwardingCacheable (void) const
+{
+  // A random ECMP route is drawn for each packet
+  return !m_randomEcmpRouting;
+}
+
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
@@ -537,6 +597,11 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
+      if (m_incrementalRouteUpdates)
+        {
+          GlobalRouteManager::UpdateRoutes ();
+          return;
+        }
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
       GlobalRouteManager::InitializeRoutes ();
@@ -549,6 +614,11 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
+      if (m_incrementalRouteUpdates)
+        {
+          GlobalRouteManager::UpdateRoutes ();
+          return;
+        }
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
       GlobalRouteManager::InitializeRoutes ();
@@ -561,6 +631,11 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
+      if (m_incrementalRouteUpdates)
+        {
+          GlobalRouteManager::UpdateRoutes ();
+          return;
+        }
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
       GlobalRouteManager::InitializeRoutes ();
@@ -573,6 +648,11 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
+      if (m_incrementalRouteUpdates)
+        {
+          GlobalRouteManager::UpdateRoutes ();
+          return;
+        }
       GlobalRouteManager::DeleteGlobalRoutes ();
       GlobalRouteManager::BuildGlobalRoutingDatabase ();
       GlobalRouteManager::InitializeRoutes ();
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-routing-table-index.h"
 
 namespace ns3 {
 
@@ -99,6 +100,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual bool IsForwardingCacheable (void) const;
 
   /**
    * \brief Add a host route to the global routing table.
@@ -218,6 +220,40 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove a host route from the global routing table.
+   *
+   * The first host route added with the given destination, next hop and
+   * interface is removed; the route must exist.
+   *
+   * \param dest The Ipv4Address destination of the route.
+   * \param nextHop The Ipv4Address of the next hop of the route.
+   * \param interface The network interface index of the route.
+   *
+   * \see Ipv4GlobalRouting::AddHostRouteTo
+   */
+  void RemoveHostRouteTo (Ipv4Address dest,
+                          Ipv4Address nextHop,
+                          uint32_t interface);
+
+  /**
+   * \brief Remove a network route from the global routing table.
+   *
+   * The first network route added with the given network, mask, next hop
+   * and interface is removed; the route must exist.
+   *
+   * \param network The Ipv4Address network of the route.
+   * \param networkMask The Ipv4Mask of the network.
+   * \param nextHop The next hop of the route.
+   * \param interface The network interface index of the route.
+   *
+   * \see Ipv4GlobalRouting::AddNetworkRouteTo
+   */
+  void RemoveNetworkRouteTo (Ipv4Address network,
+                             Ipv4Mask networkMask,
+                             Ipv4Address nextHop,
+                             uint32_t interface);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -236,6 +272,8 @@ private:
   bool m_randomEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
+  /// Set to true if the interface events should update the affected shortest path trees only
+  bool m_incrementalRouteUpdates;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
@@ -268,10 +306,22 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Store the matching routes on the requested interface in m_candidates.
+   * \param matches the matching routes
+   * \param oif output interface if any (put 0 otherwise)
+   */
+  void CollectRoutes (const Ipv4RoutingTableIndex::Matches &matches, Ptr<NetDevice> oif);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4RoutingTableIndex m_hostIndex;       //!< Index of the routes to hosts
+  Ipv4RoutingTableIndex m_networkIndex;    //!< Index of the routes to networks
+  Ipv4RoutingTableIndex m_ASexternalIndex; //!< Index of the external routes
+  Ipv4RoutingTableIndex::Routes m_candidates; //!< Candidate routes of the last lookup, in insertion order
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
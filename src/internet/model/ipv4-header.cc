@@ -22,6 +22,7 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/ip-checksum.h"
 #include "ipv4-header.h"
 
 namespace ns3 {
@@ -41,6 +42,7 @@ Ipv4Header::Ipv4Header ()
     m_fragmentOffset (0),
     m_checksum (0),
     m_goodChecksum (true),
+    m_checksumValid (false),
     m_headerSize(5*4)
 {
 }
@@ -57,6 +59,7 @@ Ipv4Header::SetPayloadSize (uint16_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_payloadSize = size;
+  m_checksumValid = false;
 }
 uint16_t
 Ipv4Header::GetPayloadSize (void) const
@@ -76,12 +79,14 @@ Ipv4Header::SetIdentification (uint16_t identification)
 {
   NS_LOG_FUNCTION (this << identification);
   m_identification = identification;
+  m_checksumValid = false;
 }
 
 void 
 Ipv4Header::SetTos (uint8_t tos)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (tos));
+  UpdateChecksum (m_tos << 8, tos << 8);
   m_tos = tos;
 }
 
@@ -89,16 +94,20 @@ void
 Ipv4Header::SetDscp (DscpType dscp)
 {
   NS_LOG_FUNCTION (this << dscp);
+  uint8_t oldTos = m_tos;
   m_tos &= 0x3; // Clear out the DSCP part, retain 2 bits of ECN
   m_tos |= (dscp << 2);
+  UpdateChecksum (oldTos << 8, m_tos << 8);
 }
 
 void
 Ipv4Header::SetEcn (EcnType ecn)
 {
   NS_LOG_FUNCTION (this << ecn);
+  uint8_t oldTos = m_tos;
   m_tos &= 0xFC; // Clear out the ECN part, retain 6 bits of DSCP
   m_tos |= ecn;
+  UpdateChecksum (oldTos << 8, m_tos << 8);
 }
 
 Ipv4Header::DscpType 
@@ -201,12 +210,14 @@ Ipv4Header::SetMoreFragments (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags |= MORE_FRAGMENTS;
+  m_checksumValid = false;
 }
 void
 Ipv4Header::SetLastFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags &= ~MORE_FRAGMENTS;
+  m_checksumValid = false;
 }
 bool 
 Ipv4Header::IsLastFragment (void) const
@@ -220,12 +231,14 @@ Ipv4Header::SetDontFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags |= DONT_FRAGMENT;
+  m_checksumValid = false;
 }
 void 
 Ipv4Header::SetMayFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags &= ~DONT_FRAGMENT;
+  m_checksumValid = false;
 }
 bool 
 Ipv4Header::IsDontFragment (void) const
@@ -241,6 +254,7 @@ Ipv4Header::SetFragmentOffset (uint16_t offsetBytes)
   // check if the user is trying to set an invalid offset
   NS_ABORT_MSG_IF ((offsetBytes & 0x7), "offsetBytes must be multiple of 8 bytes");
   m_fragmentOffset = offsetBytes;
+  m_checksumValid = false;
 }
 uint16_t 
 Ipv4Header::GetFragmentOffset (void) const
@@ -259,6 +273,7 @@ void
 Ipv4Header::SetTtl (uint8_t ttl)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (ttl));
+  UpdateChecksum (m_ttl, ttl);
   m_ttl = ttl;
 }
 uint8_t 
@@ -278,6 +293,7 @@ void
 Ipv4Header::SetProtocol (uint8_t protocol)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (protocol));
+  UpdateChecksum (m_protocol << 8, protocol << 8);
   m_protocol = protocol;
 }
 
@@ -285,6 +301,7 @@ void
 Ipv4Header::SetSource (Ipv4Address source)
 {
   NS_LOG_FUNCTION (this << source);
+  UpdateChecksum (m_source, source);
   m_source = source;
 }
 Ipv4Address
@@ -298,6 +315,7 @@ void
 Ipv4Header::SetDestination (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
+  UpdateChecksum (m_destination, dst);
   m_destination = dst;
 }
 Ipv4Address
@@ -315,6 +333,28 @@ Ipv4Header::IsChecksumOk (void) const
   return m_goodChecksum;
 }
 
+void
+Ipv4Header::UpdateChecksum (uint16_t oldWord, uint16_t newWord)
+{
+  NS_LOG_FUNCTION (this << oldWord << newWord);
+  if (m_checksumValid)
+    {
+      m_checksum = IpChecksumUpdate (m_checksum, oldWord, newWord);
+    }
+}
+
+void
+Ipv4Header::UpdateChecksum (Ipv4Address oldAddress, Ipv4Address newAddress)
+{
+  NS_LOG_FUNCTION (this << oldAddress << newAddress);
+  uint32_t oldValue = oldAddress.Get ();
+  uint32_t newValue = newAddress.Get ();
+  UpdateChecksum (((oldValue >> 24) & 0xff) | ((oldValue >> 8) & 0xff00),
+                  ((newValue >> 24) & 0xff) | ((newValue >> 8) & 0xff00));
+  UpdateChecksum (((oldValue >> 8) & 0xff) | ((oldValue << 8) & 0xff00),
+                  ((newValue >> 8) & 0xff) | ((newValue << 8) & 0xff00));
+}
+
 TypeId 
 Ipv4Header::GetTypeId (void)
 {
@@ -405,11 +445,18 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
   i.WriteU8 (frag);
   i.WriteU8 (m_ttl);
   i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
+  if (m_calcChecksum && m_checksumValid)
+    {
+      i.WriteU16 (m_checksum);
+    }
+  else
+    {
+      i.WriteHtonU16 (0);
+    }
   i.WriteHtonU32 (m_source.Get ());
   i.WriteHtonU32 (m_destination.Get ());
 
-  if (m_calcChecksum) 
+  if (m_calcChecksum && !m_checksumValid)
     {
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (20);
@@ -469,6 +516,13 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
       NS_LOG_LOGIC ("checksum=" <<checksum);
 
       m_goodChecksum = (checksum == 0);
+      // The setters keep the checksum up to date as long as the header
+      // serializes back to the bytes it was read from
+      m_checksumValid = m_goodChecksum && headerSize == 5*4 && !(flags & (1<<7));
+    }
+  else
+    {
+      m_checksumValid = false;
     }
   return GetSerializedSize ();
 }
@@ -237,6 +237,23 @@ public:
   virtual uint32_t Deserialize (Buffer::Iterator start);
 private:
 
+  /**
+   * \brief Update the checksum after the change of a 16 bit word of the header
+   *
+   * The words are in the byte order of Buffer::Iterator::ReadU16. The
+   * checksum is updated incrementally (RFC 1624), if it is valid.
+   *
+   * \param oldWord the previous value of the word
+   * \param newWord the new value of the word
+   */
+  void UpdateChecksum (uint16_t oldWord, uint16_t newWord);
+  /**
+   * \brief Update the checksum after the change of an address of the header
+   * \param oldAddress the previous address
+   * \param newAddress the new address
+   */
+  void UpdateChecksum (Ipv4Address oldAddress, Ipv4Address newAddress);
+
   /// flags related to IP fragmentation
   enum FlagsE {
     DONT_FRAGMENT = (1<<0),
@@ -256,6 +273,7 @@ private:
   Ipv4Address m_destination; //!< destination address
   uint16_t m_checksum; //!< checksum
   bool m_goodChecksum; //!< true if checksum is correct
+  bool m_checksumValid; //!< true if m_checksum is the checksum of the header, as serialized
   uint16_t m_headerSize; //!< IP header size
 };
 
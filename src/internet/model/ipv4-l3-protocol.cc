@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/super-segment-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -69,6 +70,15 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("ForwardingCacheSize",
+                   "The maximum number of entries of the forwarding cache, "
+                   "which maps the destination, incoming interface and DSCP "
+                   "of the forwarded packets to their route (0 to disable it). "
+                   "It is only used with the routing protocols which allow it "
+                   "(see Ipv4RoutingProtocol::IsForwardingCacheable).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_forwardingCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -270,6 +280,9 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
 {
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
+  m_routingProtocol->TraceConnectWithoutContext ("RoutingTableChange",
+                                                 MakeCallback (&Ipv4L3Protocol::FlushForwardingCache, this));
+  FlushForwardingCache ();
   m_routingProtocol->SetIpv4 (this);
 }
 
@@ -301,6 +314,7 @@ Ipv4L3Protocol::DoDispose (void)
   m_sockets.clear ();
   m_node = 0;
   m_routingProtocol = 0;
+  m_forwardingCache.clear ();
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
@@ -630,9 +644,24 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
       socket->ForwardUp (packet, ipHeader, ipv4Interface);
     }
 
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  if (m_forwardingCacheSize > 0 && m_routingProtocol != 0
+      && m_routingProtocol->IsForwardingCacheable ())
+    {
+      ForwardingCacheKey_t key = std::make_pair ((uint64_t (ipHeader.GetDestination ().Get ()) << 32) | interface,
+                                                 uint8_t (ipHeader.GetDscp ()));
+      ForwardingCache_t::const_iterator it = m_forwardingCache.find (key);
+      if (it != m_forwardingCache.end ())
+        {
+          NS_LOG_LOGIC ("Forwarding with the cached route");
+          IpForward (it->second, packet, ipHeader);
+          return;
+        }
+      ucb = MakeCallback (&Ipv4L3Protocol::CacheAndForward, this).Bind (key);
+    }
+
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, ucb,
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
@@ -925,6 +954,30 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  if (outInterface->IsUp ()
+      && packet->GetSize () + ipHeader.GetSerializedSize () > outDev->GetMtu ())
+    {
+      // A super-segment is sent as the segments it stands for, rather than
+      // fragmented, through a device which cannot carry it whole
+      SuperSegmentTag superSegment;
+      Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetProtocol ());
+      std::list<Ptr<Packet> > segments;
+      if (packet->PeekPacketTag (superSegment) && protocol != 0
+          && protocol->SplitSuperSegment (packet, ipHeader, segments))
+        {
+          NS_LOG_LOGIC ("Splitting super-segment into " << segments.size () << " segments");
+          uint16_t identification = ipHeader.GetIdentification ();
+          for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+            {
+              Ipv4Header segmentHeader = ipHeader;
+              segmentHeader.SetPayloadSize ((*it)->GetSize ());
+              segmentHeader.SetIdentification (identification++);
+              SendRealOut (route, *it, segmentHeader);
+            }
+          return;
+        }
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
@@ -1057,6 +1110,26 @@ Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ip
   SendRealOut (rtentry, packet, ipHeader);
 }
 
+void
+Ipv4L3Protocol::CacheAndForward (ForwardingCacheKey_t key, Ptr<Ipv4Route> rtentry,
+                                 Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << p << header);
+  if (m_forwardingCache.size () >= m_forwardingCacheSize)
+    {
+      FlushForwardingCache ();
+    }
+  m_forwardingCache[key] = rtentry;
+  IpForward (rtentry, p, header);
+}
+
+void
+Ipv4L3Protocol::FlushForwardingCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_forwardingCache.clear ();
+}
+
 void
 Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uint32_t iif)
 {
@@ -1126,6 +1199,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  FlushForwardingCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1157,6 +1231,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      FlushForwardingCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1180,6 +1255,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      FlushForwardingCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1314,6 +1390,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      FlushForwardingCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -1332,6 +1409,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  FlushForwardingCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1354,6 +1432,7 @@ Ipv4L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  FlushForwardingCache ();
 }
 
 Ptr<NetDevice>
@@ -1372,6 +1451,7 @@ Ipv4L3Protocol::SetIpForward (bool forward)
     {
       (*i)->SetForwarding (forward);
     }
+  FlushForwardingCache ();
 }
 
 bool 
@@ -1386,6 +1466,7 @@ Ipv4L3Protocol::SetWeakEsModel (bool model)
 {
   NS_LOG_FUNCTION (this << model);
   m_weakEsModel = model;
+  FlushForwardingCache ();
 }
 
 bool 
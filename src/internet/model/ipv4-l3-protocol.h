@@ -76,6 +76,17 @@ class Icmpv4L4Protocol;
  * Moreover, the actual implementation does not mimic exactly the Linux
  * kernel. Hence it is not possible, for instance, to test a fragmentation
  * attack.
+ *
+ * A forwarding cache can be enabled with the ForwardingCacheSize attribute.
+ * It maps the destination, incoming interface and DSCP of the forwarded
+ * packets to the route found by the routing protocol, so that the next
+ * packets of the same kind are forwarded without calling RouteInput. The
+ * cache is flushed when an interface, an address or the forwarding state
+ * changes, and when the routing protocol fires its RoutingTableChange trace
+ * source. It is only used when Ipv4RoutingProtocol::IsForwardingCacheable
+ * returns true, i.e., with routing protocols which forward packets on their
+ * destination only and notify their route changes (Ipv4StaticRouting, and
+ * Ipv4GlobalRouting with deterministic ECMP).
  */
 class Ipv4L3Protocol : public Ipv4
 {
@@ -338,6 +349,27 @@ private:
              Ptr<const Packet> p, 
              const Ipv4Header &header);
 
+  /// Forwarding cache key: (destination address + incoming interface, DSCP)
+  typedef std::pair<uint64_t, uint8_t> ForwardingCacheKey_t;
+
+  /**
+   * \brief Store the route of a packet in the forwarding cache, and forward it.
+   * \param key forwarding cache key of the packet
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void
+  CacheAndForward (ForwardingCacheKey_t key,
+                   Ptr<Ipv4Route> rtentry,
+                   Ptr<const Packet> p,
+                   const Ipv4Header &header);
+
+  /**
+   * \brief Remove all the entries of the forwarding cache.
+   */
+  void FlushForwardingCache (void);
+
   /**
    * \brief Forward a multicast packet.
    * \param mrtentry route
@@ -556,6 +588,12 @@ private:
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
   MapFragmentsTimers_t m_fragmentsTimers; //!< Expiration events.
 
+  /// Container of the routes of the forwarded packets
+  typedef std::map<ForwardingCacheKey_t, Ptr<Ipv4Route> > ForwardingCache_t;
+
+  ForwardingCache_t m_forwardingCache; //!< Forwarding cache.
+  uint32_t m_forwardingCacheSize;      //!< Max number of entries of the forwarding cache (0 to disable it).
+
 };
 
 } // Namespace ns3
@@ -85,6 +85,21 @@ Ipv4ListRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit
     }
 }
 
+bool
+Ipv4ListRouting::IsForwardingCacheable (void) const
+{
+  // Any protocol of the list may handle the packets
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      if (!(*i).second->IsForwardingCacheable ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
 void
 Ipv4ListRouting::DoInitialize (void)
 {
@@ -255,10 +270,13 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  routingProtocol->TraceConnectWithoutContext ("RoutingTableChange",
+                                               MakeCallback (&Ipv4ListRouting::NotifyRoutingTableChange, this));
   if (m_ipv4 != 0)
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
+  NotifyRoutingTableChange ();
 }
 
 uint32_t 
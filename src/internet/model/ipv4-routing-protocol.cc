@@ -32,8 +32,25 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Ipv4RoutingProtocol")
     .SetParent<Object> ()
     .SetGroupName ("Internet")
+    .AddTraceSource ("RoutingTableChange",
+                     "The routes of the protocol have changed",
+                     MakeTraceSourceAccessor (&Ipv4RoutingProtocol::m_routingTableChangeTrace),
+                     "ns3::Ipv4RoutingProtocol::RoutingTableChangeTracedCallback")
   ;
   return tid;
 }
 
+bool
+Ipv4RoutingProtocol::IsForwardingCacheable (void) const
+{
+  return false;
+}
+
+void
+Ipv4RoutingProtocol::NotifyRoutingTableChange (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routingTableChangeTrace ();
+}
+
 } // namespace ns3
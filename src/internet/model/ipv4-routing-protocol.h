@@ -27,6 +27,7 @@
 #include "ipv4.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
 
 namespace ns3 {
 
@@ -52,6 +53,9 @@ class NetDevice;
  * RouteInput(), is used for forwarding and/or delivering received packets. 
  * Also defines the signatures of four callbacks used in RouteInput().
  *
+ * The protocols which forward packets on their destination only, and fire
+ * the RoutingTableChange trace source whenever their routes change, can
+ * opt in the forwarding cache of Ipv4L3Protocol with IsForwardingCacheable.
  */
 class Ipv4RoutingProtocol : public Object
 {
@@ -171,6 +175,36 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Whether the forwarding cache of Ipv4L3Protocol can be used
+   *
+   * The routes found by RouteInput for forwarded packets are then cached,
+   * and the next packets with the same destination, incoming interface and
+   * DSCP are forwarded without calling RouteInput, until the RoutingTableChange
+   * trace source fires. It requires that the routes only depend on these
+   * fields, that RouteInput does not modify the packets, and that the route
+   * changes are notified.
+   *
+   * eturn true if the forwarded packets can bypass RouteInput (false by default)
+   */
+  virtual bool IsForwardingCacheable (void) const;
+
+  /**
+   * TracedCallback signature for routing table changes.
+   */
+  typedef void (* RoutingTableChangeTracedCallback)(void);
+
+protected:
+  /**
+   * \brief Notify that the routes of this protocol have changed
+   *
+   * Fires the RoutingTableChange trace source.
+   */
+  void NotifyRoutingTableChange (void);
+
+private:
+  /// Trace of the changes of the routes
+  TracedCallback<> m_routingTableChangeTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-routing-table-index.h"
+#include "ipv4-routing-table-entry.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RoutingTableIndex");
+
+Ipv4RoutingTableIndex::Ipv4RoutingTableIndex ()
+  : m_nextOrder (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+Ipv4RoutingTableIndex::FindTable (Ipv4Mask mask, bool create)
+{
+  uint16_t prefixLength = mask.GetPrefixLength ();
+  uint32_t i = 0;
+  // the tables are sorted by decreasing prefix length, then by mask
+  while (i < m_tables.size ()
+         && (m_tables[i].prefixLength > prefixLength
+             || (m_tables[i].prefixLength == prefixLength && m_tables[i].mask > mask.Get ())))
+    {
+      i++;
+    }
+  if (i < m_tables.size () && m_tables[i].mask == mask.Get ())
+    {
+      return i;
+    }
+  if (!create)
+    {
+      return m_tables.size ();
+    }
+  MaskTable table;
+  table.mask = mask.Get ();
+  table.prefixLength = prefixLength;
+  m_tables.insert (m_tables.begin () + i, table);
+  return i;
+}
+
+void
+Ipv4RoutingTableIndex::Add (Ipv4RoutingTableEntry *entry, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << entry << metric);
+  Ipv4Mask mask = entry->GetDestNetworkMask ();
+  MaskTable &table = m_tables[FindTable (mask, true)];
+  Route route;
+  route.entry = entry;
+  route.metric = metric;
+  route.order = m_nextOrder++;
+  table.networks[entry->GetDestNetwork ().Get () & table.mask].push_back (route);
+}
+
+void
+Ipv4RoutingTableIndex::Remove (Ipv4RoutingTableEntry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  uint32_t i = FindTable (entry->GetDestNetworkMask (), false);
+  if (i == m_tables.size ())
+    {
+      return;
+    }
+  std::unordered_map<uint32_t, Routes> &networks = m_tables[i].networks;
+  std::unordered_map<uint32_t, Routes>::iterator it = networks.find (entry->GetDestNetwork ().Get () & m_tables[i].mask);
+  if (it == networks.end ())
+    {
+      return;
+    }
+  for (Routes::iterator route = it->second.begin (); route != it->second.end (); ++route)
+    {
+      if (route->entry == entry)
+        {
+          it->second.erase (route);
+          break;
+        }
+    }
+  if (it->second.empty ())
+    {
+      networks.erase (it);
+      if (networks.empty ())
+        {
+          m_tables.erase (m_tables.begin () + i);
+        }
+    }
+}
+
+void
+Ipv4RoutingTableIndex::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tables.clear ();
+  m_matches.clear ();
+}
+
+const Ipv4RoutingTableIndex::Matches &
+Ipv4RoutingTableIndex::Lookup (Ipv4Address dest)
+{
+  m_matches.clear ();
+  uint32_t address = dest.Get ();
+  for (std::vector<MaskTable>::const_iterator table = m_tables.begin (); table != m_tables.end (); ++table)
+    {
+      std::unordered_map<uint32_t, Routes>::const_iterator it = table->networks.find (address & table->mask);
+      if (it != table->networks.end ())
+        {
+          Match match;
+          match.routes = &it->second;
+          match.prefixLength = table->prefixLength;
+          m_matches.push_back (match);
+        }
+    }
+  return m_matches;
+}
+
+} // namespace ns3
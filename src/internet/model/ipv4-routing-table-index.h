@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTING_TABLE_INDEX_H
+#define IPV4_ROUTING_TABLE_INDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Index of unicast routing table entries by destination network.
+ *
+ * The routes are grouped by network mask, and within a mask by destination
+ * network in a hash table, so that the routes matching an address are
+ * found with one hash lookup per distinct mask of the table (at most 33
+ * with contiguous masks) instead of a scan of all the routes. The routes
+ * to the same network (e.g., equal-cost multipath routes) are kept
+ * together, in insertion order, so that they can be used directly as a
+ * candidate set.
+ *
+ * The index does not own the entries: the routing protocols keep their
+ * own containers of routes, and add or remove the entries to or from the
+ * index alongside.
+ */
+class Ipv4RoutingTableIndex
+{
+public:
+  /// A route of the index
+  struct Route
+  {
+    Ipv4RoutingTableEntry *entry; ///< the routing table entry
+    uint32_t metric;              ///< the metric of the route
+    uint64_t order;               ///< the insertion order of the route
+  };
+
+  /// The routes to a network, in insertion order
+  typedef std::vector<Route> Routes;
+
+  /// The routes to a network matching an address
+  struct Match
+  {
+    const Routes *routes;  ///< the routes
+    uint16_t prefixLength; ///< the prefix length of the network mask of the routes
+  };
+
+  /// The matches of an address, by decreasing prefix length
+  typedef std::vector<Match> Matches;
+
+  Ipv4RoutingTableIndex ();
+
+  /**
+   * Add a route, after the other routes to the same network
+   *
+   * \param entry the routing table entry
+   * \param metric the metric of the route
+   */
+  void Add (Ipv4RoutingTableEntry *entry, uint32_t metric = 0);
+
+  /**
+   * Remove a route
+   *
+   * \param entry the routing table entry
+   */
+  void Remove (Ipv4RoutingTableEntry *entry);
+
+  /// Remove all the routes
+  void Clear (void);
+
+  /**
+   * Find the routes whose destination network matches an address
+   *
+   * The matches are stored in a buffer of the index, so that no memory is
+   * allocated once the buffer is large enough; they are valid until the
+   * next call to a non-const method.
+   *
+   * \param dest the address
+   * \return the sets of matching routes, one per network mask, by
+   * decreasing prefix length
+   */
+  const Matches & Lookup (Ipv4Address dest);
+
+private:
+  /// The routes with a given network mask
+  struct MaskTable
+  {
+    uint32_t mask;                                   ///< the network mask
+    uint16_t prefixLength;                           ///< the prefix length of the mask
+    std::unordered_map<uint32_t, Routes> networks;   ///< the routes by destination network
+  };
+
+  /**
+   * \param mask a network mask
+   * \param create whether to create the table if not found
+   * \return the index of the table of the mask in m_tables, or m_tables.size ()
+   */
+  uint32_t FindTable (Ipv4Mask mask, bool create);
+
+  std::vector<MaskTable> m_tables; ///< the tables, by decreasing prefix length
+  uint64_t m_nextOrder;            ///< the insertion order of the next route
+  Matches m_matches;               ///< the buffer of the matches
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTING_TABLE_INDEX_H */
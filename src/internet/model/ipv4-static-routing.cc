@@ -73,6 +73,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkIndex.Add (route, metric);
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -87,6 +89,8 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkIndex.Add (route, metric);
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -144,6 +148,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_networkIndex.Add (route, 0);
 }
 
 uint32_t 
@@ -224,8 +229,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -240,56 +243,61 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // the matching networks come by decreasing mask length: the first mask
+  // length with a route on the requested interface is the longest match
+  const Ipv4RoutingTableIndex::Matches &matches = m_networkIndex.Lookup (dest);
+  Ipv4RoutingTableEntry *route = 0;
+  Ipv4RoutingTableIndex::Matches::const_iterator i = matches.begin ();
+  while (i != matches.end () && route == 0)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      uint16_t masklen = i->prefixLength;
+      uint32_t shortest_metric = 0xffffffff;
+      uint64_t order = 0;
+      for (; i != matches.end () && i->prefixLength == masklen; i++)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
+          for (Ipv4RoutingTableIndex::Routes::const_iterator j = i->routes->begin (); j != i->routes->end (); j++)
             {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+              NS_LOG_LOGIC ("Found global network route " << j->entry << ", mask length " << masklen << ", metric " << j->metric);
+              if (oif != 0)
                 {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  if (oif != m_ipv4->GetNetDevice (j->entry->GetInterface ()))
+                    {
+                      NS_LOG_LOGIC ("Not on requested interface, skipping");
+                      continue;
+                    }
+                }
+              if (masklen == 32)
+                {
+                  // the first host route added wins
+                  if (route == 0 || j->order < order)
+                    {
+                      route = j->entry;
+                      order = j->order;
+                    }
                   continue;
                 }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
-            {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
-            }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
+              // the shortest metric wins, and the last route added among equals
+              if (route != 0 && (j->metric > shortest_metric
+                                 || (j->metric == shortest_metric && j->order < order)))
+                {
+                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                  continue;
+                }
+              route = j->entry;
+              shortest_metric = j->metric;
+              order = j->order;
             }
         }
     }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+    }
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetGateway () << " at the end");
@@ -447,8 +455,10 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_networkIndex.Remove (j->first);
           delete j->first;
           m_networkRoutes.erase (j);
+          NotifyRoutingTableChange ();
           return;
         }
       tmp++;
@@ -575,6 +585,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkIndex.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,6 +624,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          m_networkIndex.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -621,6 +633,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
           it++;
         }
     }
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -660,6 +673,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          m_networkIndex.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -668,6 +682,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           it++;
         }
     }
+  NotifyRoutingTableChange ();
 }
 
 void 
@@ -742,4 +757,10 @@ Ipv4StaticRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Uni
   *os << std::endl;
 }
 
+bool
+Ipv4StaticRouting::IsForwardingCacheable (void) const
+{
+  return true;
+}
+
 } // namespace ns3
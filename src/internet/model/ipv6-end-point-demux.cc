@@ -21,6 +21,7 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -45,22 +46,75 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv6EndPointDemux::EndPointKey::EndPointKey (Ipv6Address localAddress, uint16_t localPort,
+                                              Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    localPort (localPort),
+    peerAddress (peerAddress),
+    peerPort (peerPort)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+}
+
+bool Ipv6EndPointDemux::EndPointKey::operator== (const EndPointKey &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::EndPointKeyHash::operator() (const EndPointKey &key) const
+{
+  Ipv6AddressHash hash;
+  size_t h = hash (key.localAddress);
+  h = h * 31 + hash (key.peerAddress);
+  h = h * 31 + ((static_cast<size_t> (key.localPort) << 16) | key.peerPort);
+  return h;
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_positions[endPoint] = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_ports[endPoint->GetLocalPort ()]++;
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+}
+
+void Ipv6EndPointDemux::AddToIndex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  m_index[key].push_back (endPoint);
+}
+
+void Ipv6EndPointDemux::RemoveFromIndex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointKey key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  std::unordered_map<EndPointKey, std::vector<Ipv6EndPoint *>, EndPointKeyHash>::iterator it = m_index.find (key);
+  NS_ASSERT (it != m_index.end ());
+  std::vector<Ipv6EndPoint *> &endPoints = it->second;
+  endPoints.erase (std::find (endPoints.begin (), endPoints.end (), endPoint));
+  if (endPoints.empty ())
     {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
+      m_index.erase (it);
     }
-  return false;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port &&
@@ -83,7 +137,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -98,7 +152,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -119,7 +173,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,21 +183,22 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<EndPointKey, std::vector<Ipv6EndPoint *>, EndPointKeyHash>::const_iterator it =
+    m_index.find (EndPointKey (localAddress, localPort, peerAddress, peerPort));
+  if (it != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      for (std::vector<Ipv6EndPoint *>::const_iterator i = it->second.begin (); i != it->second.end (); i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -153,59 +208,39 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<Ipv6EndPoint *, EndPointsI>::iterator position = m_positions.find (endPoint);
+  if (position == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  RemoveFromIndex (endPoint);
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  if (--port->second == 0)
+    {
+      m_ports.erase (port);
+    }
+  m_endPoints.erase (position->second);
+  m_positions.erase (position);
+  delete endPoint;
 }
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
-                                                        Ipv6Address saddr, uint16_t sport,
-                                                        Ptr<Ipv6Interface> incomingInterface)
+void Ipv6EndPointDemux::LookupIndex (const EndPointKey &key, Ptr<Ipv6Interface> incomingInterface, EndPoints &endPoints)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-
-  EndPoints retval1; /* Matches exact on local port, wildcards on others */
-  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-  EndPoints retval3; /* Matches all but local address */
-  EndPoints retval4; /* Exact match on all 4 */
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << key.localAddress << key.localPort << key.peerAddress << key.peerPort);
+  std::unordered_map<EndPointKey, std::vector<Ipv6EndPoint *>, EndPointKeyHash>::const_iterator it = m_index.find (key);
+  if (it == m_index.end ())
+    {
+      return;
+    }
+  for (std::vector<Ipv6EndPoint *>::const_iterator i = it->second.begin (); i != it->second.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-
       if (!endP->IsRxEnabled ())
         {
           NS_LOG_LOGIC ("Skipping endpoint " << &endP
                         << " because endpoint can not receive packets");
           continue;
         }
-
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
       if (endP->GetBoundNetDevice ())
         {
           if (!incomingInterface)
@@ -221,61 +256,40 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
               continue;
             }
         }
+      endPoints.push_back (endP);
+    }
+}
 
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
+                                                        Ipv6Address saddr, uint16_t sport,
+                                                        Ptr<Ipv6Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
 
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+  EndPoints retval1; /* Matches exact on local port, wildcards on others */
+  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
+  EndPoints retval3; /* Matches all but local address */
+  EndPoints retval4; /* Exact match on all 4 */
 
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-          continue;
-        }
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
 
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
-    }
+  /* The local address of an endpoint matches exactly or is a wildcard, and
+     so are its remote address and port: only the four-tuples of these
+     combinations are looked up in the index. */
+  Ipv6Address any = Ipv6Address::GetAny ();
+  /* Only local port matches exactly */
+  LookupIndex (EndPointKey (any, dport, any, 0), incomingInterface, retval1);
+  /* Only local port and local address matches exactly */
+  LookupIndex (EndPointKey (daddr, dport, any, 0), incomingInterface, retval2);
+  /* All but local address */
+  LookupIndex (EndPointKey (any, dport, saddr, sport), incomingInterface, retval3);
+  /* All 4 match */
+  LookupIndex (EndPointKey (daddr, dport, saddr, sport), incomingInterface, retval4);
 
   // Here we find the most exact match
   EndPoints retval;
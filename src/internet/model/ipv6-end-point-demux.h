@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,10 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed in a hash table by their four-tuple, where the
+ * listening endpoints have a wildcard peer address and port, and the number
+ * of endpoints per local port is counted, as in Ipv4EndPointDemux.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,76 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint.
+   */
+  struct EndPointKey
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress the local address
+     * \param localPort the local port
+     * \param peerAddress the peer address
+     * \param peerPort the peer port
+     */
+    EndPointKey (Ipv6Address localAddress, uint16_t localPort,
+                 Ipv6Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the other four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator== (const EndPointKey &other) const;
+
+    Ipv6Address localAddress; //!< the local address
+    uint16_t localPort;       //!< the local port
+    Ipv6Address peerAddress;  //!< the peer address
+    uint16_t peerPort;        //!< the peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct EndPointKeyHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param key the four-tuple
+     * \returns the hash
+     */
+    size_t operator() (const EndPointKey &key) const;
+  };
+
+  /**
+   * \brief Add an allocated endpoint to the list, the index and the ports.
+   * \param endPoint the endpoint
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an endpoint by its current four-tuple.
+   * \param endPoint the endpoint
+   */
+  void AddToIndex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the index, before its four-tuple changes.
+   * \param endPoint the endpoint
+   */
+  void RemoveFromIndex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Find the endpoints with a four-tuple which can receive packets
+   * from an interface.
+   * \param key the four-tuple
+   * \param incomingInterface the incoming interface
+   * \param endPoints the list to append the endpoints to
+   */
+  void LookupIndex (const EndPointKey &key, Ptr<Ipv6Interface> incomingInterface, EndPoints &endPoints);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +254,20 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+  /**
+   * \brief The IPv6 end points by four-tuple.
+   */
+  std::unordered_map<EndPointKey, std::vector<Ipv6EndPoint *>, EndPointKeyHash> m_index;
+
+  /**
+   * \brief The position of each IPv6 end point in the list.
+   */
+  std::unordered_map<Ipv6EndPoint *, EndPointsI> m_positions;
+
+  /**
+   * \brief The number of IPv6 end points of each local port in use.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } /* namespace ns3 */
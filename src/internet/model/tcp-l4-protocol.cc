@@ -29,6 +29,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/super-segment-tag.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -602,6 +603,59 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
     }
 }
 
+bool
+TcpL4Protocol::SplitSuperSegment (Ptr<const Packet> p, Ipv4Header const &header,
+                                  std::list<Ptr<Packet> > &segments) const
+{
+  NS_LOG_FUNCTION (this << p << header);
+
+  SuperSegmentTag superSegment;
+  if (!p->PeekPacketTag (superSegment) || superSegment.GetSegmentSize () == 0)
+    {
+      return false;
+    }
+  Ptr<Packet> payload = p->Copy ();
+  payload->RemovePacketTag (superSegment);
+  TcpHeader tcpHeader;
+  payload->RemoveHeader (tcpHeader);
+  uint32_t size = payload->GetSize ();
+  uint32_t segmentSize = superSegment.GetSegmentSize ();
+  if (size <= segmentSize)
+    {
+      return false;
+    }
+
+  if (Node::ChecksumEnabled ())
+    {
+      tcpHeader.EnableChecksums ();
+    }
+  tcpHeader.InitializeChecksum (header.GetSource (), header.GetDestination (), PROT_NUMBER);
+
+  // The segments carry the header of the super-segment, at their own offset;
+  // FIN and PSH belong to the last one, CWR to the first one
+  uint8_t flags = tcpHeader.GetFlags ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = payload->CreateFragment (offset, length);
+      TcpHeader segmentHeader = tcpHeader;
+      segmentHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      uint8_t segmentFlags = flags;
+      if (offset + length < size)
+        {
+          segmentFlags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      if (offset > 0)
+        {
+          segmentFlags &= ~TcpHeader::CWR;
+        }
+      segmentHeader.SetFlags (segmentFlags);
+      segment->AddHeader (segmentHeader);
+      segments.push_back (segment);
+    }
+  return true;
+}
+
 void
 TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv6Address &saddr, const Ipv6Address &daddr,
@@ -262,6 +262,8 @@ public:
                             uint8_t icmpType, uint8_t icmpCode, uint32_t icmpInfo,
                             Ipv6Address payloadSource,Ipv6Address payloadDestination,
                             const uint8_t payload[8]);
+  virtual bool SplitSuperSegment (Ptr<const Packet> p, Ipv4Header const &header,
+                                  std::list<Ptr<Packet> > &segments) const;
 
   virtual void SetDownTarget (IpL4Protocol::DownTargetCallback cb);
   virtual void SetDownTarget6 (IpL4Protocol::DownTargetCallback6 cb);
@@ -18,6 +18,8 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <iterator>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -155,68 +157,76 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
+
+  // Start from the first run which ends at or after the packet head
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
+      BufIterator prev = std::prev (i);
+      if (prev->second.m_tail >= headSeq)
         {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
-            { // Incoming head is overlapped
-              headSeq = lastByteSeq;
-            }
-          if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-              tailSeq = i->first;
-            }
+          i = prev;
+        }
+    }
+
+  // Store the bytes falling in the holes between the runs; the bytes already
+  // buffered are skipped
+  SequenceNumber32 seq = headSeq;
+  SequenceNumber32 firstStored = tailSeq;
+  uint32_t stored = 0;
+  while (seq < tailSeq)
+    {
+      if (i != m_data.end () && i->first <= seq)
+        { // seq falls in (or right after) this run
+          if (i->second.m_tail > seq) seq = i->second.m_tail;
+          ++i;
+          continue;
         }
-      ++i;
+      SequenceNumber32 holeEnd = tailSeq;
+      if (i != m_data.end () && i->first < holeEnd) holeEnd = i->first;
+      uint32_t start = static_cast<uint32_t> (seq - tcph.GetSequenceNumber ());
+      uint32_t length = static_cast<uint32_t> (holeEnd - seq);
+      BufIterator run = m_data.insert (i, std::make_pair (seq, DataBlock ()));
+      run->second.m_tail = holeEnd;
+      run->second.m_packets.push_back (p->CreateFragment (start, length));
+      NS_LOG_LOGIC ("Buffered " << length << " bytes of seqno=" << seq);
+      if (stored == 0) firstStored = seq;
+      stored += length;
+      seq = holeEnd;
     }
-  // We now know how much we are going to store, trim the packet
-  if (headSeq >= tailSeq)
+  if (stored == 0)
     {
       NS_LOG_LOGIC ("Nothing to buffer");
       return false; // Nothing to buffer anyway
     }
-  else
+  m_size += stored;      // Occupancy
+
+  // Coalesce the runs touched by the packet, including the ones ending at
+  // its head and starting at its tail: [headSeq;tailSeq] is now contiguous
+  BufIterator run = std::prev (m_data.upper_bound (firstStored));
+  if (run != m_data.begin () && std::prev (run)->second.m_tail == run->first)
     {
-      uint32_t start = static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ());
-      uint32_t length = static_cast<uint32_t> (tailSeq - headSeq);
-      p = p->CreateFragment (start, length);
-      NS_ASSERT (length == p->GetSize ());
+      --run;
+    }
+  BufIterator next = std::next (run);
+  while (next != m_data.end () && next->first == run->second.m_tail)
+    {
+      run->second.m_tail = next->second.m_tail;
+      run->second.m_packets.splice (run->second.m_packets.end (), next->second.m_packets);
+      m_data.erase (next++);
     }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
 
-  if (headSeq > m_nextRxSeq)
+  if (firstStored > m_nextRxSeq)
     {
       // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      UpdateSackList (run->first, run->second.m_tail);
     }
-
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  else
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      // The run is the in-order data at the head of the buffer
+      NS_ASSERT (run == m_data.begin ());
+      m_availBytes += run->second.m_tail - m_nextRxSeq;
+      m_nextRxSeq = run->second.m_tail;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -271,53 +281,23 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // The block "current" is the whole interval of buffered data containing
+  // the segment, so it includes any block of the previous list it touches:
+  // those are removed, the others are kept in their order.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
   while (it != m_sackList.end ())
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (it->first >= current.first && it->second <= current.second)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          NS_ASSERT (it->second < current.first || it->first > current.second);
+          ++it;
         }
-
-      ++it;
     }
+  m_sackList.push_front (current);
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
@@ -325,11 +305,6 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     {
       m_sackList.pop_back ();
     }
-
-  // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -369,39 +344,76 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
-  while (extractSize)
-    { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
-      // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
-      if (pktSize <= extractSize)
+  BufIterator i = m_data.begin ();
+  NS_ASSERT (i->first < m_nextRxSeq); // in-sequence data expected
+
+  // Take the pieces to return from the head of the first run
+  std::vector<Ptr<Packet> > pieces;
+  std::list<Ptr<Packet> > &packets = i->second.m_packets;
+  uint32_t remaining = extractSize;
+  while (remaining)
+    {
+      NS_ASSERT (!packets.empty ());
+      Ptr<Packet> head = packets.front ();
+      uint32_t pktSize = head->GetSize ();
+      if (pktSize <= remaining)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
+          pieces.push_back (head);
+          packets.pop_front ();
+          remaining -= pktSize;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          pieces.push_back (head->CreateFragment (0, remaining));
+          packets.front () = head->CreateFragment (remaining, pktSize - remaining);
+          remaining = 0;
         }
     }
-  if (outPkt->GetSize () == 0)
+  m_size -= extractSize;
+  m_availBytes -= extractSize;
+
+  // The rest of the run is now indexed by its new head
+  if (packets.empty ())
+    {
+      NS_ASSERT (i->first + SequenceNumber32 (extractSize) == i->second.m_tail);
+      m_data.erase (i);
+    }
+  else
     {
-      NS_LOG_LOGIC ("Nothing extracted.");
-      return nullptr;
+      BufIterator rest = m_data.insert (std::next (i),
+                                        std::make_pair (i->first + SequenceNumber32 (extractSize),
+                                                        DataBlock ()));
+      rest->second.m_tail = i->second.m_tail;
+      rest->second.m_packets.swap (packets);
+      m_data.erase (i);
     }
+
+  // Packet::AddAtEnd reallocates the buffer to its exact new size when the
+  // appended bytes are not virtual, so appending the pieces one after the
+  // other would copy the head of the output once per piece. Concatenate
+  // them pairwise instead, so that each byte is copied a logarithmic number
+  // of times; the result is always a new packet.
+  do
+    {
+      std::vector<Ptr<Packet> > merged;
+      merged.reserve ((pieces.size () + 1) / 2);
+      for (uint32_t k = 0; k < pieces.size (); k += 2)
+        {
+          Ptr<Packet> pair = Create<Packet> ();
+          pair->AddAtEnd (pieces[k]);
+          if (k + 1 < pieces.size ())
+            {
+              pair->AddAtEnd (pieces[k + 1]);
+            }
+          merged.push_back (pair);
+        }
+      pieces.swap (merged);
+    }
+  while (pieces.size () > 1);
+  Ptr<Packet> outPkt = pieces.front (); // The packet that contains all the data to return
+
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num runs in buffer=" << m_data.size ());
   return outPkt;
 }
 
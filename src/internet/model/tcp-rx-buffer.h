@@ -22,6 +22,7 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <list>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -53,6 +54,18 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * Reassembly
+ * ----------
+ *
+ * The buffered bytes are kept as a set of disjoint intervals, indexed by their
+ * first sequence number: each interval is a run of contiguous bytes, and
+ * holds the (parts of) segments forming it in order. The intervals
+ * adjacent to a new segment are coalesced with it on insertion, so that the
+ * number of intervals is the number of holes in the sequence space, not the
+ * number of segments received; finding where a segment goes costs a
+ * logarithmic lookup. The segments of a run are concatenated only when the
+ * run is extracted, once per call to Extract.
+ *
  * SACK list
  * ---------
  *
@@ -139,9 +152,8 @@ public:
   /**
    * Insert a packet into the buffer and update the availBytes counter to
    * reflect the number of bytes ready to send to the application. This
-   * function handles overlap by triming the head of the inputted packet and
-   * removing data from the buffer that overlaps the tail of the inputted
-   * packet
+   * function handles overlap by storing only the bytes of the inputted
+   * packet which are not in the buffer yet
    *
    * \param p packet
    * \param tcph packet's TCP header
@@ -185,6 +197,10 @@ private:
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
+   * The block is the interval of buffered data which contains the segment
+   * just received; the blocks of the previous list which are now part of it
+   * are removed, the others are kept in their order.
+   *
    * Note: the maximum size of the block list is 4. Caller is free to
    * drop blocks at the end to accommodate header size; from RFC 2018:
    *
@@ -197,6 +213,8 @@ private:
    * (or other) options, it is even less. For more detail about this function,
    * please see the source code and in-line comments.
    *
+   * The cost is linear in the number of blocks of the list.
+   *
    * \param head sequence number of the block at the beginning
    * \param tail sequence number of the block at the end
    */
@@ -215,17 +233,31 @@ private:
    */
   void ClearSackList (const SequenceNumber32 &seq);
 
-  TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
+  /**
+   * \brief A run of contiguous bytes stored in the buffer
+   *
+   * The run starts at the sequence number indexing it in the buffer.
+   */
+  struct DataBlock
+  {
+    SequenceNumber32 m_tail;            //!< Seqnum following the last byte of the run
+    std::list<Ptr<Packet> > m_packets;  //!< (Parts of) segments forming the run, in order
+  };
 
   /// container for data stored in the buffer
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  typedef std::map<SequenceNumber32, DataBlock> DataBlocks;
+  /// iterator on the data stored in the buffer
+  typedef DataBlocks::iterator BufIterator;
+
+  TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
+
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  DataBlocks m_data;                         //!< Disjoint runs of buffered bytes, by first seqnum
 };
 
 } //namespace ns3
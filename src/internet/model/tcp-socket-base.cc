@@ -43,6 +43,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
 #include "ns3/object.h"
+#include "ns3/super-segment-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -141,6 +142,12 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("SuperSegmentSize",
+                   "Max payload size of the super-segments carrying new data, "
+                   "rounded down to a multiple of the segment size (0 to disable)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_superSegmentSize),
+                   MakeUintegerChecker<uint32_t> (0, 65535 - 20 - 60))
     .AddAttribute ("EcnMode", "Determines the mode of ECN",
                    EnumValue (EcnMode_t::NoEcn),
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
@@ -329,6 +336,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_superSegmentSize (sock.m_superSegmentSize),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -1698,9 +1706,20 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
         }
     }
 
+  // A coalesced ACK stands for the ACKs of the segments of a super-segment.
+  // The tag of a data super-segment is ignored: only the first of its
+  // segments would have acknowledged anything.
+  SuperSegmentTag superSegment;
+  if (packet->GetSize () == 0 && packet->PeekPacketTag (superSegment)
+      && superSegment.GetSegmentSize () == 0)
+    {
+      m_rxAckCount = superSegment.GetSegments ();
+    }
+
   // RFC 6675 Section 5: 2nd, 3rd paragraph and point (A), (B) implementation
   // are inside the function ProcessAck
   ProcessAck (ackNumber, scoreboardUpdated, oldHeadSequence);
+  m_rxAckCount = 1;
 
   // If there is any data piggybacked, store it into m_rxBuffer
   if (packet->GetSize () > 0)
@@ -1761,7 +1780,10 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
     {
       // loss recovery check is done inside this function thanks to
       // the congestion state machine
-      DupAck ();
+      for (uint32_t i = 0; i < m_rxAckCount; ++i)
+        {
+          DupAck ();
+        }
     }
 
   if (ackNumber == oldHeadSequence
@@ -1781,7 +1803,10 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
   else if (ackNumber == oldHeadSequence)
     {
       // DupAck. Artificially call PktsAcked: after all, one segment has been ACKed.
-      m_congestionControl->PktsAcked (m_tcb, 1, m_tcb->m_lastRtt);
+      for (uint32_t i = 0; i < m_rxAckCount; ++i)
+        {
+          m_congestionControl->PktsAcked (m_tcb, 1, m_tcb->m_lastRtt);
+        }
     }
   else if (ackNumber > oldHeadSequence)
     {
@@ -1889,7 +1914,10 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
         {
           if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
             {
-              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
+              for (uint32_t segs : SplitAckedSegments (segsAcked))
+                {
+                  m_congestionControl->PktsAcked (m_tcb, segs, m_tcb->m_lastRtt);
+                }
             }
           else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
             {
@@ -1966,7 +1994,10 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              for (uint32_t segs : SplitAckedSegments (segsAcked))
+                {
+                  m_congestionControl->IncreaseWindow (m_tcb, segs);
+                }
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -1981,6 +2012,19 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
     }
 }
 
+std::vector<uint32_t>
+TcpSocketBase::SplitAckedSegments (uint32_t segsAcked) const
+{
+  // One share per ACK the received one stands for, but no empty share
+  uint32_t acks = std::min (m_rxAckCount, std::max (segsAcked, 1U));
+  std::vector<uint32_t> shares (acks, segsAcked / acks);
+  for (uint32_t i = 0; i < segsAcked % acks; ++i)
+    {
+      ++shares[i];
+    }
+  return shares;
+}
+
 /* Received a packet upon LISTEN state. */
 void
 TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
@@ -2556,8 +2600,14 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
         {
           AddOptionSack (header);
         }
+      if (m_txAckCount > 1)
+        { // The ACK stands for the ones of the segments of a super-segment
+          p->AddPacketTag (SuperSegmentTag (m_txAckCount, 0,
+                                            Ipv4Header ().GetSerializedSize () + header.GetSerializedSize ()));
+        }
       NS_LOG_INFO ("Sending a pure ACK, acking seq " << m_rxBuffer->NextRxSequence ());
     }
+  m_txAckCount = 1;
 
   m_txTrace (p, header, this);
 
@@ -2840,7 +2890,29 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
+  Ptr<Packet> p;
+  uint32_t segments = 1;
+  if (maxSize > m_tcb->m_segmentSize)
+    {
+      // Super-segment: the Tx buffer keeps an entry per segment
+      p = Create<Packet> ();
+      segments = 0;
+      while (p->GetSize () < maxSize)
+        {
+          uint32_t size = std::min (maxSize - p->GetSize (), m_tcb->m_segmentSize);
+          Ptr<Packet> segment = m_txBuffer->CopyFromSequence (size, seq + p->GetSize ());
+          if (segment->GetSize () == 0)
+            {
+              break;
+            }
+          p->AddAtEnd (segment);
+          ++segments;
+        }
+    }
+  else
+    {
+      p = m_txBuffer->CopyFromSequence (maxSize, seq);
+    }
   uint32_t sz = p->GetSize (); // Size of packet
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
@@ -2929,6 +3001,12 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
     }
 
+  if (segments > 1)
+    {
+      p->AddPacketTag (SuperSegmentTag (segments, m_tcb->m_segmentSize,
+                                        Ipv4Header ().GetSerializedSize () + header.GetSerializedSize ()));
+    }
+
   m_txTrace (p, header, this);
 
   if (m_endPoint)
@@ -3076,6 +3154,19 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_superSegmentSize > m_tcb->m_segmentSize && m_endPoint != nullptr
+              && next == m_tcb->m_highTxMark)
+            {
+              // New data: send the full segments allowed by the window at
+              // once, but no more than a third of the window (as Linux does
+              // with TSO), not to lose the pipelining of the segments
+              uint32_t segments = std::min (std::min (availableWindow, m_superSegmentSize),
+                                            Window () / 3) / m_tcb->m_segmentSize;
+              if (segments > 1)
+                {
+                  s = segments * m_tcb->m_segmentSize;
+                }
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -3230,6 +3321,14 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // A super-segment is acknowledged as the segments it stands for
+  uint32_t segments = 1;
+  SuperSegmentTag superSegment;
+  if (p->PeekPacketTag (superSegment))
+    {
+      segments = superSegment.GetSegments ();
+    }
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -3269,6 +3368,7 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   // Now send a new ACK packet acknowledging all received and delivered data
   if (m_rxBuffer->Size () > m_rxBuffer->Available () || m_rxBuffer->NextRxSequence () > expectedSeq + p->GetSize ())
     { // A gap exists in the buffer, or we filled a gap: Always ACK
+      m_txAckCount = segments;
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
       if (m_tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD || m_tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE)
         {
@@ -3283,8 +3383,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
+          m_txAckCount = std::max (m_delAckCount / std::max (m_delAckMaxCount, 1u), 1u);
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <queue>
+#include <vector>
 #include "ns3/traced-value.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/ipv4-header.h"
@@ -212,6 +213,24 @@ public:
  * you need more information. The reference paper is
  * https://dl.acm.org/citation.cfm?id=3067666.
  *
+ * Super-segments
+ * --------------
+ *
+ * For throughput studies of long-lived flows, where only the window dynamics
+ * matter, the attribute SuperSegmentSize lets the socket send new data in
+ * super-segments of several full segments (see SuperSegmentTag), as with TCP
+ * segmentation offload. A super-segment is no larger than a third of the
+ * window, and is only used over IPv4. The Tx
+ * buffer still keeps one entry per segment, so that losses and
+ * retransmissions are handled segment by segment.
+ *
+ * The receiver acknowledges a super-segment of k segments with a single ACK,
+ * which stands for the ACKs it would have sent for the k segments, and the
+ * sender runs the congestion control once for each of them. Devices which
+ * cannot carry a super-segment get its segments instead (see
+ * Ipv4L3Protocol), so the drop decisions of their queues are per segment.
+ * A duplicate ACK standing for k ACKs counts as k duplicate ACKs.
+ *
  */
 class TcpSocketBase : public TcpSocket
 {
@@ -969,6 +988,17 @@ protected:
   virtual void ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpdated,
                            const SequenceNumber32 &oldHeadSequence);
 
+  /**
+   * \brief Split the segments acknowledged by a coalesced ACK
+   *
+   * A coalesced ACK stands for m_rxAckCount ACKs: the congestion control is
+   * called once per ACK, with its share of the acknowledged segments.
+   *
+   * \param segsAcked the number of segments acknowledged
+   * \return the shares, one per ACK (at least one, and no empty share)
+   */
+  std::vector<uint32_t> SplitAckedSegments (uint32_t segsAcked) const;
+
   /**
    * \brief Recv of a data, put into buffer, call L7 to get it if necessary
    * \param packet the packet
@@ -1180,6 +1210,8 @@ protected:
   uint32_t          m_dupAckCount {0};     //!< Dupack counter
   uint32_t          m_delAckCount {0};     //!< Delayed ACK counter
   uint32_t          m_delAckMaxCount {0};  //!< Number of packet to fire an ACK before delay timeout
+  uint32_t          m_txAckCount {1};      //!< Number of ACKs the next pure ACK sent stands for
+  uint32_t          m_rxAckCount {1};      //!< Number of ACKs the ACK being processed stands for
 
   // Nagle algorithm
   bool              m_noDelay {false};     //!< Set to true to disable Nagle's algorithm
@@ -1249,6 +1281,8 @@ protected:
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
 
+  uint32_t m_superSegmentSize {0}; //!< Max payload of a super-segment (0 to disable)
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
@@ -96,7 +96,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostUpTo (n), m_lostHint (n), m_rule3Hint (n)
 {
 }
 
@@ -169,6 +170,9 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostUpTo = seq;
+  m_lostHint = seq;
+  m_rule3Hint = seq;
 }
 
 bool
@@ -294,7 +298,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_sentIndex[item->m_startSeq] = m_sentList.insert (m_sentList.end (), item);
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,36 +312,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  SentIndex::const_iterator index = m_sentIndex.find (seq);
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -398,7 +399,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,12 +435,25 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool isSentList = &list == &m_sentList;
+
+  if (isSentList)
+    {
+      // Start from the sent item that contains seq
+      SentIndex::const_iterator index = m_sentIndex.upper_bound (seq);
+      if (index != m_sentIndex.begin ())
+        {
+          --index;
+          it = index->second;
+          beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!isSentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -469,7 +483,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -535,7 +554,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = firstPartIt;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -565,6 +589,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
 
           MergeItems (currentItem, next);
           list.erase (it);
+          if (isSentList)
+            {
+              m_sentIndex.erase (next->m_startSeq);
+            }
 
           delete next;
 
@@ -602,6 +630,7 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
   // be updated in GetTransmittedSegment.
   if (! AreEquals (t1->m_retrans, t2->m_retrans))
     {
+      RestartNextSegFrom (t1->m_startSeq);
       if (t1->m_retrans)
         {
           TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
@@ -693,6 +722,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          m_sentIndex.erase (item->m_startSeq);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -705,7 +735,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
+          m_sentIndex.erase (item->m_startSeq);
           item->m_startSeq += offset;
+          m_sentIndex[item->m_startSeq] = i;
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -724,6 +756,30 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       m_firstByteSeq = seq;
     }
 
+  // Forget the SACKed sequence space below SND.UNA
+  while (!m_sackedRanges.empty () && m_sackedRanges.begin ()->first < m_firstByteSeq)
+    {
+      SequenceNumber32 end = m_sackedRanges.begin ()->second;
+      m_sackedRanges.erase (m_sackedRanges.begin ());
+      if (end > m_firstByteSeq)
+        {
+          m_sackedRanges[m_firstByteSeq] = end;
+          break;
+        }
+    }
+  if (m_lostUpTo < m_firstByteSeq)
+    {
+      m_lostUpTo = m_firstByteSeq;
+    }
+  if (m_lostHint < m_firstByteSeq)
+    {
+      m_lostHint = m_firstByteSeq;
+    }
+  if (m_rule3Hint < m_firstByteSeq)
+    {
+      m_rule3Hint = m_firstByteSeq;
+    }
+
   if (!m_sentList.empty ())
     {
       TcpTxItem *head = m_sentList.front ();
@@ -735,9 +791,12 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          RemoveSackedRange (head);
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
-          AddRenoSack ();
+          // Mark the head first, so that it is never seen neither lost nor
+          // sacked below the segments already marked
           MarkHeadAsLost ();
+          AddRenoSack ();
         }
 
       NS_ASSERT_MSG (head->m_startSeq == seq,
@@ -768,68 +827,67 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Only the items starting inside the block can be mapped over it
+      PacketList::const_iterator item_it = FindSentItem ((*option_it).first);
+
       while (item_it != m_sentList.end ())
         {
-          uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          TcpTxItem *item = *item_it;
+          SequenceNumber32 beginOfCurrentPacket = item->m_startSeq;
+          uint32_t pktSize = item->m_packet->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
           // is reporting as sacked single range bytes that are not mapped 1:1
           // in what we have, the option is discarded. There's room for improvement
           // here.
-          if (beginOfCurrentPacket >= (*option_it).first
-              && beginOfCurrentPacket + pktSize <= (*option_it).second)
-            {
-              if ((*item_it)->m_sacked)
-                {
-                  NS_ASSERT (!(*item_it)->m_lost);
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard already sacked");
-                }
-              else
-                {
-                  if ((*item_it)->m_lost)
-                    {
-                      (*item_it)->m_lost = false;
-                      m_lostOut -= (*item_it)->m_packet->GetSize ();
-                    }
-
-                  (*item_it)->m_sacked = true;
-                  m_sackedOut += (*item_it)->m_packet->GetSize ();
-
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
-                    {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
-                    }
-
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
-                }
-              modified = true;
-            }
-          else if (beginOfCurrentPacket + pktSize > (*option_it).second)
+          if (beginOfCurrentPacket + pktSize > (*option_it).second)
             {
               // We already passed the received block end. Exit from the loop
               NS_LOG_INFO ("Received block [" << *option_it <<
-                           ", checking sentList for block " << *(*item_it) <<
+                           ", checking sentList for block " << *item <<
                            "], not found, breaking loop");
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
+          modified = true;
+          if (item->m_sacked)
+            {
+              NS_ASSERT (!item->m_lost);
+              NS_LOG_INFO ("Received block " << *option_it <<
+                           ", checking sentList for block " << *item <<
+                           ", found in the sackboard already sacked");
+              // Skip the items sacked by the previous options in one step
+              item_it = SkipSackedRange (item_it);
+              continue;
+            }
+
+          if (item->m_lost)
+            {
+              item->m_lost = false;
+              m_lostOut -= pktSize;
+            }
+
+          item->m_sacked = true;
+          m_sackedOut += pktSize;
+          AddSackedRange (item);
+
+          if (m_highestSack.first == m_sentList.end()
+              || m_highestSack.second <= beginOfCurrentPacket + pktSize)
+            {
+              m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+            }
+
+          NS_LOG_INFO ("Received block " << *option_it <<
+                       ", checking sentList for block " << *item <<
+                       ", found in the sackboard, sacking, current highSack: " <<
+                       m_highestSack.second);
           ++item_it;
         }
     }
@@ -853,7 +911,8 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
+  bool reached = false;
+  SequenceNumber32 lostUpTo = m_lostUpTo;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
@@ -868,6 +927,12 @@ TcpTxBuffer::UpdateLostCount ()
   for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
     {
       TcpTxItem *item = *it;
+      if (reached && item->m_startSeq < m_lostUpTo)
+        {
+          // The items below have been already marked by a previous update
+          break;
+        }
+
       if (item->m_sacked)
         {
           sacked++;
@@ -875,14 +940,27 @@ TcpTxBuffer::UpdateLostCount ()
 
       if (sacked >= m_dupAckThresh)
         {
+          if (!reached)
+            {
+              // All the items from here down to the head will be lost or sacked
+              reached = true;
+              if (lostUpTo < item->m_startSeq)
+                {
+                  lostUpTo = item->m_startSeq;
+                }
+            }
           if (!item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              if (item->m_startSeq < m_lostHint)
+                {
+                  m_lostHint = item->m_startSeq;
+                }
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
     }
+  m_lostUpTo = lostUpTo;
 
   if (sacked >= m_dupAckThresh)
     {
@@ -891,6 +969,7 @@ TcpTxBuffer::UpdateLostCount ()
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          m_lostHint = item->m_startSeq;
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -902,7 +981,6 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
   PacketList::const_iterator it;
 
   if (seq >= m_highestSack.second)
@@ -910,27 +988,20 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Search for the first item at or after seq, then check the flags
+  for (it = FindSentItem (seq); it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it)->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -956,34 +1027,33 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    */
   PacketList::const_iterator it;
   TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // No item before m_lostHint meets the criteria: start from there, and
+  // skip the SACKed ranges
+  it = FindSentItem (m_lostHint);
+  while (it != m_sentList.end ())
     {
       item = *it;
 
+      if (item->m_sacked)
+        {
+          it = SkipSackedRange (it);
+          continue;
+        }
+
       // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      if (item->m_retrans == false && item->m_lost)
         {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
+          NS_LOG_INFO("IsLost, returning" << item->m_startSeq);
+          m_lostHint = item->m_startSeq;
+          *seq = item->m_startSeq;
+          return true;
         }
 
       // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      ++it;
     }
+  m_lostHint = m_firstByteSeq + m_sentSize;
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
    *     exists available unsent data and the receiver's advertised
@@ -1008,11 +1078,43 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery)
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
-      return true;
+      SequenceNumber32 seqPerRule3;
+      bool isSeqPerRule3Valid = false;
+
+      // No item before m_rule3Hint meets the criteria
+      it = FindSentItem (m_rule3Hint);
+      m_rule3Hint = m_firstByteSeq + m_sentSize;
+      while (it != m_sentList.end () && (!isSeqPerRule3Valid || seqPerRule3.GetValue () == 0))
+        {
+          item = *it;
+
+          if (item->m_sacked)
+            {
+              it = SkipSackedRange (it);
+              continue;
+            }
+
+          if (item->m_retrans == false)
+            {
+              NS_LOG_INFO ("Saving for rule 3 the seq " << item->m_startSeq);
+              if (!isSeqPerRule3Valid)
+                {
+                  m_rule3Hint = item->m_startSeq;
+                }
+              isSeqPerRule3Valid = true;
+              seqPerRule3 = item->m_startSeq;
+            }
+          ++it;
+        }
+
+      if (isSeqPerRule3Valid)
+        {
+          NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
+          *seq = seqPerRule3;
+          return true;
+        }
     }
 
   /* (4) If the conditions for (1), (2), and (3) fail, but there exists
@@ -1185,7 +1287,11 @@ TcpTxBuffer::ResetRenoSack ()
       (*it)->m_sacked = false;
     }
 
+  m_sackedRanges.clear ();
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostUpTo = m_firstByteSeq;
+  RestartNextSegFrom (m_firstByteSeq);
+  ConsistencyCheck ();
 }
 
 void
@@ -1208,6 +1314,12 @@ TcpTxBuffer::ResetSentList ()
   m_retrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_sentIndex.clear ();
+  m_sackedRanges.clear ();
+  m_lostUpTo = m_firstByteSeq;
+  m_lostHint = m_firstByteSeq;
+  m_rule3Hint = m_firstByteSeq;
+  ConsistencyCheck ();
 }
 
 void
@@ -1219,11 +1331,22 @@ TcpTxBuffer::ResetLastSegmentSent ()
       TcpTxItem *item = m_sentList.back ();
 
       m_sentList.pop_back ();
+      m_sentIndex.erase (item->m_startSeq);
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
         {
           m_retrans -= item->m_packet->GetSize ();
         }
+      if (item->m_sacked)
+        {
+          RemoveSackedRange (item);
+        }
+      // The item will be sent again at the same sequence
+      if (item->m_startSeq < m_lostUpTo)
+        {
+          m_lostUpTo = item->m_startSeq;
+        }
+      RestartNextSegFrom (item->m_startSeq);
       m_appList.insert (m_appList.begin (), item);
     }
   ConsistencyCheck ();
@@ -1240,6 +1363,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       m_sackedOut = 0;
       m_lostOut = m_sentSize;
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_sackedRanges.clear ();
     }
   else
     {
@@ -1270,6 +1394,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
       (*it)->m_retrans = false;
     }
+  RestartNextSegFrom (m_firstByteSeq);
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
@@ -1303,6 +1428,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      RestartNextSegFrom (m_sentList.front ()->m_startSeq);
     }
   ConsistencyCheck ();
 }
@@ -1319,6 +1445,7 @@ TcpTxBuffer::MarkHeadAsLost ()
         {
           m_sentList.front ()->m_sacked = false;
           m_sackedOut -= m_sentList.front ()->m_packet->GetSize ();
+          RemoveSackedRange (m_sentList.front ());
         }
 
       if (m_sentList.front ()->m_retrans)
@@ -1332,6 +1459,7 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+      RestartNextSegFrom (m_sentList.front ()->m_startSeq);
     }
   ConsistencyCheck ();
 }
@@ -1345,12 +1473,12 @@ TcpTxBuffer::AddRenoSack (void)
   m_renoSack = true;
 
   // We can _never_ SACK the head, so start from the second segment sent
-  auto it = ++m_sentList.begin ();
+  PacketList::const_iterator it = ++m_sentList.begin ();
 
   // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
   while (it != m_sentList.end () && (*it)->m_sacked)
     {
-      ++it;
+      it = SkipSackedRange (it);
     }
 
   // Add to the sacked size the size of the first "not sacked" segment
@@ -1358,6 +1486,7 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
+      AddSackedRange (*it);
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
@@ -1373,9 +1502,7 @@ TcpTxBuffer::AddRenoSack (void)
 void
 TcpTxBuffer::ConsistencyCheck () const
 {
-  static const bool enable = false;
-
-  if (!enable)
+  if (!m_consistencyCheck)
     {
       return;
     }
@@ -1406,6 +1533,136 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+
+  // The index and the SACKed ranges mirror the sent list, and the markers
+  // of UpdateLostCount and NextSeg hold
+  SackedRanges ranges;
+  NS_ASSERT (m_sentIndex.size () == m_sentList.size ());
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      const TcpTxItem *item = *it;
+      SentIndex::const_iterator index = m_sentIndex.find (item->m_startSeq);
+      NS_ASSERT_MSG (index != m_sentIndex.end () && *index->second == item,
+                     "Item " << *item << " not indexed");
+      if (item->m_sacked)
+        {
+          SequenceNumber32 end = item->m_startSeq + item->m_packet->GetSize ();
+          if (!ranges.empty () && ranges.rbegin ()->second == item->m_startSeq)
+            {
+              ranges.rbegin ()->second = end;
+            }
+          else
+            {
+              ranges[item->m_startSeq] = end;
+            }
+        }
+      NS_ASSERT_MSG (item->m_startSeq >= m_lostUpTo || item->m_lost || item->m_sacked,
+                     "Item " << *item << " below " << m_lostUpTo << " not marked");
+      NS_ASSERT_MSG (item->m_startSeq >= m_lostHint || !item->m_lost || item->m_retrans
+                     || item->m_sacked, "Item " << *item << " below " << m_lostHint);
+      NS_ASSERT_MSG (item->m_startSeq >= m_rule3Hint || item->m_retrans || item->m_sacked,
+                     "Item " << *item << " below " << m_rule3Hint);
+    }
+  NS_ASSERT (ranges == m_sackedRanges);
+}
+
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  SentIndex::const_iterator index = m_sentIndex.lower_bound (seq);
+  if (index == m_sentIndex.end ())
+    {
+      return m_sentList.end ();
+    }
+  return index->second;
+}
+
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::SkipSackedRange (PacketList::const_iterator it) const
+{
+  NS_ASSERT ((*it)->m_sacked);
+  SackedRanges::const_iterator range = m_sackedRanges.upper_bound ((*it)->m_startSeq);
+  NS_ASSERT (range != m_sackedRanges.begin ());
+  --range;
+  NS_ASSERT (range->second > (*it)->m_startSeq);
+  return FindSentItem (range->second);
+}
+
+void
+TcpTxBuffer::AddSackedRange (const TcpTxItem *item)
+{
+  SequenceNumber32 start = item->m_startSeq;
+  SequenceNumber32 end = item->m_startSeq + item->m_packet->GetSize ();
+
+  // Merge with the ranges that overlap or touch the new one
+  SackedRanges::iterator next = m_sackedRanges.lower_bound (start);
+  if (next != m_sackedRanges.begin ())
+    {
+      SackedRanges::iterator previous = std::prev (next);
+      if (previous->second >= start)
+        {
+          start = previous->first;
+          if (previous->second > end)
+            {
+              end = previous->second;
+            }
+          m_sackedRanges.erase (previous);
+        }
+    }
+  while (next != m_sackedRanges.end () && next->first <= end)
+    {
+      if (next->second > end)
+        {
+          end = next->second;
+        }
+      next = m_sackedRanges.erase (next);
+    }
+  m_sackedRanges[start] = end;
+}
+
+void
+TcpTxBuffer::RemoveSackedRange (const TcpTxItem *item)
+{
+  SequenceNumber32 start = item->m_startSeq;
+  SequenceNumber32 end = item->m_startSeq + item->m_packet->GetSize ();
+
+  SackedRanges::iterator range = m_sackedRanges.upper_bound (start);
+  if (range == m_sackedRanges.begin ())
+    {
+      return;
+    }
+  --range;
+  SequenceNumber32 rangeStart = range->first;
+  SequenceNumber32 rangeEnd = range->second;
+  if (rangeEnd <= start)
+    {
+      return;
+    }
+  m_sackedRanges.erase (range);
+  if (rangeStart < start)
+    {
+      m_sackedRanges[rangeStart] = start;
+    }
+  if (end < rangeEnd)
+    {
+      m_sackedRanges[end] = rangeEnd;
+    }
+}
+
+void
+TcpTxBuffer::RestartNextSegFrom (const SequenceNumber32 &seq) const
+{
+  // Items moved back to the application list do not have a meaningful
+  // sequence, hence the lower bound
+  SequenceNumber32 from = seq < m_firstByteSeq ? m_firstByteSeq.Get () : seq;
+  if (from < m_lostHint)
+    {
+      m_lostHint = from;
+    }
+  if (from < m_rule3Hint)
+    {
+      m_rule3Hint = from;
+    }
 }
 
 std::ostream &
@@ -22,6 +22,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -102,8 +104,18 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding the
+ * segments sent covered by a SACK block and set their SACK flag.
+ *
+ * With large windows (tens of thousands of segments in flight) walking the
+ * sent list on every ACK is too expensive, so the sent items are also indexed
+ * by their starting sequence number, and the SACKed sequence space is kept as
+ * a set of disjoint ranges. A SACK block is then mapped onto the sent list
+ * with a logarithmic search, and the segments already SACKed are skipped a
+ * range at a time. In the same way, the lost segments are marked
+ * incrementally (only the segments above the previously marked ones are
+ * examined), and NextSeg starts its scans from the first segment that can
+ * still be returned instead of the head of the sent list.
  *
  * Item properties
  * ---------------
@@ -216,6 +228,14 @@ public:
    */
   void SetSegmentSize (uint32_t segmentSize) { m_segmentSize = segmentSize; }
 
+  /**
+   * \brief Enable the check of the internal state after each operation
+   *
+   * The check walks the whole sent list, and is meant for the tests only.
+   * \param enable whether to check the internal state
+   */
+  void SetConsistencyCheck (bool enable) { m_consistencyCheck = enable; }
+
   /**
    * \brief Return the number of segments in the sent list that
    * have been transmitted more than once, without acknowledgment.
@@ -410,6 +430,8 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< sent items by starting sequence
+  typedef std::map<SequenceNumber32, SequenceNumber32> SackedRanges; //!< SACKed ranges [start, end) by start
 
   /**
    * \brief Update the lost count
@@ -426,8 +448,8 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. The segments below m_lostUpTo are already
+   * lost or sacked, so the walk stops there.
    *
    */
   void UpdateLostCount ();
@@ -560,7 +582,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -592,6 +614,39 @@ private:
    */
   void ConsistencyCheck () const;
 
+  /**
+   * \brief Find the first sent item starting at or after a sequence
+   * \param seq the sequence
+   * \return an iterator inside m_sentList (possibly the end)
+   */
+  PacketList::const_iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Skip the SACKed range that starts with a sent item
+   * \param it iterator to a SACKed item inside m_sentList
+   * \return the first item after the SACKed range (possibly the end)
+   */
+  PacketList::const_iterator SkipSackedRange (PacketList::const_iterator it) const;
+
+  /**
+   * \brief Add the sequence space of an item to the SACKed ranges
+   * \param item the item just SACKed
+   */
+  void AddSackedRange (const TcpTxItem *item);
+
+  /**
+   * \brief Remove the sequence space of an item from the SACKed ranges
+   * \param item the item no longer SACKed
+   */
+  void RemoveSackedRange (const TcpTxItem *item);
+
+  /**
+   * \brief Restart the NextSeg scans from a sequence, because the item
+   * starting there may have become a candidate for retransmission
+   * \param seq the starting sequence of the item
+   */
+  void RestartNextSegFrom (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Find the highest SACK byte
    * \return a pair with the highest byte and an iterator inside m_sentList
@@ -601,6 +656,8 @@ private:
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  SentIndex m_sentIndex; //!< Items of m_sentList by starting sequence
+  SackedRanges m_sackedRanges; //!< SACKed sequence space, as disjoint and non-contiguous ranges
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
@@ -612,9 +669,14 @@ private:
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
 
+  SequenceNumber32 m_lostUpTo; //!< The items starting before this sequence are lost or sacked
+  mutable SequenceNumber32 m_lostHint;  //!< No item before this sequence is lost and not retransmitted nor sacked (NextSeg rule 1)
+  mutable SequenceNumber32 m_rule3Hint; //!< No item before this sequence is not retransmitted nor sacked (NextSeg rule 3)
+
   uint32_t m_dupAckThresh {0}; //!< Duplicate Ack threshold from TcpSocketBase
   uint32_t m_segmentSize {0}; //!< Segment size from TcpSocketBase
   bool     m_renoSack {false}; //!< Indicates if AddRenoSack was called
+  bool     m_consistencyCheck {false}; //!< Indicates if ConsistencyCheck has to run
 
 };
 
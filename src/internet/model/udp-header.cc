@@ -20,6 +20,7 @@
 
 #include "udp-header.h"
 #include "ns3/address-utils.h"
+#include "ns3/ip-checksum.h"
 
 namespace ns3 {
 
@@ -101,35 +102,31 @@ UdpHeader::InitializeChecksum (Ipv6Address source,
 uint16_t
 UdpHeader::CalculateHeaderChecksum (uint16_t size) const
 {
-  Buffer buf = Buffer ((2 * Address::MAX_SIZE) + 8);
-  buf.AddAtStart ((2 * Address::MAX_SIZE) + 8);
-  Buffer::Iterator it = buf.Begin ();
+  uint8_t buf[(2 * Address::MAX_SIZE) + 8] = { 0 };
+  uint32_t pos = m_source.CopyTo (buf);
+  pos += m_destination.CopyTo (buf + pos);
   uint32_t hdrSize = 0;
 
-  WriteTo (it, m_source);
-  WriteTo (it, m_destination);
   if (Ipv4Address::IsMatchingType (m_source))
     {
-      it.WriteU8 (0); /* protocol */
-      it.WriteU8 (m_protocol); /* protocol */
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
+      buf[pos++] = 0; /* protocol */
+      buf[pos++] = m_protocol; /* protocol */
+      buf[pos++] = size >> 8; /* length */
+      buf[pos++] = size & 0xff; /* length */
       hdrSize = 12;
     }
   else if (Ipv6Address::IsMatchingType (m_source))
     {
-      it.WriteU16 (0);
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      it.WriteU16 (0);
-      it.WriteU8 (0);
-      it.WriteU8 (m_protocol); /* protocol */
+      pos += 2;
+      buf[pos++] = size >> 8; /* length */
+      buf[pos++] = size & 0xff; /* length */
+      pos += 3;
+      buf[pos++] = m_protocol; /* protocol */
       hdrSize = 40;
     }
 
-  it = buf.Begin ();
   /* we don't CompleteChecksum ( ~ ) now */
-  return ~(it.CalculateIpChecksum (hdrSize));
+  return IpChecksumPartial (buf, hdrSize);
 }
 
 bool
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 EndPoint demultiplexer Test: the lookups of the indexed
+ * demultiplexer follow the most-specific-match rules.
+ */
+class Ipv4EndPointDemuxLookupTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check that a lookup finds exactly one endpoint.
+   * \param demux the demultiplexer
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \param expected the expected endpoint, or 0 if none
+   * \param msg the message of the test
+   */
+  void CheckLookup (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                    Ipv4Address saddr, uint16_t sport,
+                    Ipv4EndPoint *expected, std::string msg);
+
+  Ptr<Ipv4Interface> m_interface; //!< incoming interface of the lookups
+};
+
+Ipv4EndPointDemuxLookupTestCase::Ipv4EndPointDemuxLookupTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup precedence")
+{
+}
+
+void
+Ipv4EndPointDemuxLookupTestCase::CheckLookup (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                                              Ipv4Address saddr, uint16_t sport,
+                                              Ipv4EndPoint *expected, std::string msg)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  if (expected == 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, msg);
+      return;
+    }
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, msg);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), expected, msg);
+}
+
+void
+Ipv4EndPointDemuxLookupTestCase::DoRun (void)
+{
+  Ipv4Address local ("10.1.1.1");
+  Ipv4Address peer1 ("10.1.1.2");
+  Ipv4Address peer2 ("10.1.1.3");
+  Ipv4Address other ("10.2.2.2");
+
+  m_interface = CreateObject<Ipv4Interface> ();
+  m_interface->AddAddress (Ipv4InterfaceAddress (local, Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+
+  Ipv4EndPoint *any = demux.Allocate (0, 80);
+  Ipv4EndPoint *listener = demux.Allocate (0, local, 80);
+  Ipv4EndPoint *connected = demux.Allocate (0, local, 80, peer1, 1000);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, peer1, 1000), 0, "Duplicate four-tuple must be refused");
+
+  CheckLookup (demux, local, 80, peer1, 1000, connected, "Connected endpoint must be preferred");
+  CheckLookup (demux, local, 80, peer2, 1000, listener, "Bound listener must be preferred to the Any listener");
+  CheckLookup (demux, other, 80, peer2, 1000, any, "Any listener must match other addresses");
+  CheckLookup (demux, local, 81, peer1, 1000, 0, "No endpoint on another port");
+
+  // A connecting socket: the endpoint is re-indexed once its peer is set
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, local, 80, Ipv4Address::GetAny (), 0), 0,
+                         "Second listener on the same address and port must be refused");
+  Ipv4EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Ephemeral allocation failed");
+  uint16_t clientPort = client->GetLocalPort ();
+  client->SetPeer (peer2, 2000);
+  CheckLookup (demux, local, clientPort, peer2, 2000, client, "Endpoint must be found by its new peer");
+  CheckLookup (demux, local, clientPort, peer1, 2000, 0, "Endpoint must not be found by another peer");
+
+  demux.DeAllocate (connected);
+  CheckLookup (demux, local, 80, peer1, 1000, listener, "Lookup must fall back to the listener");
+  demux.DeAllocate (listener);
+  CheckLookup (demux, local, 80, peer1, 1000, any, "Lookup must fall back to the Any listener");
+
+  // Subnet-directed broadcast
+  Ipv4EndPoint *subnet = demux.Allocate (0, Ipv4Address ("10.1.1.0"), 5000);
+  CheckLookup (demux, Ipv4Address ("10.1.1.255"), 5000, peer1, 1000, subnet, "Subnet listener must match the subnet broadcast");
+  CheckLookup (demux, other, 5000, peer1, 1000, 0, "Subnet listener must not match another network");
+
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "Port 80 is still in use");
+  demux.DeAllocate (any);
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 must be free");
+
+  // Ephemeral ports are not reused while allocated
+  Ipv4EndPoint *first = demux.Allocate ();
+  Ipv4EndPoint *second = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (first, 0, "Ephemeral allocation failed");
+  NS_TEST_ASSERT_MSG_NE (second, 0, "Ephemeral allocation failed");
+  NS_TEST_EXPECT_MSG_NE (first->GetLocalPort (), second->GetLocalPort (), "Ephemeral ports must differ");
+
+  demux.DeAllocate (first);
+  demux.DeAllocate (second);
+  demux.DeAllocate (subnet);
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 EndPoint demultiplexer TestSuite
+ */
+class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite () : TestSuite ("ipv4-end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxLookupTestCase (), TestCase::QUICK);
+  }
+};
+
+static Ipv4EndPointDemuxTestSuite g_ipv4EndPointDemuxTestSuite; //!< Static variable for test initialization
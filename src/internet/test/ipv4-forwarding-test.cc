@@ -26,6 +26,7 @@
 #include "ns3/simple-net-device.h"
 #include "ns3/socket.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -56,6 +57,7 @@ using namespace ns3;
 class Ipv4ForwardingTest : public TestCase
 {
   Ptr<Packet> m_receivedPacket; //!< Received packet
+  bool m_forwardingCache;       //!< Enable the forwarding cache of the forwarding node
 
   /**
    * \brief Send data.
@@ -72,7 +74,11 @@ class Ipv4ForwardingTest : public TestCase
 
 public:
   virtual void DoRun (void);
-  Ipv4ForwardingTest ();
+  /**
+   * \brief Constructor.
+   * \param forwardingCache Enable the forwarding cache of the forwarding node.
+   */
+  Ipv4ForwardingTest (bool forwardingCache);
 
   /**
    * \brief Receive data.
@@ -81,8 +87,9 @@ public:
   void ReceivePkt (Ptr<Socket> socket);
 };
 
-Ipv4ForwardingTest::Ipv4ForwardingTest ()
-  : TestCase ("UDP socket implementation")
+Ipv4ForwardingTest::Ipv4ForwardingTest (bool forwardingCache)
+  : TestCase (forwardingCache ? "UDP socket implementation, forwarding cache" : "UDP socket implementation"),
+    m_forwardingCache (forwardingCache)
 {
 }
 
@@ -139,6 +146,10 @@ Ipv4ForwardingTest::DoRun (void)
   Ptr<Node> fwNode = CreateObject<Node> ();
 
   internet.Install (fwNode);
+  if (m_forwardingCache)
+    {
+      fwNode->GetObject<Ipv4> ()->SetAttribute ("ForwardingCacheSize", UintegerValue (16));
+    }
   Ptr<SimpleNetDevice> fwDev1, fwDev2;
   { // first interface
     fwDev1 = CreateObject<SimpleNetDevice> ();
@@ -208,6 +219,20 @@ Ipv4ForwardingTest::DoRun (void)
   m_receivedPacket->RemoveAllByteTags ();
   m_receivedPacket = 0;
 
+  // A more specific route to an unreachable gateway must be used at once,
+  // even if the route of the destination has been cached
+  Ptr<Ipv4StaticRouting> fwStaticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (fwNode->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  fwStaticRouting->AddHostRouteTo (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.1.0.3"), 2);
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "IPv4 Forwarding through the new route");
+
+  fwStaticRouting->RemoveRoute (fwStaticRouting->GetNRoutes () - 1);
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 Forwarding after the route removal");
+
+  m_receivedPacket->RemoveAllByteTags ();
+  m_receivedPacket = 0;
+
   Ptr<Ipv4> ipv4 = fwNode->GetObject<Ipv4> ();
   ipv4->SetAttribute("IpForward", BooleanValue (false));
   SendData (txSocket, "10.0.0.2");
@@ -234,7 +259,8 @@ private:
 Ipv4ForwardingTestSuite::Ipv4ForwardingTestSuite ()
   : TestSuite ("ipv4-forwarding", UNIT)
 {
-  AddTestCase (new Ipv4ForwardingTest, TestCase::QUICK);
+  AddTestCase (new Ipv4ForwardingTest (false), TestCase::QUICK);
+  AddTestCase (new Ipv4ForwardingTest (true), TestCase::QUICK);
 }
 
 static Ipv4ForwardingTestSuite g_ipv4forwardingTestSuite; //!< Static variable for test initialization
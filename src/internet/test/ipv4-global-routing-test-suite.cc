@@ -15,6 +15,9 @@
  */
 
 #include <vector>
+#include <map>
+#include <sstream>
+#include <algorithm>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -1244,6 +1247,391 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental route updates test
+ *
+ * The routes updated by Ipv4GlobalRoutingHelper::UpdateRoutingTables after
+ * a change of the topology of a grid of routers must be the same as the
+ * routes computed by Ipv4GlobalRoutingHelper::RecomputeRoutingTables, in
+ * the same order for each destination.  The grid may have a transit network,
+ * and the interface changes may be handled by the routing protocols, with
+ * the Ipv4GlobalRouting::RespondToInterfaceEvents and
+ * Ipv4GlobalRouting::IncrementalRouteUpdates attributes.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param lan whether routers 2, 5 and 8 are also on a transit network
+   * \param events whether the routes are updated on the interface events
+   */
+  Ipv4GlobalRoutingUpdateTestCase (bool lan, bool events);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the global routes of the nodes.
+   * \return the routes of each node, by destination, in table order
+   */
+  std::string GetRoutes (void);
+
+  /**
+   * \brief Check that the updated routes are the same as the recomputed
+   * routes, then update the routes again to record the new shortest path
+   * trees.
+   * \param change the description of the change of the topology
+   * \param interfaceEvent whether the change is an interface event, on
+   * which the routes are already updated if m_events is true
+   */
+  void CheckUpdate (std::string change, bool interfaceEvent);
+
+  /**
+   * \brief Set an interface of a router down or up, and check the routes.
+   * \param node the router
+   * \param device the device of the interface
+   * \param up whether to set the interface up
+   * \param change the description of the change of the topology
+   */
+  void SetInterface (uint32_t node, Ptr<NetDevice> device, bool up, std::string change);
+
+  /// Change the topology, and check the routes after each change.
+  void ChangeTopology (void);
+
+  bool m_lan; //!< Whether routers 2, 5 and 8 are also on a transit network.
+  bool m_events; //!< Whether the routes are updated on the interface events.
+  NodeContainer m_nodes; //!< Nodes used in the test.
+  std::vector<NetDeviceContainer> m_links; //!< Devices of the links, and of the transit network.
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase (bool lan, bool events)
+  : TestCase (std::string ("Incremental global routing updates")
+              + (lan ? ", with a transit network" : "")
+              + (events ? ", on interface events" : "")),
+    m_lan (lan),
+    m_events (events)
+{
+}
+
+std::string
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (void)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = m_nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      // The first of several routes to a destination is used, so that the
+      // routes to each destination are compared in table order
+      std::map<std::string, std::string> routes;
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = globalRouting->GetRoute (j);
+          std::ostringstream dest;
+          dest << (route->IsHost () ? "host " : "network ") << route->GetDestNetwork () << route->GetDestNetworkMask ();
+          std::ostringstream entry;
+          entry << " via " << route->GetGateway () << " if " << route->GetInterface () << ";";
+          routes[dest.str ()] += entry.str ();
+        }
+      oss << "node " << i << ":";
+      for (std::map<std::string, std::string>::const_iterator j = routes.begin (); j != routes.end (); j++)
+        {
+          oss << " " << j->first << j->second;
+        }
+      oss << std::endl;
+    }
+  return oss.str ();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::CheckUpdate (std::string change, bool interfaceEvent)
+{
+  if (!m_events || !interfaceEvent)
+    {
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+    }
+  std::string updated = GetRoutes ();
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string recomputed = GetRoutes ();
+  NS_TEST_EXPECT_MSG_EQ (updated, recomputed, "Updated and recomputed routes differ after " << change);
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), recomputed, "Routes differ after recording the trees again");
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::SetInterface (uint32_t node, Ptr<NetDevice> device, bool up, std::string change)
+{
+  Ptr<Ipv4> ipv4 = m_nodes.Get (node)->GetObject<Ipv4> ();
+  int32_t interface = ipv4->GetInterfaceForDevice (device);
+  if (up)
+    {
+      ipv4->SetUp (interface);
+    }
+  else
+    {
+      ipv4->SetDown (interface);
+    }
+  CheckUpdate (change, true);
+}
+
+// A 3x3 grid of routers, with a host attached to router 0, and possibly a
+// transit network between routers 2, 5 and 8:
+//
+//   9 - 0 - 1 - 2 -+
+//       |   |   |  |
+//       3 - 4 - 5 -+ LAN
+//       |   |   |  |
+//       6 - 7 - 8 -+
+//
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  m_nodes.Create (10);
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      if (i % 3 < 2)
+        {
+          m_links.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (i + 1))));
+          ipv4.Assign (m_links.back ());
+          ipv4.NewNetwork ();
+        }
+      if (i < 6)
+        {
+          m_links.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (i + 3))));
+          ipv4.Assign (m_links.back ());
+          ipv4.NewNetwork ();
+        }
+    }
+  m_links.push_back (simpleHelper.Install (NodeContainer (m_nodes.Get (0), m_nodes.Get (9))));
+  ipv4.Assign (m_links.back ());
+  if (m_lan)
+    {
+      SimpleNetDeviceHelper lanHelper;
+      m_links.push_back (lanHelper.Install (NodeContainer (m_nodes.Get (2), m_nodes.Get (5), m_nodes.Get (8))));
+      ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+      ipv4.Assign (m_links.back ());
+    }
+  if (m_events)
+    {
+      for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+        {
+          Ptr<Ipv4GlobalRouting> globalRouting = m_nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+          globalRouting->SetAttribute ("RespondToInterfaceEvents", BooleanValue (true));
+          globalRouting->SetAttribute ("IncrementalRouteUpdates", BooleanValue (true));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string populated = GetRoutes ();
+
+  // The first update computes all the routes, and the second one finds no change
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), populated, "Error-- wrong routes after the first update");
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), populated, "Error-- wrong routes after an update without change");
+
+  // The routing protocols ignore the interface events at the start of the
+  // simulation
+  if (m_events)
+    {
+      Simulator::Schedule (Seconds (1), &Ipv4GlobalRoutingUpdateTestCase::ChangeTopology, this);
+      Simulator::Run ();
+    }
+  else
+    {
+      ChangeTopology ();
+    }
+
+  Simulator::Destroy ();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::ChangeTopology (void)
+{
+  std::string populated = GetRoutes ();
+
+  // Link 4-5 down and up
+  SetInterface (4, m_links[7].Get (0), false, "link 4-5 down");
+  NS_TEST_EXPECT_MSG_NE (GetRoutes (), populated, "Error-- link 4-5 down does not change the routes");
+  SetInterface (4, m_links[7].Get (0), true, "link 4-5 up");
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), populated, "Error-- link 4-5 up does not restore the routes");
+
+  if (m_lan)
+    {
+      // Router 8 off the transit network and back, then router 2, whose
+      // address is the link state ID of the network LSA
+      SetInterface (8, m_links[13].Get (2), false, "router 8 off the network");
+      NS_TEST_EXPECT_MSG_NE (GetRoutes (), populated, "Error-- router 8 off the network does not change the routes");
+      SetInterface (8, m_links[13].Get (2), true, "router 8 on the network");
+      NS_TEST_EXPECT_MSG_EQ (GetRoutes (), populated, "Error-- router 8 on the network does not restore the routes");
+      SetInterface (2, m_links[13].Get (0), false, "router 2 off the network");
+      SetInterface (2, m_links[13].Get (0), true, "router 2 on the network");
+      NS_TEST_EXPECT_MSG_EQ (GetRoutes (), populated, "Error-- router 2 on the network does not restore the routes");
+    }
+
+  // Link 1-2 off the shortest paths, then down and up: the routes to its
+  // addresses are updated in the trees of the routers not adjacent to it
+  Ptr<Ipv4> ipv4Router1 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4Router2 = m_nodes.Get (2)->GetObject<Ipv4> ();
+  ipv4Router1->SetMetric (ipv4Router1->GetInterfaceForDevice (m_links[2].Get (0)), 10);
+  CheckUpdate ("link 1-2 metric change", false);
+  ipv4Router2->SetMetric (ipv4Router2->GetInterfaceForDevice (m_links[2].Get (1)), 10);
+  CheckUpdate ("link 1-2 metric change", false);
+  std::string offPath = GetRoutes ();
+  SetInterface (1, m_links[2].Get (0), false, "link 1-2 down");
+  SetInterface (1, m_links[2].Get (0), true, "link 1-2 up");
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), offPath, "Error-- link 1-2 up does not restore the routes");
+
+  // Link 7-8 down
+  SetInterface (7, m_links[11].Get (0), false, "link 7-8 down");
+
+  // Link to the host down
+  SetInterface (0, m_links[12].Get (0), false, "link 0-9 down");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting random ECMP and forwarding cache test
+ *
+ * Router 1 has two equal cost paths to node 4, through routers 2 and 3, and
+ * a forwarding cache. With random ECMP, the cache is not used, and the
+ * packets from node 0 take both paths; otherwise they all take the same
+ * path.
+ */
+class Ipv4GlobalRoutingEcmpCacheTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingEcmpCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send packets from node 0 to node 4, through router 1.
+   * \param randomEcmp the RandomEcmpRouting attribute of the routers
+   */
+  void SendPackets (bool randomEcmp);
+
+  /**
+   * \brief Send a packet.
+   * \param ipv4 the IPv4 of the source
+   * \param source the source address
+   * \param destination the destination address
+   */
+  void SendPacket (Ptr<Ipv4> ipv4, Ipv4Address source, Ipv4Address destination);
+
+  /**
+   * \brief Packet forwarded by a router.
+   * \param router the router
+   * \param header the IPv4 header
+   * \param packet the packet
+   * \param interface the incoming interface
+   */
+  void UnicastForward (uint32_t router, const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+
+  std::vector<uint32_t> m_forwarded; //!< Number of packets forwarded by each node
+};
+
+Ipv4GlobalRoutingEcmpCacheTestCase::Ipv4GlobalRoutingEcmpCacheTestCase ()
+  : TestCase ("Random ECMP routing bypasses the forwarding cache")
+{
+}
+
+void
+Ipv4GlobalRoutingEcmpCacheTestCase::SendPacket (Ptr<Ipv4> ipv4, Ipv4Address source, Ipv4Address destination)
+{
+  // An experimental protocol number, which no protocol handles
+  ipv4->Send (Create<Packet> (100), source, destination, 253, 0);
+}
+
+void
+Ipv4GlobalRoutingEcmpCacheTestCase::UnicastForward (uint32_t router, const Ipv4Header &header,
+                                                    Ptr<const Packet> packet, uint32_t interface)
+{
+  m_forwarded[router]++;
+}
+
+// 0 - 1 - 2 - 4
+//     |       |
+//     +-- 3 --+
+//
+void
+Ipv4GlobalRoutingEcmpCacheTestCase::SendPackets (bool randomEcmp)
+{
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::RandomEcmpRouting", BooleanValue (randomEcmp));
+  m_forwarded.assign (5, 0);
+
+  NodeContainer nodes;
+  nodes.Create (5);
+  // The default routing: the static and global routing protocols
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer interfaces01 = ipv4.Assign (simpleHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv4.NewNetwork ();
+  ipv4.Assign (simpleHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+  ipv4.NewNetwork ();
+  ipv4.Assign (simpleHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (3))));
+  ipv4.NewNetwork ();
+  Ipv4InterfaceContainer interfaces24 = ipv4.Assign (simpleHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (4))));
+  ipv4.NewNetwork ();
+  ipv4.Assign (simpleHelper.Install (NodeContainer (nodes.Get (3), nodes.Get (4))));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4> router = nodes.Get (1)->GetObject<Ipv4> ();
+  NS_TEST_ASSERT_MSG_EQ (router->GetRoutingProtocol ()->IsForwardingCacheable (), !randomEcmp,
+                         "Wrong use of the forwarding cache");
+  router->SetAttribute ("ForwardingCacheSize", UintegerValue (16));
+  for (uint32_t i = 1; i < 4; i++)
+    {
+      nodes.Get (i)->GetObject<Ipv4> ()->TraceConnectWithoutContext ("UnicastForward",
+                                                                    MakeCallback (&Ipv4GlobalRoutingEcmpCacheTestCase::UnicastForward, this).Bind (i));
+    }
+
+  Ptr<Ipv4> source = nodes.Get (0)->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      Simulator::Schedule (Seconds (1 + i), &Ipv4GlobalRoutingEcmpCacheTestCase::SendPacket, this,
+                           source, interfaces01.GetAddress (0), interfaces24.GetAddress (1));
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+void
+Ipv4GlobalRoutingEcmpCacheTestCase::DoRun (void)
+{
+  SendPackets (true);
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[1], 20, "Packets not forwarded by router 1");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[2] + m_forwarded[3], 20, "Packets not forwarded by routers 2 and 3");
+  NS_TEST_EXPECT_MSG_GT (m_forwarded[2], 0, "Random ECMP routing pinned to router 3");
+  NS_TEST_EXPECT_MSG_GT (m_forwarded[3], 0, "Random ECMP routing pinned to router 2");
+
+  SendPackets (false);
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[1], 20, "Packets not forwarded by router 1");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[2] * m_forwarded[3], 0, "Packets spread over both paths");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[2] + m_forwarded[3], 20, "Packets not forwarded by routers 2 and 3");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1655,10 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (false, false), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (true, false), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (true, true), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpCacheTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
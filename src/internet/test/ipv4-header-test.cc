@@ -39,6 +39,7 @@
 #include "ns3/ipv4-static-routing.h"
 #include "ns3/traffic-control-layer.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/random-variable-stream.h"
 
 #include <string>
 #include <sstream>
@@ -265,6 +266,131 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header checksum Test: the checksum updated by the setters of
+ * a deserialized header matches the one of a header built from scratch.
+ */
+class Ipv4HeaderChecksumTest : public TestCase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumTest ();
+
+private:
+  /**
+   * \brief Serialize a header.
+   * \param header The header.
+   * \returns The serialized bytes.
+   */
+  std::vector<uint8_t> SerializeHeader (const Ipv4Header &header);
+
+  /**
+   * \brief Check that a header serializes to the bytes of a header with
+   * the same fields, built from scratch.
+   * \param header The header.
+   * \param msg The message of the test.
+   */
+  void CheckHeader (const Ipv4Header &header, std::string msg);
+};
+
+Ipv4HeaderChecksumTest::Ipv4HeaderChecksumTest ()
+  : TestCase ("IPv4 Header incremental checksum Test")
+{
+}
+
+std::vector<uint8_t>
+Ipv4HeaderChecksumTest::SerializeHeader (const Ipv4Header &header)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  std::vector<uint8_t> bytes (packet->GetSize ());
+  packet->CopyData (&bytes[0], bytes.size ());
+  return bytes;
+}
+
+void
+Ipv4HeaderChecksumTest::CheckHeader (const Ipv4Header &header, std::string msg)
+{
+  Ipv4Header reference;
+  reference.EnableChecksum ();
+  reference.SetTos (header.GetTos ());
+  reference.SetPayloadSize (header.GetPayloadSize ());
+  reference.SetIdentification (header.GetIdentification ());
+  if (header.IsDontFragment ())
+    {
+      reference.SetDontFragment ();
+    }
+  if (!header.IsLastFragment ())
+    {
+      reference.SetMoreFragments ();
+    }
+  reference.SetFragmentOffset (header.GetFragmentOffset ());
+  reference.SetTtl (header.GetTtl ());
+  reference.SetProtocol (header.GetProtocol ());
+  reference.SetSource (header.GetSource ());
+  reference.SetDestination (header.GetDestination ());
+
+  std::vector<uint8_t> bytes = SerializeHeader (header);
+  std::vector<uint8_t> expected = SerializeHeader (reference);
+  NS_TEST_ASSERT_MSG_EQ ((bytes == expected), true, msg);
+
+  Ptr<Packet> packet = Create<Packet> (&bytes[0], bytes.size ());
+  Ipv4Header received;
+  received.EnableChecksum ();
+  packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (received.IsChecksumOk (), true, msg);
+}
+
+void
+Ipv4HeaderChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  for (uint32_t n = 0; n < 1000; n++)
+    {
+      Ipv4Header original;
+      original.EnableChecksum ();
+      original.SetTos (rng->GetInteger (0, 255));
+      original.SetPayloadSize (rng->GetInteger (0, 1480));
+      original.SetIdentification (rng->GetInteger (0, 65535));
+      original.SetFragmentOffset (rng->GetInteger (0, 1000) * 8);
+      original.SetTtl (rng->GetInteger (1, 255));
+      original.SetProtocol (rng->GetInteger (0, 255));
+      original.SetSource (Ipv4Address (rng->GetInteger (0, 0xffffffff)));
+      original.SetDestination (Ipv4Address (rng->GetInteger (0, 0xffffffff)));
+
+      std::vector<uint8_t> bytes = SerializeHeader (original);
+      Ptr<Packet> packet = Create<Packet> (&bytes[0], bytes.size ());
+      Ipv4Header header;
+      header.EnableChecksum ();
+      packet->RemoveHeader (header);
+      NS_TEST_ASSERT_MSG_EQ (header.IsChecksumOk (), true, "Bad checksum of the original header");
+
+      // forwarding
+      header.SetTtl (header.GetTtl () - 1);
+      CheckHeader (header, "Bad checksum after a TTL decrement");
+      // address rewrites
+      header.SetSource (Ipv4Address (rng->GetInteger (0, 0xffffffff)));
+      CheckHeader (header, "Bad checksum after a source rewrite");
+      header.SetDestination (n % 2 ? Ipv4Address::GetBroadcast () : Ipv4Address::GetAny ());
+      CheckHeader (header, "Bad checksum after a destination rewrite");
+      // ECN marking
+      header.SetEcn (Ipv4Header::ECN_CE);
+      CheckHeader (header, "Bad checksum after an ECN marking");
+      header.SetDscp (Ipv4Header::DSCP_EF);
+      header.SetProtocol (rng->GetInteger (0, 255));
+      CheckHeader (header, "Bad checksum after DSCP and protocol changes");
+      // fields without incremental update
+      header.SetPayloadSize (rng->GetInteger (0, 1480));
+      header.SetTtl (rng->GetInteger (1, 255));
+      CheckHeader (header, "Bad checksum after a payload size change");
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +403,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumTest, TestCase::QUICK);
   }
 };
 
@@ -35,6 +35,10 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
 
 using namespace ns3;
 
@@ -201,6 +205,113 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting longest prefix match Test
+ *
+ * Check the route chosen among overlapping routes: the longest prefix
+ * wins, then the shortest metric, then the last route added, except
+ * among host routes, where the first route added wins.
+ */
+class Ipv4StaticRoutingLongestPrefixMatchTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLongestPrefixMatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the gateway of the route to a destination.
+   * \param dest The destination address.
+   * \return The gateway, or 0.0.0.0 if there is no route.
+   */
+  Ipv4Address Gateway (std::string dest);
+
+  Ptr<Ipv4StaticRouting> m_routing; //!< The static routing protocol
+};
+
+Ipv4StaticRoutingLongestPrefixMatchTestCase::Ipv4StaticRoutingLongestPrefixMatchTestCase ()
+  : TestCase ("Longest prefix match among overlapping static routes")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLongestPrefixMatchTestCase::Gateway (std::string dest)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest.c_str ()));
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (0, header, 0, sockerr);
+  if (route == 0)
+    {
+      return Ipv4Address::GetZero ();
+    }
+  return route->GetGateway ();
+}
+
+void
+Ipv4StaticRoutingLongestPrefixMatchTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices.Add (devHelper.Install (node));
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.1.0", "255.255.255.0");
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      ipv4.Assign (devices.Get (i));
+      ipv4.NewNetwork ();
+    }
+  Ipv4StaticRoutingHelper helper;
+  m_routing = helper.GetStaticRouting (node->GetObject<Ipv4> ());
+
+  m_routing->SetDefaultRoute (Ipv4Address ("192.168.1.254"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), Ipv4Address ("192.168.1.8"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("192.168.2.5"), 2, 5);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("192.168.3.2"), 3, 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("192.168.2.1"), 2, 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("192.168.3.1"), 3, 1);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.2.3"), Ipv4Address ("192.168.2.32"), 2, 7);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.2.3"), Ipv4Address ("192.168.3.32"), 3, 0);
+
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("172.16.0.1"), Ipv4Address ("192.168.1.254"), "Default route not used");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.3.0.1"), Ipv4Address ("192.168.1.8"), "/8 route not used");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.1.0.1"), Ipv4Address ("192.168.3.2"), "Shortest metric not used");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.2.0.1"), Ipv4Address ("192.168.3.1"), "Last route among equal metrics not used");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.1.2.3"), Ipv4Address ("192.168.2.32"), "First host route not used");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("192.168.2.7"), Ipv4Address ("0.0.0.0"), "Connected route not used");
+
+  // remove the shortest metric /16 route and the first host route
+  for (uint32_t i = m_routing->GetNRoutes (); i-- > 0; )
+    {
+      Ipv4RoutingTableEntry route = m_routing->GetRoute (i);
+      if (route.GetGateway () == Ipv4Address ("192.168.3.2")
+          || route.GetGateway () == Ipv4Address ("192.168.2.32"))
+        {
+          m_routing->RemoveRoute (i);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.1.0.1"), Ipv4Address ("192.168.2.5"), "Remaining /16 route not used");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.1.2.3"), Ipv4Address ("192.168.3.32"), "Remaining host route not used");
+
+  // an interface down removes its routes
+  node->GetObject<Ipv4> ()->SetDown (3);
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.1.2.3"), Ipv4Address ("192.168.2.5"), "/16 route not used after interface down");
+  NS_TEST_EXPECT_MSG_EQ (Gateway ("10.2.0.1"), Ipv4Address ("192.168.2.1"), "Remaining equal metric route not used");
+
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +328,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLongestPrefixMatchTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -44,6 +44,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the reassembly of overlapping, out-of-order segments.
+   */
+  void TestReassembly ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReassembly ();
 }
 
 void
@@ -338,6 +344,87 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReassembly ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpHeader h;
+  uint8_t data[1000];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = static_cast<uint8_t> (i * 7);
+    }
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (sizeof (data));
+
+  // Segments of 100 bytes, starting from byte seq - 1 of the data
+  uint32_t seqs[] = { 601, 201, 801, 251, 401, 701 };
+  for (uint32_t i = 0; i < sizeof (seqs) / sizeof (seqs[0]); i++)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (seqs[i]));
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + seqs[i] - 1, 100), h), true,
+                             "New bytes must be buffered");
+    }
+
+  // [201;351) [401;501) [601;901)
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 550, "Overlapping bytes must be stored once");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "No in-order data yet");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 3, "SACK list should contain three elements");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (601),
+                         "First SACK block must be the whole interval of the last segment");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (901),
+                         "First SACK block must be the whole interval of the last segment");
+
+  // Duplicate bytes are refused
+  h.SetSequenceNumber (SequenceNumber32 (651));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + 650, 100), h), false,
+                         "Duplicate bytes must not be buffered");
+
+  // A segment spanning two holes and a run fills both holes
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data + 300, 350), h), true,
+                         "New bytes must be buffered");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 700, "Holes must be filled");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 1, "SACK list should contain one element");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (201),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (901),
+                         "SACK block different than expected");
+
+  // The in-order segment makes everything available
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (data, 200), h), true,
+                         "New bytes must be buffered");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (901),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 900, "All the data must be available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list should be empty");
+
+  // Extract in chunks not aligned to the segments, and check the bytes
+  uint8_t out[1000];
+  uint32_t extracted = 0;
+  uint32_t chunks[] = { 150, 1, 449, 1000 };
+  for (uint32_t i = 0; i < sizeof (chunks) / sizeof (chunks[0]); i++)
+    {
+      Ptr<Packet> p = rxBuf.Extract (chunks[i]);
+      NS_TEST_ASSERT_MSG_NE (PeekPointer (p), 0, "Extract must return data");
+      NS_TEST_ASSERT_MSG_EQ (p->GetSize (), std::min (chunks[i], 900 - extracted),
+                             "Extracted size differs from expected");
+      p->CopyData (out + extracted, p->GetSize ());
+      extracted += p->GetSize ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Buffer must be empty");
+  NS_TEST_ASSERT_MSG_EQ (PeekPointer (rxBuf.Extract (100)), 0, "Nothing left to extract");
+  for (uint32_t i = 0; i < extracted; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (out[i], data[i], "Byte " << i << " differs from the one sent");
+    }
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -347,6 +347,325 @@ TcpTxBufferTestCase::DoTeardown ()
 {
 }
 
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The TcpTxBuffer scoreboard Test: the SACKed ranges, the lost count
+ * and the hints of NextSeg, with the check of the internal state enabled
+ * after each operation.
+ *
+ * The segments are 1000 bytes long; segment i starts at 1 + 1000 * i.
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  /** \brief Constructor */
+  TcpTxBufferScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** \brief Test SACK blocks spanning and merging existing ranges */
+  void TestSackMerge ();
+  /** \brief Test the lost count while the SACK blocks are repeated */
+  void TestLostCount ();
+  /** \brief Test NextSeg rules 1 and 3 after retransmissions and merges */
+  void TestNextSeg ();
+  /** \brief Test the resets of the scoreboard followed by new SACKs */
+  void TestReset ();
+
+  /**
+   * \brief Prepare a buffer and send segments
+   * \param txBuf the buffer
+   * \param nSegments the number of segments added to the buffer
+   * \param nSent the number of segments sent
+   */
+  void Send (TcpTxBuffer &txBuf, uint32_t nSegments, uint32_t nSent);
+  /**
+   * \brief Receive an ACK carrying a SACK block
+   * \param txBuf the buffer
+   * \param first the first SACKed segment
+   * \param end the segment after the last SACKed one
+   */
+  void Sack (TcpTxBuffer &txBuf, uint32_t first, uint32_t end);
+  /**
+   * \brief Check the segment returned by NextSeg, and retransmit it
+   * \param txBuf the buffer
+   * \param isRecovery whether the sender is in recovery
+   * \param expected the expected segment
+   * \param msg the message of the test
+   */
+  void CheckNextSeg (TcpTxBuffer &txBuf, bool isRecovery, uint32_t expected, std::string msg);
+
+  /**
+   * \brief Get the starting sequence of a segment
+   * \param i the index of the segment
+   * \return the starting sequence
+   */
+  static SequenceNumber32 Seq (uint32_t i) { return SequenceNumber32 (1 + i * SEGMENT_SIZE); }
+
+  static const uint32_t SEGMENT_SIZE = 1000; //!< Segment size
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer scoreboard Test")
+{
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun ()
+{
+  TestSackMerge ();
+  TestLostCount ();
+  TestNextSeg ();
+  TestReset ();
+  Simulator::Destroy ();
+}
+
+void
+TcpTxBufferScoreboardTestCase::Send (TcpTxBuffer &txBuf, uint32_t nSegments, uint32_t nSent)
+{
+  txBuf.SetConsistencyCheck (true);
+  txBuf.SetHeadSequence (Seq (0));
+  txBuf.SetSegmentSize (SEGMENT_SIZE);
+  txBuf.SetDupAckThresh (3);
+  txBuf.Add (Create<Packet> (nSegments * SEGMENT_SIZE));
+  for (uint32_t i = 0; i < nSent; i++)
+    {
+      txBuf.CopyFromSequence (SEGMENT_SIZE, Seq (i));
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::Sack (TcpTxBuffer &txBuf, uint32_t first, uint32_t end)
+{
+  TcpOptionSack::SackList list;
+  list.push_back (TcpOptionSack::SackBlock (Seq (first), Seq (end)));
+  txBuf.Update (list);
+}
+
+void
+TcpTxBufferScoreboardTestCase::CheckNextSeg (TcpTxBuffer &txBuf, bool isRecovery,
+                                             uint32_t expected, std::string msg)
+{
+  SequenceNumber32 seq;
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, isRecovery), true, msg);
+  NS_TEST_ASSERT_MSG_EQ (seq, Seq (expected), msg);
+  txBuf.CopyFromSequence (SEGMENT_SIZE, seq);
+}
+
+void
+TcpTxBufferScoreboardTestCase::TestSackMerge ()
+{
+  TcpTxBuffer txBuf;
+  Send (txBuf, 10, 10);
+
+  Sack (txBuf, 3, 4);
+  Sack (txBuf, 6, 7);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 2000, "Two segments are SACKed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 0, "No segment has three SACKed segments above");
+
+  // A block spanning both ranges and the segments in between
+  Sack (txBuf, 2, 8);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 6000, "The ranges are merged");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 2000, "The two first segments are lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (Seq (0)), true, "The first segment is lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (Seq (1)), true, "The second segment is lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (Seq (8)), false, "Segment above the SACKs is not lost");
+
+  // A block touching the range
+  Sack (txBuf, 8, 9);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 7000, "The block extends the range");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 2000, "The lost segments are unchanged");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 1000, "Only the last segment is in flight");
+
+  // A block inside the range
+  Sack (txBuf, 4, 5);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 7000, "The block is already SACKed");
+
+  // The first lost segment is acknowledged
+  txBuf.DiscardUpTo (Seq (1));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 7000, "The SACKed segments are not acknowledged");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 1000, "The second segment is still lost");
+  CheckNextSeg (txBuf, true, 1, "Rule 1 returns the lost segment");
+  CheckNextSeg (txBuf, true, 9, "Rule 3 returns the segment above the range");
+
+  // The acknowledgment covers the SACKed range
+  txBuf.DiscardUpTo (Seq (9));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 0, "The SACKed segments are acknowledged");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 0, "The lost segments are acknowledged");
+
+  txBuf.DiscardUpTo (Seq (10));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 0, "Everything is acknowledged");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Everything is acknowledged");
+}
+
+void
+TcpTxBufferScoreboardTestCase::TestLostCount ()
+{
+  const uint32_t nSegments = 20;
+  TcpTxBuffer txBuf;
+  Send (txBuf, nSegments, nSegments);
+
+  // The odd segments are received, and SACKed one by one; each ACK also
+  // carries the two previous blocks. Everything is then SACKed again.
+  std::vector<bool> sacked (nSegments, false);
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      for (uint32_t i = 1; i < nSegments; i += 2)
+        {
+          TcpOptionSack::SackList list;
+          for (uint32_t k = 0; k < 3 && 2 * k < i; k++)
+            {
+              list.push_back (TcpOptionSack::SackBlock (Seq (i - 2 * k), Seq (i - 2 * k + 1)));
+            }
+          txBuf.Update (list);
+          sacked[i] = true;
+
+          // A segment is lost if three segments above it are SACKed
+          uint32_t lost = 0;
+          uint32_t sackedAbove = 0;
+          for (uint32_t j = nSegments; j-- > 0; )
+            {
+              if (sacked[j])
+                {
+                  sackedAbove++;
+                }
+              else
+                {
+                  bool isLost = sackedAbove >= 3;
+                  lost += isLost ? SEGMENT_SIZE : 0;
+                  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (Seq (j)), isLost,
+                                         "Bad loss of segment " << j << " after SACK of " << i);
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), sackedAbove * SEGMENT_SIZE, "Bad SACKed count");
+          NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), lost, "Bad lost count after SACK of " << i);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 8000, "The first 8 even segments are lost");
+}
+
+void
+TcpTxBufferScoreboardTestCase::TestNextSeg ()
+{
+  TcpTxBuffer txBuf;
+  Send (txBuf, 10, 10);
+
+  Sack (txBuf, 4, 7);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 4000, "The four first segments are lost");
+
+  // Rule 1: the lost segments, in order
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      CheckNextSeg (txBuf, true, i, "Rule 1 returns the lost segments");
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), (i + 1) * SEGMENT_SIZE, "Bad retransmit count");
+    }
+
+  // Rule 3: the segments above the SACKed range
+  SequenceNumber32 seq;
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, false), false, "Rule 3 applies in recovery only");
+  CheckNextSeg (txBuf, true, 7, "Rule 3 returns the first segment above the range");
+
+  // A SACK merged with the range, and a SACK of a retransmitted segment
+  Sack (txBuf, 7, 8);
+  Sack (txBuf, 1, 2);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 5000, "Bad SACKed count after the merge");
+  CheckNextSeg (txBuf, true, 8, "Rule 3 skips the merged range");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, true), true, "Rule 3 returns the last segment");
+  NS_TEST_ASSERT_MSG_EQ (seq, Seq (9), "Rule 3 returns the last segment");
+
+  // Retransmission timeout: the segments not SACKed are lost again, and
+  // rule 1 starts over from the head
+  txBuf.SetSentListLost ();
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 0, "No retransmission after a timeout");
+  CheckNextSeg (txBuf, true, 0, "Rule 1 starts over from the head");
+  CheckNextSeg (txBuf, true, 2, "Rule 1 skips the SACKed segment");
+  CheckNextSeg (txBuf, true, 3, "Rule 1 returns the next lost segment");
+  CheckNextSeg (txBuf, true, 8, "Rule 1 skips the SACKed range");
+  CheckNextSeg (txBuf, true, 9, "Rule 1 returns the last lost segment");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&seq, true), false, "Everything is retransmitted");
+
+  // The head is lost again
+  txBuf.MarkHeadAsLost ();
+  CheckNextSeg (txBuf, true, 0, "Rule 1 returns the head marked as lost");
+}
+
+void
+TcpTxBufferScoreboardTestCase::TestReset ()
+{
+  // Reset of the SACK information
+  {
+    TcpTxBuffer txBuf;
+    Send (txBuf, 10, 10);
+    Sack (txBuf, 4, 7);
+    CheckNextSeg (txBuf, true, 0, "Rule 1 returns the head");
+
+    txBuf.ResetRenoSack ();
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 0, "No SACKed segment after the reset");
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 4000, "The lost segments are kept");
+
+    Sack (txBuf, 5, 8);
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 3000, "Bad SACKed count after the reset");
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 5000, "The segments below the new range are lost");
+    CheckNextSeg (txBuf, true, 1, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 2, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 3, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 4, "Rule 1 returns the segment lost after the reset");
+    CheckNextSeg (txBuf, true, 8, "Rule 3 after the reset");
+  }
+
+  // Reset of the sent list
+  {
+    TcpTxBuffer txBuf;
+    Send (txBuf, 10, 10);
+    Sack (txBuf, 4, 7);
+    CheckNextSeg (txBuf, true, 0, "Rule 1 returns the head");
+
+    txBuf.ResetSentList ();
+    NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0, "Nothing in flight after the reset");
+    NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (Seq (0)), 10000, "Everything is unsent");
+    for (uint32_t i = 0; i < 10; i++)
+      {
+        CheckNextSeg (txBuf, false, i, "Rule 2 sends everything again");
+      }
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 0, "No retransmission after the reset");
+
+    Sack (txBuf, 2, 5);
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 3000, "Bad SACKed count after the reset");
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 2000, "The segments below the new range are lost");
+    CheckNextSeg (txBuf, true, 0, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 1, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 5, "Rule 3 after the reset");
+  }
+
+  // Reset of the last segment sent
+  {
+    TcpTxBuffer txBuf;
+    Send (txBuf, 10, 9);
+    Sack (txBuf, 3, 6);
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 3000, "The three first segments are lost");
+
+    txBuf.CopyFromSequence (SEGMENT_SIZE, Seq (9));
+    txBuf.ResetLastSegmentSent ();
+    NS_TEST_ASSERT_MSG_EQ (txBuf.SizeFromSequence (Seq (9)), 1000, "The last segment is unsent");
+
+    CheckNextSeg (txBuf, true, 0, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 1, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 2, "Rule 1 after the reset");
+    CheckNextSeg (txBuf, true, 9, "Rule 2 sends the last segment again");
+
+    TcpOptionSack::SackList list;
+    list.push_back (TcpOptionSack::SackBlock (Seq (9), Seq (10)));
+    list.push_back (TcpOptionSack::SackBlock (Seq (3), Seq (6)));
+    txBuf.Update (list);
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 4000, "Bad SACKed count after the reset");
+    NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 3000, "Bad lost count after the reset");
+    CheckNextSeg (txBuf, true, 6, "Rule 3 after the reset");
+  }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -360,6 +679,7 @@ public:
     : TestSuite ("tcp-tx-buffer", UNIT)
   {
     AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// This program converts a fading trace in the text format generated by
+// src/lte/model/fading-traces/fading_trace_generator.m into the binary
+// format which TraceFadingLossModel maps in memory instead of parsing it
+// (see LteFadingTrace). The binary trace can be used wherever the text
+// trace was, through the TraceFilename attribute of TraceFadingLossModel.
+//
+// The number of RBs and of samples must match the ones used to generate
+// the trace (the defaults match the defaults of TraceFadingLossModel).
+// The program displays the wall clock time taken to load the text and the
+// binary traces.
+//
+// Example usage:
+//
+//   ./waf --run "lena-fading-trace-converter
+//     --input=src/lte/model/fading-traces/fading_trace_EPA_3kmph.fad
+//     --output=src/lte/model/fading-traces/fading_trace_EPA_3kmph.bin"
+//
+
+#include "ns3/command-line.h"
+#include "ns3/abort.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/lte-fading-trace.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+  uint32_t rbNum = 100;
+  uint32_t samplesNum = 10000;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Fading trace file in text format", input);
+  cmd.AddValue ("output", "Fading trace file in binary format to write", output);
+  cmd.AddValue ("rbNum", "Number of RBs of the trace", rbNum);
+  cmd.AddValue ("samplesNum", "Number of samples of the trace", samplesNum);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (input.empty () || output.empty (), "Both --input and --output are required");
+  NS_ABORT_MSG_IF (rbNum == 0 || rbNum > 255, "Invalid number of RBs " << rbNum);
+
+  LteFadingTrace::WriteBinary (input, output, rbNum, samplesNum);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  LteFadingTrace::Load (input, rbNum, samplesNum);
+  int64_t textMs = clock.End ();
+  clock.Start ();
+  LteFadingTrace::Load (output, rbNum, samplesNum);
+  int64_t binaryMs = clock.End ();
+
+  std::cout << "text load(ms)" << "\t" << "binary load(ms)" << std::endl;
+  std::cout << textMs << "\t\t" << binaryMs << std::endl;
+  return 0;
+}
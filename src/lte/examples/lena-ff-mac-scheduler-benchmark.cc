@@ -0,0 +1,366 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// This program measures the cost of the FF MAC schedulers, without the
+// rest of the LTE stack.
+//
+// Each scheduler is connected to stub SAP users and to a no-op frequency
+// reuse algorithm. For each bandwidth and number of UEs, the cell and the
+// UEs (one full-buffer data radio bearer each, in both directions) are
+// configured through the CSCHED SAP; then, at every TTI, the program feeds
+// the scheduler through the SCHED SAP the way LteEnbMac does:
+// - the DL CQIs (A30, one CQI per RBG), refreshed every cqiPeriod TTIs;
+// - the SRS UL CQIs of the UEs whose SRS occasion falls in the TTI (one
+//   every srsPeriod TTIs per UE) and the PUSCH UL CQIs of the UL grants of
+//   the TTI;
+// - the RLC buffer status and the BSR of the UEs scheduled in the previous
+//   TTI, with the HARQ ACKs of the previous TTI;
+// - the DL and UL scheduling triggers.
+// The scheduling decisions are captured by the stub SCHED SAP user.
+//
+// The output displays, for each scheduler, bandwidth and number of UEs,
+// the wall clock time per TTI and the average number of UEs scheduled per
+// TTI in DL and UL:
+//
+//   scheduler   RBs   UEs   us/TTI   DL UEs/TTI   UL UEs/TTI
+//
+// Example usage:
+//
+//   ./waf --run "lena-ff-mac-scheduler-benchmark --schedulers=ns3::PfFfMacScheduler,ns3::PssFfMacScheduler --bandwidths=25,100 --nUes=100,1000"
+//
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/ff-mac-scheduler.h"
+#include "ns3/ff-mac-csched-sap.h"
+#include "ns3/ff-mac-sched-sap.h"
+#include "ns3/lte-common.h"
+#include "ns3/lte-vendor-specific-parameters.h"
+#include "ns3/lte-fr-no-op-algorithm.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Stub CSCHED SAP user, ignoring the confirmations
+ */
+class BenchmarkCschedSapUser : public FfMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+  {
+  }
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+  {
+  }
+};
+
+/**
+ * Stub SCHED SAP user, keeping the last DL and UL scheduling decisions
+ */
+class BenchmarkSchedSapUser : public FfMacSchedSapUser
+{
+public:
+  virtual void SchedDlConfigInd (const struct SchedDlConfigIndParameters& params)
+  {
+    m_dlConfig = params;
+  }
+  virtual void SchedUlConfigInd (const struct SchedUlConfigIndParameters& params)
+  {
+    m_ulConfig = params;
+  }
+
+  SchedDlConfigIndParameters m_dlConfig; ///< the last DL scheduling decision
+  SchedUlConfigIndParameters m_ulConfig; ///< the last UL scheduling decision
+};
+
+/**
+ * Compute the SFN/SF of a TTI, the way LteEnbMac does (frames and
+ * subframes are numbered from 1)
+ *
+ * \param tti the index of the TTI
+ * \return the SFN/SF
+ */
+uint16_t
+GetSfnSf (uint32_t tti)
+{
+  uint16_t frameNo = 1 + (tti / 10) % 1024;
+  uint16_t subframeNo = 1 + tti % 10;
+  return ((0x3FF & frameNo) << 4) | (0xF & subframeNo);
+}
+
+/**
+ * Measure the scheduling cost for a cell
+ *
+ * \param schedulerFactory the factory of the scheduler
+ * \param bandwidth the bandwidth in RBs
+ * \param nUes the number of UEs
+ * \param nTtis the number of TTIs
+ * \param cqiPeriod the period of the DL CQI reports in TTIs
+ * \param srsPeriod the period of the SRS of each UE in TTIs
+ * \param cqi the random variable of the CQIs
+ */
+void
+RunBenchmark (ObjectFactory schedulerFactory, uint8_t bandwidth, uint16_t nUes, uint32_t nTtis,
+              uint32_t cqiPeriod, uint32_t srsPeriod, Ptr<UniformRandomVariable> cqi)
+{
+  Ptr<FfMacScheduler> scheduler = schedulerFactory.Create<FfMacScheduler> ();
+  Ptr<LteFfrAlgorithm> ffrAlgorithm = CreateObject<LteFrNoOpAlgorithm> ();
+  ffrAlgorithm->SetDlBandwidth (bandwidth);
+  ffrAlgorithm->SetUlBandwidth (bandwidth);
+  BenchmarkCschedSapUser cschedSapUser;
+  BenchmarkSchedSapUser schedSapUser;
+  scheduler->SetFfMacCschedSapUser (&cschedSapUser);
+  scheduler->SetFfMacSchedSapUser (&schedSapUser);
+  scheduler->SetLteFfrSapProvider (ffrAlgorithm->GetLteFfrSapProvider ());
+  ffrAlgorithm->SetLteFfrSapUser (scheduler->GetLteFfrSapUser ());
+  FfMacCschedSapProvider* cschedSapProvider = scheduler->GetFfMacCschedSapProvider ();
+  FfMacSchedSapProvider* schedSapProvider = scheduler->GetFfMacSchedSapProvider ();
+
+  FfMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+  cellConfig.m_ulBandwidth = bandwidth;
+  cellConfig.m_dlBandwidth = bandwidth;
+  cschedSapProvider->CschedCellConfigReq (cellConfig);
+
+  const uint8_t lcId = 3;
+  for (uint16_t rnti = 1; rnti <= nUes; rnti++)
+    {
+      FfMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+      ueConfig.m_rnti = rnti;
+      ueConfig.m_transmissionMode = 0;
+      cschedSapProvider->CschedUeConfigReq (ueConfig);
+
+      FfMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+      lcConfig.m_rnti = rnti;
+      lcConfig.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = lcId;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = 9;
+      lc.m_eRabMaximulBitrateUl = 1000000;
+      lc.m_eRabMaximulBitrateDl = 1000000;
+      lc.m_eRabGuaranteedBitrateUl = 0;
+      lc.m_eRabGuaranteedBitrateDl = 0;
+      lcConfig.m_logicalChannelConfigList.push_back (lc);
+      cschedSapProvider->CschedLcConfigReq (lcConfig);
+    }
+
+  // full buffer RLC status and BSR, sent for all the UEs at the beginning,
+  // then for the UEs scheduled in the previous TTI
+  FfMacSchedSapProvider::SchedDlRlcBufferReqParameters rlcBuffer;
+  rlcBuffer.m_logicalChannelIdentity = lcId;
+  rlcBuffer.m_rlcTransmissionQueueSize = 1000000000;
+  rlcBuffer.m_rlcTransmissionQueueHolDelay = 10;
+  rlcBuffer.m_rlcRetransmissionQueueSize = 0;
+  rlcBuffer.m_rlcRetransmissionHolDelay = 0;
+  rlcBuffer.m_rlcStatusPduSize = 0;
+  MacCeListElement_s bsr;
+  bsr.m_macCeType = MacCeListElement_s::BSR;
+  bsr.m_macCeValue.m_phr = 0;
+  bsr.m_macCeValue.m_crnti = 0;
+  bsr.m_macCeValue.m_bufferStatus.assign (4, 0);
+  bsr.m_macCeValue.m_bufferStatus.at (1) = BufferSizeLevelBsr::BufferSize2BsrId (1000000);
+  FfMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters ulMacCtrl;
+  ulMacCtrl.m_sfnSf = GetSfnSf (0);
+  for (uint16_t rnti = 1; rnti <= nUes; rnti++)
+    {
+      rlcBuffer.m_rnti = rnti;
+      schedSapProvider->SchedDlRlcBufferReq (rlcBuffer);
+      bsr.m_rnti = rnti;
+      ulMacCtrl.m_macCeList.push_back (bsr);
+    }
+  schedSapProvider->SchedUlMacCtrlInfoReq (ulMacCtrl);
+
+  uint8_t rbgSize = bandwidth < 11 ? 1 : (bandwidth < 27 ? 2 : (bandwidth < 64 ? 3 : 4));
+  uint32_t rbgNum = (bandwidth + rbgSize - 1) / rbgSize;
+  // the UL grants are decided for the TTI following the PUSCH delay, when
+  // the PUSCH CQIs are reported
+  const uint32_t ulDelay = UL_PUSCH_TTIS_DELAY + 1;
+  uint64_t dlScheduledUes = 0;
+  uint64_t ulScheduledUes = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t tti = 0; tti < nTtis; tti++)
+    {
+      uint16_t sfnSf = GetSfnSf (tti);
+
+      if (tti % cqiPeriod == 0)
+        {
+          FfMacSchedSapProvider::SchedDlCqiInfoReqParameters cqiInfo;
+          cqiInfo.m_sfnSf = sfnSf;
+          for (uint16_t rnti = 1; rnti <= nUes; rnti++)
+            {
+              CqiListElement_s dlCqi;
+              dlCqi.m_rnti = rnti;
+              dlCqi.m_ri = 1;
+              dlCqi.m_cqiType = CqiListElement_s::A30;
+              dlCqi.m_wbPmi = 0;
+              uint32_t meanCqi = cqi->GetInteger ();
+              for (uint32_t rbg = 0; rbg < rbgNum; rbg++)
+                {
+                  HigherLayerSelected_s hlCqi;
+                  hlCqi.m_sbPmi = 0;
+                  hlCqi.m_sbCqi.push_back (std::max (1U, std::min (15U, meanCqi + rbg % 3)));
+                  dlCqi.m_sbMeasResult.m_higherLayerSelected.push_back (hlCqi);
+                }
+              cqiInfo.m_cqiList.push_back (dlCqi);
+            }
+          schedSapProvider->SchedDlCqiInfoReq (cqiInfo);
+        }
+
+      // SRS of the UEs whose occasion falls in this TTI
+      for (uint32_t rnti = 1 + (tti % srsPeriod); rnti <= nUes; rnti += srsPeriod)
+        {
+          FfMacSchedSapProvider::SchedUlCqiInfoReqParameters srsCqi;
+          srsCqi.m_sfnSf = sfnSf;
+          srsCqi.m_ulCqi.m_type = UlCqi_s::SRS;
+          srsCqi.m_ulCqi.m_sinr.assign (bandwidth, LteFfConverter::double2fpS11dot3 (cqi->GetValue ()));
+          VendorSpecificListElement_s vsp;
+          vsp.m_type = SRS_CQI_RNTI_VSP;
+          vsp.m_length = sizeof (SrsCqiRntiVsp);
+          vsp.m_value = Create<SrsCqiRntiVsp> (rnti);
+          srsCqi.m_vendorSpecificList.push_back (vsp);
+          schedSapProvider->SchedUlCqiInfoReq (srsCqi);
+        }
+
+      // PUSCH CQIs of the UL grants of this TTI
+      if (tti >= ulDelay)
+        {
+          FfMacSchedSapProvider::SchedUlCqiInfoReqParameters puschCqi;
+          puschCqi.m_sfnSf = sfnSf;
+          puschCqi.m_ulCqi.m_type = UlCqi_s::PUSCH;
+          puschCqi.m_ulCqi.m_sinr.assign (bandwidth, LteFfConverter::double2fpS11dot3 (cqi->GetValue ()));
+          schedSapProvider->SchedUlCqiInfoReq (puschCqi);
+        }
+
+      // acknowledge the TBs of the previous TTI and refresh the RLC status
+      // and the BSR of the UEs scheduled
+      FfMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+      dlTrigger.m_sfnSf = sfnSf;
+      const std::vector<BuildDataListElement_s> &dataList = schedSapUser.m_dlConfig.m_buildDataList;
+      for (std::vector<BuildDataListElement_s>::const_iterator it = dataList.begin (); it != dataList.end (); ++it)
+        {
+          DlInfoListElement_s harqInfo;
+          harqInfo.m_rnti = it->m_rnti;
+          harqInfo.m_harqProcessId = it->m_dci.m_harqProcess;
+          harqInfo.m_harqStatus.assign (it->m_dci.m_ndi.size (), DlInfoListElement_s::ACK);
+          dlTrigger.m_dlInfoList.push_back (harqInfo);
+          rlcBuffer.m_rnti = it->m_rnti;
+          schedSapProvider->SchedDlRlcBufferReq (rlcBuffer);
+        }
+      FfMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+      ulTrigger.m_sfnSf = GetSfnSf (tti + ulDelay);
+      ulMacCtrl.m_sfnSf = sfnSf;
+      ulMacCtrl.m_macCeList.clear ();
+      const std::vector<UlDciListElement_s> &dciList = schedSapUser.m_ulConfig.m_dciList;
+      for (std::vector<UlDciListElement_s>::const_iterator it = dciList.begin (); it != dciList.end (); ++it)
+        {
+          UlInfoListElement_s harqInfo;
+          harqInfo.m_rnti = it->m_rnti;
+          harqInfo.m_receptionStatus = UlInfoListElement_s::Ok;
+          harqInfo.m_tpc = 0;
+          ulTrigger.m_ulInfoList.push_back (harqInfo);
+          bsr.m_rnti = it->m_rnti;
+          ulMacCtrl.m_macCeList.push_back (bsr);
+        }
+      if (ulMacCtrl.m_macCeList.size () > 0)
+        {
+          schedSapProvider->SchedUlMacCtrlInfoReq (ulMacCtrl);
+        }
+
+      schedSapUser.m_dlConfig = FfMacSchedSapUser::SchedDlConfigIndParameters ();
+      schedSapUser.m_ulConfig = FfMacSchedSapUser::SchedUlConfigIndParameters ();
+      schedSapProvider->SchedDlTriggerReq (dlTrigger);
+      schedSapProvider->SchedUlTriggerReq (ulTrigger);
+      dlScheduledUes += schedSapUser.m_dlConfig.m_buildDataList.size ();
+      ulScheduledUes += schedSapUser.m_ulConfig.m_dciList.size ();
+    }
+  int64_t elapsedMs = clock.End ();
+
+  std::cout << schedulerFactory.GetTypeId ().GetName () << "\t" << (uint32_t) bandwidth << "\t" << nUes
+            << "\t" << (elapsedMs * 1000.0 / nTtis)
+            << "\t" << ((double) dlScheduledUes / nTtis) << "\t" << ((double) ulScheduledUes / nTtis) << std::endl;
+  scheduler->Dispose ();
+  ffrAlgorithm->Dispose ();
+}
+
+int main (int argc, char *argv[])
+{
+  std::string schedulers = "ns3::PfFfMacScheduler";
+  std::string bandwidths = "25,50,100";
+  std::string ueCounts = "100,200,500,1000";
+  uint32_t nTtis = 1000;
+  uint32_t cqiPeriod = 2;
+  uint32_t srsPeriod = 80;
+
+  CommandLine cmd;
+  cmd.AddValue ("schedulers", "Comma separated list of TypeIds of FF MAC schedulers", schedulers);
+  cmd.AddValue ("bandwidths", "Comma separated list of bandwidths in RBs", bandwidths);
+  cmd.AddValue ("nUes", "Comma separated list of numbers of UEs", ueCounts);
+  cmd.AddValue ("nTtis", "Number of TTIs per measurement", nTtis);
+  cmd.AddValue ("cqiPeriod", "Period of the DL CQI reports in TTIs", cqiPeriod);
+  cmd.AddValue ("srsPeriod", "Period of the SRS of each UE in TTIs", srsPeriod);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> cqi = CreateObject<UniformRandomVariable> ();
+  cqi->SetAttribute ("Min", DoubleValue (1));
+  cqi->SetAttribute ("Max", DoubleValue (15));
+
+  std::cout << "scheduler" << "\t" << "RBs" << "\t" << "UEs" << "\t" << "us/TTI"
+            << "\t" << "DL UEs/TTI" << "\t" << "UL UEs/TTI" << std::endl;
+  std::istringstream schedulerStream (schedulers);
+  std::string schedulerType;
+  while (std::getline (schedulerStream, schedulerType, ','))
+    {
+      ObjectFactory schedulerFactory;
+      schedulerFactory.SetTypeId (schedulerType);
+      std::istringstream bandwidthStream (bandwidths);
+      std::string bandwidth;
+      while (std::getline (bandwidthStream, bandwidth, ','))
+        {
+          std::istringstream ueStream (ueCounts);
+          std::string nUes;
+          while (std::getline (ueStream, nUes, ','))
+            {
+              RunBenchmark (schedulerFactory, static_cast<uint8_t> (std::stoi (bandwidth)),
+                            static_cast<uint16_t> (std::stoi (nUes)), nTtis,
+                            std::max (1U, cqiPeriod), std::max (1U, srsPeriod), cqi);
+            }
+        }
+    }
+  return 0;
+}
@@ -194,6 +194,16 @@ TypeId LteHelper::GetTypeId (void)
                    UintegerValue (1),
                    MakeUintegerAccessor (&LteHelper::m_noOfCcs),
                    MakeUintegerChecker<uint16_t> (MIN_NO_CC, MAX_NO_CC))
+    .AddAttribute ("PhyAbstraction",
+                   "If true, the spectrum channels cache the path loss of the links "
+                   "(see MultiModelSpectrumChannel::CacheLinkGains) and deliver to each "
+                   "LteSpectrumPhy the signals of the other cells summed in a single "
+                   "signal per frame type, instead of one signal per transmitter "
+                   "(see LteSpectrumPhy::IsInterferenceOnly). "
+                   "It requires the SpectrumChannel type to be MultiModelSpectrumChannel.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LteHelper::m_phyAbstraction),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -266,6 +276,18 @@ LteHelper::ChannelModelInitialization (void)
       m_downlinkChannel->AddSpectrumPropagationLossModel (m_fadingModule);
       m_uplinkChannel->AddSpectrumPropagationLossModel (m_fadingModule);
     }
+
+  if (m_phyAbstraction)
+    {
+      Ptr<MultiModelSpectrumChannel> channels[2] = {DynamicCast<MultiModelSpectrumChannel> (m_downlinkChannel),
+                                                    DynamicCast<MultiModelSpectrumChannel> (m_uplinkChannel)};
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          NS_ABORT_MSG_IF (channels[i] == 0, "PhyAbstraction requires the channels to be MultiModelSpectrumChannel");
+          channels[i]->SetAttribute ("CacheLinkGains", BooleanValue (true));
+          channels[i]->SetInterferenceOnlyCallback (MakeCallback (&LteSpectrumPhy::IsInterferenceOnly));
+        }
+    }
 }
 
 void 
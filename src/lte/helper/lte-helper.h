@@ -837,6 +837,13 @@ private:
    */
   bool m_useCa;
 
+  /**
+   * The `PhyAbstraction` attribute. If true, the spectrum channels cache
+   * the path loss of the links and sum the signals of the other cells
+   * before delivering them to each receiver.
+   */
+  bool m_phyAbstraction;
+
   /**
    * This contains all the information about each component carrier
    */
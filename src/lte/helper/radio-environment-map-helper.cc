@@ -37,9 +37,22 @@
 #include <ns3/node.h>
 #include <ns3/buildings-helper.h>
 #include <ns3/lte-spectrum-value-helper.h>
+#include <ns3/lte-spectrum-signal-parameters.h>
+#include <ns3/spectrum-converter.h>
+#include <ns3/spectrum-propagation-loss-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/angles.h>
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <ns3/system-thread.h>
+#include <ns3/system-mutex.h>
+#endif
 
 #include <fstream>
 #include <limits>
+#include <cmath>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -47,7 +60,286 @@ NS_LOG_COMPONENT_DEFINE ("RadioEnvironmentMapHelper");
 
 NS_OBJECT_ENSURE_REGISTERED (RadioEnvironmentMapHelper);
 
+/// Number of points taken at once by a thread of RemDirectComputation
+static const std::size_t REM_POINTS_PER_BLOCK = 1024;
+
+/**
+ * \ingroup lte
+ *
+ * Computation of the SINR at the points of a Radio Environment Map from
+ * the signals transmitted in a TTI, on behalf of RadioEnvironmentMapHelper
+ * when its DirectComputation attribute is set.
+ *
+ * The points are split in blocks, which the threads take in turn, the
+ * simulation thread being one of them. Each thread owns the mobility
+ * models passed to the propagation loss models, so that the threads never
+ * share a reference counted object.
+ */
+class RemDirectComputation
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param loss the single-frequency propagation loss model of the channel, if any
+   * \param spectrumLoss the frequency-dependent propagation loss model of the channel, if any
+   * \param maxLossDb the maximum loss of the channel, in dB
+   * \param rbId the RB for which the SINR is computed, or -1 for the whole bandwidth
+   * \param noisePower the noise power, in W
+   */
+  RemDirectComputation (Ptr<PropagationLossModel> loss, Ptr<SpectrumPropagationLossModel> spectrumLoss,
+                        double maxLossDb, int32_t rbId, double noisePower);
+
+  /**
+   * Add a transmitter
+   *
+   * \param psd the transmitted PSD, in the spectrum model of the map
+   * \param mobility the mobility of the transmitter
+   * \param antenna the antenna of the transmitter, if any
+   */
+  void AddTransmitter (Ptr<const SpectrumValue> psd, Ptr<MobilityModel> mobility, Ptr<AntennaModel> antenna);
+
+  /**
+   * \return whether the SINR of several points can be computed concurrently
+   */
+  bool IsParallelizable (void) const;
+
+  /**
+   * Compute the SINR at the given points
+   *
+   * \param points the positions of the points
+   * \param nThreads the number of threads, including the simulation thread
+   * \param sinr the SINR at each point, in the order of the points
+   */
+  void Run (const std::vector<Vector> &points, uint32_t nThreads, std::vector<double> &sinr);
+
+private:
+  /// A transmitter, as seen by a thread
+  struct Transmitter
+  {
+    Ptr<const SpectrumValue> psd; ///< the transmitted PSD
+    double power;                 ///< the transmitted power over the RBs of the map, in W
+    Vector position;              ///< the position of the transmitter
+    Ptr<MobilityModel> mobility;  ///< the mobility of the transmitter
+    AntennaModel *antenna;        ///< the antenna of the transmitter, if any
+  };
+
+  /// The state owned by a thread
+  struct Worker
+  {
+    std::vector<Transmitter> transmitters; ///< the transmitters
+    Ptr<MobilityModel> rxMobility;         ///< the mobility of the point being computed
+  };
+
+  /**
+   * Compute the SINR at the points of the given range
+   *
+   * \param worker the state of the calling thread
+   * \param begin the index of the first point
+   * \param end the index following the last point
+   */
+  void Process (Worker &worker, std::size_t begin, std::size_t end);
+
+  /// Body of the threads: take blocks of points until all of them have been taken.
+  void DoWork (void);
+
+  Ptr<PropagationLossModel> m_loss;                    //!< single-frequency propagation loss model
+  Ptr<SpectrumPropagationLossModel> m_spectrumLoss;    //!< frequency-dependent propagation loss model
+  double m_maxLossDb;                                  //!< maximum loss in dB
+  int32_t m_rbId;                                      //!< RB for which the SINR is computed
+  double m_noisePower;                                 //!< noise power
+  bool m_makeConsistent;                               //!< whether the building info of the points is updated
+  std::vector<Transmitter> m_transmitters;             //!< the transmitters
+  std::vector<Worker> m_workers;                       //!< the state of each thread
+  const std::vector<Vector> *m_points;                 //!< the points being computed
+  std::vector<double> *m_sinr;                         //!< the SINR of the points
+  std::size_t m_nextBlock;                             //!< the next block of points to take
+  uint32_t m_nStarted;                                 //!< number of threads started so far
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_mutex;                                 //!< protects m_nextBlock and m_nStarted
+#endif
+};
+
+RemDirectComputation::RemDirectComputation (Ptr<PropagationLossModel> loss, Ptr<SpectrumPropagationLossModel> spectrumLoss,
+                                            double maxLossDb, int32_t rbId, double noisePower)
+  : m_loss (loss),
+    m_spectrumLoss (spectrumLoss),
+    m_maxLossDb (maxLossDb),
+    m_rbId (rbId),
+    m_noisePower (noisePower),
+    m_makeConsistent (true),
+    m_points (0),
+    m_sinr (0),
+    m_nextBlock (0),
+    m_nStarted (0)
+{
+}
+
+void
+RemDirectComputation::AddTransmitter (Ptr<const SpectrumValue> psd, Ptr<MobilityModel> mobility, Ptr<AntennaModel> antenna)
+{
+  Transmitter tx;
+  tx.psd = psd;
+  tx.power = (m_rbId >= 0) ? (*psd)[m_rbId] * 180000 : Integral (*psd);
+  tx.position = mobility->GetPosition ();
+  tx.mobility = mobility;
+  tx.antenna = PeekPointer (antenna);
+  m_transmitters.push_back (tx);
+}
+
+bool
+RemDirectComputation::IsParallelizable (void) const
+{
+  return (m_loss == 0 || m_loss->IsPositionOnly ()) && m_spectrumLoss == 0;
+}
+
+void
+RemDirectComputation::Run (const std::vector<Vector> &points, uint32_t nThreads, std::vector<double> &sinr)
+{
+#ifndef HAVE_PTHREAD_H
+  nThreads = 1;
+#endif
+  if (nThreads > 1 && !IsParallelizable ())
+    {
+      NS_LOG_WARN ("the propagation loss models of the channel cannot be evaluated concurrently, using a single thread");
+      nThreads = 1;
+    }
+  sinr.resize (points.size ());
+  m_points = &points;
+  m_sinr = &sinr;
+  m_nextBlock = 0;
+  m_nStarted = 0;
+
+  m_workers.assign (nThreads, Worker ());
+  if (nThreads == 1)
+    {
+      // use the mobility models of the transmitters, and the building info of the points
+      m_makeConsistent = true;
+      m_workers[0].transmitters = m_transmitters;
+      m_workers[0].rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+      m_workers[0].rxMobility->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+      Process (m_workers[0], 0, points.size ());
+    }
+#ifdef HAVE_PTHREAD_H
+  else
+    {
+      // the propagation loss only depends on the positions: each thread
+      // gets its own copies of the mobility models
+      m_makeConsistent = false;
+      for (std::vector<Worker>::iterator it = m_workers.begin (); it != m_workers.end (); ++it)
+        {
+          it->transmitters = m_transmitters;
+          for (std::vector<Transmitter>::iterator txIt = it->transmitters.begin (); txIt != it->transmitters.end (); ++txIt)
+            {
+              txIt->mobility = CreateObject<ConstantPositionMobilityModel> ();
+              txIt->mobility->SetPosition (txIt->position);
+            }
+          it->rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+        }
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 1; i < nThreads; i++)
+        {
+          Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&RemDirectComputation::DoWork, this));
+          threads.push_back (thread);
+          thread->Start ();
+        }
+      DoWork ();
+      for (std::vector<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+        {
+          (*it)->Join ();
+        }
+    }
+#endif
+  m_workers.clear ();
+  m_points = 0;
+  m_sinr = 0;
+}
+
+void
+RemDirectComputation::Process (Worker &worker, std::size_t begin, std::size_t end)
+{
+  for (std::size_t i = begin; i < end; i++)
+    {
+      const Vector &point = (*m_points)[i];
+      worker.rxMobility->SetPosition (point);
+      if (m_makeConsistent)
+        {
+          BuildingsHelper::MakeConsistent (worker.rxMobility);
+        }
+      double sumPower = 0;
+      double referenceSignalPower = 0;
+      for (std::vector<Transmitter>::iterator tx = worker.transmitters.begin (); tx != worker.transmitters.end (); ++tx)
+        {
+          double pathLossDb = 0;
+          if (tx->antenna != 0)
+            {
+              Angles txAngles (point, tx->position);
+              pathLossDb -= tx->antenna->GetGainDb (txAngles);
+            }
+          if (m_loss)
+            {
+              pathLossDb -= m_loss->CalcRxPower (0, tx->mobility, worker.rxMobility);
+            }
+          if (pathLossDb > m_maxLossDb)
+            {
+              // beyond range
+              continue;
+            }
+          double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+          double power;
+          if (m_spectrumLoss)
+            {
+              Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (tx->psd);
+              *rxPsd *= pathGainLinear;
+              rxPsd = m_spectrumLoss->CalcRxPowerSpectralDensity (rxPsd, tx->mobility, worker.rxMobility);
+              power = (m_rbId >= 0) ? (*rxPsd)[m_rbId] * 180000 : Integral (*rxPsd);
+            }
+          else
+            {
+              power = tx->power * pathGainLinear;
+            }
+          sumPower += power;
+          if (power > referenceSignalPower)
+            {
+              referenceSignalPower = power;
+            }
+        }
+      (*m_sinr)[i] = referenceSignalPower / (sumPower - referenceSignalPower + m_noisePower);
+    }
+}
+
+void
+RemDirectComputation::DoWork (void)
+{
+#ifdef HAVE_PTHREAD_H
+  uint32_t worker;
+  {
+    CriticalSection cs (m_mutex);
+    worker = m_nStarted++;
+  }
+  std::size_t n = m_points->size ();
+  while (true)
+    {
+      std::size_t block;
+      {
+        CriticalSection cs (m_mutex);
+        block = m_nextBlock++;
+      }
+      std::size_t begin = block * REM_POINTS_PER_BLOCK;
+      if (begin >= n)
+        {
+          break;
+        }
+      Process (m_workers[worker], begin, std::min (n, begin + REM_POINTS_PER_BLOCK));
+    }
+#endif
+}
+
+
 RadioEnvironmentMapHelper::RadioEnvironmentMapHelper ()
+  : m_xPoints (0),
+    m_yPoints (0),
+    m_lastX (0)
 {
 }
 
@@ -144,6 +436,27 @@ RadioEnvironmentMapHelper::GetTypeId (void)
                    IntegerValue (-1),
                    MakeIntegerAccessor (&RadioEnvironmentMapHelper::m_rbId),
                    MakeIntegerChecker<int32_t> ())
+    .AddAttribute ("DirectComputation",
+                   "If true, the signals transmitted in one TTI are recorded and the SINR of every point "
+                   "is computed directly from the propagation loss models of the channel, instead of "
+                   "attaching listeners to the channel in iterations of MaxPointsPerIteration points",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RadioEnvironmentMapHelper::m_directComputation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Threads",
+                   "The number of threads, including the simulation thread, computing the map when "
+                   "DirectComputation is true. More than one thread is only used if the propagation "
+                   "loss models of the channel only depend on the positions of the nodes and no "
+                   "SpectrumPropagationLossModel is used.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RadioEnvironmentMapHelper::m_threads),
+                   MakeUintegerChecker<uint32_t> (1, 256))
+    .AddAttribute ("BinaryOutputFile",
+                   "If not empty, the filename to which the Radio Environment Map is also saved "
+                   "as a binary raster (see the RadioEnvironmentMapHelper documentation)",
+                   StringValue (""),
+                   MakeStringAccessor (&RadioEnvironmentMapHelper::m_binaryOutputFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -181,7 +494,7 @@ void
 RadioEnvironmentMapHelper::Install ()
 {
   NS_LOG_FUNCTION (this);
-  if (!m_rem.empty ())
+  if (!m_rem.empty () || !m_sinr.empty ())
     {
       NS_FATAL_ERROR ("only one REM supported per instance of RadioEnvironmentMapHelper");
     }
@@ -220,6 +533,15 @@ RadioEnvironmentMapHelper::DelayedInstall ()
   NS_LOG_FUNCTION (this);
   m_xStep = (m_xMax - m_xMin)/(m_xRes-1);
   m_yStep = (m_yMax - m_yMin)/(m_yRes-1);
+
+  if (m_directComputation)
+    {
+      // record the signals of one TTI
+      m_channel->TraceConnectWithoutContext ("TxSigParams",
+                                             MakeCallback (&RadioEnvironmentMapHelper::RecordTransmission, this));
+      Simulator::Schedule (Seconds (0.001), &RadioEnvironmentMapHelper::ComputeDirectly, this);
+      return;
+    }
   
   if ((double)m_xRes * (double) m_yRes < (double) m_maxPointsPerIteration)
     {
@@ -326,18 +648,91 @@ RadioEnvironmentMapHelper::PrintAndReset ()
           // at the end of the list can be unused
           break;
         }
-      Vector pos = it->bmm->GetPosition ();
-      NS_LOG_LOGIC ("output: " << pos.x << "\t" 
-                    << pos.y << "\t" 
-                    << pos.z << "\t" 
-                    << it->phy->GetSinr (m_noisePower));
-      m_outFile << pos.x << "\t" 
+      WritePoint (it->bmm->GetPosition (), it->phy->GetSinr (m_noisePower));
+      it->phy->Reset ();
+    }
+}
+
+void
+RadioEnvironmentMapHelper::WritePoint (const Vector &pos, double sinr)
+{
+  NS_LOG_LOGIC ("output: " << pos.x << "\t" 
                 << pos.y << "\t" 
                 << pos.z << "\t" 
-                << it->phy->GetSinr (m_noisePower)
-                << std::endl;
-      it->phy->Reset ();
+                << sinr);
+  m_outFile << pos.x << "\t" 
+            << pos.y << "\t" 
+            << pos.z << "\t" 
+            << sinr
+            << std::endl;
+  if (m_sinr.empty () || pos.x != m_lastX)
+    {
+      m_lastX = pos.x;
+      ++m_xPoints;
+    }
+  if (m_xPoints == 1)
+    {
+      ++m_yPoints;
     }
+  m_sinr.push_back (sinr);
+}
+
+void
+RadioEnvironmentMapHelper::RecordTransmission (Ptr<SpectrumSignalParameters> params)
+{
+  NS_LOG_FUNCTION (this << params);
+  if ((m_useDataChannel && DynamicCast<LteSpectrumSignalParametersDataFrame> (params) != 0)
+      || (!m_useDataChannel && DynamicCast<LteSpectrumSignalParametersDlCtrlFrame> (params) != 0))
+    {
+      m_transmissions.push_back (params);
+    }
+}
+
+void
+RadioEnvironmentMapHelper::ComputeDirectly ()
+{
+  NS_LOG_FUNCTION (this);
+  m_channel->TraceDisconnectWithoutContext ("TxSigParams",
+                                            MakeCallback (&RadioEnvironmentMapHelper::RecordTransmission, this));
+
+  DoubleValue maxLossDb;
+  m_channel->GetAttribute ("MaxLossDb", maxLossDb);
+  RemDirectComputation computation (m_channel->GetPropagationLossModel (),
+                                    m_channel->GetSpectrumPropagationLossModel (),
+                                    maxLossDb.Get (), m_rbId, m_noisePower);
+  Ptr<const SpectrumModel> remSpectrumModel = LteSpectrumValueHelper::GetSpectrumModel (m_earfcn, m_bandwidth);
+  for (std::vector<Ptr<SpectrumSignalParameters> >::iterator it = m_transmissions.begin ();
+       it != m_transmissions.end ();
+       ++it)
+    {
+      Ptr<MobilityModel> txMobility = (*it)->txPhy->GetMobility ();
+      NS_ABORT_MSG_IF (txMobility == 0, "DirectComputation requires transmitters with a mobility model");
+      Ptr<const SpectrumValue> psd = (*it)->psd;
+      if (psd->GetSpectrumModelUid () != remSpectrumModel->GetUid ())
+        {
+          SpectrumConverter converter (psd->GetSpectrumModel (), remSpectrumModel);
+          psd = converter.Convert (psd);
+        }
+      computation.AddTransmitter (psd, txMobility, (*it)->txAntenna);
+    }
+  NS_LOG_LOGIC (m_transmissions.size () << " transmitters");
+  m_transmissions.clear ();
+
+  std::vector<Vector> points;
+  for (double x = m_xMin; x < m_xMax + 0.5*m_xStep; x += m_xStep)
+    {
+      for (double y = m_yMin; y < m_yMax + 0.5*m_yStep ; y += m_yStep)
+        {
+          points.push_back (Vector (x, y, m_z));
+        }
+    }
+  std::vector<double> sinr;
+  computation.Run (points, m_threads, sinr);
+  for (std::size_t i = 0; i < points.size (); i++)
+    {
+      WritePoint (points[i], sinr[i]);
+    }
+  Finalize ();
 }
 
 void 
@@ -345,6 +740,20 @@ RadioEnvironmentMapHelper::Finalize ()
 {
   NS_LOG_FUNCTION (this);
   m_outFile.close ();
+  if (!m_binaryOutputFile.empty ())
+    {
+      std::ofstream binaryFile (m_binaryOutputFile.c_str (), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+      NS_ABORT_MSG_IF (!binaryFile.good (), "Can't open file " << m_binaryOutputFile);
+      NS_ASSERT (m_sinr.size () == static_cast<std::size_t> (m_xPoints) * m_yPoints);
+      const char magic[8] = {'L', 'T', 'E', 'R', 'E', 'M', '0', '1'};
+      double bounds[5] = {m_xMin, m_xMax, m_yMin, m_yMax, m_z};
+      binaryFile.write (magic, sizeof (magic));
+      binaryFile.write (reinterpret_cast<const char *> (&m_xPoints), sizeof (m_xPoints));
+      binaryFile.write (reinterpret_cast<const char *> (&m_yPoints), sizeof (m_yPoints));
+      binaryFile.write (reinterpret_cast<const char *> (bounds), sizeof (bounds));
+      binaryFile.write (reinterpret_cast<const char *> (m_sinr.data ()), m_sinr.size () * sizeof (double));
+      NS_ABORT_MSG_IF (!binaryFile.good (), "Error writing " << m_binaryOutputFile);
+    }
   if (m_stopWhenDone)
     {
       Simulator::Stop ();
@@ -24,7 +24,9 @@
 
 
 #include <ns3/object.h>
+#include <ns3/vector.h>
 #include <fstream>
+#include <vector>
 
 
 namespace ns3 {
@@ -35,6 +37,7 @@ class NetDevice;
 class SpectrumChannel;
 //class BuildingsMobilityModel;
 class MobilityModel;
+class SpectrumSignalParameters;
 
 /** 
  * \ingroup lte
@@ -42,6 +45,24 @@ class MobilityModel;
  * Generates a 2D map of the SINR from the strongest transmitter in the
  * downlink of an LTE FDD system. For instructions on usage, please refer to
  * the User Documentation.
+ *
+ * By default, the map is generated by attaching RemSpectrumPhy listeners
+ * to the channel, in iterations of at most MaxPointsPerIteration points.
+ * If the DirectComputation attribute is set, the signals transmitted in
+ * one TTI are recorded instead, and the SINR of each point is computed
+ * directly from the propagation loss models of the channel and the
+ * antennas of the transmitters, possibly by several threads.
+ *
+ * Besides the text output, the map can be saved in a binary raster file
+ * (BinaryOutputFile attribute) made of:
+ * - the 8 bytes magic "LTEREM01";
+ * - the number of points along the x and y axes, as uint32_t;
+ * - XMin, XMax, YMin, YMax and Z, as double;
+ * - the SINR of each point (linear), as double, in the order of the text
+ *   output: the SINR of the j-th point of the i-th column (x coordinate)
+ *   is the value of index i * (number of points along y) + j.
+ *
+ * All the values are stored in the byte order of the host.
  */
 class RadioEnvironmentMapHelper : public Object
 {
@@ -108,6 +129,28 @@ private:
   /// Called when the map generation procedure has been completed.
   void Finalize ();
 
+  /**
+   * Record a signal transmitted on the channel, used by DirectComputation.
+   *
+   * \param params the parameters of the signal
+   */
+  void RecordTransmission (Ptr<SpectrumSignalParameters> params);
+
+  /**
+   * Compute the SINR of every point of the map from the signals recorded
+   * in the previous TTI, write the map and call Finalize().
+   */
+  void ComputeDirectly ();
+
+  /**
+   * Write the SINR of a point to the text output, and keep it for the
+   * binary output.
+   *
+   * \param pos the position of the point
+   * \param sinr the SINR at that position
+   */
+  void WritePoint (const Vector &pos, double sinr);
+
   /// A complete Radio Environment Map is composed of many of this structure.
   struct RemPoint 
   {
@@ -152,6 +195,19 @@ private:
   bool m_useDataChannel;  ///< The `UseDataChannel` attribute.
   int32_t m_rbId;         ///< The `RbId` attribute.
 
+  bool m_directComputation;      ///< The `DirectComputation` attribute.
+  uint32_t m_threads;            ///< The `Threads` attribute.
+  std::string m_binaryOutputFile; ///< The `BinaryOutputFile` attribute.
+
+  /// The signals recorded by DirectComputation, in the order of transmission.
+  std::vector<Ptr<SpectrumSignalParameters> > m_transmissions;
+
+  /// The SINR of the points written so far, for the binary output.
+  std::vector<double> m_sinr;
+  uint32_t m_xPoints; ///< Number of points written along the x axis.
+  uint32_t m_yPoints; ///< Number of points written along the y axis.
+  double m_lastX;     ///< X coordinate of the last point written.
+
 }; // end of `class RadioEnvironmentMapHelper`
 
 
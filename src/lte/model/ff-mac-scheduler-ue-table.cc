@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ff-mac-scheduler-ue-table.h"
+#include <ns3/log.h>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FfMacSchedulerUeTable");
+
+const uint32_t FfMacSchedulerUeTable::NOT_FOUND;
+
+FfMacSchedulerUeTable::ColumnBase::ColumnBase (FfMacSchedulerUeTable &table)
+  : m_table (&table)
+{
+  m_table->m_columns.push_back (this);
+}
+
+FfMacSchedulerUeTable::ColumnBase::~ColumnBase ()
+{
+  if (m_table != 0)
+    {
+      std::vector<ColumnBase *> &columns = m_table->m_columns;
+      columns.erase (std::remove (columns.begin (), columns.end (), this), columns.end ());
+    }
+}
+
+FfMacSchedulerUeTable::FfMacSchedulerUeTable ()
+{
+}
+
+FfMacSchedulerUeTable::~FfMacSchedulerUeTable ()
+{
+  // the columns declared before the table outlive it
+  for (std::vector<ColumnBase *>::iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      (*it)->m_table = 0;
+    }
+}
+
+uint32_t
+FfMacSchedulerUeTable::Add (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  uint32_t index = Find (rnti);
+  if (index != NOT_FOUND)
+    {
+      return index;
+    }
+  index = std::lower_bound (m_rntis.begin (), m_rntis.end (), rnti) - m_rntis.begin ();
+  m_rntis.insert (m_rntis.begin () + index, rnti);
+  for (std::vector<ColumnBase *>::iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      (*it)->Insert (index);
+    }
+  if (rnti >= m_indices.size ())
+    {
+      m_indices.resize (rnti + 1, NOT_FOUND);
+    }
+  UpdateIndices (index);
+  return index;
+}
+
+void
+FfMacSchedulerUeTable::Remove (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  uint32_t index = Find (rnti);
+  if (index == NOT_FOUND)
+    {
+      return;
+    }
+  m_rntis.erase (m_rntis.begin () + index);
+  for (std::vector<ColumnBase *>::iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      (*it)->Erase (index);
+    }
+  m_indices[rnti] = NOT_FOUND;
+  UpdateIndices (index);
+}
+
+void
+FfMacSchedulerUeTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_rntis.clear ();
+  m_indices.clear ();
+  for (std::vector<ColumnBase *>::iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      (*it)->Clear ();
+    }
+}
+
+void
+FfMacSchedulerUeTable::UpdateIndices (uint32_t first)
+{
+  for (uint32_t i = first; i < m_rntis.size (); i++)
+    {
+      m_indices[m_rntis[i]] = i;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FF_MAC_SCHEDULER_UE_TABLE_H
+#define FF_MAC_SCHEDULER_UE_TABLE_H
+
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup ff-api
+ *
+ * Dense table of the UEs of a cell, for the FF MAC schedulers.
+ *
+ * The UEs are stored in increasing RNTI order at indices 0 to GetN () - 1,
+ * so that iterating over the indices visits the UEs in the same order as
+ * iterating over a std::map keyed by RNTI. The index of a RNTI is found
+ * in constant time.
+ *
+ * The per-UE metrics are stored as columns (one contiguous array per
+ * metric, indexed like the table) which are declared by the scheduler
+ * after the table and kept in sync with it when UEs are added or removed.
+ * Adding or removing a UE costs O(number of UEs), which is paid at UE
+ * (re)configuration, while the per-TTI and per-RBG loops only access
+ * arrays.
+ *
+ * \code
+ *   FfMacSchedulerUeTable m_ueTable;
+ *   FfMacSchedulerUeTable::Column<double> m_avgThroughput; // initialized with (m_ueTable, 1.0)
+ *
+ *   for (uint32_t i = 0; i < m_ueTable.GetN (); i++)
+ *     {
+ *       double rate = m_avgThroughput[i];
+ *       ...
+ *     }
+ * \endcode
+ */
+class FfMacSchedulerUeTable
+{
+public:
+  /// Index returned by Find for a RNTI which is not in the table
+  static const uint32_t NOT_FOUND = 0xffffffff;
+
+  /**
+   * Base class of the columns, letting the table resize them
+   */
+  class ColumnBase
+  {
+public:
+    /**
+     * Constructor: register the column with a table
+     *
+     * \param table the table
+     */
+    ColumnBase (FfMacSchedulerUeTable &table);
+    virtual ~ColumnBase ();
+
+private:
+    friend class FfMacSchedulerUeTable;
+
+    /**
+     * Insert a default value
+     * \param index the index of the new value
+     */
+    virtual void Insert (uint32_t index) = 0;
+    /**
+     * Erase a value
+     * \param index the index of the value
+     */
+    virtual void Erase (uint32_t index) = 0;
+    /// Erase all the values
+    virtual void Clear (void) = 0;
+
+    /// Copying a column is not allowed, since it is registered with a table
+    ColumnBase (const ColumnBase &);
+    /// Copying a column is not allowed, since it is registered with a table
+    /// \return the column
+    ColumnBase& operator= (const ColumnBase &);
+
+    FfMacSchedulerUeTable *m_table; ///< the table
+  };
+
+  /**
+   * A per-UE metric of type T, indexed like the table
+   */
+  template <typename T>
+  class Column : public ColumnBase
+  {
+public:
+    /**
+     * Constructor
+     *
+     * \param table the table, which must outlive the column
+     * \param defaultValue the value of the metric of the UEs added to the table
+     */
+    Column (FfMacSchedulerUeTable &table, const T &defaultValue = T ())
+      : ColumnBase (table),
+        m_values (table.GetN (), defaultValue),
+        m_defaultValue (defaultValue)
+    {
+    }
+
+    /**
+     * \param index the index of a UE in the table
+     * \return the metric of the UE
+     */
+    T& operator[] (uint32_t index)
+    {
+      return m_values[index];
+    }
+
+    /**
+     * \param index the index of a UE in the table
+     * \return the metric of the UE
+     */
+    const T& operator[] (uint32_t index) const
+    {
+      return m_values[index];
+    }
+
+    /**
+     * Set the metric of all the UEs
+     * \param value the value of the metric
+     */
+    void Fill (const T &value)
+    {
+      m_values.assign (m_values.size (), value);
+    }
+
+private:
+    virtual void Insert (uint32_t index)
+    {
+      m_values.insert (m_values.begin () + index, m_defaultValue);
+    }
+    virtual void Erase (uint32_t index)
+    {
+      m_values.erase (m_values.begin () + index);
+    }
+    virtual void Clear (void)
+    {
+      m_values.clear ();
+    }
+
+    std::vector<T> m_values; ///< the values, indexed like the table
+    T m_defaultValue;        ///< the value of the new UEs
+  };
+
+  FfMacSchedulerUeTable ();
+  ~FfMacSchedulerUeTable ();
+
+  /**
+   * Add a UE, if not already in the table; the columns get their default
+   * value for the new UE.
+   *
+   * \param rnti the RNTI of the UE
+   * \return the index of the UE
+   */
+  uint32_t Add (uint16_t rnti);
+
+  /**
+   * Remove a UE, if in the table; the UEs following it are shifted.
+   *
+   * \param rnti the RNTI of the UE
+   */
+  void Remove (uint16_t rnti);
+
+  /// Remove all the UEs
+  void Clear (void);
+
+  /**
+   * \param rnti the RNTI of a UE
+   * \return the index of the UE, or NOT_FOUND
+   */
+  uint32_t Find (uint16_t rnti) const
+  {
+    return (rnti < m_indices.size ()) ? m_indices[rnti] : NOT_FOUND;
+  }
+
+  /**
+   * \param index the index of a UE
+   * \return the RNTI of the UE
+   */
+  uint16_t GetRnti (uint32_t index) const
+  {
+    return m_rntis[index];
+  }
+
+  /**
+   * \return the number of UEs
+   */
+  uint32_t GetN (void) const
+  {
+    return m_rntis.size ();
+  }
+
+private:
+  friend class ColumnBase;
+
+  /**
+   * Update the indices of the UEs starting from the given one
+   * \param first the index of the first UE to update
+   */
+  void UpdateIndices (uint32_t first);
+
+  /// Copying a table is not allowed, since the columns refer to it
+  FfMacSchedulerUeTable (const FfMacSchedulerUeTable &);
+  /// Copying a table is not allowed, since the columns refer to it
+  /// \return the table
+  FfMacSchedulerUeTable& operator= (const FfMacSchedulerUeTable &);
+
+  std::vector<uint16_t> m_rntis;        ///< the RNTIs, in increasing order
+  std::vector<uint32_t> m_indices;      ///< the index of each RNTI, or NOT_FOUND
+  std::vector<ColumnBase *> m_columns;  ///< the registered columns
+};
+
+} // namespace ns3
+
+#endif /* FF_MAC_SCHEDULER_UE_TABLE_H */
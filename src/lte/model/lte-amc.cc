@@ -374,6 +374,10 @@ LteAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
       NS_ASSERT_MSG (rbgSize > 0, " LteAmc-Vienna: RBG size must be greater than 0");
       std::vector <int> rbgMap;
       int rbId = 0;
+      // all the MCSs of all the RBGs are evaluated with the same SINR
+      MiPerRb_t miPerRb;
+      LteMiErrorModel::MapSinrToMi (sinr, miPerRb);
+      HarqProcessInfoList_t harqInfoList;
       for (it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); it++)
       {
         rbgMap.push_back (rbId++);
@@ -383,8 +387,7 @@ LteAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
             TbStats_t tbStats;
             while (mcs <= 28)
               {
-                HarqProcessInfoList_t harqInfoList;
-                tbStats = LteMiErrorModel::GetTbDecodificationStats (sinr, rbgMap, (uint16_t)GetDlTbSizeFromMcs (mcs, rbgSize) / 8, mcs, harqInfoList);
+                tbStats = LteMiErrorModel::GetTbDecodificationStats (miPerRb, rbgMap, (uint16_t)GetDlTbSizeFromMcs (mcs, rbgSize) / 8, mcs, harqInfoList);
                 if (tbStats.tbler > 0.1)
                   {
                     break;
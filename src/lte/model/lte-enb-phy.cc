@@ -36,6 +36,7 @@
 #include "lte-enb-net-device.h"
 #include "lte-ue-rrc.h"
 #include "lte-enb-mac.h"
+#include "lte-subframe-driver.h"
 #include <ns3/lte-common.h>
 #include <ns3/lte-vendor-specific-parameters.h>
 
@@ -44,6 +45,7 @@
 #include <ns3/node.h>
 #include <ns3/lte-ue-net-device.h>
 #include <ns3/pointer.h>
+#include <ns3/simulation-singleton.h>
 
 namespace ns3 {
 
@@ -775,9 +777,16 @@ LteEnbPhy::StartSubFrame (void)
   // trigger the MAC
   m_enbPhySapUser->SubframeIndication (m_nrFrames, m_nrSubFrames);
 
-  Simulator::Schedule (Seconds (GetTti ()),
-                       &LteEnbPhy::EndSubFrame,
-                       this);
+  if (m_coalescedSubframes)
+    {
+      SimulationSingleton<LteSubframeDriver>::Get ()->ScheduleEnbEndSubFrame (Seconds (GetTti ()), this);
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (GetTti ()),
+                           &LteEnbPhy::EndSubFrame,
+                           this);
+    }
 
 }
 
@@ -50,6 +50,8 @@ class LteEnbPhy : public LtePhy
   friend class EnbMemberLteEnbPhySapProvider;
   /// allow MemberLteEnbCphySapProvider<LteEnbPhy> class friend access
   friend class MemberLteEnbCphySapProvider<LteEnbPhy>;
+  /// allow LteSubframeDriver class friend access
+  friend class LteSubframeDriver;
 
 public:
   /**
@@ -0,0 +1,207 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-config.h"
+#include <ns3/lte-fading-trace.h>
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <fstream>
+#include <cstring>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LteFadingTrace");
+
+/// magic number at the beginning of the binary traces
+static const char g_binaryMagic[8] = {'L', 'T', 'E', 'F', 'A', 'D', 'E', '1'};
+
+/// size of the header of the binary traces
+static const std::size_t g_binaryHeaderSize = sizeof (g_binaryMagic) + 2 * sizeof (uint32_t);
+
+/**
+ * Read a trace in text format, made of one line of samples per RB
+ *
+ * \param fileName the name of the trace file
+ * \param rbNum the number of RBs of the trace
+ * \param samplesNum the number of samples of the trace
+ * \param samples the samples, stored row by row (one row per time sample)
+ */
+static void
+ReadTextTrace (std::string fileName, uint8_t rbNum, uint32_t samplesNum, std::vector<double> &samples)
+{
+  std::ifstream ifTraceFile;
+  ifTraceFile.open (fileName.c_str (), std::ifstream::in);
+  NS_ABORT_MSG_IF (!ifTraceFile.good (), "Fading trace file " << fileName << " not found");
+  samples.assign (static_cast<std::size_t> (rbNum) * samplesNum, 0.0);
+  for (uint32_t i = 0; i < rbNum; i++)
+    {
+      for (uint32_t j = 0; j < samplesNum; j++)
+        {
+          ifTraceFile >> samples[static_cast<std::size_t> (j) * rbNum + i];
+        }
+    }
+  NS_ABORT_MSG_IF (ifTraceFile.fail (), "Fading trace file " << fileName << " has less than "
+                   << (uint32_t) rbNum << " x " << samplesNum << " samples");
+}
+
+
+LteFadingTrace::LteFadingTrace (std::string fileName, uint8_t rbNum, uint32_t samplesNum)
+  : m_fileName (fileName),
+    m_rbNum (rbNum),
+    m_samplesNum (samplesNum),
+    m_samples (0),
+    m_mapAddress (0),
+    m_mapLength (0)
+{
+  NS_LOG_FUNCTION (this << fileName << (uint32_t) rbNum << samplesNum);
+  if (!LoadBinary ())
+    {
+      LoadText ();
+    }
+}
+
+LteFadingTrace::~LteFadingTrace ()
+{
+  NS_LOG_FUNCTION (this);
+  GetTraceMap ().erase (m_fileName);
+#ifdef HAVE_SYS_MMAN_H
+  if (m_mapAddress != 0)
+    {
+      munmap (m_mapAddress, m_mapLength);
+    }
+#endif
+}
+
+LteFadingTrace::TraceMap_t&
+LteFadingTrace::GetTraceMap (void)
+{
+  static TraceMap_t traceMap;
+  return traceMap;
+}
+
+Ptr<const LteFadingTrace>
+LteFadingTrace::Load (std::string fileName, uint8_t rbNum, uint32_t samplesNum)
+{
+  NS_LOG_FUNCTION (fileName << (uint32_t) rbNum << samplesNum);
+  TraceMap_t::iterator it = GetTraceMap ().find (fileName);
+  if (it != GetTraceMap ().end ())
+    {
+      NS_ABORT_MSG_IF (it->second->m_rbNum != rbNum || it->second->m_samplesNum != samplesNum,
+                       "Fading trace " << fileName << " already loaded with a different size");
+      return Ptr<const LteFadingTrace> (it->second);
+    }
+  Ptr<LteFadingTrace> trace = Ptr<LteFadingTrace> (new LteFadingTrace (fileName, rbNum, samplesNum), false);
+  GetTraceMap ().insert (std::make_pair (fileName, PeekPointer (trace)));
+  return trace;
+}
+
+bool
+LteFadingTrace::LoadBinary (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::ifstream ifTraceFile (m_fileName.c_str (), std::ifstream::in | std::ifstream::binary);
+  NS_ABORT_MSG_IF (!ifTraceFile.good (), "Fading trace file " << m_fileName << " not found");
+  char magic[sizeof (g_binaryMagic)];
+  uint32_t rbNum = 0;
+  uint32_t samplesNum = 0;
+  ifTraceFile.read (magic, sizeof (magic));
+  if (!ifTraceFile.good () || std::memcmp (magic, g_binaryMagic, sizeof (magic)) != 0)
+    {
+      return false;
+    }
+  ifTraceFile.read (reinterpret_cast<char *> (&rbNum), sizeof (rbNum));
+  ifTraceFile.read (reinterpret_cast<char *> (&samplesNum), sizeof (samplesNum));
+  NS_ABORT_MSG_IF (!ifTraceFile.good (), "Truncated fading trace file " << m_fileName);
+  NS_ABORT_MSG_IF (rbNum != m_rbNum || samplesNum != m_samplesNum,
+                   "Fading trace file " << m_fileName << " has " << rbNum << " RBs and " << samplesNum
+                   << " samples, " << (uint32_t) m_rbNum << " RBs and " << m_samplesNum << " samples expected");
+  std::size_t samplesSize = static_cast<std::size_t> (m_rbNum) * m_samplesNum * sizeof (double);
+  ifTraceFile.seekg (0, std::ifstream::end);
+  NS_ABORT_MSG_IF (static_cast<std::size_t> (ifTraceFile.tellg ()) != g_binaryHeaderSize + samplesSize,
+                   "Fading trace file " << m_fileName << " has an unexpected size");
+
+#ifdef HAVE_SYS_MMAN_H
+  int fd = open (m_fileName.c_str (), O_RDONLY);
+  if (fd >= 0)
+    {
+      m_mapLength = g_binaryHeaderSize + samplesSize;
+      void *address = mmap (0, m_mapLength, PROT_READ, MAP_SHARED, fd, 0);
+      close (fd);
+      if (address != MAP_FAILED)
+        {
+          NS_LOG_LOGIC (this << " mapped " << m_mapLength << " bytes");
+          m_mapAddress = address;
+          m_samples = reinterpret_cast<const double *> (static_cast<const char *> (address) + g_binaryHeaderSize);
+          return true;
+        }
+    }
+  m_mapLength = 0;
+#endif
+
+  // mmap is not available: read the samples
+  m_buffer.resize (static_cast<std::size_t> (m_rbNum) * m_samplesNum);
+  ifTraceFile.seekg (g_binaryHeaderSize, std::ifstream::beg);
+  ifTraceFile.read (reinterpret_cast<char *> (m_buffer.data ()), samplesSize);
+  NS_ABORT_MSG_IF (!ifTraceFile.good (), "Error reading fading trace file " << m_fileName);
+  m_samples = m_buffer.data ();
+  return true;
+}
+
+void
+LteFadingTrace::LoadText (void)
+{
+  NS_LOG_FUNCTION (this);
+  ReadTextTrace (m_fileName, m_rbNum, m_samplesNum, m_buffer);
+  m_samples = m_buffer.data ();
+}
+
+void
+LteFadingTrace::WriteBinary (std::string textFileName, std::string binaryFileName, uint8_t rbNum, uint32_t samplesNum)
+{
+  NS_LOG_FUNCTION (textFileName << binaryFileName << (uint32_t) rbNum << samplesNum);
+  std::vector<double> samples;
+  ReadTextTrace (textFileName, rbNum, samplesNum, samples);
+
+  std::ofstream ofTraceFile (binaryFileName.c_str (), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+  NS_ABORT_MSG_IF (!ofTraceFile.good (), "Cannot open " << binaryFileName << " for writing");
+  uint32_t rbNum32 = rbNum;
+  ofTraceFile.write (g_binaryMagic, sizeof (g_binaryMagic));
+  ofTraceFile.write (reinterpret_cast<const char *> (&rbNum32), sizeof (rbNum32));
+  ofTraceFile.write (reinterpret_cast<const char *> (&samplesNum), sizeof (samplesNum));
+  ofTraceFile.write (reinterpret_cast<const char *> (samples.data ()), samples.size () * sizeof (double));
+  NS_ABORT_MSG_IF (!ofTraceFile.good (), "Error writing " << binaryFileName);
+}
+
+uint8_t
+LteFadingTrace::GetRbNum (void) const
+{
+  return m_rbNum;
+}
+
+uint32_t
+LteFadingTrace::GetSamplesNum (void) const
+{
+  return m_samplesNum;
+}
+
+} // namespace ns3
@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_FADING_TRACE_H
+#define LTE_FADING_TRACE_H
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/ptr.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * \brief Fading trace shared by all the TraceFadingLossModel instances
+ * using the same trace file.
+ *
+ * The trace holds, for each time sample, the fading in dB of every RB.
+ * The samples of a given time are stored contiguously, so that the fading
+ * of all the RBs of a signal is read from a single row.
+ *
+ * Two file formats are supported:
+ * - the text format generated by fading_trace_generator.m, made of one
+ *   line of samples per RB. It is parsed and transposed in memory.
+ * - the binary format written by WriteBinary, made of a header (the
+ *   8 bytes magic "LTEFADE1", the number of RBs and the number of samples
+ *   as uint32_t) followed by the samples as double, row by row, in the
+ *   byte order of the host which wrote them. Where mmap is available, the
+ *   file is mapped read-only and its pages are loaded on first access.
+ *
+ * The traces are cached by file name: loading a file which is already
+ * loaded returns the same instance, which is released when its last user
+ * releases it.
+ */
+class LteFadingTrace : public SimpleRefCount<LteFadingTrace>
+{
+public:
+  ~LteFadingTrace ();
+
+  /**
+   * Get the trace stored in a file, loading it if no other user holds it
+   *
+   * \param fileName the name of the trace file (text or binary format)
+   * \param rbNum the number of RBs of the trace
+   * \param samplesNum the number of samples of the trace
+   * \return the trace
+   */
+  static Ptr<const LteFadingTrace> Load (std::string fileName, uint8_t rbNum, uint32_t samplesNum);
+
+  /**
+   * Convert a trace in text format into the binary format
+   *
+   * \param textFileName the name of the trace file in text format
+   * \param binaryFileName the name of the binary file to write
+   * \param rbNum the number of RBs of the trace
+   * \param samplesNum the number of samples of the trace
+   */
+  static void WriteBinary (std::string textFileName, std::string binaryFileName, uint8_t rbNum, uint32_t samplesNum);
+
+  /**
+   * \return the number of RBs of the trace
+   */
+  uint8_t GetRbNum (void) const;
+
+  /**
+   * \return the number of samples of the trace
+   */
+  uint32_t GetSamplesNum (void) const;
+
+  /**
+   * \param index the index of the time sample
+   * \return a pointer to the fading values in dB of the RBs at that time
+   */
+  const double* GetSample (uint32_t index) const
+  {
+    return m_samples + static_cast<std::size_t> (index) * m_rbNum;
+  }
+
+private:
+  /**
+   * Constructor
+   * \param fileName the name of the trace file
+   * \param rbNum the number of RBs of the trace
+   * \param samplesNum the number of samples of the trace
+   */
+  LteFadingTrace (std::string fileName, uint8_t rbNum, uint32_t samplesNum);
+
+  /**
+   * Load a trace in binary format
+   * \return true if the file is in binary format
+   */
+  bool LoadBinary (void);
+
+  /// Load a trace in text format
+  void LoadText (void);
+
+  /// map of the loaded traces, indexed by file name
+  typedef std::map<std::string, LteFadingTrace*> TraceMap_t;
+
+  /**
+   * \return the map of the loaded traces
+   */
+  static TraceMap_t& GetTraceMap (void);
+
+  std::string m_fileName; ///< the trace file name
+  uint8_t m_rbNum; ///< number of RBs
+  uint32_t m_samplesNum; ///< number of samples
+  const double *m_samples; ///< first sample of the trace
+  std::vector<double> m_buffer; ///< the samples, when the file is not mapped
+  void *m_mapAddress; ///< address of the mapped file, if any
+  std::size_t m_mapLength; ///< length of the mapped file
+};
+
+} // namespace ns3
+
+#endif /* LTE_FADING_TRACE_H */
@@ -53,6 +53,8 @@ LteInterference::DoDispose ()
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_interf = 0;
+  m_sinr = 0;
   Object::DoDispose ();
 } 
 
@@ -188,9 +190,16 @@ LteInterference::ConditionallyEvaluateChunk ()
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
 
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
+      // interf = allSignals - rxSignal + noise and sinr = rxSignal / interf,
+      // computed in place so that no SpectrumValue is allocated
+      SpectrumValue& interf = *m_interf;
+      interf = *m_allSignals;
+      interf -= *m_rxSignal;
+      interf += *m_noise;
 
-      SpectrumValue sinr = (*m_rxSignal) / interf;
+      SpectrumValue& sinr = *m_sinr;
+      sinr = *m_rxSignal;
+      sinr /= interf;
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<LteChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
         {
@@ -217,6 +226,8 @@ LteInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noisePsd
   // reset m_allSignals (will reset if already set previously)
   // this is needed since this method can potentially change the SpectrumModel
   m_allSignals = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  m_interf = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  m_sinr = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
   if (m_receiving == true)
     {
       // abort rx
@@ -331,90 +331,179 @@ static const double cEcrTable [9][38] = {
 };
 
 
+/// scaling coefficient of the uniformly spaced SINR axis of the QPSK MI map
+static const double scalingCoeffQpsk =
+  (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
+/// scaling coefficient of the uniformly spaced SINR axis of the 16-QAM MI map
+static const double scalingCoeff16qam =
+  (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
+/// scaling coefficient of the uniformly spaced SINR axis of the 64-QAM MI map
+static const double scalingCoeff64qam =
+  (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
+
+/**
+ * Map the SINR of a RB to the MI of a modulation
+ *
+ * \param sinrLin the SINR in linear units
+ * \param miMap the MI map of the modulation
+ * \param miMapAxis the SINR axis of the MI map
+ * \param size the size of the MI map
+ * \param scalingCoeff the scaling coefficient of the SINR axis
+ * \return the MI
+ */
+static inline double
+MapSinrToMiValue (double sinrLin, const double *miMap, const double *miMapAxis, uint16_t size, double scalingCoeff)
+{
+  if (sinrLin > miMapAxis[size - 1])
+    {
+      return 1;
+    }
+  // since the values in the axis are uniformly spaced, we have
+  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+  double sinrIndexDouble = (sinrLin - miMapAxis[0]) * scalingCoeff + 1;
+  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
+  NS_ASSERT_MSG (sinrIndex < size, "MI map out of data");
+  return miMap[sinrIndex];
+}
+
+/**
+ * Map the SINR of all the RBs to the MI of a modulation
+ *
+ * \param sinr the perceived sinrs in the whole bandwidth
+ * \param mi the MI of each RB
+ * \param miMap the MI map of the modulation
+ * \param miMapAxis the SINR axis of the MI map
+ * \param size the size of the MI map
+ * \param scalingCoeff the scaling coefficient of the SINR axis
+ */
+static void
+MapSinrToMiValues (const SpectrumValue& sinr, std::vector<double>& mi,
+                   const double *miMap, const double *miMapAxis, uint16_t size, double scalingCoeff)
+{
+  std::size_t nRbs = sinr.GetSpectrumModel ()->GetNumBands ();
+  mi.resize (nRbs);
+  Values::const_iterator sinrIt = sinr.ConstValuesBegin ();
+  for (std::size_t rb = 0; rb < nRbs; rb++, ++sinrIt)
+    {
+      mi[rb] = MapSinrToMiValue (*sinrIt, miMap, miMapAxis, size, scalingCoeff);
+    }
+}
+
+
 double 
 LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
-  
+
+  const double *miMap;
+  const double *miMapAxis;
+  uint16_t size;
+  double scalingCoeff;
+  if (mcs <= MI_QPSK_MAX_ID) // QPSK
+    {
+      miMap = MI_map_qpsk;
+      miMapAxis = MI_map_qpsk_axis;
+      size = MI_MAP_QPSK_SIZE;
+      scalingCoeff = scalingCoeffQpsk;
+    }
+  else if (mcs <= MI_16QAM_MAX_ID) // 16-QAM
+    {
+      miMap = MI_map_16qam;
+      miMapAxis = MI_map_16qam_axis;
+      size = MI_MAP_16QAM_SIZE;
+      scalingCoeff = scalingCoeff16qam;
+    }
+  else // 64-QAM
+    {
+      miMap = MI_map_64qam;
+      miMapAxis = MI_map_64qam_axis;
+      size = MI_MAP_64QAM_SIZE;
+      scalingCoeff = scalingCoeff64qam;
+    }
+
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  
+  Values::const_iterator sinrIt = sinr.ConstValuesBegin ();
   for (uint32_t i = 0; i < map.size (); i++)
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MI_QPSK_MAX_ID) // QPSK
-        {
+      double sinrLin = sinrIt[map[i]];
+      MI = MapSinrToMiValue (sinrLin, miMap, miMapAxis, size, scalingCoeff);
+      NS_LOG_LOGIC (" RB " << map[i] << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+      MIsum += MI;
+    }
+  MI = MIsum / map.size ();
+  NS_LOG_LOGIC (" MI = " << MI);
+  return MI;
+}
 
-          if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
-            {
-              MI = 1;
-            }
-          else 
-            { 
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-              static const double scalingCoeffQpsk = 
-                (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-              uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
-            }
-        }
-      else
+void
+LteMiErrorModel::MapSinrToMi (const SpectrumValue& sinr, MiPerRb_t& mi)
+{
+  NS_LOG_FUNCTION (sinr);
+  MapSinrToMiValues (sinr, mi.qpsk, MI_map_qpsk, MI_map_qpsk_axis, MI_MAP_QPSK_SIZE, scalingCoeffQpsk);
+  MapSinrToMiValues (sinr, mi.qam16, MI_map_16qam, MI_map_16qam_axis, MI_MAP_16QAM_SIZE, scalingCoeff16qam);
+  MapSinrToMiValues (sinr, mi.qam64, MI_map_64qam, MI_map_64qam_axis, MI_MAP_64QAM_SIZE, scalingCoeff64qam);
+}
+
+double
+LteMiErrorModel::Mib (const MiPerRb_t& mi, const std::vector<int>& map, uint8_t mcs)
+{
+  NS_LOG_FUNCTION (&mi << &map << (uint32_t) mcs);
+  const std::vector<double>& miPerRb = (mcs <= MI_QPSK_MAX_ID) ? mi.qpsk : ((mcs <= MI_16QAM_MAX_ID) ? mi.qam16 : mi.qam64);
+  NS_ASSERT_MSG (!miPerRb.empty (), "MapSinrToMi has not been called");
+  const double *miValues = miPerRb.data ();
+  double MIsum = 0.0;
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      NS_ASSERT (static_cast<std::size_t> (map[i]) < miPerRb.size ());
+      MIsum += miValues[map[i]];
+    }
+  double MI = MIsum / map.size ();
+  NS_LOG_LOGIC (" MI = " << MI);
+  return MI;
+}
+
+
+/**
+ * Parameters b and c of the BLER curves for each CB size of cbMiSizeTable
+ * and each ECR. When a curve is missing for a CB size (negative value in
+ * bEcrTable or cEcrTable), the one of the lowest larger CB size having it is
+ * used, in order to remove the CB size quantization errors.
+ */
+struct BlerCurveParams
+{
+  BlerCurveParams ();
+  double b[9][38]; ///< the b parameters
+  double c[9][38]; ///< the c parameters
+};
+
+BlerCurveParams::BlerCurveParams ()
+{
+  for (int cbIndex = 0; cbIndex < 9; cbIndex++)
+    {
+      for (int ecrId = 0; ecrId < 38; ecrId++)
         {
-          if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+          double bValue = bEcrTable[cbIndex][ecrId];
+          int i = cbIndex;
+          while ((i < 9) && (bValue < 0))
             {
-              if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else 
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam = 
-                    (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
+              bValue = bEcrTable[i++][ecrId];
             }
-          else // 64-QAM
+          b[cbIndex][ecrId] = bValue;
+          double cValue = cEcrTable[cbIndex][ecrId];
+          i = cbIndex;
+          while ((i < 9) && (cValue < 0))
             {
-              if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam = 
-                    (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
+              cValue = cEcrTable[i++][ecrId];
             }
+          c[cbIndex][ecrId] = cValue;
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
-      MIsum += MI;
     }
-  MI = MIsum / map.size ();
-  NS_LOG_LOGIC (" MI = " << MI);
-  return MI;
 }
 
+/// the parameters of the BLER curves, computed once
+static const BlerCurveParams g_blerCurveParams;
+
 
 double 
 LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
@@ -432,28 +521,8 @@ LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
   cbIndex--;
   NS_LOG_LOGIC (" ECRid " << (uint16_t)ecrId << " ECR " << BlerCurvesEcrMap[ecrId] << " CB size " << cbSize << " CB size curve " << cbMiSizeTable[cbIndex]);
 
-  b = bEcrTable[cbIndex][ecrId];
-  if (b<0.0)
-    {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i<9)&&(b<0))
-        {
-          b = bEcrTable[i++][ecrId];
-        }
-    }
-  c = cEcrTable[cbIndex][ecrId];
-  if (c<0.0)
-    {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i<9)&&(c<0))
-        {
-          c = cEcrTable[i++][ecrId];
-        }
-    }
+  b = g_blerCurveParams.b[cbIndex][ecrId];
+  c = g_blerCurveParams.c[cbIndex][ecrId];
   // see IEEE802.16m EMD formula 55 of section 4.3.2.1
   double bler = 0.5*( 1 - erf((mib-b)/(sqrt(2)*c)) );
   NS_LOG_LOGIC ("MIB: " << mib << " BLER:" << bler << " b:" << b << " c:" << c);
@@ -468,30 +537,12 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
   NS_LOG_FUNCTION (sinr);
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  Values::iterator sinrIt = sinrCopy.ValuesBegin ();
+  Values::const_iterator sinrIt = sinr.ConstValuesBegin ();
   uint16_t rb = 0;
-  NS_ASSERT (sinrIt!=sinrCopy.ValuesEnd ());
-  while (sinrIt!=sinrCopy.ValuesEnd ())
+  NS_ASSERT (sinrIt!=sinr.ConstValuesEnd ());
+  while (sinrIt!=sinr.ConstValuesEnd ())
     {
-      double sinrLin = *sinrIt;
-      if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
-        {
-          MI = 1;
-        }
-      else 
-        { 
-          // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-          // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-          static const double scalingCoeffQpsk = 
-            (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-          double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-          uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-          NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-          MI = MI_map_qpsk[sinrIndex];
-        }
+      MI = MapSinrToMiValue (*sinrIt, MI_map_qpsk, MI_map_qpsk_axis, MI_MAP_QPSK_SIZE, scalingCoeffQpsk);
       MIsum += MI;
       sinrIt++;
       rb++;
@@ -554,11 +605,24 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
 
 
 TbStats_t
-LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory)
+LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+  return EvaluateTb (Mib (sinr, map, mcs), size, mcs, miHistory);
+}
+
+TbStats_t
+LteMiErrorModel::GetTbDecodificationStats (const MiPerRb_t& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
+{
+  NS_LOG_FUNCTION (&mi << &map << (uint32_t) size << (uint32_t) mcs);
+  return EvaluateTb (Mib (mi, map, mcs), size, mcs, miHistory);
+}
+
+TbStats_t
+LteMiErrorModel::EvaluateTb (double tbMi, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
+{
+  NS_LOG_FUNCTION (tbMi << (uint32_t) size << (uint32_t) mcs);
 
-  double tbMi = Mib(sinr, map, mcs);
   double MI = 0.0;
   double Reff = 0.0;
   NS_ASSERT (mcs < 29);
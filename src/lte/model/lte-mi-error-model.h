@@ -72,6 +72,19 @@ struct TbStats_t
   double tbler; ///< tbler
   double mi; ///< mi
 };
+
+/**
+ * Mutual information of each RB of a SINR vector for the three
+ * modulations, stored as one array per modulation. It is computed once per
+ * subframe and shared by the evaluation of all the TBs received with that
+ * SINR (see LteMiErrorModel::MapSinrToMi).
+ */
+struct MiPerRb_t
+{
+  std::vector<double> qpsk;  ///< MI of each RB with QPSK
+  std::vector<double> qam16; ///< MI of each RB with 16-QAM
+  std::vector<double> qam64; ///< MI of each RB with 64-QAM
+};
   
 
 
@@ -109,7 +122,37 @@ public:
    * \param miHistory  MI of past transmissions (in case of retx)
    * \return the TB error rate and MI
    */
-  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory);
+  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
+
+  /**
+   * \brief map the SINR of every RB to the mutual information of each
+   * modulation, to evaluate several TBs received with the same SINR
+   * \param sinr the perceived sinrs in the whole bandwidth
+   * \param mi the MI of each RB (the vectors are resized, so that the same
+   * instance can be reused without allocations)
+   */
+  static void MapSinrToMi (const SpectrumValue& sinr, MiPerRb_t& mi);
+
+  /**
+   * \brief find the mmib (mean mutual information per bit) of the specified TB
+   * \param mi the MI of each RB, as returned by MapSinrToMi
+   * \param map the actives RBs for the TB
+   * \param mcs the MCS of the TB
+   * \return the mmib
+   */
+  static double Mib (const MiPerRb_t& mi, const std::vector<int>& map, uint8_t mcs);
+
+  /**
+   * \brief run the error-model algorithm for the specified TB. The result
+   * is the same as the one of the variant taking the SINR vector.
+   * \param mi the MI of each RB, as returned by MapSinrToMi
+   * \param map the actives RBs for the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory  MI of past transmissions (in case of retx)
+   * \return the TB error rate and MI
+   */
+  static TbStats_t GetTbDecodificationStats (const MiPerRb_t& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
   
   /** 
   * \brief run the error-model algorithm for the specified PCFICH+PDCCH channels
@@ -118,10 +161,16 @@ public:
   */  
   static double GetPcfichPdcchError (const SpectrumValue& sinr);
 
-
-//private:
-
-
+private:
+  /**
+   * \brief run the error-model algorithm for a TB whose mmib is known
+   * \param tbMi the mmib of the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory  MI of past transmissions (in case of retx)
+   * \return the TB error rate and MI
+   */
+  static TbStats_t EvaluateTb (double tbMi, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
 
 };
 
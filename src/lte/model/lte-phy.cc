@@ -24,6 +24,7 @@
 #include <ns3/log.h>
 #include <cmath>
 #include <ns3/simulator.h>
+#include <ns3/boolean.h>
 #include "ns3/spectrum-error-model.h"
 #include "lte-phy.h"
 #include "lte-net-device.h"
@@ -50,7 +51,8 @@ LtePhy::LtePhy (Ptr<LteSpectrumPhy> dlPhy, Ptr<LteSpectrumPhy> ulPhy)
     m_rbgSize (0),
     m_macChTtiDelay (0),
     m_cellId (0),
-    m_componentCarrierId(0)
+    m_componentCarrierId(0),
+    m_coalescedSubframes (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -62,6 +64,17 @@ LtePhy::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::LtePhy")
     .SetParent<Object> ()
     .SetGroupName("Lte")
+    .AddAttribute ("CoalescedSubframes",
+                   "If true, the subframes of this PHY are processed by the "
+                   "LteSubframeDriver together with the subframes of all the "
+                   "other PHYs with this attribute set, in one event per step "
+                   "and per TTI, rather than by events scheduled by this PHY. "
+                   "The subframes may then be processed in another order with "
+                   "respect to the other events due at the same time, and in "
+                   "the context of the node of another PHY (see LteSubframeDriver).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LtePhy::m_coalescedSubframes),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
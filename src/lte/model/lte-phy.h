@@ -310,6 +310,12 @@ protected:
   /// component carrier Id used to address sap
   uint8_t m_componentCarrierId;
 
+  /**
+   * Whether the subframes are processed by the LteSubframeDriver. Also
+   * available as attribute `CoalescedSubframes`.
+   */
+  bool m_coalescedSubframes;
+
 }; // end of `class LtePhy`
 
 
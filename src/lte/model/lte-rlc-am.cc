@@ -24,7 +24,6 @@
 
 #include "ns3/lte-rlc-am-header.h"
 #include "ns3/lte-rlc-am.h"
-#include "ns3/lte-rlc-sdu-status-tag.h"
 #include "ns3/lte-rlc-tag.h"
 
 
@@ -41,6 +40,7 @@ LteRlcAm::LteRlcAm ()
 
   // Buffers
   m_txonBufferSize = 0;
+  m_txonBufferFrontOffset = 0;
   m_retxBuffer.resize (1024);
   m_retxBufferSize = 0;
   m_txedBuffer.resize (1024);
@@ -135,6 +135,7 @@ LteRlcAm::DoDispose ()
 
   m_txonBuffer.clear ();
   m_txonBufferSize = 0;
+  m_txonBufferFrontOffset = 0;
   m_txedBuffer.clear ();
   m_txedBufferSize = 0;
   m_retxBuffer.clear ();
@@ -164,10 +165,6 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
 
   /** Store PDCP PDU */
 
-  LteRlcSduStatusTag tag;
-  tag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-  p->AddPacketTag (tag);
-
   NS_LOG_LOGIC ("Txon Buffer: New packet added");
   m_txonBuffer.push_back (p);
   m_txonBufferSize += p->GetSize ();
@@ -421,7 +418,6 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
   //
   //
 
-  Ptr<Packet> packet = Create<Packet> ();
   LteRlcAmHeader rlcAmHeader;
   rlcAmHeader.SetDataPdu ();
 
@@ -432,8 +428,10 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
   uint32_t dataFieldAddedSize = 0;
   std::vector < Ptr<Packet> > dataField;
 
-  // Remove the first packet from the transmission buffer.
-  // If only a segment of the packet is taken, then the remaining is given back later
+  // The Data field is made of byte ranges of the SDUs at the front of the
+  // transmission buffer. An SDU stays in the buffer until its last byte is
+  // sent, m_txonBufferFrontOffset counting the bytes of the first SDU already
+  // sent, so the SDUs are neither copied nor tagged when segmented.
   if ( m_txonBuffer.size () == 0 )
     {
       NS_LOG_LOGIC ("No data pending");
@@ -441,93 +439,56 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
     }
 
   NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txonBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
+  NS_LOG_LOGIC ("First SDU buffer  = " << m_txonBuffer.front ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txonBuffer.front ()->GetSize ());
+  NS_LOG_LOGIC ("First SDU offset  = " << m_txonBufferFrontOffset);
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
-  NS_LOG_LOGIC ("Remove SDU from TxBuffer");
-  Ptr<Packet> firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
-  m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-  NS_LOG_LOGIC ("txBufferSize      = " << m_txonBufferSize );
-  m_txonBuffer.erase (m_txonBuffer.begin ());
 
-  while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
+  // FramingInfo: whether the Data field begins with the first byte of an SDU
+  // and ends with the last byte of an SDU
+  bool firstByte = (m_txonBufferFrontOffset == 0);
+  bool lastByte = false;
+
+  while ( !m_txonBuffer.empty () && (nextSegmentSize > 0) )
     {
-      NS_LOG_LOGIC ("WHILE ( firstSegment && firstSegment->GetSize > 0 && nextSegmentSize > 0 )");
-      NS_LOG_LOGIC ("    firstSegment size = " << firstSegment->GetSize ());
+      Ptr<Packet> sdu = m_txonBuffer.front ();
+      uint32_t firstSegmentSize = sdu->GetSize () - m_txonBufferFrontOffset;
+      NS_LOG_LOGIC ("WHILE ( txonBuffer.size > 0 && nextSegmentSize > 0 )");
+      NS_LOG_LOGIC ("    firstSegment size = " << firstSegmentSize);
       NS_LOG_LOGIC ("    nextSegmentSize   = " << nextSegmentSize);
-      if ( (firstSegment->GetSize () > nextSegmentSize) ||
+      if ( (firstSegmentSize > nextSegmentSize) ||
            // Segment larger than 2047 octets can only be mapped to the end of the Data field
-           (firstSegment->GetSize () > 2047)
+           (firstSegmentSize > 2047)
          )
         {
           // Take the minimum size, due to the 2047-bytes 3GPP exception
           // This exception is due to the length of the LI field (just 11 bits)
-          uint32_t currSegmentSize = std::min (firstSegment->GetSize (), nextSegmentSize);
+          uint32_t currSegmentSize = std::min (firstSegmentSize, nextSegmentSize);
 
           NS_LOG_LOGIC ("    IF ( firstSegment > nextSegmentSize ||");
           NS_LOG_LOGIC ("         firstSegment > 2047 )");
 
-          // Segment txBuffer.FirstBuffer and
-          // Give back the remaining segment to the transmission buffer
-          Ptr<Packet> newSegment = firstSegment->CreateFragment (0, currSegmentSize);
-          NS_LOG_LOGIC ("    newSegment size   = " << newSegment->GetSize ());
-
-          // Status tag of the new and remaining segments
-          // Note: This is the only place where a PDU is segmented and
-          // therefore its status can change
-          LteRlcSduStatusTag oldTag, newTag;
-          firstSegment->RemovePacketTag (oldTag);
-          newSegment->RemovePacketTag (newTag);
-          if (oldTag.GetStatus () == LteRlcSduStatusTag::FULL_SDU)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::FIRST_SEGMENT);
-              oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-          else if (oldTag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::MIDDLE_SEGMENT);
-              //oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-
-          // Give back the remaining segment to the transmission buffer
-          firstSegment->RemoveAtStart (currSegmentSize);
-          NS_LOG_LOGIC ("    firstSegment size (after RemoveAtStart) = " << firstSegment->GetSize ());
-          if (firstSegment->GetSize () > 0)
+          // Add a segment of txBuffer.FirstBuffer to DataField
+          dataField.push_back (sdu->CreateFragment (m_txonBufferFrontOffset, currSegmentSize));
+          m_txonBufferSize -= currSegmentSize;
+          lastByte = (currSegmentSize == firstSegmentSize);
+          if (lastByte)
             {
-              firstSegment->AddPacketTag (oldTag);
-
-              m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
-              m_txonBufferSize += (*(m_txonBuffer.begin()))->GetSize ();
-
-              NS_LOG_LOGIC ("    Txon buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txonBuffer.begin()))->GetSize ());
-              NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBufferSize );
+              // Whole SDU was taken
+              m_txonBuffer.pop_front ();
+              m_txonBufferFrontOffset = 0;
             }
           else
             {
-              // Whole segment was taken, so adjust tag
-              if (newTag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-                }
-              else if (newTag.GetStatus () == LteRlcSduStatusTag::MIDDLE_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-                }
+              // The remaining segment stays in the transmission buffer
+              m_txonBufferFrontOffset += currSegmentSize;
+              NS_LOG_LOGIC ("    Txon buffer: Keep the remaining segment");
+              NS_LOG_LOGIC ("    First SDU offset = " << m_txonBufferFrontOffset);
             }
-          // Segment is completely taken or
-          // the remaining segment is given back to the transmission buffer
-          firstSegment = 0;
-
-          // Put status tag once it has been adjusted
-          newSegment->AddPacketTag (newTag);
+          NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBufferSize );
 
-          // Add Segment to Data field
-          dataFieldAddedSize = newSegment->GetSize ();
+          dataFieldAddedSize = currSegmentSize;
           dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (newSegment);
-          newSegment = 0;
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::DATA_FIELD_FOLLOWS);
@@ -539,19 +500,24 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
 
           // nextSegmentSize MUST be zero (only if segment is smaller or equal to 2047)
 
-          // (NO more segments) ? exit
-          // break;
+          // (NO more segments) → exit
+          break;
         }
-      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) || (m_txonBuffer.size () == 0) )
+
+      // Add (the remaining segment of) txBuffer.FirstBuffer to DataField
+      dataField.push_back ((m_txonBufferFrontOffset == 0) ? sdu : sdu->CreateFragment (m_txonBufferFrontOffset, firstSegmentSize));
+      m_txonBufferSize -= firstSegmentSize;
+      m_txonBuffer.pop_front ();
+      m_txonBufferFrontOffset = 0;
+      lastByte = true;
+      dataFieldAddedSize = firstSegmentSize;
+      dataFieldTotalSize += dataFieldAddedSize;
+      NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBufferSize );
+
+      if ( (nextSegmentSize - firstSegmentSize <= 2) || (m_txonBuffer.size () == 0) )
         {
           NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txonBuffer.size == 0");
 
-          // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
-          dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
-          firstSegment = 0;
-
           // ExtensionBit (Next_Segment - 1) = 0
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::DATA_FIELD_FOLLOWS);
 
@@ -560,52 +526,32 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
           nextSegmentSize -= dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxonBuffer  = " << m_txonBuffer.size ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
           // nextSegmentSize <= 2 (only if txBuffer is not empty)
 
-          // (NO more segments) ? exit
-          // break;
+          // (NO more segments) → exit
+          break;
         }
-      else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 0)
+      else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txonBuffer.size () > 0)
         {
           NS_LOG_LOGIC ("    IF firstSegment < NextSegmentSize && txonBuffer.size > 0");
-          // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
-          dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
 
           // ExtensionBit (Next_Segment - 1) = 1
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::E_LI_FIELDS_FOLLOWS);
 
           // LengthIndicator (Next_Segment)  = txBuffer.FirstBuffer.length()
-          rlcAmHeader.PushLengthIndicator (firstSegment->GetSize ());
+          rlcAmHeader.PushLengthIndicator (firstSegmentSize);
 
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxonBuffer  = " << m_txonBuffer.size ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
-          NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
 
           // (more segments)
-          firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
-          m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-          m_txonBuffer.erase (m_txonBuffer.begin ());
-          NS_LOG_LOGIC ("        txBufferSize = " << m_txonBufferSize );
         }
-
     }
 
   //
@@ -620,55 +566,22 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
   NS_ASSERT_MSG(rlcAmHeader.GetSequenceNumber () < m_vtMs, "SN above TX window");
   NS_ASSERT_MSG(rlcAmHeader.GetSequenceNumber () >= m_vtA, "SN below TX window");
 
-  // Calculate FramingInfo flag according the status of the SDUs in the DataField
-  uint8_t framingInfo = 0;
-  std::vector< Ptr<Packet> >::iterator it;
-  it = dataField.begin ();
-
-  // FIRST SEGMENT
-  LteRlcSduStatusTag tag;
-  NS_ASSERT_MSG ((*it)->PeekPacketTag (tag), "LteRlcSduStatusTag is missing");
-  (*it)->PeekPacketTag (tag);
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-       (tag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
-     )
-    {
-      framingInfo |= LteRlcAmHeader::FIRST_BYTE;
-    }
-  else
-    {
-      framingInfo |= LteRlcAmHeader::NO_FIRST_BYTE;
-    }
-
-  // Add all SDUs (in DataField) to the Packet
-  while (it < dataField.end ())
+  // Build RLC PDU with DataField and Header: this is the only copy of the
+  // segments, the first one being copied so that the SDUs are never modified
+  std::vector< Ptr<Packet> >::const_iterator it = dataField.begin ();
+  Ptr<Packet> packet = (*it)->Copy ();
+  NS_LOG_LOGIC ("Adding SDU/segment to packet, length = " << (*it)->GetSize ());
+  for (++it; it != dataField.end (); ++it)
     {
       NS_LOG_LOGIC ("Adding SDU/segment to packet, length = " << (*it)->GetSize ());
-
-      NS_ASSERT_MSG ((*it)->PeekPacketTag (tag), "LteRlcSduStatusTag is missing");
-      (*it)->RemovePacketTag (tag);
-      if (packet->GetSize () > 0)
-        {
-          packet->AddAtEnd (*it);
-        }
-      else
-        {
-          packet = (*it);
-        }
-      it++;
+      packet->AddAtEnd (*it);
     }
 
-  // LAST SEGMENT (Note: There could be only one and be the first one)
-  it--;
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-        (tag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT) )
-    {
-      framingInfo |= LteRlcAmHeader::LAST_BYTE;
-    }
-  else
-    {
-      framingInfo |= LteRlcAmHeader::NO_LAST_BYTE;
-    }
+  // Calculate FramingInfo flag according the status of the SDUs in the DataField
+  uint8_t framingInfo = 0;
+  framingInfo |= firstByte ? LteRlcAmHeader::FIRST_BYTE : LteRlcAmHeader::NO_FIRST_BYTE;
+  // (Note: There could be only one segment, being the first and the last one)
+  framingInfo |= lastByte ? LteRlcAmHeader::LAST_BYTE : LteRlcAmHeader::NO_LAST_BYTE;
 
   // Set the FramingInfo flag after the calculation
   rlcAmHeader.SetFramingInfo (framingInfo);
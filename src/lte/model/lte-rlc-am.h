@@ -26,6 +26,7 @@
 #include <ns3/lte-rlc.h>
 
 #include <vector>
+#include <deque>
 #include <map>
 
 namespace ns3 {
@@ -112,7 +113,7 @@ private:
   void DoReportBufferStatus ();
 
 private:
-    std::vector < Ptr<Packet> > m_txonBuffer; ///< Transmission buffer
+    std::deque < Ptr<Packet> > m_txonBuffer; ///< Transmission buffer
 
     /// RetxPdu structure
     struct RetxPdu
@@ -127,6 +128,7 @@ private:
   std::vector <RetxPdu> m_retxBuffer;  ///< Buffer for PDUs considered for retransmission
 
     uint32_t m_txonBufferSize; ///< transmit on buffer size
+    uint32_t m_txonBufferFrontOffset; ///< bytes of the first SDU of the transmission buffer already sent
     uint32_t m_retxBufferSize; ///< retransmit buffer size
     uint32_t m_txedBufferSize; ///< transmit ed buffer size
 
@@ -23,7 +23,6 @@
 
 #include "ns3/lte-rlc-header.h"
 #include "ns3/lte-rlc-um.h"
-#include "ns3/lte-rlc-sdu-status-tag.h"
 #include "ns3/lte-rlc-tag.h"
 
 namespace ns3 {
@@ -35,6 +34,7 @@ NS_OBJECT_ENSURE_REGISTERED (LteRlcUm);
 LteRlcUm::LteRlcUm ()
   : m_maxTxBufferSize (10 * 1024),
     m_txBufferSize (0),
+    m_txBufferFrontOffset (0),
     m_sequenceNumber (0),
     m_vrUr (0),
     m_vrUx (0),
@@ -94,10 +94,6 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
 
       /** Store PDCP PDU */
 
-      LteRlcSduStatusTag tag;
-      tag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-      p->AddPacketTag (tag);
-
       NS_LOG_LOGIC ("Tx Buffer: New packet added");
       m_txBuffer.push_back (p);
       m_txBufferSize += p->GetSize ();
@@ -135,7 +131,6 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
       return;
     }
 
-  Ptr<Packet> packet = Create<Packet> ();
   LteRlcHeader rlcHeader;
 
   // Build Data field
@@ -145,8 +140,10 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
   uint32_t dataFieldAddedSize = 0;
   std::vector < Ptr<Packet> > dataField;
 
-  // Remove the first packet from the transmission buffer.
-  // If only a segment of the packet is taken, then the remaining is given back later
+  // The Data field is made of byte ranges of the SDUs at the front of the
+  // transmission buffer. An SDU stays in the buffer until its last byte is
+  // sent, m_txBufferFrontOffset counting the bytes of the first SDU already
+  // sent, so the SDUs are neither copied nor tagged when segmented.
   if ( m_txBuffer.size () == 0 )
     {
       NS_LOG_LOGIC ("No data pending");
@@ -154,93 +151,56 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
     }
 
   NS_LOG_LOGIC ("SDUs in TxBuffer  = " << m_txBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
+  NS_LOG_LOGIC ("First SDU buffer  = " << m_txBuffer.front ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txBuffer.front ()->GetSize ());
+  NS_LOG_LOGIC ("First SDU offset  = " << m_txBufferFrontOffset);
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
-  NS_LOG_LOGIC ("Remove SDU from TxBuffer");
-  Ptr<Packet> firstSegment = (*(m_txBuffer.begin ()))->Copy ();
-  m_txBufferSize -= (*(m_txBuffer.begin()))->GetSize ();
-  NS_LOG_LOGIC ("txBufferSize      = " << m_txBufferSize );
-  m_txBuffer.erase (m_txBuffer.begin ());
 
-  while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
+  // FramingInfo: whether the Data field begins with the first byte of an SDU
+  // and ends with the last byte of an SDU
+  bool firstByte = (m_txBufferFrontOffset == 0);
+  bool lastByte = false;
+
+  while ( !m_txBuffer.empty () && (nextSegmentSize > 0) )
     {
-      NS_LOG_LOGIC ("WHILE ( firstSegment && firstSegment->GetSize > 0 && nextSegmentSize > 0 )");
-      NS_LOG_LOGIC ("    firstSegment size = " << firstSegment->GetSize ());
+      Ptr<Packet> sdu = m_txBuffer.front ();
+      uint32_t firstSegmentSize = sdu->GetSize () - m_txBufferFrontOffset;
+      NS_LOG_LOGIC ("WHILE ( txBuffer.size > 0 && nextSegmentSize > 0 )");
+      NS_LOG_LOGIC ("    firstSegment size = " << firstSegmentSize);
       NS_LOG_LOGIC ("    nextSegmentSize   = " << nextSegmentSize);
-      if ( (firstSegment->GetSize () > nextSegmentSize) ||
+      if ( (firstSegmentSize > nextSegmentSize) ||
            // Segment larger than 2047 octets can only be mapped to the end of the Data field
-           (firstSegment->GetSize () > 2047)
+           (firstSegmentSize > 2047)
          )
         {
           // Take the minimum size, due to the 2047-bytes 3GPP exception
           // This exception is due to the length of the LI field (just 11 bits)
-          uint32_t currSegmentSize = std::min (firstSegment->GetSize (), nextSegmentSize);
+          uint32_t currSegmentSize = std::min (firstSegmentSize, nextSegmentSize);
 
           NS_LOG_LOGIC ("    IF ( firstSegment > nextSegmentSize ||");
           NS_LOG_LOGIC ("         firstSegment > 2047 )");
 
-          // Segment txBuffer.FirstBuffer and
-          // Give back the remaining segment to the transmission buffer
-          Ptr<Packet> newSegment = firstSegment->CreateFragment (0, currSegmentSize);
-          NS_LOG_LOGIC ("    newSegment size   = " << newSegment->GetSize ());
-
-          // Status tag of the new and remaining segments
-          // Note: This is the only place where a PDU is segmented and
-          // therefore its status can change
-          LteRlcSduStatusTag oldTag, newTag;
-          firstSegment->RemovePacketTag (oldTag);
-          newSegment->RemovePacketTag (newTag);
-          if (oldTag.GetStatus () == LteRlcSduStatusTag::FULL_SDU)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::FIRST_SEGMENT);
-              oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-          else if (oldTag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT)
+          // Add a segment of txBuffer.FirstBuffer to DataField
+          dataField.push_back (sdu->CreateFragment (m_txBufferFrontOffset, currSegmentSize));
+          m_txBufferSize -= currSegmentSize;
+          lastByte = (currSegmentSize == firstSegmentSize);
+          if (lastByte)
             {
-              newTag.SetStatus (LteRlcSduStatusTag::MIDDLE_SEGMENT);
-              //oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-
-          // Give back the remaining segment to the transmission buffer
-          firstSegment->RemoveAtStart (currSegmentSize);
-          NS_LOG_LOGIC ("    firstSegment size (after RemoveAtStart) = " << firstSegment->GetSize ());
-          if (firstSegment->GetSize () > 0)
-            {
-              firstSegment->AddPacketTag (oldTag);
-
-              m_txBuffer.insert (m_txBuffer.begin (), firstSegment);
-              m_txBufferSize += (*(m_txBuffer.begin()))->GetSize ();
-
-              NS_LOG_LOGIC ("    TX buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    TX buffers = " << m_txBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txBuffer.begin()))->GetSize ());
-              NS_LOG_LOGIC ("    txBufferSize = " << m_txBufferSize );
+              // Whole SDU was taken
+              m_txBuffer.pop_front ();
+              m_txBufferFrontOffset = 0;
             }
           else
             {
-              // Whole segment was taken, so adjust tag
-              if (newTag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-                }
-              else if (newTag.GetStatus () == LteRlcSduStatusTag::MIDDLE_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-                }
+              // The remaining segment stays in the transmission buffer
+              m_txBufferFrontOffset += currSegmentSize;
+              NS_LOG_LOGIC ("    TX buffer: Keep the remaining segment");
+              NS_LOG_LOGIC ("    First SDU offset = " << m_txBufferFrontOffset);
             }
-          // Segment is completely taken or
-          // the remaining segment is given back to the transmission buffer
-          firstSegment = 0;
+          NS_LOG_LOGIC ("    txBufferSize = " << m_txBufferSize );
 
-          // Put status tag once it has been adjusted
-          newSegment->AddPacketTag (newTag);
-
-          // Add Segment to Data field
-          dataFieldAddedSize = newSegment->GetSize ();
+          dataFieldAddedSize = currSegmentSize;
           dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (newSegment);
-          newSegment = 0;
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcHeader.PushExtensionBit (LteRlcHeader::DATA_FIELD_FOLLOWS);
@@ -253,16 +213,22 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
           // nextSegmentSize MUST be zero (only if segment is smaller or equal to 2047)
 
           // (NO more segments) → exit
-          // break;
+          break;
         }
-      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) || (m_txBuffer.size () == 0) )
+
+      // Add (the remaining segment of) txBuffer.FirstBuffer to DataField
+      dataField.push_back ((m_txBufferFrontOffset == 0) ? sdu : sdu->CreateFragment (m_txBufferFrontOffset, firstSegmentSize));
+      m_txBufferSize -= firstSegmentSize;
+      m_txBuffer.pop_front ();
+      m_txBufferFrontOffset = 0;
+      lastByte = true;
+      dataFieldAddedSize = firstSegmentSize;
+      dataFieldTotalSize += dataFieldAddedSize;
+      NS_LOG_LOGIC ("    txBufferSize = " << m_txBufferSize );
+
+      if ( (nextSegmentSize - firstSegmentSize <= 2) || (m_txBuffer.size () == 0) )
         {
           NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txBuffer.size == 0");
-          // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
-          dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
-          firstSegment = 0;
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcHeader.PushExtensionBit (LteRlcHeader::DATA_FIELD_FOLLOWS);
@@ -273,105 +239,51 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId,
           nextSegmentId++;
 
           NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.size ());
-          if (m_txBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
-            }
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
           // nextSegmentSize <= 2 (only if txBuffer is not empty)
 
           // (NO more segments) → exit
-          // break;
+          break;
         }
       else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 0)
         {
           NS_LOG_LOGIC ("    IF firstSegment < NextSegmentSize && txBuffer.size > 0");
-          // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
-          dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
 
           // ExtensionBit (Next_Segment - 1) = 1
           rlcHeader.PushExtensionBit (LteRlcHeader::E_LI_FIELDS_FOLLOWS);
 
           // LengthIndicator (Next_Segment)  = txBuffer.FirstBuffer.length()
-          rlcHeader.PushLengthIndicator (firstSegment->GetSize ());
+          rlcHeader.PushLengthIndicator (firstSegmentSize);
 
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
           NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.size ());
-          if (m_txBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
-            }
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
-          NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
 
           // (more segments)
-          firstSegment = (*(m_txBuffer.begin ()))->Copy ();
-          m_txBufferSize -= (*(m_txBuffer.begin()))->GetSize ();
-          m_txBuffer.erase (m_txBuffer.begin ());
-          NS_LOG_LOGIC ("        txBufferSize = " << m_txBufferSize );
         }
-
     }
 
   // Build RLC header
   rlcHeader.SetSequenceNumber (m_sequenceNumber++);
 
-  // Build RLC PDU with DataField and Header
-  std::vector< Ptr<Packet> >::iterator it;
-  it = dataField.begin ();
-
-  uint8_t framingInfo = 0;
-
-  // FIRST SEGMENT
-  LteRlcSduStatusTag tag;
-  NS_ASSERT_MSG ((*it)->PeekPacketTag (tag), "LteRlcSduStatusTag is missing");
-  (*it)->PeekPacketTag (tag);
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-        (tag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT) )
-    {
-      framingInfo |= LteRlcHeader::FIRST_BYTE;
-    }
-  else
-    {
-      framingInfo |= LteRlcHeader::NO_FIRST_BYTE;
-    }
-
-  while (it < dataField.end ())
+  // Build RLC PDU with DataField and Header: this is the only copy of the
+  // segments, the first one being copied so that the SDUs are never modified
+  std::vector< Ptr<Packet> >::const_iterator it = dataField.begin ();
+  Ptr<Packet> packet = (*it)->Copy ();
+  NS_LOG_LOGIC ("Adding SDU/segment to packet, length = " << (*it)->GetSize ());
+  for (++it; it != dataField.end (); ++it)
     {
       NS_LOG_LOGIC ("Adding SDU/segment to packet, length = " << (*it)->GetSize ());
-
-      NS_ASSERT_MSG ((*it)->PeekPacketTag (tag), "LteRlcSduStatusTag is missing");
-      (*it)->RemovePacketTag (tag);
-      if (packet->GetSize () > 0)
-        {
-          packet->AddAtEnd (*it);
-        }
-      else
-        {
-          packet = (*it);
-        }
-      it++;
-    }
-
-  // LAST SEGMENT (Note: There could be only one and be the first one)
-  it--;
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-        (tag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT) )
-    {
-      framingInfo |= LteRlcHeader::LAST_BYTE;
-    }
-  else
-    {
-      framingInfo |= LteRlcHeader::NO_LAST_BYTE;
+      packet->AddAtEnd (*it);
     }
 
+  uint8_t framingInfo = 0;
+  framingInfo |= firstByte ? LteRlcHeader::FIRST_BYTE : LteRlcHeader::NO_FIRST_BYTE;
+  // (Note: There could be only one segment, being the first and the last one)
+  framingInfo |= lastByte ? LteRlcHeader::LAST_BYTE : LteRlcHeader::NO_LAST_BYTE;
   rlcHeader.SetFramingInfo (framingInfo);
 
   NS_LOG_LOGIC ("RLC header: " << rlcHeader);
@@ -26,6 +26,7 @@
 
 #include <ns3/event-id.h>
 #include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -102,7 +103,8 @@ private:
 private:
   uint32_t m_maxTxBufferSize; ///< maximum transmit buffer status
   uint32_t m_txBufferSize; ///< transmit buffer size
-  std::vector < Ptr<Packet> > m_txBuffer;       ///< Transmission buffer
+  uint32_t m_txBufferFrontOffset; ///< bytes of the first SDU of the transmission buffer already sent
+  std::deque < Ptr<Packet> > m_txBuffer;        ///< Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; ///< Reception buffer
   std::vector < Ptr<Packet> > m_reasBuffer;     ///< Reassembling buffer
 
@@ -1213,6 +1213,42 @@ LteSpectrumPhy::SetCellId (uint16_t cellId)
   m_cellId = cellId;
 }
 
+bool
+LteSpectrumPhy::IsInterferenceOnly (Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiver)
+{
+  Ptr<const LteSpectrumPhy> ltePhy = DynamicCast<const LteSpectrumPhy> (receiver);
+  if (ltePhy == 0)
+    {
+      return false;
+    }
+  uint16_t cellId;
+  Ptr<const LteSpectrumSignalParametersDataFrame> lteDataParams = DynamicCast<const LteSpectrumSignalParametersDataFrame> (params);
+  Ptr<const LteSpectrumSignalParametersDlCtrlFrame> lteDlCtrlParams = DynamicCast<const LteSpectrumSignalParametersDlCtrlFrame> (params);
+  Ptr<const LteSpectrumSignalParametersUlSrsFrame> lteUlSrsParams = DynamicCast<const LteSpectrumSignalParametersUlSrsFrame> (params);
+  if (lteDataParams != 0)
+    {
+      cellId = lteDataParams->cellId;
+    }
+  else if (lteDlCtrlParams != 0)
+    {
+      if (lteDlCtrlParams->pss)
+        {
+          // the PSS is used for cell search and UE measurements
+          return false;
+        }
+      cellId = lteDlCtrlParams->cellId;
+    }
+  else if (lteUlSrsParams != 0)
+    {
+      cellId = lteUlSrsParams->cellId;
+    }
+  else
+    {
+      return false;
+    }
+  return cellId != ltePhy->m_cellId;
+}
+
 void
 LteSpectrumPhy::SetComponentCarrierId (uint8_t componentCarrierId)
 {
@@ -333,6 +333,20 @@ public:
    */
   void SetCellId (uint16_t cellId);
 
+  /**
+   * Tell whether a signal is only interference for a receiver, i.e.,
+   * whether it is a data frame, a DL control frame without PSS or an UL SRS
+   * frame of a cell other than the one of the receiving LteSpectrumPhy.
+   * This function can be used as the
+   * MultiModelSpectrumChannel::InterferenceOnlyCallback, since these
+   * signals only contribute to the interference of the receiver.
+   *
+   * \param params the parameters of the signal
+   * \param receiver the receiver
+   * \return true if the signal is only interference for the receiver
+   */
+  static bool IsInterferenceOnly (Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiver);
+
   /**
    *
    * \param componentCarrierId the component carrier id
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lte-subframe-driver.h"
+#include <ns3/simulator.h>
+#include <ns3/log.h>
+#include <ns3/lte-enb-phy.h>
+#include <ns3/lte-ue-phy.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LteSubframeDriver");
+
+LteSubframeDriver::LteSubframeDriver ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LteSubframeDriver::~LteSubframeDriver ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LteSubframeDriver::ScheduleUeSubframe (Time delay, LteUePhy *phy, uint32_t frameNo, uint32_t subframeNo)
+{
+  NS_LOG_FUNCTION (this << delay << phy << frameNo << subframeNo);
+  Time time = Simulator::Now () + delay;
+  std::map<Time, std::vector<UeSubframe> >::iterator it = m_ueSubframes.find (time);
+  if (it == m_ueSubframes.end ())
+    {
+      it = m_ueSubframes.insert (std::make_pair (time, std::vector<UeSubframe> ())).first;
+      Simulator::Schedule (delay, &LteSubframeDriver::UeSubframeIndication, this, time);
+    }
+  UeSubframe subframe;
+  subframe.phy = phy;
+  subframe.frameNo = frameNo;
+  subframe.subframeNo = subframeNo;
+  it->second.push_back (subframe);
+}
+
+void
+LteSubframeDriver::ScheduleEnbEndSubFrame (Time delay, LteEnbPhy *phy)
+{
+  NS_LOG_FUNCTION (this << delay << phy);
+  Time time = Simulator::Now () + delay;
+  std::map<Time, std::vector<LteEnbPhy *> >::iterator it = m_enbEndSubFrames.find (time);
+  if (it == m_enbEndSubFrames.end ())
+    {
+      it = m_enbEndSubFrames.insert (std::make_pair (time, std::vector<LteEnbPhy *> ())).first;
+      Simulator::Schedule (delay, &LteSubframeDriver::EnbEndSubFrame, this, time);
+    }
+  it->second.push_back (phy);
+}
+
+void
+LteSubframeDriver::UeSubframeIndication (Time time)
+{
+  NS_LOG_FUNCTION (this << time);
+  // the PHYs schedule their next subframe while the list is processed
+  std::vector<UeSubframe> subframes;
+  subframes.swap (m_ueSubframes[time]);
+  m_ueSubframes.erase (time);
+  for (std::vector<UeSubframe>::const_iterator it = subframes.begin (); it != subframes.end (); ++it)
+    {
+      it->phy->SubframeIndication (it->frameNo, it->subframeNo);
+    }
+}
+
+void
+LteSubframeDriver::EnbEndSubFrame (Time time)
+{
+  NS_LOG_FUNCTION (this << time);
+  std::vector<LteEnbPhy *> phys;
+  phys.swap (m_enbEndSubFrames[time]);
+  m_enbEndSubFrames.erase (time);
+  std::vector<LteEnbPhy *> startSubFrame;
+  std::vector<LteEnbPhy *> endFrame;
+  for (std::vector<LteEnbPhy *>::const_iterator it = phys.begin (); it != phys.end (); ++it)
+    {
+      if ((*it)->m_nrSubFrames == 10)
+        {
+          endFrame.push_back (*it);
+        }
+      else
+        {
+          startSubFrame.push_back (*it);
+        }
+    }
+  if (!startSubFrame.empty ())
+    {
+      Simulator::ScheduleNow (&LteSubframeDriver::EnbStartSubFrame, this, startSubFrame);
+    }
+  if (!endFrame.empty ())
+    {
+      Simulator::ScheduleNow (&LteSubframeDriver::EnbEndFrame, this, endFrame);
+    }
+}
+
+void
+LteSubframeDriver::EnbStartSubFrame (std::vector<LteEnbPhy *> phys)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<LteEnbPhy *>::const_iterator it = phys.begin (); it != phys.end (); ++it)
+    {
+      (*it)->StartSubFrame ();
+    }
+}
+
+void
+LteSubframeDriver::EnbEndFrame (std::vector<LteEnbPhy *> phys)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::ScheduleNow (&LteSubframeDriver::EnbStartFrame, this, phys);
+}
+
+void
+LteSubframeDriver::EnbStartFrame (std::vector<LteEnbPhy *> phys)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<LteEnbPhy *>::const_iterator it = phys.begin (); it != phys.end (); ++it)
+    {
+      (*it)->StartFrame ();
+    }
+}
+
+} // namespace ns3
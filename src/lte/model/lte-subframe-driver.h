@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_SUBFRAME_DRIVER_H
+#define LTE_SUBFRAME_DRIVER_H
+
+#include <ns3/nstime.h>
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+class LteEnbPhy;
+class LteUePhy;
+
+/**
+ * \ingroup lte
+ *
+ * Global driver of the subframes of the LteEnbPhy and LteUePhy instances
+ * whose `CoalescedSubframes` attribute is true.
+ *
+ * Without the driver, every PHY schedules its own subframe events each
+ * TTI: LteUePhy::SubframeIndication for a UE, and LteEnbPhy::EndSubFrame,
+ * followed by LteEnbPhy::StartSubFrame (or LteEnbPhy::EndFrame and
+ * LteEnbPhy::StartFrame at the end of a frame) for an eNB. With the
+ * driver, a PHY hands its next subframe to the driver instead, which
+ * processes the subframes of all the PHYs due at the same time in one
+ * event per step, looping over an array of PHYs.
+ *
+ * The steps are the same as without the driver, and the PHYs of each kind
+ * (UE or eNB) are processed in the order in which they would have
+ * scheduled their own events.  The order is otherwise not preserved: the
+ * UE subframes due at a given time are all processed when the first of
+ * them would have been, and so are the eNB subframes.  The UE and eNB
+ * subframes due at the same time, and the other events due at that time
+ * (e.g., the end of the transmissions), may then be processed in another
+ * order than without the driver, and the results may differ.
+ *
+ * The processing of a step also runs in the context of the event in which
+ * the first subframe of the step was handed to the driver, i.e., usually of
+ * the node of the first PHY which used the driver, rather than in the
+ * context of the node of each PHY.  This context is shown in the logs, and
+ * inherited by the events scheduled during the processing.
+ *
+ * The driver is a SimulationSingleton, destroyed by Simulator::Destroy.
+ */
+class LteSubframeDriver
+{
+public:
+  LteSubframeDriver ();
+  ~LteSubframeDriver ();
+
+  /**
+   * Schedule a call to LteUePhy::SubframeIndication
+   *
+   * \param delay the delay after which the subframe starts
+   * \param phy the UE PHY
+   * \param frameNo the frame number
+   * \param subframeNo the subframe number
+   */
+  void ScheduleUeSubframe (Time delay, LteUePhy *phy, uint32_t frameNo, uint32_t subframeNo);
+
+  /**
+   * Schedule the end of the current subframe of an eNB PHY, i.e., a call to
+   * LteEnbPhy::EndSubFrame
+   *
+   * \param delay the delay after which the subframe ends
+   * \param phy the eNB PHY
+   */
+  void ScheduleEnbEndSubFrame (Time delay, LteEnbPhy *phy);
+
+private:
+  /// The next subframe of a UE PHY
+  struct UeSubframe
+  {
+    LteUePhy *phy;       ///< the PHY
+    uint32_t frameNo;    ///< the frame number
+    uint32_t subframeNo; ///< the subframe number
+  };
+
+  /**
+   * Call LteUePhy::SubframeIndication for the UE PHYs due now
+   * \param time the current time
+   */
+  void UeSubframeIndication (Time time);
+
+  /**
+   * End the subframe of the eNB PHYs due now, scheduling their next
+   * subframe or frame like LteEnbPhy::EndSubFrame
+   * \param time the current time
+   */
+  void EnbEndSubFrame (Time time);
+
+  /**
+   * Start a subframe of eNB PHYs, like LteEnbPhy::StartSubFrame
+   * \param phys the eNB PHYs
+   */
+  void EnbStartSubFrame (std::vector<LteEnbPhy *> phys);
+
+  /**
+   * End the frame of eNB PHYs, like LteEnbPhy::EndFrame
+   * \param phys the eNB PHYs
+   */
+  void EnbEndFrame (std::vector<LteEnbPhy *> phys);
+
+  /**
+   * Start a frame of eNB PHYs, like LteEnbPhy::StartFrame
+   * \param phys the eNB PHYs
+   */
+  void EnbStartFrame (std::vector<LteEnbPhy *> phys);
+
+  /// The UE subframes, by start time, in scheduling order
+  std::map<Time, std::vector<UeSubframe> > m_ueSubframes;
+  /// The eNB PHYs whose subframe ends, by end time, in scheduling order
+  std::map<Time, std::vector<LteEnbPhy *> > m_enbEndSubFrames;
+};
+
+} // namespace ns3
+
+#endif /* LTE_SUBFRAME_DRIVER_H */
@@ -37,8 +37,10 @@
 #include "lte-ue-mac.h"
 #include "ff-mac-common.h"
 #include "lte-chunk-processor.h"
+#include "lte-subframe-driver.h"
 #include <ns3/lte-common.h>
 #include <ns3/pointer.h>
+#include <ns3/simulation-singleton.h>
 #include <ns3/boolean.h>
 #include <ns3/lte-ue-power-control.h>
 
@@ -1167,7 +1169,14 @@ LteUePhy::SubframeIndication (uint32_t frameNo, uint32_t subframeNo)
     }
 
   // schedule next subframe indication
-  Simulator::Schedule (Seconds (GetTti ()), &LteUePhy::SubframeIndication, this, frameNo, subframeNo);
+  if (m_coalescedSubframes)
+    {
+      SimulationSingleton<LteSubframeDriver>::Get ()->ScheduleUeSubframe (Seconds (GetTti ()), this, frameNo, subframeNo);
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (GetTti ()), &LteUePhy::SubframeIndication, this, frameNo, subframeNo);
+    }
 }
 
 
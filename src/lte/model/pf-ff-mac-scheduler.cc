@@ -49,7 +49,12 @@ NS_OBJECT_ENSURE_REGISTERED (PfFfMacScheduler);
 
 
 PfFfMacScheduler::PfFfMacScheduler ()
-  : m_cschedSapUser (0),
+  : m_flowStatsDl (m_dlUeTable),
+    m_dlNLayers (m_dlUeTable, 0),
+    m_dlSbCqi (m_dlUeTable, 0),
+    m_dlLcActive (m_dlUeTable, 0),
+    m_dlSchedulable (m_dlUeTable, 0),
+    m_cschedSapUser (0),
     m_schedSapUser (0),
     m_timeWindow (99.0),
     m_nextRntiUl (0)
@@ -203,19 +208,16 @@ PfFfMacScheduler::DoCschedLcConfigReq (const struct FfMacCschedSapProvider::Csch
 {
   NS_LOG_FUNCTION (this << " New LC, rnti: "  << params.m_rnti);
 
-  std::map <uint16_t, pfsFlowPerf_t>::iterator it;
   for (uint16_t i = 0; i < params.m_logicalChannelConfigList.size (); i++)
     {
-      it = m_flowStatsDl.find (params.m_rnti);
-
-      if (it == m_flowStatsDl.end ())
+      if (m_dlUeTable.Find (params.m_rnti) == FfMacSchedulerUeTable::NOT_FOUND)
         {
           pfsFlowPerf_t flowStatsDl;
           flowStatsDl.flowStart = Simulator::Now ();
           flowStatsDl.totalBytesTransmitted = 0;
           flowStatsDl.lastTtiBytesTrasmitted = 0;
           flowStatsDl.lastAveragedThroughput = 1;
-          m_flowStatsDl.insert (std::pair<uint16_t, pfsFlowPerf_t> (params.m_rnti, flowStatsDl));
+          m_flowStatsDl[m_dlUeTable.Add (params.m_rnti)] = flowStatsDl;
           pfsFlowPerf_t flowStatsUl;
           flowStatsUl.flowStart = Simulator::Now ();
           flowStatsUl.totalBytesTransmitted = 0;
@@ -267,7 +269,7 @@ PfFfMacScheduler::DoCschedUeReleaseReq (const struct FfMacCschedSapProvider::Csc
   m_ulHarqCurrentProcessId.erase  (params.m_rnti);
   m_ulHarqProcessesStatus.erase  (params.m_rnti);
   m_ulHarqProcessesDciBuffer.erase  (params.m_rnti);
-  m_flowStatsDl.erase  (params.m_rnti);
+  m_dlUeTable.Remove (params.m_rnti);
   m_flowStatsUl.erase  (params.m_rnti);
   m_ceBsrRxed.erase (params.m_rnti);
   std::map<LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
@@ -920,125 +922,162 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
 
 
 
+  // collect the per-UE inputs of the RBG allocation, which do not change
+  // along the RBG loop
+  std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
+  m_dlLcActive.Fill (0);
+  for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+    {
+      if (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
+          || ((*itBufReq).second.m_rlcRetransmissionQueueSize > 0)
+          || ((*itBufReq).second.m_rlcStatusPduSize > 0))
+        {
+          uint32_t index = m_dlUeTable.Find ((*itBufReq).first.m_rnti);
+          if (index != FfMacSchedulerUeTable::NOT_FOUND)
+            {
+              m_dlLcActive[index]++;
+            }
+        }
+    }
+  for (uint32_t ue = 0; ue < m_dlUeTable.GetN (); ue++)
+    {
+      uint16_t rnti = m_dlUeTable.GetRnti (ue);
+      if (rntiAllocated.find (rnti) != rntiAllocated.end ())
+        {
+          // UE already allocated for HARQ -> drop it
+          NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << rnti);
+          m_dlSchedulable[ue] = false;
+        }
+      else if (!HarqProcessAvailability (rnti))
+        {
+          // UE without HARQ process available -> drop it
+          NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << rnti);
+          m_dlSchedulable[ue] = false;
+        }
+      else
+        {
+          m_dlSchedulable[ue] = true;
+        }
+      std::map <uint16_t,uint8_t>::iterator itTxMode = m_uesTxMode.find (rnti);
+      m_dlNLayers[ue] = (itTxMode == m_uesTxMode.end ()) ? 0 : TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+      std::map <uint16_t,SbMeasResult_s>::iterator itCqi = m_a30CqiRxed.find (rnti);
+      m_dlSbCqi[ue] = (itCqi == m_a30CqiRxed.end ()) ? 0 : &(*itCqi).second;
+    }
+
+  // achievable rate of a layer over one RBG, per CQI
+  double rbgRateForCqi[16];
+  uint8_t mcsForCqi[16];
+  for (uint8_t cqi = 0; cqi < 16; cqi++)
+    {
+      mcsForCqi[cqi] = m_amc->GetMcsFromCqi (cqi);
+      rbgRateForCqi[cqi] = ((m_amc->GetDlTbSizeFromMcs (mcsForCqi[cqi], rbgSize) / 8) / 0.001);   // = TB size / TTI
+    }
+  // no info on the subband -> worst MCS
+  double rbgRateNoCqi = ((m_amc->GetDlTbSizeFromMcs (0, rbgSize) / 8) / 0.001);
+
   for (int i = 0; i < rbgNum; i++)
     {
       NS_LOG_INFO (this << " ALLOCATION for RBG " << i << " of " << rbgNum);
       if (rbgMap.at (i) == false)
         {
-          std::map <uint16_t, pfsFlowPerf_t>::iterator it;
-          std::map <uint16_t, pfsFlowPerf_t>::iterator itMax = m_flowStatsDl.end ();
+          uint32_t ueMax = FfMacSchedulerUeTable::NOT_FOUND;
           double rcqiMax = 0.0;
-          for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+          for (uint32_t ue = 0; ue < m_dlUeTable.GetN (); ue++)
             {
-              if ((m_ffrSapProvider->IsDlRbgAvailableForUe (i, (*it).first)) == false)
+              uint16_t rnti = m_dlUeTable.GetRnti (ue);
+              if ((m_ffrSapProvider->IsDlRbgAvailableForUe (i, rnti)) == false)
                 continue;
 
-              std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it).first);
-              if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it).first)))
+              if (!m_dlSchedulable[ue])
                 {
-                  // UE already allocated for HARQ or without HARQ process available -> drop it
-                  if (itRnti != rntiAllocated.end ())
-                    {
-                      NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it).first);
-                    }
-                  if (!HarqProcessAvailability ((*it).first))
-                    {
-                      NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it).first);
-                    }
                   continue;
                 }
-              std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-              itCqi = m_a30CqiRxed.find ((*it).first);
-              std::map <uint16_t,uint8_t>::iterator itTxMode;
-              itTxMode = m_uesTxMode.find ((*it).first);
-              if (itTxMode == m_uesTxMode.end ())
-                {
-                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
-                }
-              int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-              std::vector <uint8_t> sbCqi;
-              if (itCqi == m_a30CqiRxed.end ())
-                {
-                  for (uint8_t k = 0; k < nLayer; k++)
-                    {
-                      sbCqi.push_back (1);  // start with lowest value
-                    }
-                }
-              else
+              int nLayer = m_dlNLayers[ue];
+              if (nLayer == 0)
                 {
-                  sbCqi = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
+                  NS_FATAL_ERROR ("No Transmission Mode info on user " << rnti);
                 }
-              uint8_t cqi1 = sbCqi.at (0);
-              uint8_t cqi2 = 0;
-              if (sbCqi.size () > 1)
+              uint8_t cqi1 = 1;  // start with lowest value
+              uint8_t cqi2 = (nLayer > 1) ? 1 : 0;
+              const std::vector <uint8_t> *sbCqi = 0;
+              if (m_dlSbCqi[ue] != 0)
                 {
-                  cqi2 = sbCqi.at (1);
+                  sbCqi = &m_dlSbCqi[ue]->m_higherLayerSelected.at (i).m_sbCqi;
+                  cqi1 = sbCqi->at (0);
+                  cqi2 = (sbCqi->size () > 1) ? sbCqi->at (1) : 0;
                 }
 
               if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                 {
-                  if (LcActivePerFlow ((*it).first) > 0)
+                  if (m_dlLcActive[ue] > 0)
                     {
                       // this UE has data to transmit
                       double achievableRate = 0.0;
                       uint8_t mcs = 0;
                       for (uint8_t k = 0; k < nLayer; k++)
                         {
-                          if (sbCqi.size () > k)
+                          if (sbCqi == 0)
+                            {
+                              mcs = mcsForCqi[1];
+                              achievableRate += rbgRateForCqi[1];
+                            }
+                          else if (sbCqi->size () > k)
                             {
-                              mcs = m_amc->GetMcsFromCqi (sbCqi.at (k));
+                              NS_ASSERT_MSG (sbCqi->at (k) <= 15, "CQI must be in [0..15] = " << (uint16_t) sbCqi->at (k));
+                              mcs = mcsForCqi[sbCqi->at (k)];
+                              achievableRate += rbgRateForCqi[sbCqi->at (k)];
                             }
                           else
                             {
                               // no info on this subband -> worst MCS
                               mcs = 0;
+                              achievableRate += rbgRateNoCqi;
                             }
-                          achievableRate += ((m_amc->GetDlTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
                         }
 
-                      double rcqi = achievableRate / (*it).second.lastAveragedThroughput;
-                      NS_LOG_INFO (this << " RNTI " << (*it).first << " MCS " << (uint32_t)mcs << " achievableRate " << achievableRate << " avgThr " << (*it).second.lastAveragedThroughput << " RCQI " << rcqi);
+                      double rcqi = achievableRate / m_flowStatsDl[ue].lastAveragedThroughput;
+                      NS_LOG_INFO (this << " RNTI " << rnti << " MCS " << (uint32_t)mcs << " achievableRate " << achievableRate << " avgThr " << m_flowStatsDl[ue].lastAveragedThroughput << " RCQI " << rcqi);
 
                       if (rcqi > rcqiMax)
                         {
                           rcqiMax = rcqi;
-                          itMax = it;
+                          ueMax = ue;
                         }
                     }
                 }   // end if cqi
-            } // end for m_rlcBufferReq
+            } // end for UEs
 
-          if (itMax == m_flowStatsDl.end ())
+          if (ueMax == FfMacSchedulerUeTable::NOT_FOUND)
             {
               // no UE available for this RB
               NS_LOG_INFO (this << " any UE found");
             }
           else
             {
+              uint16_t rntiMax = m_dlUeTable.GetRnti (ueMax);
               rbgMap.at (i) = true;
               std::map <uint16_t, std::vector <uint16_t> >::iterator itMap;
-              itMap = allocationMap.find ((*itMax).first);
+              itMap = allocationMap.find (rntiMax);
               if (itMap == allocationMap.end ())
                 {
                   // insert new element
                   std::vector <uint16_t> tempMap;
                   tempMap.push_back (i);
-                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > ((*itMax).first, tempMap));
+                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > (rntiMax, tempMap));
                 }
               else
                 {
                   (*itMap).second.push_back (i);
                 }
-              NS_LOG_INFO (this << " UE assigned " << (*itMax).first);
+              NS_LOG_INFO (this << " UE assigned " << rntiMax);
             }
         } // end for RBG free
     } // end for RBGs
 
   // reset TTI stats of users
-  std::map <uint16_t, pfsFlowPerf_t>::iterator itStats;
-  for (itStats = m_flowStatsDl.begin (); itStats != m_flowStatsDl.end (); itStats++)
+  for (uint32_t ue = 0; ue < m_dlUeTable.GetN (); ue++)
     {
-      (*itStats).second.lastTtiBytesTrasmitted = 0;
+      m_flowStatsDl[ue].lastTtiBytesTrasmitted = 0;
     }
 
   // generate the transmission opportunities by grouping the RBGs of the same RNTI and
@@ -1136,7 +1175,6 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
       newDci.m_rbBitmap = rbgMask; // (32 bit bitmap see 7.1.6 of 36.213)
 
       // create the rlc PDUs -> equally divide resources among actives LCs
-      std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
       for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
@@ -1203,12 +1241,11 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
 
       ret.m_buildDataList.push_back (newEl);
       // update UE stats
-      std::map <uint16_t, pfsFlowPerf_t>::iterator it;
-      it = m_flowStatsDl.find ((*itMap).first);
-      if (it != m_flowStatsDl.end ())
+      uint32_t ue = m_dlUeTable.Find ((*itMap).first);
+      if (ue != FfMacSchedulerUeTable::NOT_FOUND)
         {
-          (*it).second.lastTtiBytesTrasmitted = bytesTxed;
-          NS_LOG_INFO (this << " UE total bytes txed " << (*it).second.lastTtiBytesTrasmitted);
+          m_flowStatsDl[ue].lastTtiBytesTrasmitted = bytesTxed;
+          NS_LOG_INFO (this << " UE total bytes txed " << m_flowStatsDl[ue].lastTtiBytesTrasmitted);
 
 
         }
@@ -1224,14 +1261,15 @@ PfFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sched
 
   // update UEs stats
   NS_LOG_INFO (this << " Update UEs statistics");
-  for (itStats = m_flowStatsDl.begin (); itStats != m_flowStatsDl.end (); itStats++)
+  for (uint32_t ue = 0; ue < m_dlUeTable.GetN (); ue++)
     {
-      (*itStats).second.totalBytesTransmitted += (*itStats).second.lastTtiBytesTrasmitted;
+      pfsFlowPerf_t &flowStats = m_flowStatsDl[ue];
+      flowStats.totalBytesTransmitted += flowStats.lastTtiBytesTrasmitted;
       // update average throughput (see eq. 12.3 of Sec 12.3.1.2 of LTE – The UMTS Long Term Evolution, Ed Wiley)
-      (*itStats).second.lastAveragedThroughput = ((1.0 - (1.0 / m_timeWindow)) * (*itStats).second.lastAveragedThroughput) + ((1.0 / m_timeWindow) * (double)((*itStats).second.lastTtiBytesTrasmitted / 0.001));
-      NS_LOG_INFO (this << " UE total bytes " << (*itStats).second.totalBytesTransmitted);
-      NS_LOG_INFO (this << " UE average throughput " << (*itStats).second.lastAveragedThroughput);
-      (*itStats).second.lastTtiBytesTrasmitted = 0;
+      flowStats.lastAveragedThroughput = ((1.0 - (1.0 / m_timeWindow)) * flowStats.lastAveragedThroughput) + ((1.0 / m_timeWindow) * (double)(flowStats.lastTtiBytesTrasmitted / 0.001));
+      NS_LOG_INFO (this << " UE total bytes " << flowStats.totalBytesTransmitted);
+      NS_LOG_INFO (this << " UE average throughput " << flowStats.lastAveragedThroughput);
+      flowStats.lastTtiBytesTrasmitted = 0;
     }
 
   m_schedSapUser->SchedDlConfigInd (ret);
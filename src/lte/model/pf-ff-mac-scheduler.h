@@ -25,6 +25,7 @@
 #include <ns3/ff-mac-csched-sap.h>
 #include <ns3/ff-mac-sched-sap.h>
 #include <ns3/ff-mac-scheduler.h>
+#include <ns3/ff-mac-scheduler-ue-table.h>
 #include <vector>
 #include <map>
 #include <ns3/nstime.h>
@@ -315,9 +316,35 @@ private:
 
 
   /**
-  * Map of UE statistics (per RNTI basis) in downlink
+  * Table of the UEs having a downlink flow
   */
-  std::map <uint16_t, pfsFlowPerf_t> m_flowStatsDl;
+  FfMacSchedulerUeTable m_dlUeTable;
+
+  /**
+  * UE statistics in downlink, indexed like m_dlUeTable
+  */
+  FfMacSchedulerUeTable::Column<pfsFlowPerf_t> m_flowStatsDl;
+
+  /**
+  * Number of layers of each UE, refreshed at each DL TTI (0 if the
+  * transmission mode is unknown)
+  */
+  FfMacSchedulerUeTable::Column<uint8_t> m_dlNLayers;
+
+  /**
+  * A30 CQI of each UE, refreshed at each DL TTI (0 if not received)
+  */
+  FfMacSchedulerUeTable::Column<const SbMeasResult_s *> m_dlSbCqi;
+
+  /**
+  * Number of active LCs of each UE, refreshed at each DL TTI
+  */
+  FfMacSchedulerUeTable::Column<uint16_t> m_dlLcActive;
+
+  /**
+  * Whether each UE can be allocated new data in the current DL TTI
+  */
+  FfMacSchedulerUeTable::Column<uint8_t> m_dlSchedulable;
 
   /**
   * Map of UE statistics (per RNTI basis)
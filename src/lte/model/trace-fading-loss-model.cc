@@ -27,7 +27,6 @@
 #include <ns3/string.h>
 #include <ns3/double.h>
 #include "ns3/uinteger.h"
-#include <fstream>
 #include <ns3/simulator.h>
 
 namespace ns3 {
@@ -48,9 +47,8 @@ TraceFadingLossModel::TraceFadingLossModel ()
 
 TraceFadingLossModel::~TraceFadingLossModel ()
 {
-  m_fadingTrace.clear ();
-  m_windowOffsetsMap.clear ();
-  m_startVariableMap.clear ();
+  m_fadingTrace = 0;
+  m_channelRealizations.clear ();
 }
 
 
@@ -120,28 +118,7 @@ void
 TraceFadingLossModel::LoadTrace ()
 {
   NS_LOG_FUNCTION (this << "Loading Fading Trace " << m_traceFile);
-  std::ifstream ifTraceFile;
-  ifTraceFile.open (m_traceFile.c_str (), std::ifstream::in);
-  m_fadingTrace.clear ();
-  if (!ifTraceFile.good ())
-    {
-      NS_LOG_INFO (this << " File: " << m_traceFile);
-      NS_ASSERT_MSG(ifTraceFile.good (), " Fading trace file not found");
-    }
-
-//   NS_LOG_INFO (this << " length " << m_traceLength.GetSeconds ());
-//   NS_LOG_INFO (this << " RB " << (uint32_t)m_rbNum << " samples " << m_samplesNum);
-  for (uint32_t i = 0; i < m_rbNum; i++)
-    {
-      FadingTraceSample rbTimeFadingTrace;
-      for (uint32_t j = 0; j < m_samplesNum; j++)
-        {
-          double sample;
-          ifTraceFile >> sample;
-          rbTimeFadingTrace.push_back (sample);
-        }
-      m_fadingTrace.push_back (rbTimeFadingTrace);
-    }
+  m_fadingTrace = LteFadingTrace::Load (m_traceFile, m_rbNum, m_samplesNum);
   m_timeGranularity = m_traceLength.GetMilliSeconds () / m_samplesNum;
   m_lastWindowUpdate = Simulator::Now ();
 }
@@ -155,28 +132,26 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
 {
   NS_LOG_FUNCTION (this << *txPsd << a << b);
   
-  std::map <ChannelRealizationId_t, int >::iterator itOff;
+  std::map <ChannelRealizationId_t, ChannelRealization>::iterator itOff;
   ChannelRealizationId_t mobilityPair = std::make_pair (a,b);
-  itOff = m_windowOffsetsMap.find (mobilityPair);
-  if (itOff!=m_windowOffsetsMap.end ())
+  itOff = m_channelRealizations.find (mobilityPair);
+  if (itOff!=m_channelRealizations.end ())
     {
       if (Simulator::Now ().GetSeconds () >= m_lastWindowUpdate.GetSeconds () + m_windowSize.GetSeconds ())
         {
           // update all the offsets
           NS_LOG_INFO ("Fading Windows Updated");
-          std::map <ChannelRealizationId_t, int >::iterator itOff2;
-          for (itOff2 = m_windowOffsetsMap.begin (); itOff2 != m_windowOffsetsMap.end (); itOff2++)
+          std::map <ChannelRealizationId_t, ChannelRealization>::iterator itOff2;
+          for (itOff2 = m_channelRealizations.begin (); itOff2 != m_channelRealizations.end (); itOff2++)
             {
-              std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> >::iterator itVar;
-              itVar = m_startVariableMap.find ((*itOff2).first);
-              (*itOff2).second = (*itVar).second->GetValue ();
+              (*itOff2).second.m_windowOffset = (*itOff2).second.m_startVariable->GetValue ();
             }
           m_lastWindowUpdate = Simulator::Now ();
         }
     }
   else
     {
-      NS_LOG_LOGIC (this << "insert new channel realization, m_windowOffsetMap.size () = " << m_windowOffsetsMap.size ());
+      NS_LOG_LOGIC (this << "insert new channel realization, m_channelRealizations.size () = " << m_channelRealizations.size ());
       Ptr<UniformRandomVariable> startV = CreateObject<UniformRandomVariable> ();
       startV->SetAttribute ("Min", DoubleValue (1.0));
       startV->SetAttribute ("Max", DoubleValue ((m_traceLength.GetSeconds () - m_windowSize.GetSeconds ()) * 1000.0));
@@ -186,9 +161,10 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
           startV->SetStream (m_currentStream);
           m_currentStream += 1;
         }
-      ChannelRealizationId_t mobilityPair = std::make_pair (a,b);
-      m_startVariableMap.insert (std::pair<ChannelRealizationId_t,Ptr<UniformRandomVariable> > (mobilityPair, startV));
-      itOff = m_windowOffsetsMap.insert (std::pair<ChannelRealizationId_t,int> (mobilityPair, startV->GetValue ())).first;
+      ChannelRealization realization;
+      realization.m_startVariable = startV;
+      realization.m_windowOffset = startV->GetValue ();
+      itOff = m_channelRealizations.insert (std::make_pair (mobilityPair, realization)).first;
     }
 
   
@@ -201,18 +177,20 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
   //double speed = std::sqrt (std::pow (aSpeedVector.x-bSpeedVector.x,2) + std::pow (aSpeedVector.y-bSpeedVector.y,2));
 
   NS_LOG_LOGIC (this << *rxPsd);
-  NS_ASSERT (!m_fadingTrace.empty ());
+  NS_ASSERT (m_fadingTrace != 0);
   int now_ms = static_cast<int> (Simulator::Now ().GetMilliSeconds () * m_timeGranularity);
   int lastUpdate_ms = static_cast<int> (m_lastWindowUpdate.GetMilliSeconds () * m_timeGranularity);
-  int index = ((*itOff).second + now_ms - lastUpdate_ms) % m_samplesNum;
+  int index = ((*itOff).second.m_windowOffset + now_ms - lastUpdate_ms) % m_samplesNum;
+  // the fading of all the RBs at this time
+  const double *sample = m_fadingTrace->GetSample (index);
   int subChannel = 0;
   while (vit != rxPsd->ValuesEnd ())
     {
-      NS_ASSERT (subChannel < 100);
+      NS_ASSERT (subChannel < m_rbNum);
       if (*vit != 0.)
         {
-          double fading = m_fadingTrace.at (subChannel).at (index);
-          NS_LOG_INFO (this << " FADING now " << now_ms << " offset " << (*itOff).second << " id " << index << " fading " << fading);
+          double fading = sample[subChannel];
+          NS_LOG_INFO (this << " FADING now " << now_ms << " offset " << (*itOff).second.m_windowOffset << " id " << index << " fading " << fading);
           double power = *vit; // in Watt/Hz
           power = 10 * std::log10 (180000 * power); // in dB
 
@@ -241,15 +219,16 @@ TraceFadingLossModel::AssignStreams (int64_t stream)
   m_streamsAssigned = true;
   m_currentStream = stream;
   m_lastStream = stream + m_streamSetSize - 1;
-  std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> >::iterator itVar;
-  itVar = m_startVariableMap.begin ();
+  std::map <ChannelRealizationId_t, ChannelRealization>::iterator itVar;
+  itVar = m_channelRealizations.begin ();
   // the following loop is for eventually pre-existing ChannelRealization instances
   // note that more instances are expected to be created at run time
-  while (itVar!=m_startVariableMap.end ())
+  while (itVar!=m_channelRealizations.end ())
     {
       NS_ASSERT_MSG (m_currentStream <= m_lastStream, "not enough streams, consider increasing the StreamSetSize attribute");
-      (*itVar).second->SetStream (m_currentStream);
+      (*itVar).second.m_startVariable->SetStream (m_currentStream);
       m_currentStream += 1;
+      ++itVar;
     }
   return m_streamSetSize;
 }
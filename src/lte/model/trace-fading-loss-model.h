@@ -29,6 +29,7 @@
 #include <map>
 #include "ns3/random-variable-stream.h"
 #include <ns3/nstime.h>
+#include <ns3/lte-fading-trace.h>
 
 namespace ns3 {
 
@@ -107,27 +108,20 @@ private:
   void LoadTrace ();
 
 
-   
-  mutable std::map <ChannelRealizationId_t, int > m_windowOffsetsMap; ///< windows offsets map
-  
-  mutable std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> > m_startVariableMap; ///< start variable map
-  
-  /**
-   * Vector with fading samples in time domain (for a fixed RB)
-   */
-  typedef std::vector<double> FadingTraceSample;
-  /**
-   * Vector collecting the time fading traces in the frequency domain (per RB)
-   */
-  typedef std::vector<FadingTraceSample> FadingTrace;
 
+  /// the fading window of a channel realization
+  struct ChannelRealization
+  {
+    int m_windowOffset; ///< offset of the window in the trace, in samples
+    Ptr<UniformRandomVariable> m_startVariable; ///< random variable drawing the window offsets
+  };
+
+  mutable std::map <ChannelRealizationId_t, ChannelRealization> m_channelRealizations; ///< the channel realizations
 
-  
   std::string m_traceFile; ///< the trace file name
-  
-  FadingTrace m_fadingTrace; ///< fading trace
 
-  
+  Ptr<const LteFadingTrace> m_fadingTrace; ///< fading trace, shared with the other instances using the same file
+
   Time m_traceLength; ///< the trace time
   uint32_t m_samplesNum; ///< number of samples
   Time m_windowSize; ///< window size
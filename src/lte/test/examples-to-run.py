@@ -27,6 +27,8 @@ cpp_examples = [
     ("lena-profiling --simTime=0.1 --nUe=2 --nEnb=5 --nFloors=0", "True", "True"),
     ("lena-profiling --simTime=0.1 --nUe=3 --nEnb=6 --nFloors=1", "True", "True"),
     ("lena-rlc-traces", "True", "True"),
+    ("lena-spectrum-value-benchmark --nIterations=1000", "True", "False"),
+    ("lena-ff-mac-scheduler-benchmark --schedulers=ns3::PfFfMacScheduler,ns3::RrFfMacScheduler --bandwidths=25 --nUes=20 --nTtis=50", "True", "False"),
     ("lena-rem", "True", "True"),
     ("lena-rem-sector-antenna", "True", "True"),
     ("lena-simple", "True", "True"),
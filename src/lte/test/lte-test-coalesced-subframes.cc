@@ -0,0 +1,174 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/config.h>
+#include <ns3/boolean.h>
+#include <ns3/node-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/lte-helper.h>
+#include <ns3/lte-common.h>
+#include <ns3/net-device-container.h>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteCoalescedSubframesTest");
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test that the scheduling decisions of several cells are the same
+ * whether their subframes are processed by the LteSubframeDriver or by
+ * events scheduled by each PHY, in a scenario where the different order of
+ * the events due at the same time does not change them.
+ */
+class LteCoalescedSubframesTestCase : public TestCase
+{
+public:
+  LteCoalescedSubframesTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run the simulation
+   * \param coalescedSubframes the CoalescedSubframes attribute of the PHYs
+   * \return the log of the DL and UL scheduling decisions
+   */
+  std::string RunSimulation (bool coalescedSubframes);
+
+  /**
+   * DL scheduling trace sink
+   * \param context the context
+   * \param info the scheduling decision
+   */
+  void DlScheduling (std::string context, DlSchedulingCallbackInfo info);
+
+  /**
+   * UL scheduling trace sink
+   * \param context the context
+   * \param frameNo the frame number
+   * \param subframeNo the subframe number
+   * \param rnti the RNTI
+   * \param mcs the MCS
+   * \param tbsSize the size of the TB
+   * \param componentCarrierId the component carrier ID
+   */
+  void UlScheduling (std::string context, uint32_t frameNo, uint32_t subframeNo, uint16_t rnti,
+                     uint8_t mcs, uint16_t tbsSize, uint8_t componentCarrierId);
+
+  std::ostringstream m_log; ///< the log of the scheduling decisions
+};
+
+LteCoalescedSubframesTestCase::LteCoalescedSubframesTestCase ()
+  : TestCase ("Scheduling with coalesced subframes")
+{
+}
+
+void
+LteCoalescedSubframesTestCase::DlScheduling (std::string context, DlSchedulingCallbackInfo info)
+{
+  m_log << Simulator::Now ().GetMicroSeconds () << " " << context << " DL " << info.frameNo << " " << info.subframeNo
+        << " " << info.rnti << " " << (uint32_t) info.mcsTb1 << " " << info.sizeTb1 << std::endl;
+}
+
+void
+LteCoalescedSubframesTestCase::UlScheduling (std::string context, uint32_t frameNo, uint32_t subframeNo, uint16_t rnti,
+                                             uint8_t mcs, uint16_t tbsSize, uint8_t componentCarrierId)
+{
+  m_log << Simulator::Now ().GetMicroSeconds () << " " << context << " UL " << frameNo << " " << subframeNo
+        << " " << rnti << " " << (uint32_t) mcs << " " << tbsSize << std::endl;
+}
+
+std::string
+LteCoalescedSubframesTestCase::RunSimulation (bool coalescedSubframes)
+{
+  Config::SetDefault ("ns3::LtePhy::CoalescedSubframes", BooleanValue (coalescedSubframes));
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+
+  NodeContainer enbNodes;
+  enbNodes.Create (3);
+  NodeContainer ueNodes;
+  ueNodes.Create (9);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < enbNodes.GetN (); i++)
+    {
+      positionAlloc->Add (Vector (500.0 * i, 0.0, 0.0));
+    }
+  for (uint32_t i = 0; i < ueNodes.GetN (); i++)
+    {
+      positionAlloc->Add (Vector (500.0 * (i % 3) + 40.0 * (i + 1), 30.0, 0.0));
+    }
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  lteHelper->AssignStreams (enbDevs, 1);
+  lteHelper->AssignStreams (ueDevs, 1000);
+  lteHelper->AttachToClosestEnb (ueDevs, enbDevs);
+  lteHelper->ActivateDataRadioBearer (ueDevs, EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
+
+  m_log.str ("");
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/DlScheduling",
+                   MakeCallback (&LteCoalescedSubframesTestCase::DlScheduling, this));
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/UlScheduling",
+                   MakeCallback (&LteCoalescedSubframesTestCase::UlScheduling, this));
+
+  Simulator::Stop (Seconds (0.3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::Reset ();
+  return m_log.str ();
+}
+
+void
+LteCoalescedSubframesTestCase::DoRun (void)
+{
+  std::string reference = RunSimulation (false);
+  NS_TEST_ASSERT_MSG_NE (reference.find (" DL "), std::string::npos, "nothing scheduled in DL");
+  NS_TEST_ASSERT_MSG_NE (reference.find (" UL "), std::string::npos, "nothing scheduled in UL");
+  std::string coalesced = RunSimulation (true);
+  NS_TEST_ASSERT_MSG_EQ (coalesced, reference, "different scheduling with coalesced subframes");
+}
+
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test suite of the LteSubframeDriver.
+ */
+class LteCoalescedSubframesTestSuite : public TestSuite
+{
+public:
+  LteCoalescedSubframesTestSuite ();
+};
+
+LteCoalescedSubframesTestSuite::LteCoalescedSubframesTestSuite ()
+  : TestSuite ("lte-coalesced-subframes", SYSTEM)
+{
+  AddTestCase (new LteCoalescedSubframesTestCase, TestCase::QUICK);
+}
+
+static LteCoalescedSubframesTestSuite g_lteCoalescedSubframesTestSuite; ///< the test suite
@@ -0,0 +1,175 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/uinteger.h>
+#include <ns3/nstime.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/lte-spectrum-value-helper.h>
+#include <ns3/lte-fading-trace.h>
+#include <ns3/trace-fading-loss-model.h>
+#include <fstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteFadingTraceTest");
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test the conversion of a fading trace to the binary format, and
+ * that TraceFadingLossModel computes the same received PSDs with the text
+ * and the binary traces.
+ */
+class LteFadingTraceTestCase : public TestCase
+{
+public:
+  LteFadingTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Compute the received PSD with both fading models and compare them
+   * \param txPsd the transmitted PSD
+   */
+  void CheckRxPsd (Ptr<const SpectrumValue> txPsd);
+
+  /**
+   * Expected value of a sample of the trace
+   * \param rb the RB
+   * \param sample the index of the sample
+   * \return the fading in dB
+   */
+  static double GetExpectedFading (uint32_t rb, uint32_t sample);
+
+  Ptr<TraceFadingLossModel> m_textModel; ///< the fading model using the text trace
+  Ptr<TraceFadingLossModel> m_binaryModel; ///< the fading model using the binary trace
+  Ptr<MobilityModel> m_a; ///< the mobility of the transmitter
+  Ptr<MobilityModel> m_b; ///< the mobility of the receiver
+};
+
+LteFadingTraceTestCase::LteFadingTraceTestCase ()
+  : TestCase ("Conversion of a fading trace to the binary format")
+{
+}
+
+double
+LteFadingTraceTestCase::GetExpectedFading (uint32_t rb, uint32_t sample)
+{
+  return -20.0 + rb * 0.25 + sample * 0.5;
+}
+
+void
+LteFadingTraceTestCase::CheckRxPsd (Ptr<const SpectrumValue> txPsd)
+{
+  Ptr<SpectrumValue> textRxPsd = m_textModel->CalcRxPowerSpectralDensity (txPsd, m_a, m_b);
+  Ptr<SpectrumValue> binaryRxPsd = m_binaryModel->CalcRxPowerSpectralDensity (txPsd, m_a, m_b);
+  for (uint32_t rb = 0; rb < txPsd->GetSpectrumModel ()->GetNumBands (); rb++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((*textRxPsd)[rb], (*binaryRxPsd)[rb], "different fading at " << Simulator::Now ().GetMilliSeconds () << " ms, RB " << rb);
+      NS_TEST_ASSERT_MSG_NE ((*textRxPsd)[rb], (*txPsd)[rb], "no fading at " << Simulator::Now ().GetMilliSeconds () << " ms, RB " << rb);
+    }
+}
+
+void
+LteFadingTraceTestCase::DoRun (void)
+{
+  const uint8_t rbNum = 6;
+  const uint32_t samplesNum = 20;
+  std::string textFileName = CreateTempDirFilename ("fading-trace.fad");
+  std::string binaryFileName = CreateTempDirFilename ("fading-trace.bin");
+
+  // one line of samples per RB
+  std::ofstream textFile (textFileName.c_str ());
+  for (uint32_t rb = 0; rb < rbNum; rb++)
+    {
+      for (uint32_t sample = 0; sample < samplesNum; sample++)
+        {
+          textFile << GetExpectedFading (rb, sample) << " ";
+        }
+      textFile << std::endl;
+    }
+  textFile.close ();
+
+  LteFadingTrace::WriteBinary (textFileName, binaryFileName, rbNum, samplesNum);
+
+  Ptr<const LteFadingTrace> textTrace = LteFadingTrace::Load (textFileName, rbNum, samplesNum);
+  Ptr<const LteFadingTrace> binaryTrace = LteFadingTrace::Load (binaryFileName, rbNum, samplesNum);
+  for (uint32_t sample = 0; sample < samplesNum; sample++)
+    {
+      for (uint32_t rb = 0; rb < rbNum; rb++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (textTrace->GetSample (sample)[rb], GetExpectedFading (rb, sample), "wrong text sample");
+          NS_TEST_ASSERT_MSG_EQ (binaryTrace->GetSample (sample)[rb], GetExpectedFading (rb, sample), "wrong binary sample");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (LteFadingTrace::Load (binaryFileName, rbNum, samplesNum), binaryTrace, "the trace is not shared");
+
+  m_a = CreateObject<ConstantPositionMobilityModel> ();
+  m_b = CreateObject<ConstantPositionMobilityModel> ();
+  m_textModel = CreateObject<TraceFadingLossModel> ();
+  m_binaryModel = CreateObject<TraceFadingLossModel> ();
+  Ptr<TraceFadingLossModel> models[2] = {m_textModel, m_binaryModel};
+  std::string fileNames[2] = {textFileName, binaryFileName};
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      models[i]->SetAttribute ("TraceFilename", StringValue (fileNames[i]));
+      models[i]->SetAttribute ("RbNum", UintegerValue (rbNum));
+      models[i]->SetAttribute ("SamplesNum", UintegerValue (samplesNum));
+      models[i]->SetAttribute ("TraceLength", TimeValue (MilliSeconds (samplesNum)));
+      models[i]->SetAttribute ("WindowSize", TimeValue (MilliSeconds (5)));
+      models[i]->AssignStreams (1);
+      models[i]->Initialize ();
+    }
+
+  Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (LteSpectrumValueHelper::GetSpectrumModel (100, rbNum));
+  (*txPsd) = 1e-16;
+  for (uint32_t ms = 0; ms < 12; ms++)
+    {
+      Simulator::Schedule (MilliSeconds (ms), &LteFadingTraceTestCase::CheckRxPsd, this, txPsd);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_textModel = 0;
+  m_binaryModel = 0;
+}
+
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test suite of the binary fading traces.
+ */
+class LteFadingTraceTestSuite : public TestSuite
+{
+public:
+  LteFadingTraceTestSuite ();
+};
+
+LteFadingTraceTestSuite::LteFadingTraceTestSuite ()
+  : TestSuite ("lte-fading-trace", UNIT)
+{
+  AddTestCase (new LteFadingTraceTestCase, TestCase::QUICK);
+}
+
+static LteFadingTraceTestSuite g_lteFadingTraceTestSuite; ///< the test suite
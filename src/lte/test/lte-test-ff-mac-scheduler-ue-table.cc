@@ -0,0 +1,134 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/ff-mac-scheduler-ue-table.h>
+#include <map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteFfMacSchedulerUeTableTest");
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test that FfMacSchedulerUeTable and its columns behave like a
+ * std::map keyed by RNTI when UEs are added and removed in any order.
+ */
+class LteFfMacSchedulerUeTableTestCase : public TestCase
+{
+public:
+  LteFfMacSchedulerUeTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the table against the reference map
+   * \param table the table
+   * \param column the column
+   * \param reference the reference map
+   */
+  void Check (const FfMacSchedulerUeTable &table, const FfMacSchedulerUeTable::Column<double> &column,
+              const std::map<uint16_t, double> &reference);
+};
+
+LteFfMacSchedulerUeTableTestCase::LteFfMacSchedulerUeTableTestCase ()
+  : TestCase ("Addition and removal of UEs")
+{
+}
+
+void
+LteFfMacSchedulerUeTableTestCase::Check (const FfMacSchedulerUeTable &table, const FfMacSchedulerUeTable::Column<double> &column,
+                                         const std::map<uint16_t, double> &reference)
+{
+  NS_TEST_ASSERT_MSG_EQ (table.GetN (), reference.size (), "wrong number of UEs");
+  uint32_t index = 0;
+  for (std::map<uint16_t, double>::const_iterator it = reference.begin (); it != reference.end (); ++it, ++index)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table.GetRnti (index), it->first, "wrong order of the UEs");
+      NS_TEST_ASSERT_MSG_EQ (table.Find (it->first), index, "wrong index of RNTI " << it->first);
+      NS_TEST_ASSERT_MSG_EQ (column[index], it->second, "wrong value of RNTI " << it->first);
+    }
+}
+
+void
+LteFfMacSchedulerUeTableTestCase::DoRun (void)
+{
+  FfMacSchedulerUeTable table;
+  FfMacSchedulerUeTable::Column<double> column (table, -1.0);
+  std::map<uint16_t, double> reference;
+
+  uint16_t rntis[8] = {7, 3, 12, 1, 300, 5, 2, 9};
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      column[table.Add (rntis[i])] = rntis[i] * 0.5;
+      reference[rntis[i]] = rntis[i] * 0.5;
+      Check (table, column, reference);
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.Add (12), table.Find (12), "a UE added twice is not found");
+  NS_TEST_ASSERT_MSG_EQ (table.GetN (), 8, "a UE added twice has been duplicated");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (4), FfMacSchedulerUeTable::NOT_FOUND, "unknown RNTI found");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (1000), FfMacSchedulerUeTable::NOT_FOUND, "unknown RNTI found");
+
+  // a column declared after the UEs gets the default value
+  FfMacSchedulerUeTable::Column<uint32_t> lateColumn (table, 42);
+  NS_TEST_ASSERT_MSG_EQ (lateColumn[7], 42, "wrong default value");
+
+  uint16_t removed[4] = {3, 300, 1, 8};
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      table.Remove (removed[i]);
+      reference.erase (removed[i]);
+      Check (table, column, reference);
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.Find (300), FfMacSchedulerUeTable::NOT_FOUND, "removed RNTI found");
+
+  column[table.Add (4)] = 2.0;
+  reference[4] = 2.0;
+  Check (table, column, reference);
+  column[table.Add (4000)] = -1.0;
+  reference[4000] = -1.0;
+  Check (table, column, reference);
+
+  table.Clear ();
+  reference.clear ();
+  Check (table, column, reference);
+  NS_TEST_ASSERT_MSG_EQ (table.Find (4), FfMacSchedulerUeTable::NOT_FOUND, "RNTI found after Clear");
+}
+
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test suite of the FF MAC scheduler UE table.
+ */
+class LteFfMacSchedulerUeTableTestSuite : public TestSuite
+{
+public:
+  LteFfMacSchedulerUeTableTestSuite ();
+};
+
+LteFfMacSchedulerUeTableTestSuite::LteFfMacSchedulerUeTableTestSuite ()
+  : TestSuite ("lte-ff-mac-scheduler-ue-table", UNIT)
+{
+  AddTestCase (new LteFfMacSchedulerUeTableTestCase, TestCase::QUICK);
+}
+
+static LteFfMacSchedulerUeTableTestSuite g_lteFfMacSchedulerUeTableTestSuite; ///< the test suite
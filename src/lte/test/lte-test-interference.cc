@@ -39,6 +39,8 @@
 
 #include "lte-test-interference.h"
 
+#include <sstream>
+
 
 using namespace ns3;
 
@@ -69,20 +71,28 @@ LteInterferenceTestSuite::LteInterferenceTestSuite ()
 {
   // these two first test cases have a spectral efficiency that corresponds to CQI=0 (out of range)
   // TODO: update the test conditions to handle out-of-range correctly
-  // AddTestCase (new LteInterferenceTestCase ("d1=50, d2=10",  50.000000, 10.000000,  0.040000, 0.040000,  0.010399, 0.010399, 0, 0), TestCase::QUICK);
-  // AddTestCase (new LteInterferenceTestCase ("d1=50, d2=20",  50.000000, 20.000000,  0.160000, 0.159998,  0.041154, 0.041153, 0, 0), TestCase::QUICK);
-
-  AddTestCase (new LteInterferenceTestCase ("d1=3000, d2=6000",  3000.000000, 6000.000000,  3.844681, 1.714583,  0.761558, 0.389662, 6, 4), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=50",  50.000000, 50.000000,  0.999997, 0.999907,  0.239828, 0.239808, 2, 2), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=100",  50.000000, 100.000000,  3.999955, 3.998520,  0.785259, 0.785042, 6, 6), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=200",  50.000000, 200.000000,  15.999282, 15.976339,  1.961072, 1.959533, 14, 14), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=500",  50.000000, 500.000000,  99.971953, 99.082845,  4.254003, 4.241793, 22, 22), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=1000",  50.000000, 1000.000000,  399.551632, 385.718468,  6.194952, 6.144825, 28, 28), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=10000",  50.000000, 10000.000000,  35964.181431, 8505.970614,  12.667381, 10.588084, 28, 28), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=100000",  50.000000, 100000.000000,  327284.773828, 10774.181090,  15.853097, 10.928917, 28, 28), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=1000000",  50.000000, 1000000.000000,  356132.574152, 10802.988445,  15.974963, 10.932767, 28, 28), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=4500, d2=12600",  4500.000000, 12600.000000,  6.654462, 1.139831,  1.139781, 0.270399, 8, 2), TestCase::QUICK);
-  AddTestCase (new LteInterferenceTestCase ("d1=5400, d2=12600",  5400.000000, 12600.000000,  4.621154, 0.791549,  0.876368, 0.193019, 6, 0), TestCase::QUICK);
+  // AddTestCase (new LteInterferenceTestCase ("d1=50, d2=10",  50.000000, 10.000000,  0.040000, 0.040000,  0.010399, 0.010399, 0, 0, false), TestCase::QUICK);
+  // AddTestCase (new LteInterferenceTestCase ("d1=50, d2=20",  50.000000, 20.000000,  0.160000, 0.159998,  0.041154, 0.041153, 0, 0, false), TestCase::QUICK);
+
+  AddTestCase (new LteInterferenceTestCase ("d1=3000, d2=6000",  3000.000000, 6000.000000,  3.844681, 1.714583,  0.761558, 0.389662, 6, 4, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=50",  50.000000, 50.000000,  0.999997, 0.999907,  0.239828, 0.239808, 2, 2, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=100",  50.000000, 100.000000,  3.999955, 3.998520,  0.785259, 0.785042, 6, 6, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=200",  50.000000, 200.000000,  15.999282, 15.976339,  1.961072, 1.959533, 14, 14, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=500",  50.000000, 500.000000,  99.971953, 99.082845,  4.254003, 4.241793, 22, 22, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=1000",  50.000000, 1000.000000,  399.551632, 385.718468,  6.194952, 6.144825, 28, 28, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=10000",  50.000000, 10000.000000,  35964.181431, 8505.970614,  12.667381, 10.588084, 28, 28, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=100000",  50.000000, 100000.000000,  327284.773828, 10774.181090,  15.853097, 10.928917, 28, 28, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=1000000",  50.000000, 1000000.000000,  356132.574152, 10802.988445,  15.974963, 10.932767, 28, 28, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=4500, d2=12600",  4500.000000, 12600.000000,  6.654462, 1.139831,  1.139781, 0.270399, 8, 2, false), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=5400, d2=12600",  5400.000000, 12600.000000,  4.621154, 0.791549,  0.876368, 0.193019, 6, 0, false), TestCase::QUICK);
+
+  // same results when the channels sum the signals of the other cells
+  AddTestCase (new LteInterferenceTestCase ("d1=3000, d2=6000, PHY abstraction",  3000.000000, 6000.000000,  3.844681, 1.714583,  0.761558, 0.389662, 6, 4, true), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=50, d2=200, PHY abstraction",  50.000000, 200.000000,  15.999282, 15.976339,  1.961072, 1.959533, 14, 14, true), TestCase::QUICK);
+  AddTestCase (new LteInterferenceTestCase ("d1=4500, d2=12600, PHY abstraction",  4500.000000, 12600.000000,  6.654462, 1.139831,  1.139781, 0.270399, 8, 2, true), TestCase::QUICK);
+
+  // same SINRs when the channels sum the signals of several other cells
+  AddTestCase (new LteMultiCellInterferenceTestCase (4), TestCase::QUICK);
 
 
 }
@@ -94,14 +104,15 @@ static LteInterferenceTestSuite lteLinkAdaptationWithInterferenceTestSuite;
  * TestCase
  */
 
-LteInterferenceTestCase::LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs)
+LteInterferenceTestCase::LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs, bool phyAbstraction)
   : TestCase (name),
     m_d1 (d1),
     m_d2 (d2),
     m_expectedDlSinrDb (10 * std::log10 (dlSinr)),
     m_expectedUlSinrDb (10 * std::log10 (ulSinr)),
     m_dlMcs (dlMcs),
-    m_ulMcs (ulMcs)
+    m_ulMcs (ulMcs),
+    m_phyAbstraction (phyAbstraction)
 {
 }
 
@@ -122,6 +133,7 @@ LteInterferenceTestCase::DoRun (void)
   lteHelper->SetAttribute ("PathlossModel", StringValue ("ns3::FriisSpectrumPropagationLossModel"));
   lteHelper->SetAttribute ("UseIdealRrc", BooleanValue (false));
   lteHelper->SetAttribute ("UsePdschForCqiGeneration", BooleanValue (true));
+  lteHelper->SetAttribute ("PhyAbstraction", BooleanValue (m_phyAbstraction));
 
   //Disable Uplink Power Control
   Config::SetDefault ("ns3::LteUePhy::EnableUplinkPowerControl", BooleanValue (false));
@@ -263,3 +275,132 @@ LteInterferenceTestCase::UlScheduling (uint32_t frameNo, uint32_t subframeNo, ui
       NS_TEST_ASSERT_MSG_EQ ((uint32_t)mcs, (uint32_t)m_ulMcs, "Wrong UL MCS");
     }
 }
+
+
+LteMultiCellInterferenceTestCase::LteMultiCellInterferenceTestCase (uint16_t nCells)
+  : TestCase (BuildNameString (nCells)),
+    m_nCells (nCells)
+{
+}
+
+std::string
+LteMultiCellInterferenceTestCase::BuildNameString (uint16_t nCells)
+{
+  std::ostringstream oss;
+  oss << "PHY abstraction with " << nCells << " cells";
+  return oss.str ();
+}
+
+LteMultiCellInterferenceTestCase::~LteMultiCellInterferenceTestCase ()
+{
+}
+
+void
+LteMultiCellInterferenceTestCase::RunScenario (bool phyAbstraction, std::vector<Ptr<SpectrumValue> >& dlSinr,
+                                               std::vector<Ptr<SpectrumValue> >& ulSinr)
+{
+  Config::SetDefault ("ns3::LteSpectrumPhy::CtrlErrorModelEnabled", BooleanValue (false));
+  Config::SetDefault ("ns3::LteSpectrumPhy::DataErrorModelEnabled", BooleanValue (false));
+  Config::SetDefault ("ns3::LteUePhy::EnableUplinkPowerControl", BooleanValue (false));
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  lteHelper->SetAttribute ("PathlossModel", StringValue ("ns3::FriisSpectrumPropagationLossModel"));
+  lteHelper->SetAttribute ("UseIdealRrc", BooleanValue (false));
+  lteHelper->SetAttribute ("PhyAbstraction", BooleanValue (phyAbstraction));
+  lteHelper->SetSchedulerType ("ns3::RrFfMacScheduler");
+
+  // the eNBs are on a line, 1000 m apart, each with a UE 300 m away, so
+  // that every receiver gets the signals of all the other cells:
+  //
+  //  UE1      UE2      UE3   ...
+  //   |        |        |
+  //  eNB1 --- eNB2 --- eNB3  ...
+  //
+  NodeContainer enbNodes;
+  NodeContainer ueNodes;
+  enbNodes.Create (m_nCells);
+  ueNodes.Create (m_nCells);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint16_t i = 0; i < m_nCells; i++)
+    {
+      positionAlloc->Add (Vector (1000.0 * i, 0.0, 0.0));
+    }
+  for (uint16_t i = 0; i < m_nCells; i++)
+    {
+      positionAlloc->Add (Vector (1000.0 * i, 300.0, 0.0));
+    }
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (NodeContainer (enbNodes, ueNodes));
+
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  // the same random numbers in both modes
+  int64_t stream = lteHelper->AssignStreams (enbDevs, 0);
+  lteHelper->AssignStreams (ueDevs, stream);
+
+  std::vector<LteSpectrumValueCatcher> dlSinrCatchers (m_nCells);
+  std::vector<LteSpectrumValueCatcher> ulSinrCatchers (m_nCells);
+  for (uint16_t i = 0; i < m_nCells; i++)
+    {
+      lteHelper->Attach (ueDevs.Get (i), enbDevs.Get (i));
+      lteHelper->ActivateDataRadioBearer (ueDevs.Get (i), EpsBearer (EpsBearer::GBR_CONV_VOICE));
+
+      Ptr<LtePhy> uePhy = ueDevs.Get (i)->GetObject<LteUeNetDevice> ()->GetPhy ()->GetObject<LtePhy> ();
+      Ptr<LteChunkProcessor> testDlSinr = Create<LteChunkProcessor> ();
+      testDlSinr->AddCallback (MakeCallback (&LteSpectrumValueCatcher::ReportValue, &dlSinrCatchers[i]));
+      uePhy->GetDownlinkSpectrumPhy ()->AddDataSinrChunkProcessor (testDlSinr);
+
+      Ptr<LtePhy> enbPhy = enbDevs.Get (i)->GetObject<LteEnbNetDevice> ()->GetPhy ()->GetObject<LtePhy> ();
+      Ptr<LteChunkProcessor> testUlSinr = Create<LteChunkProcessor> ();
+      testUlSinr->AddCallback (MakeCallback (&LteSpectrumValueCatcher::ReportValue, &ulSinrCatchers[i]));
+      enbPhy->GetUplinkSpectrumPhy ()->AddDataSinrChunkProcessor (testUlSinr);
+    }
+
+  // need to allow for RRC connection establishment + SRS
+  Simulator::Stop (Seconds (0.100));
+  Simulator::Run ();
+
+  dlSinr.clear ();
+  ulSinr.clear ();
+  for (uint16_t i = 0; i < m_nCells; i++)
+    {
+      dlSinr.push_back (dlSinrCatchers[i].GetValue ());
+      ulSinr.push_back (ulSinrCatchers[i].GetValue ());
+    }
+
+  Simulator::Destroy ();
+}
+
+void
+LteMultiCellInterferenceTestCase::DoRun (void)
+{
+  NS_LOG_INFO (this << GetName ());
+  std::vector<Ptr<SpectrumValue> > dlSinr;
+  std::vector<Ptr<SpectrumValue> > ulSinr;
+  RunScenario (false, dlSinr, ulSinr);
+  std::vector<Ptr<SpectrumValue> > abstractDlSinr;
+  std::vector<Ptr<SpectrumValue> > abstractUlSinr;
+  RunScenario (true, abstractDlSinr, abstractUlSinr);
+
+  for (uint16_t i = 0; i < m_nCells; i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (dlSinr[i], 0, "No DL SINR in cell " << i + 1);
+      NS_TEST_ASSERT_MSG_NE (abstractDlSinr[i], 0, "No DL SINR in cell " << i + 1 << " with PHY abstraction");
+      NS_TEST_ASSERT_MSG_NE (ulSinr[i], 0, "No UL SINR in cell " << i + 1);
+      NS_TEST_ASSERT_MSG_NE (abstractUlSinr[i], 0, "No UL SINR in cell " << i + 1 << " with PHY abstraction");
+      // the signals are summed in another order
+      for (size_t rb = 0; rb < dlSinr[i]->GetSpectrumModel ()->GetNumBands (); rb++)
+        {
+          double sinr = (*dlSinr[i])[rb];
+          NS_TEST_ASSERT_MSG_EQ_TOL ((*abstractDlSinr[i])[rb], sinr, sinr * 1e-9,
+                                     "Wrong SINR in DL with PHY abstraction! (eNB" << i + 1 << " --> UE" << i + 1 << ", RB " << rb << ")");
+        }
+      for (size_t rb = 0; rb < ulSinr[i]->GetSpectrumModel ()->GetNumBands (); rb++)
+        {
+          double sinr = (*ulSinr[i])[rb];
+          NS_TEST_ASSERT_MSG_EQ_TOL ((*abstractUlSinr[i])[rb], sinr, sinr * 1e-9,
+                                     "Wrong SINR in UL with PHY abstraction! (UE" << i + 1 << " --> eNB" << i + 1 << ", RB " << rb << ")");
+        }
+    }
+}
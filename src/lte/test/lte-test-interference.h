@@ -23,6 +23,8 @@
 #define LTE_TEST_INTERFERENCE_H
 
 #include "ns3/test.h"
+#include "ns3/spectrum-value.h"
+#include <vector>
 
 
 using namespace ns3;
@@ -63,8 +65,9 @@ public:
    * \param ulSe the UL se
    * \param dlMcs the DL MCS
    * \param ulMcs the UL MCS
+   * \param phyAbstraction the value of the PhyAbstraction attribute of LteHelper
    */
-  LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs);
+  LteInterferenceTestCase (std::string name, double d1, double d2, double dlSinr, double ulSinr, double dlSe, double ulSe, uint16_t dlMcs, uint16_t ulMcs, bool phyAbstraction);
   virtual ~LteInterferenceTestCase ();
 
   /**
@@ -94,6 +97,49 @@ private:
   double m_expectedUlSinrDb; ///< expected UL SINR in dB
   uint16_t m_dlMcs; ///< the DL MCS
   uint16_t m_ulMcs; ///< the UL MCS
+  bool m_phyAbstraction; ///< whether the signals of the other cells are summed by the channel
+};
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test that the SINR of each cell is the same whether the channels
+ * sum the signals of the other cells (PhyAbstraction attribute of LteHelper)
+ * or not, with several interfering cells.
+ */
+class LteMultiCellInterferenceTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param nCells the number of cells, each with one UE
+   */
+  LteMultiCellInterferenceTestCase (uint16_t nCells);
+  virtual ~LteMultiCellInterferenceTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Builds the test name string based on provided parameter values
+   * \param nCells the number of cells
+   * \returns the name string
+   */
+  static std::string BuildNameString (uint16_t nCells);
+
+  /**
+   * Run the scenario
+   *
+   * \param phyAbstraction the value of the PhyAbstraction attribute of LteHelper
+   * \param dlSinr the last DL data SINR of the UE of each cell
+   * \param ulSinr the last UL data SINR of the eNB of each cell
+   */
+  void RunScenario (bool phyAbstraction, std::vector<Ptr<SpectrumValue> >& dlSinr,
+                    std::vector<Ptr<SpectrumValue> >& ulSinr);
+
+  uint16_t m_nCells; ///< the number of cells
 };
 
 #endif /* LTE_TEST_INTERFERENCE_H */
@@ -0,0 +1,189 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/double.h>
+#include <ns3/lte-spectrum-value-helper.h>
+#include <ns3/lte-mi-error-model.h>
+#include <ns3/lte-amc.h>
+#include <sstream>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteMiErrorModelTest");
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test that the MIB and the TB decodification statistics are the
+ * same whether they are computed from the SINR of each RB, or from the MI
+ * of each RB returned by LteMiErrorModel::MapSinrToMi.
+ */
+class LteMiErrorModelTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param mcs the MCS of the TBs
+   */
+  LteMiErrorModelTestCase (uint8_t mcs);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Builds the test name string based on provided parameter values
+   * \param mcs the MCS
+   * \returns the name string
+   */
+  static std::string BuildNameString (uint8_t mcs);
+
+  /**
+   * Check both paths on a TB
+   * \param sinr the SINR of each RB
+   * \param mi the MI of each RB, as returned by MapSinrToMi for sinr
+   * \param map the RBs of the TB
+   * \param miHistory the HARQ history of the TB
+   * \return the statistics of the TB
+   */
+  TbStats_t CheckTb (const SpectrumValue& sinr, const MiPerRb_t& mi,
+                     const std::vector<int>& map, const HarqProcessInfoList_t& miHistory);
+
+  uint8_t m_mcs; ///< the MCS
+};
+
+LteMiErrorModelTestCase::LteMiErrorModelTestCase (uint8_t mcs)
+  : TestCase (BuildNameString (mcs)),
+    m_mcs (mcs)
+{
+}
+
+std::string
+LteMiErrorModelTestCase::BuildNameString (uint8_t mcs)
+{
+  std::ostringstream oss;
+  oss << "MI per RB, mcs " << (uint32_t) mcs;
+  return oss.str ();
+}
+
+TbStats_t
+LteMiErrorModelTestCase::CheckTb (const SpectrumValue& sinr, const MiPerRb_t& mi,
+                                  const std::vector<int>& map, const HarqProcessInfoList_t& miHistory)
+{
+  Ptr<LteAmc> amc = CreateObject<LteAmc> ();
+  uint16_t size = amc->GetDlTbSizeFromMcs (m_mcs, map.size ()) / 8;
+
+  NS_TEST_EXPECT_MSG_EQ (LteMiErrorModel::Mib (mi, map, m_mcs),
+                         LteMiErrorModel::Mib (sinr, map, m_mcs),
+                         "Different MIB, " << map.size () << " RBs");
+  TbStats_t expected = LteMiErrorModel::GetTbDecodificationStats (sinr, map, size, m_mcs, miHistory);
+  TbStats_t stats = LteMiErrorModel::GetTbDecodificationStats (mi, map, size, m_mcs, miHistory);
+  NS_TEST_EXPECT_MSG_EQ (stats.tbler, expected.tbler,
+                         "Different TBLER, " << map.size () << " RBs, HARQ " << miHistory.size ());
+  NS_TEST_EXPECT_MSG_EQ (stats.mi, expected.mi,
+                         "Different MI, " << map.size () << " RBs, HARQ " << miHistory.size ());
+  return expected;
+}
+
+void
+LteMiErrorModelTestCase::DoRun (void)
+{
+  // 50 RBs, with SINRs from -10 dB to 30 dB
+  Ptr<SpectrumModel> model = LteSpectrumValueHelper::GetSpectrumModel (100, 50);
+  uint32_t nRbs = model->GetNumBands ();
+  Ptr<UniformRandomVariable> sinrDb = CreateObject<UniformRandomVariable> ();
+  sinrDb->SetAttribute ("Min", DoubleValue (-10.0));
+  sinrDb->SetAttribute ("Max", DoubleValue (30.0));
+  sinrDb->SetStream (m_mcs);
+
+  // A single RB, the first and the last RBs, every third RB, a contiguous
+  // block and all the RBs
+  std::vector<std::vector<int> > maps (5);
+  maps[0].push_back (7);
+  maps[1].push_back (0);
+  maps[1].push_back (nRbs - 1);
+  for (uint32_t rb = 0; rb < nRbs; rb++)
+    {
+      if (rb % 3 == 0)
+        {
+          maps[2].push_back (rb);
+        }
+      if (rb >= 10 && rb < 25)
+        {
+          maps[3].push_back (rb);
+        }
+      maps[4].push_back (rb);
+    }
+
+  for (uint32_t run = 0; run < 10; run++)
+    {
+      SpectrumValue sinr (model);
+      for (Values::iterator it = sinr.ValuesBegin (); it != sinr.ValuesEnd (); ++it)
+        {
+          *it = std::pow (10.0, sinrDb->GetValue () / 10.0);
+        }
+      MiPerRb_t mi;
+      LteMiErrorModel::MapSinrToMi (sinr, mi);
+
+      for (std::vector<std::vector<int> >::const_iterator map = maps.begin (); map != maps.end (); ++map)
+        {
+          // A first transmission, then two retransmissions combined with
+          // the previous ones
+          HarqProcessInfoList_t miHistory;
+          for (uint8_t rv = 0; rv < 3; rv++)
+            {
+              TbStats_t stats = CheckTb (sinr, mi, *map, miHistory);
+              HarqProcessInfoElement_t element;
+              element.m_mi = stats.mi;
+              element.m_rv = rv;
+              element.m_infoBits = miHistory.empty () ? map->size () * 100 : miHistory.at (0).m_infoBits;
+              element.m_codeBits = map->size () * 150;
+              miHistory.push_back (element);
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test suite for the MI of each RB used by the MI error model
+ */
+class LteMiErrorModelTestSuite : public TestSuite
+{
+public:
+  LteMiErrorModelTestSuite ();
+};
+
+LteMiErrorModelTestSuite::LteMiErrorModelTestSuite ()
+  : TestSuite ("lte-mi-error-model", UNIT)
+{
+  // The first and the last MCS of each modulation, and one in between
+  uint8_t mcs[] = {0, 5, 9, 10, 13, 16, 17, 22, 28};
+  for (uint32_t i = 0; i < sizeof (mcs) / sizeof (mcs[0]); i++)
+    {
+      AddTestCase (new LteMiErrorModelTestCase (mcs[i]), TestCase::QUICK);
+    }
+}
+
+static LteMiErrorModelTestSuite g_lteMiErrorModelTestSuite; //!< Static variable for test initialization
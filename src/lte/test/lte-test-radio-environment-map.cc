@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/boolean.h>
+#include <ns3/node-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/buildings-helper.h>
+#include <ns3/lte-helper.h>
+#include <ns3/spectrum-channel.h>
+#include <ns3/radio-environment-map-helper.h>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteRadioEnvironmentMapTest");
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test that the Radio Environment Map computed directly, with one
+ * or several threads, matches the one computed with RemSpectrumPhy
+ * listeners, and that the binary raster matches the text output.
+ */
+class LteRadioEnvironmentMapTestCase : public TestCase
+{
+public:
+  LteRadioEnvironmentMapTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A point of the map
+  struct RemPoint
+  {
+    double x;    ///< x coordinate
+    double y;    ///< y coordinate
+    double sinr; ///< SINR
+  };
+
+  /**
+   * Generate a map
+   * \param directComputation the DirectComputation attribute
+   * \param threads the Threads attribute
+   * \param binaryOutputFile the BinaryOutputFile attribute
+   * \return the points of the text output
+   */
+  std::vector<RemPoint> RunRem (bool directComputation, uint32_t threads, std::string binaryOutputFile);
+};
+
+LteRadioEnvironmentMapTestCase::LteRadioEnvironmentMapTestCase ()
+  : TestCase ("Radio Environment Map computed directly")
+{
+}
+
+std::vector<LteRadioEnvironmentMapTestCase::RemPoint>
+LteRadioEnvironmentMapTestCase::RunRem (bool directComputation, uint32_t threads, std::string binaryOutputFile)
+{
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  lteHelper->SetEnbAntennaModelType ("ns3::CosineAntennaModel");
+  lteHelper->SetEnbAntennaModelAttribute ("Beamwidth", DoubleValue (65));
+
+  NodeContainer enbNodes;
+  enbNodes.Create (3);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (300.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (150.0, 250.0, 30.0));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  BuildingsHelper::Install (enbNodes);
+
+  NetDeviceContainer enbDevs;
+  double orientations[3] = {0.0, 180.0, 270.0};
+  for (uint32_t i = 0; i < enbNodes.GetN (); i++)
+    {
+      lteHelper->SetEnbAntennaModelAttribute ("Orientation", DoubleValue (orientations[i]));
+      enbDevs.Add (lteHelper->InstallEnbDevice (enbNodes.Get (i)));
+    }
+
+  std::string textOutputFile = CreateTempDirFilename ("rem.out");
+  std::ostringstream channelPath;
+  channelPath << "/ChannelList/" << lteHelper->GetDownlinkSpectrumChannel ()->GetId ();
+  Ptr<RadioEnvironmentMapHelper> remHelper = CreateObject<RadioEnvironmentMapHelper> ();
+  remHelper->SetAttribute ("ChannelPath", StringValue (channelPath.str ()));
+  remHelper->SetAttribute ("OutputFile", StringValue (textOutputFile));
+  remHelper->SetAttribute ("XMin", DoubleValue (-100.0));
+  remHelper->SetAttribute ("XMax", DoubleValue (400.0));
+  remHelper->SetAttribute ("XRes", UintegerValue (21));
+  remHelper->SetAttribute ("YMin", DoubleValue (-100.0));
+  remHelper->SetAttribute ("YMax", DoubleValue (350.0));
+  remHelper->SetAttribute ("YRes", UintegerValue (16));
+  remHelper->SetAttribute ("Z", DoubleValue (1.5));
+  remHelper->SetAttribute ("MaxPointsPerIteration", UintegerValue (100));
+  remHelper->SetAttribute ("DirectComputation", BooleanValue (directComputation));
+  remHelper->SetAttribute ("Threads", UintegerValue (threads));
+  remHelper->SetAttribute ("BinaryOutputFile", StringValue (binaryOutputFile));
+  remHelper->Install ();
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<RemPoint> points;
+  std::ifstream textFile (textOutputFile.c_str ());
+  RemPoint point;
+  double z;
+  while (textFile >> point.x >> point.y >> z >> point.sinr)
+    {
+      points.push_back (point);
+    }
+  return points;
+}
+
+void
+LteRadioEnvironmentMapTestCase::DoRun (void)
+{
+  std::vector<RemPoint> reference = RunRem (false, 1, "");
+  NS_TEST_ASSERT_MSG_EQ (reference.size (), 21 * 16, "wrong number of points");
+
+  std::string binaryOutputFile = CreateTempDirFilename ("rem.bin");
+  uint32_t threads[2] = {1, 3};
+  for (uint32_t t = 0; t < 2; t++)
+    {
+      std::vector<RemPoint> direct = RunRem (true, threads[t], binaryOutputFile);
+      NS_TEST_ASSERT_MSG_EQ (direct.size (), reference.size (), "wrong number of points with " << threads[t] << " threads");
+      for (std::size_t i = 0; i < reference.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (direct[i].x, reference[i].x, 1e-6, "wrong x coordinate");
+          NS_TEST_ASSERT_MSG_EQ_TOL (direct[i].y, reference[i].y, 1e-6, "wrong y coordinate");
+          NS_TEST_ASSERT_MSG_EQ_TOL (direct[i].sinr, reference[i].sinr, reference[i].sinr * 2e-5,
+                                     "wrong SINR at (" << reference[i].x << ", " << reference[i].y << ") with " << threads[t] << " threads");
+        }
+
+      std::ifstream binaryFile (binaryOutputFile.c_str (), std::ifstream::in | std::ifstream::binary);
+      char magic[8];
+      uint32_t xPoints = 0;
+      uint32_t yPoints = 0;
+      double bounds[5];
+      binaryFile.read (magic, sizeof (magic));
+      binaryFile.read (reinterpret_cast<char *> (&xPoints), sizeof (xPoints));
+      binaryFile.read (reinterpret_cast<char *> (&yPoints), sizeof (yPoints));
+      binaryFile.read (reinterpret_cast<char *> (bounds), sizeof (bounds));
+      NS_TEST_ASSERT_MSG_EQ (std::memcmp (magic, "LTEREM01", sizeof (magic)), 0, "wrong magic");
+      NS_TEST_ASSERT_MSG_EQ (xPoints, 21, "wrong number of points along x");
+      NS_TEST_ASSERT_MSG_EQ (yPoints, 16, "wrong number of points along y");
+      NS_TEST_ASSERT_MSG_EQ (bounds[4], 1.5, "wrong z");
+      std::vector<double> sinr (xPoints * yPoints);
+      binaryFile.read (reinterpret_cast<char *> (sinr.data ()), sinr.size () * sizeof (double));
+      NS_TEST_ASSERT_MSG_EQ (binaryFile.good (), true, "truncated binary output");
+      for (std::size_t i = 0; i < sinr.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (sinr[i], direct[i].sinr, direct[i].sinr * 2e-5, "binary and text outputs differ");
+        }
+    }
+}
+
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test suite of the Radio Environment Map.
+ */
+class LteRadioEnvironmentMapTestSuite : public TestSuite
+{
+public:
+  LteRadioEnvironmentMapTestSuite ();
+};
+
+LteRadioEnvironmentMapTestSuite::LteRadioEnvironmentMapTestSuite ()
+  : TestSuite ("lte-radio-environment-map", SYSTEM)
+{
+  AddTestCase (new LteRadioEnvironmentMapTestCase, TestCase::QUICK);
+}
+
+static LteRadioEnvironmentMapTestSuite g_lteRadioEnvironmentMapTestSuite; ///< the test suite
@@ -20,6 +20,8 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/ip-checksum.h"
+#include <algorithm>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -1140,14 +1142,31 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  NS_ASSERT (m_current >= m_dataStart && m_current + size <= m_dataEnd);
+  /* see RFC 1071 to understand this code. The bytes before and after the
+   * zero area are summed as two blocks, skipping the zero area, and the
+   * sum of a block which starts at an odd offset is byte-swapped. */
+  uint64_t sum = initialChecksum;
+  uint32_t start = m_current;
+  uint32_t end = m_current + size;
+
+  uint32_t blockEnd = std::min (end, m_zeroStart);
+  if (start < blockEnd)
+    {
+      sum += IpChecksumPartial (&m_data[start], blockEnd - start);
+    }
+  uint32_t blockStart = std::max (start, m_zeroEnd);
+  if (blockStart < end)
+    {
+      uint16_t blockSum = IpChecksumPartial (&m_data[blockStart - (m_zeroEnd - m_zeroStart)],
+                                             end - blockStart);
+      if ((blockStart - start) & 1)
+        {
+          blockSum = (blockSum >> 8) | (blockSum << 8);
+        }
+      sum += blockSum;
+    }
+  m_current = end;
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
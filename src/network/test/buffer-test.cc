@@ -378,6 +378,94 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer checksum unit tests: the checksum of any range of a buffer with a
+ * zero area matches the one computed 16 bit word by 16 bit word.
+ */
+class BufferChecksumTest : public TestCase {
+private:
+  /**
+   * Computes the checksum of a range word by word (RFC 1071)
+   * \param i An iterator at the start of the range
+   * \param size The size of the range
+   * \param initialChecksum The initial value
+   * \returns The checksum
+   */
+  uint16_t ReferenceChecksum (Buffer::Iterator i, uint16_t size, uint32_t initialChecksum);
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum") {
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (Buffer::Iterator i, uint16_t size, uint32_t initialChecksum)
+{
+  uint32_t sum = initialChecksum;
+  for (int j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // data before the zero area, the zero area, data after the zero area
+  uint32_t sizes[][3] = { { 0, 0, 37 }, { 21, 0, 0 }, { 13, 10, 9 }, { 8, 7, 16 }, { 3, 40, 0 } };
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++)
+    {
+      Buffer buffer (sizes[s][1]);
+      buffer.AddAtStart (sizes[s][0]);
+      buffer.AddAtEnd (sizes[s][2]);
+      Buffer::Iterator i = buffer.Begin ();
+      for (uint32_t j = 0; j < sizes[s][0]; j++)
+        {
+          i.WriteU8 (rng->GetInteger (0, 255));
+        }
+      i = buffer.End ();
+      i.Prev (sizes[s][2]);
+      for (uint32_t j = 0; j < sizes[s][2]; j++)
+        {
+          i.WriteU8 (rng->GetInteger (0, 255));
+        }
+
+      uint32_t total = buffer.GetSize ();
+      for (uint32_t start = 0; start <= total; start++)
+        {
+          for (uint32_t size = 0; start + size <= total; size++)
+            {
+              uint32_t initialChecksum = rng->GetInteger (0, 0xffff);
+              i = buffer.Begin ();
+              i.Next (start);
+              uint16_t expected = ReferenceChecksum (i, size, initialChecksum);
+              uint16_t checksum = i.CalculateIpChecksum (size, initialChecksum);
+              NS_TEST_ASSERT_MSG_EQ (checksum, expected, "Bad checksum of " << size << " bytes at " << start
+                                     << " with sizes " << sizes[s][0] << "," << sizes[s][1] << "," << sizes[s][2]);
+              NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), start + size, "Bad iterator position");
+            }
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +482,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ip-checksum.h"
+#include <cstring>
+
+namespace ns3 {
+
+/**
+ * \brief Folds a one's complement sum to 16 bits
+ * \param sum the sum
+ * \returns the folded sum
+ */
+static uint16_t
+IpChecksumFold (uint64_t sum)
+{
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint16_t> (sum);
+}
+
+/**
+ * \returns true if the host is big endian
+ */
+static bool
+IpChecksumIsBigEndian (void)
+{
+  const uint16_t one = 1;
+  uint8_t first;
+  std::memcpy (&first, &one, 1);
+  return first == 0;
+}
+
+uint16_t
+IpChecksumPartial (const uint8_t *data, uint32_t length)
+{
+  /* The one's complement sum does not depend on the byte order (RFC 1071,
+   * section 2): the 64 bit words are summed in the host byte order, with
+   * end-around carry, and the folded sum is swapped at the end on big
+   * endian hosts. */
+  uint64_t sum = 0;
+  uint64_t word;
+  while (length >= 8)
+    {
+      std::memcpy (&word, data, 8);
+      sum += word;
+      sum += (sum < word);
+      data += 8;
+      length -= 8;
+    }
+  if (length > 0)
+    {
+      word = 0;
+      std::memcpy (&word, data, length);
+      sum += word;
+      sum += (sum < word);
+    }
+  uint16_t folded = IpChecksumFold (sum);
+  if (IpChecksumIsBigEndian ())
+    {
+      folded = static_cast<uint16_t> ((folded >> 8) | (folded << 8));
+    }
+  return folded;
+}
+
+uint16_t
+IpChecksumUpdate (uint16_t checksum, uint16_t oldWord, uint16_t newWord)
+{
+  /* HC' = ~(~HC + ~m + m') */
+  uint64_t sum = static_cast<uint16_t> (~checksum);
+  sum += static_cast<uint16_t> (~oldWord);
+  sum += newWord;
+  return static_cast<uint16_t> (~IpChecksumFold (sum));
+}
+
+} // namespace ns3
@@ -0,0 +1,50 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IP_CHECKSUM_H
+#define IP_CHECKSUM_H
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * Calculates the 16 bit one's complement sum (RFC 1071) of a buffer,
+ * without complementing it.
+ *
+ * The sum is computed over 64 bit words. The 16 bit words are taken in
+ * the byte order of Buffer::Iterator::ReadU16 (the first byte is the
+ * least significant), whatever the host byte order, and an odd trailing
+ * byte is taken as the least significant byte of a last word.
+ *
+ * \param data buffer to calculate the sum for
+ * \param length the length of the buffer (bytes)
+ * \returns the folded sum, which is 0 only if all the bytes are 0.
+ */
+uint16_t IpChecksumPartial (const uint8_t *data, uint32_t length);
+
+/**
+ * Updates a checksum after the change of a 16 bit word of the data it
+ * covers, without recomputing it (RFC 1624, equation 3).
+ *
+ * \param checksum the checksum, as written in the header
+ * \param oldWord the previous value of the word
+ * \param newWord the new value of the word
+ * \returns the updated checksum.
+ */
+uint16_t IpChecksumUpdate (uint16_t checksum, uint16_t oldWord, uint16_t newWord);
+
+} // namespace ns3
+
+#endif
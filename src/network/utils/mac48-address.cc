@@ -291,5 +291,17 @@ std::istream& operator>> (std::istream& is, Mac48Address & address)
   return is;
 }
 
+size_t
+Mac48AddressHash::operator() (Mac48Address const &x) const
+{
+  // the 48 address bits fit in a size_t on 64-bit platforms; on smaller
+  // ones the high-order (OUI) bytes are simply shifted out
+  size_t hash = 0;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      hash = (hash << 8) | x.m_address[i];
+    }
+  return hash;
+}
 
 } // namespace ns3
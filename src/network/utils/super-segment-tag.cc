@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "super-segment-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SuperSegmentTag");
+
+NS_OBJECT_ENSURE_REGISTERED (SuperSegmentTag);
+
+TypeId
+SuperSegmentTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SuperSegmentTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SuperSegmentTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+SuperSegmentTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SuperSegmentTag::GetSerializedSize (void) const
+{
+  return 6;
+}
+
+void
+SuperSegmentTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU16 (m_segments);
+  buf.WriteU16 (m_segmentSize);
+  buf.WriteU16 (m_headerSize);
+}
+
+void
+SuperSegmentTag::Deserialize (TagBuffer buf)
+{
+  m_segments = buf.ReadU16 ();
+  m_segmentSize = buf.ReadU16 ();
+  m_headerSize = buf.ReadU16 ();
+}
+
+void
+SuperSegmentTag::Print (std::ostream &os) const
+{
+  os << "Segments=" << m_segments << " SegmentSize=" << m_segmentSize
+     << " HeaderSize=" << m_headerSize;
+}
+
+SuperSegmentTag::SuperSegmentTag ()
+  : Tag (),
+    m_segments (1),
+    m_segmentSize (0),
+    m_headerSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SuperSegmentTag::SuperSegmentTag (uint16_t segments, uint16_t segmentSize, uint16_t headerSize)
+  : Tag (),
+    m_segments (segments),
+    m_segmentSize (segmentSize),
+    m_headerSize (headerSize)
+{
+  NS_LOG_FUNCTION (this << segments << segmentSize << headerSize);
+}
+
+uint16_t
+SuperSegmentTag::GetSegments (void) const
+{
+  return m_segments;
+}
+
+uint16_t
+SuperSegmentTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+uint16_t
+SuperSegmentTag::GetHeaderSize (void) const
+{
+  return m_headerSize;
+}
+
+uint32_t
+SuperSegmentTag::GetExtraWireBytes (uint32_t framing) const
+{
+  if (m_segments <= 1)
+    {
+      return 0;
+    }
+  return (m_segments - 1u) * (m_headerSize + framing);
+}
+
+} // namespace ns3
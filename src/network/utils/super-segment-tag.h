@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SUPER_SEGMENT_TAG_H
+#define SUPER_SEGMENT_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Packet tag marking a super-segment
+ *
+ * A super-segment is a single packet standing for several consecutive
+ * segments of a transport protocol, in the manner of TCP segmentation
+ * offload: it lets a bulk transfer cross the stack with one event per
+ * super-segment instead of one per segment. Each of the segments it stands
+ * for would carry, besides its share of the payload, its own copy of the
+ * network and transport headers; the devices account for those bytes when
+ * computing the transmission time, so that the link is busy as long as it
+ * would be for the individual segments.
+ *
+ * A pure acknowledgment standing for several acknowledgments carries the
+ * tag too, with a null segment size.
+ */
+class SuperSegmentTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SuperSegmentTag ();
+
+  /**
+   * Constructs a SuperSegmentTag
+   *
+   * \param segments number of segments the packet stands for
+   * \param segmentSize payload size of each segment (the last one may be
+   *        shorter), or 0 for acknowledgments
+   * \param headerSize size of the network and transport headers of each segment
+   */
+  SuperSegmentTag (uint16_t segments, uint16_t segmentSize, uint16_t headerSize);
+
+  /**
+   * \returns the number of segments the packet stands for
+   */
+  uint16_t GetSegments (void) const;
+  /**
+   * \returns the payload size of each segment, or 0 for acknowledgments
+   */
+  uint16_t GetSegmentSize (void) const;
+  /**
+   * \returns the size of the network and transport headers of each segment
+   */
+  uint16_t GetHeaderSize (void) const;
+  /**
+   * \brief Get the bytes the segments would add on the wire
+   *
+   * \param framing size of the link-layer framing of each packet
+   * \returns the size of the headers and framing of all the segments but the
+   *          first, which are not in the packet
+   */
+  uint32_t GetExtraWireBytes (uint32_t framing) const;
+
+private:
+  uint16_t m_segments;    //!< Number of segments the packet stands for
+  uint16_t m_segmentSize; //!< Payload size of each segment
+  uint16_t m_headerSize;  //!< Network and transport headers size of each segment
+};
+
+} // namespace ns3
+
+#endif /* SUPER_SEGMENT_TAG_H */
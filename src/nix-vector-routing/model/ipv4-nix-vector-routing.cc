@@ -24,6 +24,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
+#include "ns3/boolean.h"
 #include "ns3/ipv4-list-routing.h"
 
 #include "ipv4-nix-vector-routing.h"
@@ -35,6 +36,11 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
 bool Ipv4NixVectorRouting::g_isCacheDirty = false;
+Ipv4NixVectorRouting::Adjacency Ipv4NixVectorRouting::g_adjacency;
+bool Ipv4NixVectorRouting::g_isAdjacencyValid = false;
+
+/// Index of a node not reached by a BFS tree
+static const uint32_t NIX_NOT_REACHED = 0xffffffff;
 
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
@@ -43,12 +49,20 @@ Ipv4NixVectorRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .SetGroupName ("NixVectorRouting")
     .AddConstructor<Ipv4NixVectorRouting> ()
+    .AddAttribute ("BfsTreePerSource",
+                   "Derive the nix-vectors to all the destinations from one BFS tree "
+                   "of the source node, instead of running one BFS per destination. "
+                   "The interfaces going up or down then only flush the trees they change.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4NixVectorRouting::m_bfsTreePerSource),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_totalNeighbors (0),
+    m_bfsTreePerSource (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -75,6 +89,8 @@ Ipv4NixVectorRouting::DoDispose ()
 
   m_node = 0;
   m_ipv4 = 0;
+  m_bfsParents.clear ();
+  m_bfsOrder.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -104,7 +120,83 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
       NS_LOG_LOGIC ("Flushing Nix caches.");
       rp->FlushNixCache ();
       rp->FlushIpv4RouteCache ();
+      rp->m_bfsParents.clear ();
+      rp->m_bfsOrder.clear ();
     }
+  g_isAdjacencyValid = false;
+}
+
+void
+Ipv4NixVectorRouting::FlushBfsTrees (uint32_t interface, bool up) const
+{
+  NS_LOG_FUNCTION (this << interface << up);
+  uint32_t nodeIndex = m_node->GetId ();
+  if (nodeIndex >= g_adjacency.nDevices.size ()
+      || g_adjacency.nDevices[nodeIndex] != m_node->GetNDevices ())
+    {
+      // the devices of the node changed since the adjacency was built
+      g_isCacheDirty = true;
+      return;
+    }
+  uint32_t deviceIndex = m_ipv4->GetNetDevice (interface)->GetIfIndex ();
+  uint32_t device = g_adjacency.nodeDevices[nodeIndex];
+  while (device < g_adjacency.nodeDevices[nodeIndex + 1] && g_adjacency.devices[device] != deviceIndex)
+    {
+      device++;
+    }
+  bool isAdjacent = device < g_adjacency.nodeDevices[nodeIndex + 1];
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Ipv4NixVectorRouting> rp = (*i)->GetObject<Ipv4NixVectorRouting> ();
+      if (!rp)
+        {
+          continue;
+        }
+      if (!rp->m_bfsTreePerSource)
+        {
+          rp->FlushNixCache ();
+        }
+      else if (isAdjacent && rp->IsBfsTreeAffected (nodeIndex, device, up))
+        {
+          NS_LOG_LOGIC ("Flushing the BFS tree of node " << (*i)->GetId ());
+          rp->FlushNixCache ();
+          rp->m_bfsParents.clear ();
+          rp->m_bfsOrder.clear ();
+        }
+      // the cached routes do not depend on the source of the packets
+      rp->FlushIpv4RouteCache ();
+    }
+}
+
+bool
+Ipv4NixVectorRouting::IsBfsTreeAffected (uint32_t node, uint32_t device, bool up) const
+{
+  NS_LOG_FUNCTION (this << node << device << up);
+  if (m_bfsParents.empty () || m_bfsOrder[node] == NIX_NOT_REACHED)
+    {
+      // the links of a node not reached are not walked
+      return false;
+    }
+  for (uint32_t i = g_adjacency.deviceNeighbors[device]; i < g_adjacency.deviceNeighbors[device + 1]; i++)
+    {
+      uint32_t parent = m_bfsParents[g_adjacency.neighbors[i]];
+      if (up)
+        {
+          // the neighbor is reached for the first time, or
+          // may be reached earlier through the new link
+          if (parent == NIX_NOT_REACHED || m_bfsOrder[node] <= m_bfsOrder[parent])
+            {
+              return true;
+            }
+        }
+      else if (parent == node)
+        {
+          // the neighbor may have been reached through the lost link
+          return true;
+        }
+    }
+  return false;
 }
 
 void
@@ -131,7 +223,21 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
   // not in cache, must build the nix vector
   // First, we have to figure out the nodes 
   // associated with these IPs
-  Ptr<Node> destNode = GetNodeByIp (dest);
+  Ptr<Node> destNode;
+  if (m_bfsTreePerSource)
+    {
+      CheckAdjacency ();
+      std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator it =
+        g_adjacency.addresses.find (dest);
+      if (it != g_adjacency.addresses.end ())
+        {
+          destNode = NodeList::GetNode (it->second);
+        }
+    }
+  else
+    {
+      destNode = GetNodeByIp (dest);
+    }
   if (destNode == 0)
     {
       NS_LOG_ERROR ("No routing path exists");
@@ -146,6 +252,24 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
       NS_LOG_DEBUG ("Do not process packets to self");
       return 0;
     }
+  else if (m_bfsTreePerSource && !oif)
+    {
+      // walk the BFS tree of the source, which is
+      // built once for all the destinations
+      if (m_bfsParents.empty ())
+        {
+          BuildBfsTree ();
+        }
+      if (BuildNixVectorFromBfsTree (destNode->GetId (), nixVector))
+        {
+          return nixVector;
+        }
+      else
+        {
+          NS_LOG_ERROR ("No routing path exists");
+          return 0;
+        }
+    }
   else
     {
       // otherwise proceed as normal 
@@ -302,6 +426,46 @@ Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVec
   return true;
 }
 
+bool
+Ipv4NixVectorRouting::BuildNixVectorFromBfsTree (uint32_t dest, Ptr<NixVector> nixVector) const
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  if (m_bfsParents.at (dest) == NIX_NOT_REACHED)
+    {
+      return false;
+    }
+
+  // walk up the tree, adding the neighbor index of each node
+  // at its parent, counted as in BuildNixVector
+  uint32_t source = m_node->GetId ();
+  for (uint32_t node = dest; node != source; node = m_bfsParents[node])
+    {
+      uint32_t parent = m_bfsParents[node];
+      uint32_t destId = 0;
+      uint32_t totalNeighbors = 0;
+      for (uint32_t i = g_adjacency.nodeDevices[parent]; i < g_adjacency.nodeDevices[parent + 1]; i++)
+        {
+          if (g_adjacency.bridges[i])
+            {
+              continue;
+            }
+          for (uint32_t j = g_adjacency.deviceNeighbors[i]; j < g_adjacency.deviceNeighbors[i + 1]; j++)
+            {
+              if (g_adjacency.neighbors[j] == node)
+                {
+                  destId = totalNeighbors;
+                }
+              totalNeighbors++;
+            }
+        }
+      NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parent);
+      nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
+    }
+  return true;
+}
+
 void
 Ipv4NixVectorRouting::GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer)
 {
@@ -752,11 +916,21 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
+  if (m_bfsTreePerSource && m_node && g_isAdjacencyValid && !g_isCacheDirty)
+    {
+      FlushBfsTrees (i, true);
+      return;
+    }
   g_isCacheDirty = true;
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
+  if (m_bfsTreePerSource && m_node && g_isAdjacencyValid && !g_isCacheDirty)
+    {
+      FlushBfsTrees (i, false);
+      return;
+    }
   g_isCacheDirty = true;
 }
 void
@@ -918,6 +1092,128 @@ Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source,
   return false;
 }
 
+void
+Ipv4NixVectorRouting::CheckAdjacency (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (g_isAdjacencyValid && g_adjacency.nDevices.size () == NodeList::GetNNodes ())
+    {
+      return;
+    }
+  // the trees built over the previous adjacency are not valid any more
+  FlushGlobalNixRoutingCache ();
+  BuildAdjacency ();
+}
+
+void
+Ipv4NixVectorRouting::BuildAdjacency (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  g_adjacency.nodeDevices.clear ();
+  g_adjacency.devices.clear ();
+  g_adjacency.bridges.clear ();
+  g_adjacency.deviceNeighbors.clear ();
+  g_adjacency.neighbors.clear ();
+  g_adjacency.nDevices.clear ();
+  g_adjacency.addresses.clear ();
+
+  for (uint32_t n = 0; n < NodeList::GetNNodes (); n++)
+    {
+      Ptr<Node> node = NodeList::GetNode (n);
+      g_adjacency.nodeDevices.push_back (g_adjacency.devices.size ());
+      g_adjacency.nDevices.push_back (node->GetNDevices ());
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          g_adjacency.devices.push_back (i);
+          g_adjacency.bridges.push_back (localNetDevice->IsBridge ());
+          g_adjacency.deviceNeighbors.push_back (g_adjacency.neighbors.size ());
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+            {
+              g_adjacency.neighbors.push_back ((*iter)->GetNode ()->GetId ());
+            }
+        }
+
+      // the first node with an address owns it, as in GetNodeByIp
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (!ipv4)
+        {
+          continue;
+        }
+      for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+        {
+          for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+            {
+              g_adjacency.addresses.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), n));
+            }
+        }
+    }
+  g_adjacency.nodeDevices.push_back (g_adjacency.devices.size ());
+  g_adjacency.deviceNeighbors.push_back (g_adjacency.neighbors.size ());
+  g_isAdjacencyValid = true;
+}
+
+void
+Ipv4NixVectorRouting::BuildBfsTree (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint32_t numberOfNodes = g_adjacency.nDevices.size ();
+  m_bfsParents.assign (numberOfNodes, NIX_NOT_REACHED);
+  m_bfsOrder.assign (numberOfNodes, NIX_NOT_REACHED);
+
+  // the nodes are visited in the order they are discovered
+  std::vector<uint32_t> greyNodeList;
+  greyNodeList.reserve (numberOfNodes);
+  uint32_t source = m_node->GetId ();
+  greyNodeList.push_back (source);
+  m_bfsParents[source] = source;
+
+  for (uint32_t k = 0; k < greyNodeList.size (); k++)
+    {
+      uint32_t currNode = greyNodeList[k];
+      m_bfsOrder[currNode] = k;
+      Ptr<Node> node = NodeList::GetNode (currNode);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      for (uint32_t i = g_adjacency.nodeDevices[currNode]; i < g_adjacency.nodeDevices[currNode + 1]; i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (g_adjacency.devices[i]);
+
+          // make sure that we can go this way
+          if (ipv4)
+            {
+              uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (localNetDevice);
+              if (!(ipv4->IsUp (interfaceIndex)))
+                {
+                  continue;
+                }
+            }
+          if (!(localNetDevice->IsLinkUp ()))
+            {
+              continue;
+            }
+          for (uint32_t j = g_adjacency.deviceNeighbors[i]; j < g_adjacency.deviceNeighbors[i + 1]; j++)
+            {
+              uint32_t remoteNode = g_adjacency.neighbors[j];
+              if (m_bfsParents[remoteNode] == NIX_NOT_REACHED)
+                {
+                  m_bfsParents[remoteNode] = currNode;
+                  greyNodeList.push_back (remoteNode);
+                }
+            }
+        }
+    }
+}
+
 void 
 Ipv4NixVectorRouting::CheckCacheStateAndFlush (void) const
 {
@@ -22,6 +22,8 @@
 #define IPV4_NIX_VECTOR_ROUTING_H
 
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -79,7 +81,7 @@ public:
   /**
    * @brief Called when run-time link topology change occurs
    * which iterates through the node list and flushes any
-   * nix vector caches
+   * nix vector caches and BFS trees
    *
    * \internal
    * \c const is used here due to need to potentially flush the cache
@@ -208,6 +210,54 @@ private:
             std::vector< Ptr<Node> > & parentVector,
             Ptr<NetDevice> oif);
 
+  /**
+   * Builds the adjacency of all the nodes, if it is not valid any more.
+   * The caches of all the nodes are flushed when it is rebuilt.
+   */
+  void CheckAdjacency (void);
+
+  /**
+   * Builds the adjacency of all the nodes from the NodeList
+   */
+  void BuildAdjacency (void);
+
+  /**
+   * \brief Breadth first search of all the nodes from this node,
+   * over the adjacency, storing the BFS tree.
+   *
+   * The nodes are visited in the same order as BFS (), so that the
+   * paths are the same.
+   */
+  void BuildBfsTree (void);
+
+  /**
+   * Walks the BFS tree of this node from a destination up to this node
+   * and builds the nixvector, like BuildNixVector ()
+   * \param [in] dest Destination Node index
+   * \param [out] nixVector the NixVector to be used for routing
+   * \returns true on success, false if the destination is not reachable.
+   */
+  bool BuildNixVectorFromBfsTree (uint32_t dest, Ptr<NixVector> nixVector) const;
+
+  /**
+   * Flushes the BFS trees and nix-vector caches which may be changed
+   * by an interface of this node going up or down, and the Ipv4Route
+   * caches of all the nodes
+   * \param interface the interface
+   * \param up true if the interface went up, false if it went down
+   */
+  void FlushBfsTrees (uint32_t interface, bool up) const;
+
+  /**
+   * Checks whether the BFS tree of this node is changed by an interface
+   * going up or down
+   * \param node the index of the node of the interface
+   * \param device the index of the device of the interface in the adjacency
+   * \param up true if the interface went up, false if it went down
+   * \returns true if the BFS tree may be changed
+   */
+  bool IsBfsTreeAffected (uint32_t node, uint32_t device, bool up) const;
+
   void DoDispose (void);
 
   /* From Ipv4RoutingProtocol */
@@ -244,6 +294,42 @@ private:
 
   /** Total neighbors used for nix-vector to determine number of bits */
   uint32_t m_totalNeighbors;
+
+  /**
+   * Whether to derive the nix-vectors from one BFS tree per source node
+   * rather than from one BFS per destination
+   */
+  bool m_bfsTreePerSource;
+
+  /** BFS tree of this node: the parent of each node, if reached */
+  mutable std::vector<uint32_t> m_bfsParents;
+
+  /** BFS tree of this node: the visiting order of each node, if reached */
+  mutable std::vector<uint32_t> m_bfsOrder;
+
+  /**
+   * \brief Adjacency of the nodes in compressed sparse row form, as
+   * walked by BFS ()
+   *
+   * The devices with a channel of each node are stored contiguously,
+   * and so are the neighbors through each device.
+   */
+  struct Adjacency
+  {
+    std::vector<uint32_t> nodeDevices;     //!< the first device of each node, and the end
+    std::vector<uint32_t> devices;         //!< the index of each device in its node
+    std::vector<bool> bridges;             //!< whether each device is a bridge
+    std::vector<uint32_t> deviceNeighbors; //!< the first neighbor of each device, and the end
+    std::vector<uint32_t> neighbors;       //!< the node index of each neighbor
+    std::vector<uint32_t> nDevices;        //!< the number of devices of each node
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> addresses; //!< the node index of each address
+  };
+
+  /** Adjacency of the nodes shared by the BFS trees */
+  static Adjacency g_adjacency;
+
+  /** Flag to mark when the adjacency is out of date and needs to be rebuilt */
+  static bool g_isAdjacencyValid;
 };
 } // namespace ns3
 
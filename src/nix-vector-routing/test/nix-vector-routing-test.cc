@@ -0,0 +1,329 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/nix-vector.h"
+#include "ns3/packet.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \brief Connect nodes with a SimpleChannel.
+ * \param nodes the nodes
+ * \returns the devices
+ */
+static NetDeviceContainer
+Connect (NodeContainer nodes)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  return devices;
+}
+
+/**
+ * \ingroup nix-vector-routing
+ * \defgroup nix-vector-routing-test Nix-vector routing module tests
+ */
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing Test: the nix-vectors derived from one BFS tree
+ * per source (BfsTreePerSource attribute) are the ones of the BFS per
+ * destination, including after an interface goes down and comes back up.
+ */
+class Ipv4NixVectorBfsTreeTestCase : public TestCase
+{
+public:
+  Ipv4NixVectorBfsTreeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Compute the routes between all the nodes of a grid with a LAN,
+   * while interfaces go down and up.
+   *
+   * \param bfsTreePerSource the BfsTreePerSource attribute of the routing
+   * \returns the routes, one line per source, destination and round:
+   * the gateway, the output device and the nix-vector
+   */
+  std::vector<std::string> ComputeRoutes (bool bfsTreePerSource);
+};
+
+Ipv4NixVectorBfsTreeTestCase::Ipv4NixVectorBfsTreeTestCase ()
+  : TestCase ("Nix-vectors of the BFS trees per source")
+{
+}
+
+std::vector<std::string>
+Ipv4NixVectorBfsTreeTestCase::ComputeRoutes (bool bfsTreePerSource)
+{
+  Config::SetDefault ("ns3::Ipv4NixVectorRouting::BfsTreePerSource", BooleanValue (bfsTreePerSource));
+
+  // A 4x4 grid of point-to-point links, with a LAN of four nodes
+  // hanging off the last node of the grid
+  const uint32_t n = 4;
+  NodeContainer nodes;
+  nodes.Create (n * n + 3);
+  Ipv4NixVectorHelper nix;
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (nix);
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (uint32_t j = 0; j < n; j++)
+        {
+          if (j + 1 < n)
+            {
+              address.Assign (Connect (NodeContainer (nodes.Get (i * n + j), nodes.Get (i * n + j + 1))));
+              address.NewNetwork ();
+            }
+          if (i + 1 < n)
+            {
+              address.Assign (Connect (NodeContainer (nodes.Get (i * n + j), nodes.Get ((i + 1) * n + j))));
+              address.NewNetwork ();
+            }
+        }
+    }
+  NodeContainer lan (nodes.Get (n * n - 1));
+  for (uint32_t i = n * n; i < nodes.GetN (); i++)
+    {
+      lan.Add (nodes.Get (i));
+    }
+  Ipv4AddressHelper lanAddress ("192.168.0.0", "255.255.255.0");
+  lanAddress.Assign (Connect (lan));
+
+  std::vector<Ipv4Address> destinations;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      destinations.push_back (nodes.Get (i)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+    }
+
+  std::vector<std::string> routes;
+  for (uint32_t round = 0; round < 5; round++)
+    {
+      // The first link of a node inside the grid, then of the first node
+      // of the grid, goes down and comes back up
+      Ptr<Ipv4> ipv4 = nodes.Get (round < 3 ? n + 1 : 0)->GetObject<Ipv4> ();
+      if (round == 1 || round == 3)
+        {
+          ipv4->SetDown (1);
+        }
+      else if (round == 2 || round == 4)
+        {
+          ipv4->SetUp (1);
+        }
+
+      for (uint32_t source = 0; source < nodes.GetN (); source++)
+        {
+          Ptr<Ipv4RoutingProtocol> routing = nodes.Get (source)->GetObject<Ipv4> ()->GetRoutingProtocol ();
+          for (uint32_t destination = 0; destination < destinations.size (); destination++)
+            {
+              if (destination == source)
+                {
+                  continue;
+                }
+              Ptr<Packet> packet = Create<Packet> (10);
+              Ipv4Header header;
+              header.SetDestination (destinations[destination]);
+              Socket::SocketErrno error;
+              Ptr<Ipv4Route> route = routing->RouteOutput (packet, header, 0, error);
+              std::ostringstream oss;
+              oss << round << " " << source << " " << destination << " ";
+              if (route)
+                {
+                  oss << route->GetGateway () << " " << route->GetOutputDevice ()->GetIfIndex ()
+                      << " " << *packet->GetNixVector ();
+                }
+              else
+                {
+                  oss << "none";
+                }
+              routes.push_back (oss.str ());
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+  Config::Reset ();
+  return routes;
+}
+
+void
+Ipv4NixVectorBfsTreeTestCase::DoRun (void)
+{
+  std::vector<std::string> expected = ComputeRoutes (false);
+  std::vector<std::string> routes = ComputeRoutes (true);
+
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), expected.size (), "Different number of routes");
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (routes[i], expected[i], "Different route");
+    }
+
+  // The interfaces going down change some routes, and going up restores them
+  uint32_t perRound = routes.size () / 5;
+  uint32_t changed = 0;
+  for (uint32_t i = 0; i < perRound; i++)
+    {
+      std::string initial = routes[i].substr (2);
+      changed += (routes[perRound + i].substr (2) != initial);
+      NS_TEST_EXPECT_MSG_EQ (routes[2 * perRound + i].substr (2), initial, "Route not restored");
+      NS_TEST_EXPECT_MSG_EQ (routes[4 * perRound + i].substr (2), initial, "Route not restored");
+    }
+  NS_TEST_EXPECT_MSG_GT (changed, 0, "No route changed by the interface going down");
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing Test: the forwarding cache of Ipv4L3Protocol is
+ * not used, since the routers consume the nix-vector of each packet.
+ *
+ * In the line of nodes 0 - 1 - 2 - 3, the devices of node 2 are in the
+ * reverse order of those of node 1, and only node 1 has a forwarding cache:
+ * node 2 would send back the packets whose nix-vector has not been consumed
+ * by node 1.
+ */
+class Ipv4NixVectorForwardingCacheTestCase : public TestCase
+{
+public:
+  Ipv4NixVectorForwardingCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send a packet
+   * \param ipv4 the IPv4 of the source
+   * \param source the source address
+   * \param destination the destination address
+   */
+  void SendPacket (Ptr<Ipv4> ipv4, Ipv4Address source, Ipv4Address destination);
+
+  /**
+   * \brief Packet delivered to the destination
+   * \param header the IPv4 header
+   * \param packet the packet
+   * \param interface the incoming interface
+   */
+  void LocalDeliver (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+
+  uint32_t m_delivered; //!< Number of packets delivered to the destination
+};
+
+Ipv4NixVectorForwardingCacheTestCase::Ipv4NixVectorForwardingCacheTestCase ()
+  : TestCase ("Nix-vector routing bypasses the forwarding cache"),
+    m_delivered (0)
+{
+}
+
+void
+Ipv4NixVectorForwardingCacheTestCase::SendPacket (Ptr<Ipv4> ipv4, Ipv4Address source, Ipv4Address destination)
+{
+  // An experimental protocol number, which no protocol handles
+  ipv4->Send (Create<Packet> (100), source, destination, 253, 0);
+}
+
+void
+Ipv4NixVectorForwardingCacheTestCase::LocalDeliver (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  m_delivered++;
+}
+
+void
+Ipv4NixVectorForwardingCacheTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  Ipv4NixVectorHelper nix;
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (nix);
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer interfaces23 = address.Assign (Connect (NodeContainer (nodes.Get (2), nodes.Get (3))));
+  address.NewNetwork ();
+  Ipv4InterfaceContainer interfaces01 = address.Assign (Connect (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  address.NewNetwork ();
+  address.Assign (Connect (NodeContainer (nodes.Get (1), nodes.Get (2))));
+
+  Ptr<Ipv4> router = nodes.Get (1)->GetObject<Ipv4> ();
+  NS_TEST_ASSERT_MSG_EQ (router->GetRoutingProtocol ()->IsForwardingCacheable (), false,
+                         "Nix-vector routing cannot use the forwarding cache");
+  router->SetAttribute ("ForwardingCacheSize", UintegerValue (16));
+  nodes.Get (3)->GetObject<Ipv4> ()->TraceConnectWithoutContext ("LocalDeliver",
+                                                                MakeCallback (&Ipv4NixVectorForwardingCacheTestCase::LocalDeliver, this));
+
+  Ptr<Ipv4> ipv4 = nodes.Get (0)->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (1 + i), &Ipv4NixVectorForwardingCacheTestCase::SendPacket, this,
+                           ipv4, interfaces01.GetAddress (0), interfaces23.GetAddress (1));
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_delivered, 10, "Packets lost with the forwarding cache of the router");
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing TestSuite
+ */
+class Ipv4NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorRoutingTestSuite () : TestSuite ("ipv4-nix-vector-routing", UNIT)
+  {
+    AddTestCase (new Ipv4NixVectorBfsTreeTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4NixVectorForwardingCacheTestCase (), TestCase::QUICK);
+  }
+};
+
+static Ipv4NixVectorRoutingTestSuite g_ipv4NixVectorRoutingTestSuite; //!< Static variable for test initialization
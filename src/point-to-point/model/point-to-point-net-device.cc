@@ -26,6 +26,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/super-segment-tag.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -284,7 +285,15 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  uint32_t wireBytes = p->GetSize ();
+  SuperSegmentTag superSegment;
+  if (p->PeekPacketTag (superSegment))
+    {
+      // The link is busy as long as it would be for the segments, each
+      // with its own headers and PPP framing
+      wireBytes += superSegment.GetExtraWireBytes (PppHeader ().GetSerializedSize ());
+    }
+  Time txTime = m_bps.CalculateBytesTxTime (wireBytes);
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
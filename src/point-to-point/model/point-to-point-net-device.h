@@ -59,6 +59,12 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * A super-segment (see SuperSegmentTag) is transmitted as a single packet
+ * in the time its segments would take, headers and framing included. The
+ * IP layer hands super-segments over whole only to devices whose MTU can
+ * carry them (e.g., 65535 bytes); for the others it splits them into their
+ * segments, which then get their own queueing and drop decisions.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -94,6 +94,22 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+bool
+PropagationLossModel::IsPositionOnly (void) const
+{
+  if (!g_log.IsNoneEnabled () || !DoIsPositionOnly ())
+    {
+      return false;
+    }
+  return (m_next == 0 || m_next->IsPositionOnly ());
+}
+
+bool
+PropagationLossModel::DoIsPositionOnly (void) const
+{
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -277,6 +293,12 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FriisPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -451,6 +473,12 @@ TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+TwoRayGroundPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel);
@@ -540,6 +568,12 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+LogDistancePropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -642,6 +676,12 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+ThreeLogDistancePropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -804,6 +844,12 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FixedRssLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel);
@@ -930,6 +976,12 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+RangePropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
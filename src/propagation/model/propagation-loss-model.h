@@ -106,6 +106,22 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns whether the Rx Power computed by this PropagationLossModel and
+   * by all the PropagationLossModel(s) chained to it only depends on the
+   * transmission power and on the positions of the source and destination.
+   *
+   * Such a chain neither draws random variables nor modifies its state in
+   * CalcRxPower, hence it can be evaluated concurrently for several pairs
+   * of mobility models that are not shared between the callers.
+   *
+   * Since the logging is not thread-safe, false is returned while the
+   * PropagationLossModel log component is enabled.
+   *
+   * \return true if the chain only depends on the positions of the nodes
+   */
+  bool IsPositionOnly (void) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +156,14 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Subclasses whose loss only depends on the positions of the nodes
+   * can return true; the default implementation returns false.
+   *
+   * \return true if this particular model only depends on the positions of the nodes
+   */
+  virtual bool DoIsPositionOnly (void) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +346,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +467,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +556,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +640,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -747,6 +775,7 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
   double m_rss; //!< the received signal strength
 };
 
@@ -852,6 +881,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
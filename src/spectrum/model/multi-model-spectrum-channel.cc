@@ -26,6 +26,7 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -36,6 +37,7 @@
 #include <ns3/angles.h>
 #include <iostream>
 #include <utility>
+#include <typeinfo>
 #include "multi-model-spectrum-channel.h"
 
 
@@ -81,7 +83,27 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 }
 
 
+LinkGainInfo::LinkGainInfo ()
+  : m_valid (false),
+    m_txAntennaVersion (0),
+    m_rxAntennaVersion (0),
+    m_pathLossDb (0),
+    m_pathGainLinear (1)
+{
+}
+
+
+std::size_t
+SpectrumPhyPairHash::operator() (const SpectrumPhyPair_t& phys) const
+{
+  std::hash<const SpectrumPhy *> hasher;
+  return hasher (phys.first) ^ (hasher (phys.second) * 31);
+}
+
+
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_numDevices (0),
+    m_cacheLinkGains (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -92,6 +114,9 @@ MultiModelSpectrumChannel::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_linkGainInfoMap.clear ();
+  m_interferenceMap.clear ();
+  m_interferenceOnly = MakeNullCallback<bool, Ptr<const SpectrumSignalParameters>, Ptr<const SpectrumPhy> > ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -102,7 +127,15 @@ MultiModelSpectrumChannel::GetTypeId (void)
     .SetParent<SpectrumChannel> ()
     .SetGroupName ("Spectrum")
     .AddConstructor<MultiModelSpectrumChannel> ()
-
+    .AddAttribute ("CacheLinkGains",
+                   "If true, the path loss of each (transmitter, receiver) pair, "
+                   "including the antenna gains, is computed once and reused "
+                   "as long as the positions of the two ends and the radiation "
+                   "patterns of their antennas do not change. This is only done "
+                   "if the PropagationLossModel only depends on the positions.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_cacheLinkGains),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -120,6 +153,9 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
+  // the antenna or the mobility model of the phy might have been replaced
+  m_linkGainInfoMap.clear ();
+
   // remove a previous entry of this phy if it exists
   // we need to scan for all rxSpectrumModel values since we don't
   // know which spectrum model the phy had when it was previously added
@@ -245,6 +281,8 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  bool useCache = m_cacheLinkGains && (m_propagationLoss == 0 || m_propagationLoss->IsPositionOnly ());
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -280,56 +318,94 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
               Time delay = MicroSeconds (0);
+              double pathGainLinear = 1.0;
 
               Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
 
               if (txMobility && receiverMobility)
                 {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
                   Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
+                  double pathLossDb;
+                  if (useCache)
                     {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
+                      Vector txPosition = txMobility->GetPosition ();
+                      Vector rxPosition = receiverMobility->GetPosition ();
+                      LinkGainInfo &info = m_linkGainInfoMap[std::make_pair (PeekPointer (txParams->txPhy), PeekPointer (*rxPhyIterator))];
+                      if (!info.m_valid
+                          || info.m_txPosition.x != txPosition.x || info.m_txPosition.y != txPosition.y || info.m_txPosition.z != txPosition.z
+                          || info.m_rxPosition.x != rxPosition.x || info.m_rxPosition.y != rxPosition.y || info.m_rxPosition.z != rxPosition.z
+                          || info.m_txAntenna != txParams->txAntenna
+                          || (info.m_txAntenna != 0 && info.m_txAntennaVersion != info.m_txAntenna->GetPatternVersion ())
+                          || info.m_rxAntenna != rxAntenna
+                          || (info.m_rxAntenna != 0 && info.m_rxAntennaVersion != info.m_rxAntenna->GetPatternVersion ()))
+                        {
+                          info.m_valid = true;
+                          info.m_txPosition = txPosition;
+                          info.m_rxPosition = rxPosition;
+                          info.m_txAntenna = txParams->txAntenna;
+                          info.m_txAntennaVersion = (txParams->txAntenna != 0) ? txParams->txAntenna->GetPatternVersion () : 0;
+                          info.m_rxAntenna = rxAntenna;
+                          info.m_rxAntennaVersion = (rxAntenna != 0) ? rxAntenna->GetPatternVersion () : 0;
+                          info.m_pathLossDb = CalcPathLossDb (txParams->txAntenna, txMobility, rxAntenna, receiverMobility);
+                          info.m_pathGainLinear = std::pow (10.0, (-info.m_pathLossDb) / 10.0);
+                        }
+                      else
+                        {
+                          NS_LOG_LOGIC ("cached pathLoss = " << info.m_pathLossDb << " dB");
+                        }
+                      pathLossDb = info.m_pathLossDb;
+                      pathGainLinear = info.m_pathGainLinear;
                     }
-                  if (m_propagationLoss)
+                  else
                     {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
+                      pathLossDb = CalcPathLossDb (txParams->txAntenna, txMobility, rxAntenna, receiverMobility);
+                      pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+                    }
                   m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
                   if ( pathLossDb > m_maxLossDb)
                     {
                       // beyond range
                       continue;
                     }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
+                  if (m_propagationDelay)
+                    {
+                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+                    }
+                }
+
+              bool interferenceOnly = !m_interferenceOnly.IsNull () && m_interferenceOnly (txParams, *rxPhyIterator);
+              if (interferenceOnly && !(m_spectrumPropagationLoss && txMobility && receiverMobility))
+                {
+                  // only the contribution of the signal to the sum is needed
+                  Ptr<SpectrumSignalParameters> interference = FindAndEventuallyAddInterference (txParams, *rxPhyIterator,
+                                                                                                rxInfoIterator->second.m_rxSpectrumModel,
+                                                                                                delay);
+                  interference->psd->AddScaled (*convertedTxPowerSpectrum, pathGainLinear);
+                  continue;
+                }
+
+              NS_LOG_LOGIC (" copying signal parameters " << txParams);
+              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+
+              if (txMobility && receiverMobility)
+                {
+                  *(rxParams->psd) *= pathGainLinear;
 
                   if (m_spectrumPropagationLoss)
                     {
                       rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
                     }
+                }
 
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
+              if (interferenceOnly)
+                {
+                  Ptr<SpectrumSignalParameters> interference = FindAndEventuallyAddInterference (txParams, *rxPhyIterator,
+                                                                                                rxInfoIterator->second.m_rxSpectrumModel,
+                                                                                                delay);
+                  *(interference->psd) += *(rxParams->psd);
+                  continue;
                 }
 
               Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
@@ -353,6 +429,87 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 }
 
+Ptr<SpectrumSignalParameters>
+MultiModelSpectrumChannel::FindAndEventuallyAddInterference (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumPhy> receiver,
+                                                             Ptr<const SpectrumModel> rxSpectrumModel, Time delay)
+{
+  NS_LOG_FUNCTION (this << txParams << receiver << delay);
+  InterferenceKey_t key (receiver, Simulator::Now () + delay, txParams->duration,
+                         std::type_index (typeid (*PeekPointer (txParams))));
+  std::map<InterferenceKey_t, Ptr<SpectrumSignalParameters> >::iterator it = m_interferenceMap.find (key);
+  if (it != m_interferenceMap.end ())
+    {
+      return it->second;
+    }
+
+  // first signal of this type which is only interference for the receiver:
+  // the sum is delivered with the parameters of this signal
+  Ptr<SpectrumSignalParameters> interference = txParams->Copy ();
+  interference->psd = Create<SpectrumValue> (rxSpectrumModel);
+  m_interferenceMap.insert (std::make_pair (key, interference));
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRxInterference, this,
+                                      interference, receiver);
+    }
+  else
+    {
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRxInterference, this,
+                           interference, receiver);
+    }
+  return interference;
+}
+
+void
+MultiModelSpectrumChannel::StartRxInterference (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << params << receiver);
+  InterferenceKey_t key (receiver, Simulator::Now (), params->duration,
+                         std::type_index (typeid (*PeekPointer (params))));
+  NS_ASSERT (m_interferenceMap.find (key) != m_interferenceMap.end ());
+  m_interferenceMap.erase (key);
+  receiver->StartRx (params);
+}
+
+void
+MultiModelSpectrumChannel::SetInterferenceOnlyCallback (InterferenceOnlyCallback c)
+{
+  NS_LOG_FUNCTION (this);
+  m_interferenceOnly = c;
+}
+
+double
+MultiModelSpectrumChannel::CalcPathLossDb (Ptr<AntennaModel> txAntenna, Ptr<MobilityModel> txMobility,
+                                           Ptr<AntennaModel> rxAntenna, Ptr<MobilityModel> receiverMobility) const
+{
+  NS_LOG_FUNCTION (this << txAntenna << txMobility << rxAntenna << receiverMobility);
+  double pathLossDb = 0;
+  if (txAntenna != 0)
+    {
+      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+      double txAntennaGain = txAntenna->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+      pathLossDb -= txAntennaGain;
+    }
+  if (rxAntenna != 0)
+    {
+      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+      pathLossDb -= rxAntennaGain;
+    }
+  if (m_propagationLoss)
+    {
+      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+      pathLossDb -= propagationGainDb;
+    }
+  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+  return pathLossDb;
+}
+
 void
 MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
@@ -27,8 +27,13 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/vector.h>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <tuple>
+#include <typeindex>
 
 namespace ns3 {
 
@@ -90,6 +95,56 @@ public:
 typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap_t;
 
 
+/**
+ * \ingroup spectrum
+ *
+ * The part of the gain of a link which only depends on the positions and
+ * on the antennas of its two ends, together with the values of the
+ * parameters it was computed with.
+ */
+class LinkGainInfo
+{
+public:
+  LinkGainInfo ();
+  bool m_valid;                         //!< whether the other fields have been set
+  Vector m_txPosition;                  //!< position of the transmitter
+  Vector m_rxPosition;                  //!< position of the receiver
+  Ptr<const AntennaModel> m_txAntenna;  //!< antenna of the transmitter
+  uint32_t m_txAntennaVersion;          //!< pattern version of the antenna of the transmitter
+  Ptr<const AntennaModel> m_rxAntenna;  //!< antenna of the receiver
+  uint32_t m_rxAntennaVersion;          //!< pattern version of the antenna of the receiver
+  double m_pathLossDb;                  //!< path loss in dB, including the antenna gains
+  double m_pathGainLinear;              //!< linear gain corresponding to m_pathLossDb
+};
+
+/**
+ * \ingroup spectrum
+ * (transmitter, receiver) pair
+ */
+typedef std::pair<const SpectrumPhy *, const SpectrumPhy *> SpectrumPhyPair_t;
+
+/**
+ * \ingroup spectrum
+ * Function object that computes the hash of a (transmitter, receiver) pair
+ */
+struct SpectrumPhyPairHash
+{
+  /**
+   * Functional operator for (transmitter, receiver) hash computation.
+   *
+   * \param phys the (transmitter, receiver) pair
+   * \return the hash
+   */
+  std::size_t operator() (const SpectrumPhyPair_t& phys) const;
+};
+
+/**
+ * \ingroup spectrum
+ * Container: (transmitter, receiver) pair, LinkGainInfo
+ */
+typedef std::unordered_map<SpectrumPhyPair_t, LinkGainInfo, SpectrumPhyPairHash> LinkGainInfoMap_t;
+
+
 /**
  * \ingroup spectrum
  *
@@ -102,6 +157,15 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * When the CacheLinkGains attribute is enabled and the
+ * PropagationLossModel only depends on the positions of the nodes (see
+ * PropagationLossModel::IsPositionOnly), the path loss of each (transmitter,
+ * receiver) pair, antenna gains included, is computed once and reused by
+ * the following transmissions as long as the positions of the two ends
+ * and the radiation patterns of their antennas do not change. The
+ * SpectrumPropagationLossModel (e.g., fast fading) and the
+ * PropagationDelayModel are still evaluated for every transmission.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -124,6 +188,29 @@ public:
   virtual std::size_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
+  /**
+   * Callback telling whether a signal is only interference for a receiver,
+   * i.e., whether the receiver will not try to decode it.
+   *
+   * \param [in] params the parameters of the transmitted signal
+   * \param [in] receiver the receiver
+   * \return true if the signal is only interference for the receiver
+   */
+  typedef Callback<bool, Ptr<const SpectrumSignalParameters>, Ptr<const SpectrumPhy> > InterferenceOnlyCallback;
+
+  /**
+   * Set the callback telling which signals are only interference for a
+   * receiver. These signals are not delivered one by one: the ones
+   * arriving at a receiver at the same time, with the same duration and
+   * with parameters of the same type are summed, and the receiver gets a
+   * single signal having the parameters of the first of them and the sum
+   * of their PSDs. The receiver must therefore handle the signals for
+   * which the callback returns true only as interference.
+   *
+   * \param c the callback (a null callback disables the aggregation)
+   */
+  void SetInterferenceOnlyCallback (InterferenceOnlyCallback c);
+
 
 protected:
   void DoDispose ();
@@ -149,6 +236,49 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * (receiver, arrival time, duration, type of the parameters) of the sum
+   * of the signals which are only interference for the receiver
+   */
+  typedef std::tuple<Ptr<SpectrumPhy>, Time, Time, std::type_index> InterferenceKey_t;
+
+  /**
+   * Get the signal collecting the sum of the signals which are only
+   * interference for a receiver and have the same arrival time, duration
+   * and type of parameters as the given one. If there is none yet, it is
+   * created with a zero PSD and its reception is scheduled.
+   *
+   * \param txParams the parameters of the transmitted signal
+   * \param receiver the receiver
+   * \param rxSpectrumModel the spectrum model of the receiver
+   * \param delay the propagation delay
+   * \return the parameters of the sum of the signals
+   */
+  Ptr<SpectrumSignalParameters> FindAndEventuallyAddInterference (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumPhy> receiver,
+                                                                  Ptr<const SpectrumModel> rxSpectrumModel, Time delay);
+
+  /**
+   * Deliver the sum of the signals which are only interference for a
+   * receiver.
+   *
+   * \param params the parameters of the sum of the signals
+   * \param receiver the receiver
+   */
+  void StartRxInterference (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  /**
+   * Compute the path loss between a transmitter and a receiver, including
+   * the gains of their antennas.
+   *
+   * \param txAntenna the antenna of the transmitter (can be null)
+   * \param txMobility the mobility model of the transmitter
+   * \param rxAntenna the antenna of the receiver (can be null)
+   * \param receiverMobility the mobility model of the receiver
+   * \return the path loss in dB
+   */
+  double CalcPathLossDb (Ptr<AntennaModel> txAntenna, Ptr<MobilityModel> txMobility,
+                         Ptr<AntennaModel> rxAntenna, Ptr<MobilityModel> receiverMobility) const;
+
   /**
    * Data structure holding, for each TX SpectrumModel,  all the
    * converters to any RX SpectrumModel, and all the corresponding
@@ -169,6 +299,29 @@ private:
    */
   std::size_t m_numDevices;
 
+  /**
+   * Whether the path loss of the links is stored in m_linkGainInfoMap
+   */
+  bool m_cacheLinkGains;
+
+  /**
+   * Path loss of the links, indexed by (transmitter, receiver), when the
+   * CacheLinkGains attribute is enabled
+   */
+  LinkGainInfoMap_t m_linkGainInfoMap;
+
+  /**
+   * Callback telling which signals are only interference for a receiver
+   */
+  InterferenceOnlyCallback m_interferenceOnly;
+
+  /**
+   * Sums of the signals which are only interference for a receiver, whose
+   * reception is scheduled
+   */
+  std::map<InterferenceKey_t, Ptr<SpectrumSignalParameters> > m_interferenceMap;
+
+
 };
 
 
@@ -35,6 +35,8 @@ SpectrumInterference::SpectrumInterference ()
     m_rxSignal (0),
     m_allSignals (0),
     m_noise (0),
+    m_interf (0),
+    m_sinr (0),
     m_errorModel (0)
 {
   NS_LOG_FUNCTION (this);
@@ -63,6 +65,8 @@ SpectrumInterference::DoDispose ()
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_interf = 0;
+  m_sinr = 0;
   m_errorModel = 0;
   Object::DoDispose ();
 }
@@ -131,7 +135,15 @@ SpectrumInterference::ConditionallyEvaluateChunk ()
   NS_LOG_LOGIC ("if condition: " << condition);
   if (condition)
     {
-      SpectrumValue sinr = (*m_rxSignal) / ((*m_allSignals) - (*m_rxSignal) + (*m_noise));
+      // sinr = rxSignal / (allSignals - rxSignal + noise), computed in place
+      // so that no SpectrumValue is allocated
+      SpectrumValue& interf = *m_interf;
+      interf = *m_allSignals;
+      interf -= *m_rxSignal;
+      interf += *m_noise;
+      SpectrumValue& sinr = *m_sinr;
+      sinr = *m_rxSignal;
+      sinr /= interf;
       Time duration = Now () - m_lastChangeTime;
       NS_LOG_LOGIC ("calling m_errorModel->EvaluateChunk (sinr, duration)");
       m_errorModel->EvaluateChunk (sinr, duration);
@@ -148,6 +160,8 @@ SpectrumInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noi
   // we'll now create a zeroed SpectrumValue using the same
   // SpectrumModel which is being specified for the noise.
   m_allSignals = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  m_interf = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  m_sinr = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
 }
 
 void
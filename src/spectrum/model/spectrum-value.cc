@@ -22,6 +22,7 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -106,17 +107,14 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += w[i];
     }
 }
 
@@ -124,12 +122,11 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -138,17 +135,14 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= w[i];
     }
 }
 
@@ -164,17 +158,14 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= w[i];
     }
 }
 
@@ -182,12 +173,11 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -197,17 +187,14 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= w[i];
     }
 }
 
@@ -216,27 +203,41 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] /= s;
     }
 }
 
 
 
 
+SpectrumValue&
+SpectrumValue::AddScaled (const SpectrumValue& x, double a)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  double *v = m_values.data ();
+  const double *w = x.m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
+    {
+      v[i] += w[i] * a;
+    }
+  return *this;
+}
+
+
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  std::size_t n = m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      *it1 = -(*it1);
-      ++it1;
+      v[i] = -v[i];
     }
 }
 
@@ -361,12 +362,14 @@ Norm (const SpectrumValue& x)
 double
 Sum (const SpectrumValue& x)
 {
+  // the values are accumulated in order, so that the result does not
+  // depend on how the loop is compiled
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const double *v = x.m_values.data ();
+  std::size_t n = x.m_values.size ();
+  for (std::size_t i = 0; i < n; i++)
     {
-      s += (*it1);
-      ++it1;
+      s += v[i];
     }
   return s;
 }
@@ -389,17 +392,15 @@ Prod (const SpectrumValue& x)
 double
 Integral (const SpectrumValue& arg)
 {
+  NS_ASSERT (arg.m_values.size () == arg.m_spectrumModel->GetNumBands ());
   double i = 0;
-  Values::const_iterator vit = arg.ConstValuesBegin ();
+  const double *v = arg.m_values.data ();
   Bands::const_iterator bit = arg.ConstBandsBegin ();
-  while (vit != arg.ConstValuesEnd ())
+  std::size_t n = arg.m_values.size ();
+  for (std::size_t k = 0; k < n; k++, ++bit)
     {
-      NS_ASSERT (bit != arg.ConstBandsEnd ());
-      i += (*vit) * (bit->fh - bit->fl);
-      ++vit;
-      ++bit;
+      i += v[k] * (bit->fh - bit->fl);
     }
-  NS_ASSERT (bit == arg.ConstBandsEnd ());
   return i;
 }
 
@@ -467,9 +468,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -664,13 +664,7 @@ SpectrumValue::operator/= (double rhs)
 SpectrumValue&
 SpectrumValue::operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = rhs;
-      ++it1;
-    }
+  std::fill (m_values.begin (), m_values.end (), rhs);
   return *this;
 }
 
@@ -54,6 +54,14 @@ typedef std::vector<double> Values;
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
+ *
+ * The component by component operations are implemented as plain loops
+ * over the contiguous storage of the values, which the compiler can
+ * vectorize. The compound assignment operators (+=, *=, etc.) and
+ * AddScaled do not allocate memory, hence they should be preferred to the
+ * binary operators in code executed for every signal change. Sum,
+ * Integral and Norm accumulate the values in order, so their result does
+ * not depend on the optimization level.
  */
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
@@ -409,6 +417,23 @@ public:
    */
   SpectrumValue& operator= (double rhs);
 
+  /**
+   * Add the Right Hand Side multiplied by a scalar to *this, component
+   * by component. This is equivalent to *this += x * a, without creating
+   * a temporary SpectrumValue.
+   *
+   * The result is the same as the one of *this += x * a, unless the
+   * compiler fuses the multiplication and the addition (e.g., when
+   * targeting a CPU supporting FMA instructions); for non-negative
+   * operands, each component then differs by at most one ULP.
+   *
+   * @param x the Right Hand Side
+   * @param a the scalar
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddScaled (const SpectrumValue& x, double a);
+
 
 
   /**
@@ -0,0 +1,340 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/object.h>
+#include <ns3/log.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/net-device.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/cosine-antenna-model.h>
+#include <ns3/isotropic-antenna-model.h>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MultiModelSpectrumChannelTest");
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * SpectrumPhy recording the total power of the received signals
+ */
+class LinkCacheTestPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   * \param model the spectrum model of the phy
+   * \param mobility the mobility model of the phy
+   * \param antenna the antenna of the phy
+   */
+  LinkCacheTestPhy (Ptr<const SpectrumModel> model, Ptr<MobilityModel> mobility, Ptr<AntennaModel> antenna);
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+  /**
+   * Set the antenna of the phy
+   * \param antenna the antenna
+   */
+  void SetAntenna (Ptr<AntennaModel> antenna);
+
+  std::vector<double> m_rxPowers; //!< total power of each received signal
+
+private:
+  Ptr<const SpectrumModel> m_model; //!< spectrum model
+  Ptr<MobilityModel> m_mobility;    //!< mobility model
+  Ptr<AntennaModel> m_antenna;      //!< antenna
+};
+
+LinkCacheTestPhy::LinkCacheTestPhy (Ptr<const SpectrumModel> model, Ptr<MobilityModel> mobility, Ptr<AntennaModel> antenna)
+  : m_model (model),
+    m_mobility (mobility),
+    m_antenna (antenna)
+{
+}
+
+void
+LinkCacheTestPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+LinkCacheTestPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+LinkCacheTestPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+LinkCacheTestPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+LinkCacheTestPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+LinkCacheTestPhy::GetRxSpectrumModel () const
+{
+  return m_model;
+}
+
+Ptr<AntennaModel>
+LinkCacheTestPhy::GetRxAntenna ()
+{
+  return m_antenna;
+}
+
+void
+LinkCacheTestPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  m_rxPowers.push_back (Sum (*params->psd));
+}
+
+void
+LinkCacheTestPhy::SetAntenna (Ptr<AntennaModel> antenna)
+{
+  m_antenna = antenna;
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * Log distance propagation loss model counting the number of times it
+ * is invoked
+ */
+class CountingPropagationLossModel : public PropagationLossModel
+{
+public:
+  CountingPropagationLossModel ();
+  uint32_t m_nCalls; //!< number of calls to DoCalcRxPower
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsPositionOnly (void) const;
+};
+
+CountingPropagationLossModel::CountingPropagationLossModel ()
+  : m_nCalls (0)
+{
+}
+
+double
+CountingPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  const_cast<CountingPropagationLossModel *> (this)->m_nCalls++;
+  return txPowerDbm - 40 - 30 * std::log10 (a->GetDistanceFrom (b));
+}
+
+int64_t
+CountingPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+bool
+CountingPropagationLossModel::DoIsPositionOnly (void) const
+{
+  return true;
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * Check that the signals received through a MultiModelSpectrumChannel
+ * caching the path loss of its links are the same as with a channel which
+ * computes it for each transmission, when the nodes move (with and without
+ * CourseChange notifications) and when the antennas change.
+ */
+class MultiModelSpectrumChannelLinkCacheTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumChannelLinkCacheTestCase ();
+  virtual ~MultiModelSpectrumChannelLinkCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Transmit a signal on both channels
+   */
+  void Transmit (void);
+
+  Ptr<MultiModelSpectrumChannel> m_channel[2];         //!< channels without and with cache
+  Ptr<CountingPropagationLossModel> m_loss[2];         //!< propagation loss models of the channels
+  Ptr<LinkCacheTestPhy> m_txPhy[2];                    //!< transmitters of the channels
+  std::vector<Ptr<LinkCacheTestPhy> > m_rxPhys[2];     //!< receivers of the channels
+  Ptr<SpectrumValue> m_txPsd;                          //!< transmitted PSD
+  Ptr<CosineAntennaModel> m_txAntenna;                 //!< antenna of the transmitters
+};
+
+MultiModelSpectrumChannelLinkCacheTestCase::MultiModelSpectrumChannelLinkCacheTestCase ()
+  : TestCase ("Check the link gain cache of MultiModelSpectrumChannel")
+{
+}
+
+MultiModelSpectrumChannelLinkCacheTestCase::~MultiModelSpectrumChannelLinkCacheTestCase ()
+{
+}
+
+void
+MultiModelSpectrumChannelLinkCacheTestCase::Transmit (void)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+      params->duration = MilliSeconds (1);
+      params->psd = m_txPsd;
+      params->txPhy = m_txPhy[i];
+      params->txAntenna = m_txAntenna;
+      m_channel[i]->StartTx (params);
+    }
+}
+
+void
+MultiModelSpectrumChannelLinkCacheTestCase::DoRun (void)
+{
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      freqs.push_back (2e9 + i * 180e3);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+  m_txPsd = Create<SpectrumValue> (model);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      (*m_txPsd)[i] = 1e-3 * (i + 1);
+    }
+
+  // the transmitter and the first receiver are static, the second
+  // receiver moves at constant velocity (without CourseChange)
+  Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  txMobility->SetPosition (Vector (0, 0, 30));
+  Ptr<ConstantPositionMobilityModel> rxMobility1 = CreateObject<ConstantPositionMobilityModel> ();
+  rxMobility1->SetPosition (Vector (200, 50, 1.5));
+  Ptr<ConstantVelocityMobilityModel> rxMobility2 = CreateObject<ConstantVelocityMobilityModel> ();
+  rxMobility2->SetPosition (Vector (-100, 300, 1.5));
+  rxMobility2->SetVelocity (Vector (3, -1, 0));
+
+  m_txAntenna = CreateObject<CosineAntennaModel> ();
+  m_txAntenna->SetAttribute ("Orientation", DoubleValue (30));
+  Ptr<IsotropicAntennaModel> rxAntenna1 = CreateObject<IsotropicAntennaModel> ();
+  Ptr<IsotropicAntennaModel> rxAntenna2 = CreateObject<IsotropicAntennaModel> ();
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_loss[i] = CreateObject<CountingPropagationLossModel> ();
+      m_channel[i] = CreateObject<MultiModelSpectrumChannel> ();
+      m_channel[i]->SetAttribute ("CacheLinkGains", BooleanValue (i == 1));
+      m_channel[i]->AddPropagationLossModel (m_loss[i]);
+      m_txPhy[i] = Create<LinkCacheTestPhy> (model, txMobility, m_txAntenna);
+      m_channel[i]->AddRx (m_txPhy[i]);
+      m_rxPhys[i].push_back (Create<LinkCacheTestPhy> (model, rxMobility1, rxAntenna1));
+      m_rxPhys[i].push_back (Create<LinkCacheTestPhy> (model, rxMobility2, rxAntenna2));
+      for (uint32_t j = 0; j < m_rxPhys[i].size (); j++)
+        {
+          m_channel[i]->AddRx (m_rxPhys[i][j]);
+        }
+    }
+
+  Ptr<IsotropicAntennaModel> newRxAntenna = CreateObject<IsotropicAntennaModel> ();
+  newRxAntenna->SetAttribute ("Gain", DoubleValue (5));
+  uint32_t nTx = 40;
+  for (uint32_t t = 0; t < nTx; t++)
+    {
+      Simulator::Schedule (MilliSeconds (100 * t), &MultiModelSpectrumChannelLinkCacheTestCase::Transmit, this);
+    }
+  // static receiver moved
+  Simulator::Schedule (MilliSeconds (1050), &ConstantPositionMobilityModel::SetPosition, rxMobility1, Vector (250, -20, 1.5));
+  // pattern of the transmit antenna changed
+  Simulator::Schedule (MilliSeconds (1550), &CosineAntennaModel::SetOrientation, m_txAntenna, 120.0);
+  // gain of a receive antenna changed
+  Simulator::Schedule (MilliSeconds (2050), &IsotropicAntennaModel::SetGain, rxAntenna1, 3.0);
+  // receive antenna replaced
+  Simulator::Schedule (MilliSeconds (2550), &LinkCacheTestPhy::SetAntenna, m_rxPhys[0][0], newRxAntenna);
+  Simulator::Schedule (MilliSeconds (2550), &LinkCacheTestPhy::SetAntenna, m_rxPhys[1][0], newRxAntenna);
+  // moving receiver stopped
+  Simulator::Schedule (MilliSeconds (3050), &ConstantVelocityMobilityModel::SetVelocity, rxMobility2, Vector (0, 0, 0));
+  Simulator::Run ();
+
+  for (uint32_t j = 0; j < 2; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxPhys[0][j]->m_rxPowers.size (), nTx, "signals lost without the cache");
+      NS_TEST_ASSERT_MSG_EQ (m_rxPhys[1][j]->m_rxPowers.size (), nTx, "signals lost with the cache");
+      for (uint32_t t = 0; t < nTx; t++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_rxPhys[1][j]->m_rxPowers[t], m_rxPhys[0][j]->m_rxPowers[t],
+                                 "different power received by receiver " << j << " at transmission " << t);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_loss[0]->m_nCalls, 2 * nTx, "propagation loss not computed for each transmission");
+  // the static receiver changes 4 times, the moving one moves for 31
+  // transmissions (the first one included) and stops once
+  NS_TEST_ASSERT_MSG_EQ (m_loss[1]->m_nCalls, 5 + 32, "unexpected number of path loss computations with the cache");
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_channel[i]->Dispose ();
+    }
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * MultiModelSpectrumChannel test suite
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumChannelTestSuite ();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite ()
+  : TestSuite ("multi-model-spectrum-channel", UNIT)
+{
+  AddTestCase (new MultiModelSpectrumChannelLinkCacheTestCase, TestCase::QUICK);
+}
+
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite; ///< the test suite
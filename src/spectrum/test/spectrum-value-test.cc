@@ -203,6 +203,12 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv5, v5, "tv5 *= v2"), TestCase::QUICK);
   AddTestCase (new SpectrumValueTestCase (tv6, v6, "tv6 div= v2"), TestCase::QUICK);
 
+  SpectrumValue tv11 (f), v11 (f);
+  v11 = v1 + v2 * doubleValue;
+  tv11 = v1;
+  tv11.AddScaled (v2, doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv11, v11, "tv11.AddScaled (v2, doubleValue)"), TestCase::QUICK);
+
   SpectrumValue tv7a (f), tv8a (f), tv9a (f), tv10a (f);
   tv7a = v1 + doubleValue;
   tv8a = v1 - doubleValue;
@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/queue-size.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/queue-disc.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpSuperSegmentTest");
+
+// ===========================================================================
+// Tests of the TCP super-segments
+// ===========================================================================
+//
+// A bulk transfer from n0 to n2 over the topology
+//
+//     n0 ------------------ n1 ------------------ n2
+//          1 Gbps, 1 ms           10 Mbps, 10 ms
+//          MTU 65535              bottleneck
+//
+// is run with segments, then with super-segments. The throughput and the
+// time-averaged congestion window of the two runs must agree within a
+// tolerance. If the bottleneck has the default MTU, n1 splits the
+// super-segments, and the losses at its queue are those of segments.
+//
+// Otherwise the bottleneck carries the super-segments whole, and its queue
+// drops whole super-segments. The drops are then not exactly those of the
+// segments, but the averages still agree when the queue counts bytes (it
+// counts a super-segment as one packet) and the super-segments are small
+// with respect to it.
+//
+// The number of packet transmissions over the two links, each costing a few
+// events, and the wall clock time of the two runs are logged; the
+// super-segments must save transmissions.
+//
+class Ns3TcpSuperSegmentTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param largeBottleneck if true, the bottleneck carries the super-segments
+   * whole, otherwise it has the default MTU, and they are split by n1
+   * \param queueBytes if not zero, the size in bytes of the FIFO queue of
+   * the bottleneck, otherwise it has the default queue of 100 packets
+   * \param superSegmentSize the SuperSegmentSize of the sockets
+   * \param sack whether SACK is enabled
+   * \param desc the description of the test
+   */
+  Ns3TcpSuperSegmentTestCase (bool largeBottleneck, uint32_t queueBytes, uint32_t superSegmentSize,
+                              bool sack, std::string desc);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run the transfer
+   * \param superSegmentSize the SuperSegmentSize of the sockets
+   * \param throughput the throughput, in bit/s
+   * \param cWnd the time-averaged congestion window, in bytes
+   * \param superSegments the number of super-segments sent by n0
+   * \param transmissions the number of packets transmitted over the links
+   * \param drops the number of packets dropped by the bottleneck queue
+   * \param wallClockMs the wall clock time of the run, in milliseconds
+   */
+  void RunTransfer (uint32_t superSegmentSize, double &throughput, double &cWnd,
+                    uint32_t &superSegments, uint32_t &transmissions, uint32_t &drops,
+                    int64_t &wallClockMs);
+
+  /**
+   * \brief Connect the congestion window trace of the sender socket
+   */
+  void ConnectCwndTrace (void);
+
+  /**
+   * \brief Congestion window trace
+   * \param oldValue the old value
+   * \param newValue the new value
+   */
+  void CwndChange (uint32_t oldValue, uint32_t newValue);
+
+  /**
+   * \brief Sample the congestion window
+   */
+  void SampleCwnd (void);
+
+  /**
+   * \brief Packet transmitted by the access link device of n0
+   * \param p the packet
+   */
+  void MacTx (Ptr<const Packet> p);
+
+  /**
+   * \brief Packet transmitted by a device
+   * \param p the packet
+   */
+  void PhyTxBegin (Ptr<const Packet> p);
+
+  /**
+   * \brief Packet dropped by the bottleneck queue
+   * \param item the packet
+   */
+  void QueueDrop (Ptr<const QueueDiscItem> item);
+
+  bool m_largeBottleneck;     //!< Whether the bottleneck carries the super-segments
+  uint32_t m_queueBytes;      //!< Size in bytes of the bottleneck queue, or zero
+  uint32_t m_superSegmentSize; //!< SuperSegmentSize of the sockets
+  bool m_sack;                //!< Whether SACK is enabled
+  uint32_t m_cWnd;           //!< Current congestion window
+  double m_cWndSum;          //!< Sum of the samples of the congestion window
+  uint32_t m_cWndSamples;    //!< Number of samples of the congestion window
+  uint32_t m_superSegments;  //!< Number of super-segments sent
+  uint32_t m_transmissions;  //!< Number of packets transmitted over the links
+  uint32_t m_drops;          //!< Number of packets dropped by the bottleneck queue
+};
+
+Ns3TcpSuperSegmentTestCase::Ns3TcpSuperSegmentTestCase (bool largeBottleneck, uint32_t queueBytes,
+                                                        uint32_t superSegmentSize, bool sack,
+                                                        std::string desc)
+  : TestCase ("Check that TCP super-segments match segments, " + desc),
+    m_largeBottleneck (largeBottleneck),
+    m_queueBytes (queueBytes),
+    m_superSegmentSize (superSegmentSize),
+    m_sack (sack),
+    m_cWnd (0),
+    m_cWndSum (0),
+    m_cWndSamples (0),
+    m_superSegments (0),
+    m_transmissions (0),
+    m_drops (0)
+{
+}
+
+void
+Ns3TcpSuperSegmentTestCase::CwndChange (uint32_t oldValue, uint32_t newValue)
+{
+  m_cWnd = newValue;
+}
+
+void
+Ns3TcpSuperSegmentTestCase::SampleCwnd (void)
+{
+  m_cWndSum += m_cWnd;
+  m_cWndSamples++;
+  Simulator::Schedule (MilliSeconds (10), &Ns3TcpSuperSegmentTestCase::SampleCwnd, this);
+}
+
+void
+Ns3TcpSuperSegmentTestCase::ConnectCwndTrace (void)
+{
+  Config::ConnectWithoutContext ("/NodeList/0/$ns3::TcpL4Protocol/SocketList/0/CongestionWindow",
+                                 MakeCallback (&Ns3TcpSuperSegmentTestCase::CwndChange, this));
+}
+
+void
+Ns3TcpSuperSegmentTestCase::MacTx (Ptr<const Packet> p)
+{
+  // Larger than a segment with its headers
+  if (p->GetSize () > 3000)
+    {
+      m_superSegments++;
+    }
+}
+
+void
+Ns3TcpSuperSegmentTestCase::PhyTxBegin (Ptr<const Packet> p)
+{
+  m_transmissions++;
+}
+
+void
+Ns3TcpSuperSegmentTestCase::QueueDrop (Ptr<const QueueDiscItem> item)
+{
+  m_drops++;
+}
+
+void
+Ns3TcpSuperSegmentTestCase::RunTransfer (uint32_t superSegmentSize, double &throughput,
+                                         double &cWnd, uint32_t &superSegments,
+                                         uint32_t &transmissions, uint32_t &drops,
+                                         int64_t &wallClockMs)
+{
+  m_cWnd = 0;
+  m_cWndSum = 0;
+  m_cWndSamples = 0;
+  m_superSegments = 0;
+  m_transmissions = 0;
+  m_drops = 0;
+  SystemWallClockMs wallClock;
+  wallClock.Start ();
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 20));
+  // The queues count a super-segment as one packet: when the bottleneck
+  // carries them whole into the default queue, the transfer is limited by
+  // the receiver window
+  bool rwndLimited = m_largeBottleneck && m_queueBytes == 0;
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (rwndLimited ? 1 << 16 : 1 << 20));
+  Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (m_sack));
+  Config::SetDefault ("ns3::TcpSocketBase::SuperSegmentSize", UintegerValue (superSegmentSize));
+  Config::SetDefault ("ns3::PfifoFastQueueDisc::MaxSize", QueueSizeValue (QueueSize ("100p")));
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  access.SetDeviceAttribute ("Mtu", UintegerValue (65535));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer accessDevices = access.Install (nodes.Get (0), nodes.Get (1));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  if (m_largeBottleneck)
+    {
+      bottleneck.SetDeviceAttribute ("Mtu", UintegerValue (65535));
+    }
+  if (m_queueBytes > 0)
+    {
+      // The packets wait in the queue disc, which counts bytes
+      bottleneck.SetQueue ("ns3::DropTailQueue<Packet>", "MaxSize", StringValue ("1p"));
+    }
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (nodes.Get (1), nodes.Get (2));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  if (m_queueBytes > 0)
+    {
+      TrafficControlHelper tch;
+      std::ostringstream queueSize;
+      queueSize << m_queueBytes << "B";
+      tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", QueueSizeValue (QueueSize (queueSize.str ())));
+      QueueDiscContainer queueDiscs = tch.Install (bottleneckDevices.Get (0));
+      queueDiscs.Get (0)->TraceConnectWithoutContext ("Drop", MakeCallback (&Ns3TcpSuperSegmentTestCase::QueueDrop, this));
+    }
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (accessDevices);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer bottleneckInterfaces = address.Assign (bottleneckDevices);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 50000;
+  BulkSendHelper source ("ns3::TcpSocketFactory",
+                         InetSocketAddress (bottleneckInterfaces.GetAddress (1), port));
+  source.SetAttribute ("SendSize", UintegerValue (1 << 16));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (0.1));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (2));
+  sinkApps.Start (Seconds (0));
+
+  accessDevices.Get (0)->TraceConnectWithoutContext ("MacTx", MakeCallback (&Ns3TcpSuperSegmentTestCase::MacTx, this));
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      accessDevices.Get (i)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&Ns3TcpSuperSegmentTestCase::PhyTxBegin, this));
+      bottleneckDevices.Get (i)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&Ns3TcpSuperSegmentTestCase::PhyTxBegin, this));
+    }
+  Simulator::Schedule (Seconds (0.1) + TimeStep (1), &Ns3TcpSuperSegmentTestCase::ConnectCwndTrace, this);
+  Simulator::Schedule (Seconds (0.2), &Ns3TcpSuperSegmentTestCase::SampleCwnd, this);
+
+  double duration = 10;
+  Simulator::Stop (Seconds (0.1 + duration));
+  Simulator::Run ();
+
+  Ptr<PacketSink> packetSink = DynamicCast<PacketSink> (sinkApps.Get (0));
+  throughput = packetSink->GetTotalRx () * 8.0 / duration;
+  cWnd = m_cWndSamples > 0 ? m_cWndSum / m_cWndSamples : 0;
+  superSegments = m_superSegments;
+  transmissions = m_transmissions;
+  drops = m_drops;
+
+  Simulator::Destroy ();
+  Config::Reset ();
+  wallClockMs = wallClock.End ();
+}
+
+void
+Ns3TcpSuperSegmentTestCase::DoRun (void)
+{
+  double segmentThroughput, segmentCwnd;
+  uint32_t segmentSuperSegments, segmentTransmissions, segmentDrops;
+  int64_t segmentWallClockMs;
+  RunTransfer (0, segmentThroughput, segmentCwnd, segmentSuperSegments,
+               segmentTransmissions, segmentDrops, segmentWallClockMs);
+  NS_LOG_INFO ("segments: " << segmentThroughput << " bit/s, cwnd " << segmentCwnd
+               << ", " << segmentTransmissions << " transmissions, " << segmentDrops
+               << " drops, " << segmentWallClockMs << " ms");
+  NS_TEST_ASSERT_MSG_EQ (segmentSuperSegments, 0, "Super-segments sent while disabled");
+
+  double superThroughput, superCwnd;
+  uint32_t superSegments, superTransmissions, superDrops;
+  int64_t superWallClockMs;
+  RunTransfer (m_superSegmentSize, superThroughput, superCwnd, superSegments,
+               superTransmissions, superDrops, superWallClockMs);
+  NS_LOG_INFO ("super-segments: " << superThroughput << " bit/s, cwnd " << superCwnd
+               << ", " << superSegments << " super-segments, " << superTransmissions
+               << " transmissions, " << superDrops << " drops, " << superWallClockMs << " ms");
+  NS_TEST_ASSERT_MSG_GT (superSegments, 0, "No super-segment sent");
+  if (m_queueBytes > 0)
+    {
+      NS_TEST_ASSERT_MSG_GT (segmentDrops, 0, "No segment dropped by the bottleneck");
+      NS_TEST_ASSERT_MSG_GT (superDrops, 0, "No super-segment dropped by the bottleneck");
+    }
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (superThroughput, segmentThroughput, 0.05 * segmentThroughput,
+                             "Throughput differs from the one of segments");
+  NS_TEST_EXPECT_MSG_EQ_TOL (superCwnd, segmentCwnd, 0.15 * segmentCwnd,
+                             "Congestion window differs from the one of segments");
+  NS_TEST_EXPECT_MSG_LT (superTransmissions, segmentTransmissions,
+                         "The super-segments do not save transmissions");
+}
+
+class Ns3TcpSuperSegmentTestSuite : public TestSuite
+{
+public:
+  Ns3TcpSuperSegmentTestSuite ();
+};
+
+Ns3TcpSuperSegmentTestSuite::Ns3TcpSuperSegmentTestSuite ()
+  : TestSuite ("ns3-tcp-super-segment", SYSTEM)
+{
+  AddTestCase (new Ns3TcpSuperSegmentTestCase (false, 0, 65000, true, "split at the bottleneck, SACK"), TestCase::EXTENSIVE);
+  AddTestCase (new Ns3TcpSuperSegmentTestCase (false, 0, 65000, false, "split at the bottleneck, NewReno"), TestCase::EXTENSIVE);
+  AddTestCase (new Ns3TcpSuperSegmentTestCase (true, 0, 65000, true, "whole over the bottleneck, SACK"), TestCase::EXTENSIVE);
+  AddTestCase (new Ns3TcpSuperSegmentTestCase (true, 100000, 8 * 1448, true, "whole over a lossy bottleneck, SACK"), TestCase::EXTENSIVE);
+}
+
+static Ns3TcpSuperSegmentTestSuite ns3TcpSuperSegmentTestSuite;
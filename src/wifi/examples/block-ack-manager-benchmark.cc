@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// This program measures the cost of the block ack processing performed by
+// the originator of a block ack agreement (BlockAckManager), as a function of
+// the number of MPDUs in flight for the agreement (the window size).
+//
+// For each window size, the program repeats the following round:
+// - window MPDUs with consecutive sequence numbers are stored in the
+//   BlockAckManager, as if they were sent in an A-MPDU;
+// - the recipient acknowledges them with compressed block acks, one per
+//   64 sequence numbers, in which one MPDU every lossInterval is missing;
+//   the missing MPDUs are put in the retransmission queue;
+// - the retransmissions are dequeued and acknowledged with a second set of
+//   compressed block acks.
+//
+// The output displays, for each window size, the wall clock time and the
+// average time spent per block ack frame:
+//
+//   window   wall(ms)   us/BlockAck
+//
+// Example usage:
+//
+//   ./waf --run "block-ack-manager-benchmark --windows=64,256 --nRounds=1000"
+//
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/block-ack-manager.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/mac-tx-middle.h"
+#include "ns3/ctrl-headers.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/constant-rate-wifi-manager.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Callback used to block and unblock a destination, which is not needed here
+ * \param recipient the recipient
+ * \param tid the TID
+ */
+void
+NotifyDestination (Mac48Address recipient, uint8_t tid)
+{
+}
+
+/**
+ * Run the benchmark for a given window size
+ * \param window the number of MPDUs in flight
+ * \param nRounds the number of rounds
+ * \param lossInterval one MPDU every lossInterval is lost
+ * \return the number of block ack frames processed and the wall clock time in milliseconds
+ */
+std::pair<uint64_t, int64_t>
+RunBenchmark (uint16_t window, uint32_t nRounds, uint16_t lossInterval)
+{
+  Mac48Address recipient ("00:00:00:00:00:01");
+  uint8_t tid = 0;
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  Ptr<WifiRemoteStationManager> stationManager = CreateObject<ConstantRateWifiManager> ();
+  stationManager->SetupPhy (phy);
+  stationManager->SetHtSupported (true);
+  Ptr<WifiMacQueue> queue = CreateObject<WifiMacQueue> ();
+  Ptr<MacTxMiddle> txMiddle = Create<MacTxMiddle> ();
+
+  Ptr<BlockAckManager> manager = CreateObject<BlockAckManager> ();
+  manager->SetQueue (queue);
+  manager->SetTxMiddle (txMiddle);
+  manager->SetWifiRemoteStationManager (stationManager);
+  manager->SetBlockAckType (COMPRESSED_BLOCK_ACK);
+  manager->SetBlockAckThreshold (1);
+  manager->SetMaxPacketDelay (Seconds (10));
+  manager->SetBlockDestinationCallback (MakeCallback (&NotifyDestination));
+  manager->SetUnblockDestinationCallback (MakeCallback (&NotifyDestination));
+
+  MgtAddBaRequestHeader reqHdr;
+  reqHdr.SetImmediateBlockAck ();
+  reqHdr.SetTid (tid);
+  reqHdr.SetBufferSize (0);
+  reqHdr.SetTimeout (0);
+  reqHdr.SetStartingSequence (0);
+  manager->CreateAgreement (&reqHdr, recipient);
+
+  MgtAddBaResponseHeader respHdr;
+  StatusCode code;
+  code.SetSuccess ();
+  respHdr.SetStatusCode (code);
+  respHdr.SetImmediateBlockAck ();
+  respHdr.SetTid (tid);
+  respHdr.SetBufferSize (window - 1);
+  respHdr.SetTimeout (0);
+  manager->UpdateAgreement (&respHdr, recipient);
+
+  WifiMode mode = WifiPhy::GetHtMcs7 ();
+  uint16_t seq = 0;
+  uint64_t nBlockAcks = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t round = 0; round < nRounds; round++)
+    {
+      uint16_t startingSeq = seq;
+      for (uint16_t i = 0; i < window; i++)
+        {
+          WifiMacHeader hdr;
+          hdr.SetType (WIFI_MAC_QOSDATA);
+          hdr.SetAddr1 (recipient);
+          hdr.SetQosTid (tid);
+          hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
+          hdr.SetSequenceNumber (seq);
+          manager->StorePacket (Create<Packet> (100), hdr, Simulator::Now ());
+          seq = (seq + 1) % 4096;
+        }
+
+      // first transmission: one MPDU every lossInterval is lost
+      for (uint16_t offset = 0; offset < window; offset += 64)
+        {
+          CtrlBAckResponseHeader blockAck;
+          blockAck.SetType (COMPRESSED_BLOCK_ACK);
+          blockAck.SetTidInfo (tid);
+          blockAck.SetStartingSequence ((startingSeq + offset) % 4096);
+          for (uint16_t i = offset; i < offset + 64 && i < window; i++)
+            {
+              if (i % lossInterval != 0)
+                {
+                  blockAck.SetReceivedPacket ((startingSeq + i) % 4096);
+                }
+            }
+          manager->NotifyGotBlockAck (&blockAck, recipient, 0, mode, 0);
+          nBlockAcks++;
+        }
+
+      // retransmissions: everything is acknowledged
+      WifiMacHeader retryHdr;
+      while (manager->GetNextPacket (retryHdr, true) != 0)
+        {
+        }
+      for (uint16_t offset = 0; offset < window; offset += 64)
+        {
+          CtrlBAckResponseHeader blockAck;
+          blockAck.SetType (COMPRESSED_BLOCK_ACK);
+          blockAck.SetTidInfo (tid);
+          blockAck.SetStartingSequence ((startingSeq + offset) % 4096);
+          for (uint16_t i = offset; i < offset + 64 && i < window; i++)
+            {
+              blockAck.SetReceivedPacket ((startingSeq + i) % 4096);
+            }
+          manager->NotifyGotBlockAck (&blockAck, recipient, 0, mode, 0);
+          nBlockAcks++;
+        }
+      NS_ASSERT (manager->GetNBufferedPackets (recipient, tid) == 0);
+    }
+  int64_t wallMs = clock.End ();
+
+  manager->Dispose ();
+  stationManager->Dispose ();
+  phy->Dispose ();
+  Simulator::Destroy ();
+  return std::make_pair (nBlockAcks, wallMs);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string windows = "64,256";
+  uint32_t nRounds = 1000;
+  uint16_t lossInterval = 8;
+
+  CommandLine cmd;
+  cmd.AddValue ("windows", "Comma separated list of window sizes", windows);
+  cmd.AddValue ("nRounds", "Number of rounds per window size", nRounds);
+  cmd.AddValue ("lossInterval", "One MPDU every lossInterval is lost in the first transmission", lossInterval);
+  cmd.Parse (argc, argv);
+
+  std::cout << "window" << "\t" << "wall(ms)" << "\t" << "us/BlockAck" << std::endl;
+  std::istringstream iss (windows);
+  std::string token;
+  while (std::getline (iss, token, ','))
+    {
+      uint16_t window = static_cast<uint16_t> (std::stoi (token));
+      std::pair<uint64_t, int64_t> result = RunBenchmark (window, nRounds, lossInterval);
+      std::cout << window << "\t" << result.second << "\t\t"
+                << (result.second * 1000.0) / result.first << std::endl;
+    }
+  return 0;
+}
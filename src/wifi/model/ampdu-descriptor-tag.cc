@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ampdu-descriptor-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (AmpduDescriptorTag);
+
+TypeId
+AmpduDescriptorTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AmpduDescriptorTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<AmpduDescriptorTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+AmpduDescriptorTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+AmpduDescriptorTag::AmpduDescriptorTag ()
+{
+}
+
+void
+AmpduDescriptorTag::AddSubframe (uint32_t size)
+{
+  m_sizes.push_back (size);
+  m_success.push_back (true);
+}
+
+std::size_t
+AmpduDescriptorTag::GetNSubframes (void) const
+{
+  return m_sizes.size ();
+}
+
+uint32_t
+AmpduDescriptorTag::GetSubframeSize (std::size_t index) const
+{
+  NS_ASSERT (index < m_sizes.size ());
+  return m_sizes[index];
+}
+
+void
+AmpduDescriptorTag::SetSuccess (std::size_t index, bool success)
+{
+  NS_ASSERT (index < m_success.size ());
+  m_success[index] = success;
+}
+
+bool
+AmpduDescriptorTag::IsSuccess (std::size_t index) const
+{
+  NS_ASSERT (index < m_success.size ());
+  return m_success[index];
+}
+
+uint32_t
+AmpduDescriptorTag::GetSerializedSize (void) const
+{
+  return 2 + m_sizes.size () * 3;
+}
+
+void
+AmpduDescriptorTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (static_cast<uint16_t> (m_sizes.size ()));
+  for (std::size_t k = 0; k < m_sizes.size (); k++)
+    {
+      // A-MPDU subframes are smaller than 2^16 bytes
+      i.WriteU16 (static_cast<uint16_t> (m_sizes[k]));
+      i.WriteU8 (m_success[k] ? 1 : 0);
+    }
+}
+
+void
+AmpduDescriptorTag::Deserialize (TagBuffer i)
+{
+  uint16_t n = i.ReadU16 ();
+  m_sizes.resize (n);
+  m_success.resize (n);
+  for (uint16_t k = 0; k < n; k++)
+    {
+      m_sizes[k] = i.ReadU16 ();
+      m_success[k] = (i.ReadU8 () == 1);
+    }
+}
+
+void
+AmpduDescriptorTag::Print (std::ostream &os) const
+{
+  os << "Subframes (size/success)=";
+  for (std::size_t k = 0; k < m_sizes.size (); k++)
+    {
+      os << " " << m_sizes[k] << "/" << m_success[k];
+    }
+}
+
+} //namespace ns3
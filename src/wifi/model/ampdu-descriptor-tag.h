@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AMPDU_DESCRIPTOR_TAG_H
+#define AMPDU_DESCRIPTOR_TAG_H
+
+#include "ns3/tag.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * The AmpduDescriptorTag is attached to an A-MPDU sent as a single packet
+ * when the A-MPDU abstraction is enabled (see MacLow::SetAmpduAbstraction).
+ * It describes the A-MPDU subframes (size in bytes, including the A-MPDU
+ * subframe header and the padding) so that the receiving PHY can take an
+ * error decision for each MPDU, and it carries such decisions to the MAC.
+ */
+class AmpduDescriptorTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TypeId GetInstanceTypeId (void) const;
+
+  /**
+   * Create an empty AmpduDescriptorTag
+   */
+  AmpduDescriptorTag ();
+
+  /**
+   * Append an A-MPDU subframe to the descriptor. The subframe is marked as
+   * successfully received.
+   *
+   * \param size the size of the subframe in bytes
+   */
+  void AddSubframe (uint32_t size);
+  /**
+   * \return the number of A-MPDU subframes
+   */
+  std::size_t GetNSubframes (void) const;
+  /**
+   * \param index the index of the subframe
+   * \return the size in bytes of the subframe
+   */
+  uint32_t GetSubframeSize (std::size_t index) const;
+  /**
+   * Set whether the MPDU in the given subframe has been received successfully.
+   *
+   * \param index the index of the subframe
+   * \param success whether the MPDU has been received successfully
+   */
+  void SetSuccess (std::size_t index, bool success);
+  /**
+   * \param index the index of the subframe
+   * \return whether the MPDU in the given subframe has been received successfully
+   */
+  bool IsSuccess (std::size_t index) const;
+
+  uint32_t GetSerializedSize (void) const;
+  void Serialize (TagBuffer i) const;
+  void Deserialize (TagBuffer i);
+  void Print (std::ostream &os) const;
+
+
+private:
+  std::vector<uint32_t> m_sizes;  //!< the size of the subframes
+  std::vector<bool> m_success;    //!< the reception status of the subframes
+};
+
+} //namespace ns3
+
+#endif /* AMPDU_DESCRIPTOR_TAG_H */
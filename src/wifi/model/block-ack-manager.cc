@@ -40,6 +40,12 @@ BlockAckManager::Item::Item (Ptr<const Packet> packet, const WifiMacHeader &hdr,
   NS_LOG_FUNCTION (this << packet << hdr << tStamp);
 }
 
+BlockAckManager::RetryIndex::RetryIndex (RetryQueueI none)
+  : slots (4096, none),
+    nPackets (0)
+{
+}
+
 Bar::Bar ()
 {
   NS_LOG_FUNCTION (this);
@@ -78,6 +84,7 @@ BlockAckManager::~BlockAckManager ()
   m_queue = 0;
   m_agreements.clear ();
   m_retryPackets.clear ();
+  m_retryIndexes.clear ();
 }
 
 bool
@@ -139,6 +146,7 @@ BlockAckManager::CreateAgreement (const MgtAddBaRequestHeader *reqHdr, Mac48Addr
   PacketQueue queue;
   std::pair<OriginatorBlockAckAgreement, PacketQueue> value (agreement, queue);
   m_agreements.insert (std::make_pair (key, value));
+  m_retryIndexes.insert (std::make_pair (key, RetryIndex (m_retryPackets.end ())));
   m_blockPackets (recipient, reqHdr->GetTid ());
 }
 
@@ -149,7 +157,7 @@ BlockAckManager::DestroyAgreement (Mac48Address recipient, uint8_t tid)
   AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
   if (it != m_agreements.end ())
     {
-      for (std::list<PacketQueueI>::const_iterator i = m_retryPackets.begin (); i != m_retryPackets.end (); )
+      for (RetryQueue::const_iterator i = m_retryPackets.begin (); i != m_retryPackets.end (); )
         {
           if ((*i)->hdr.GetAddr1 () == recipient && (*i)->hdr.GetQosTid () == tid)
             {
@@ -161,6 +169,7 @@ BlockAckManager::DestroyAgreement (Mac48Address recipient, uint8_t tid)
             }
         }
       m_agreements.erase (it);
+      m_retryIndexes.erase (std::make_pair (recipient, tid));
       //remove scheduled bar
       for (std::list<Bar>::const_iterator i = m_bars.begin (); i != m_bars.end (); )
         {
@@ -221,6 +230,13 @@ BlockAckManager::StorePacket (Ptr<const Packet> packet, const WifiMacHeader &hdr
   Item item (packet, hdr, tStamp);
   AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
   NS_ASSERT (it != m_agreements.end ());
+  if (it->second.second.empty ()
+      || ((hdr.GetSequenceNumber () - it->second.second.back ().hdr.GetSequenceNumber () + 4096) % 4096) <= 2047)
+    {
+      /* packets are usually stored in sequence number order */
+      it->second.second.push_back (item);
+      return;
+    }
   PacketQueueI queueIt = it->second.second.begin ();
   for (; queueIt != it->second.second.end (); )
     {
@@ -260,7 +276,7 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr, bool removePacket)
   if (!m_retryPackets.empty ())
     {
       NS_LOG_DEBUG ("Retry buffer size is " << m_retryPackets.size ());
-      std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
+      RetryQueue::const_iterator it = m_retryPackets.begin ();
       while (it != m_retryPackets.end ())
         {
           if ((*it)->hdr.IsQosData ())
@@ -280,8 +296,9 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr, bool removePacket)
                 {
                   //Standard says the originator should not send a packet with seqnum < winstart
                   NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-                  agreement->second.second.erase ((*it));
-                  it = m_retryPackets.erase (it);
+                  PacketQueueI queueIt = *it;
+                  it = EraseFromRetryQueue (it);
+                  agreement->second.second.erase (queueIt);
                   continue;
                 }
               else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
@@ -317,16 +334,16 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr, bool removePacket)
                * the use of Block Ack.
                */
               hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
-              if (removePacket)
-                {
-                  AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-                  i->second.second.erase (*it);
-                }
             }
           if (removePacket)
             {
               NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
-              it = m_retryPackets.erase (it);
+              PacketQueueI queueIt = *it;
+              it = EraseFromRetryQueue (it);
+              if (hdr.IsQosAck ())
+                {
+                  agreement->second.second.erase (queueIt);
+                }
               NS_LOG_DEBUG ("Removed one packet, retry buffer size = " << m_retryPackets.size ());
             }
           break;
@@ -344,7 +361,7 @@ BlockAckManager::PeekNextPacketByTidAndAddress (WifiMacHeader &hdr, uint8_t tid,
   Mac48Address recipient = hdr.GetAddr1 ();
   AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
   NS_ASSERT (agreement != m_agreements.end ());
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
+  RetryQueue::const_iterator it = m_retryPackets.begin ();
   for (; it != m_retryPackets.end (); it++)
     {
       if (!(*it)->hdr.IsQosData ())
@@ -357,8 +374,9 @@ BlockAckManager::PeekNextPacketByTidAndAddress (WifiMacHeader &hdr, uint8_t tid,
             {
               //standard says the originator should not send a packet with seqnum < winstart
               NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-              agreement->second.second.erase ((*it));
-              it = m_retryPackets.erase (it);
+              PacketQueueI queueIt = *it;
+              it = EraseFromRetryQueue (it);
+              agreement->second.second.erase (queueIt);
               it--;
               continue;
             }
@@ -398,25 +416,22 @@ BlockAckManager::PeekNextPacketByTidAndAddress (WifiMacHeader &hdr, uint8_t tid,
 bool
 BlockAckManager::RemovePacket (uint8_t tid, Mac48Address recipient, uint16_t seqnumber)
 {
-
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  for (; it != m_retryPackets.end (); it++)
+  RetryIndexes::iterator index = m_retryIndexes.find (std::make_pair (recipient, tid));
+  if (index == m_retryIndexes.end ())
     {
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid && (*it)->hdr.GetSequenceNumber () == seqnumber)
-        {
-          WifiMacHeader hdr = (*it)->hdr;
-          AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-          i->second.second.erase ((*it));
-          m_retryPackets.erase (it);
-          NS_LOG_DEBUG ("Removed Packet from retry queue = " << hdr.GetSequenceNumber () << " " << +tid << " " << recipient << " Buffer Size = " << m_retryPackets.size ());
-          return true;
-        }
+      return false;
     }
-  return false;
+  RetryQueueI it = index->second.slots[seqnumber % 4096];
+  if (it == m_retryPackets.end ())
+    {
+      return false;
+    }
+  PacketQueueI queueIt = *it;
+  EraseFromRetryQueue (it, index->second);
+  AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
+  i->second.second.erase (queueIt);
+  NS_LOG_DEBUG ("Removed Packet from retry queue = " << seqnumber << " " << +tid << " " << recipient << " Buffer Size = " << m_retryPackets.size ());
+  return true;
 }
 
 bool
@@ -467,35 +482,13 @@ uint32_t
 BlockAckManager::GetNRetryNeededPackets (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << +tid);
-  uint32_t nPackets = 0;
-  uint16_t currentSeq = 0;
-  if (ExistsAgreement (recipient, tid))
+  /* there is at most one entry per sequence number, hence fragments are counted once */
+  RetryIndexes::const_iterator index = m_retryIndexes.find (std::make_pair (recipient, tid));
+  if (index == m_retryIndexes.end ())
     {
-      std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-      while (it != m_retryPackets.end ())
-        {
-          if (!(*it)->hdr.IsQosData ())
-            {
-              NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-            }
-          if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
-            {
-              currentSeq = (*it)->hdr.GetSequenceNumber ();
-              nPackets++;
-              /* a fragmented packet must be counted as one packet */
-              while (it != m_retryPackets.end () && (*it)->hdr.GetSequenceNumber () == currentSeq)
-                {
-                  it++;
-                }
-            }
-          //go to next packet
-          else
-            {
-              it++;
-            }
-        }
+      return 0;
     }
-  return nPackets;
+  return index->second.nPackets;
 }
 
 void
@@ -515,21 +508,10 @@ BlockAckManager::SetWifiRemoteStationManager (const Ptr<WifiRemoteStationManager
 bool
 BlockAckManager::AlreadyExists (uint16_t currentSeq, Mac48Address recipient, uint8_t tid) const
 {
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
-    {
-      NS_LOG_FUNCTION (this << (*it)->hdr.GetType ());
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid && currentSeq == (*it)->hdr.GetSequenceNumber ())
-        {
-          return true;
-        }
-      it++;
-    }
-  return false;
+  NS_LOG_FUNCTION (this << currentSeq << recipient << +tid);
+  RetryIndexes::const_iterator index = m_retryIndexes.find (std::make_pair (recipient, tid));
+  return (index != m_retryIndexes.end ()
+          && index->second.slots[currentSeq % 4096] != m_retryPackets.end ());
 }
 
 void
@@ -547,6 +529,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
           uint8_t nFailedMpdus = 0;
           AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
           PacketQueueI queueEnd = it->second.second.end ();
+          RetryIndex &index = m_retryIndexes.find (std::make_pair (recipient, tid))->second;
 
           if (it->second.first.m_inactivityEvent.IsRunning ())
             {
@@ -568,7 +551,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                                                     (*queueIt).hdr.GetFragmentNumber ()))
                     {
                       nSuccessfulMpdus++;
-                      RemoveFromRetryQueue (recipient, tid, (*queueIt).hdr.GetSequenceNumber ());
+                      RemoveFromRetryQueue (index, (*queueIt).hdr.GetSequenceNumber ());
                       queueIt = it->second.second.erase (queueIt);
                     }
                   else
@@ -580,9 +563,9 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                           (*it).second.first.SetStartingSequence (sequenceFirstLost);
                         }
                       nFailedMpdus++;
-                      if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
+                      if (index.slots[(*queueIt).hdr.GetSequenceNumber ()] == m_retryPackets.end ())
                         {
-                          InsertInRetryQueue (queueIt);
+                          InsertInRetryQueue (queueIt, index);
                         }
                       queueIt++;
                     }
@@ -603,7 +586,7 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                             {
                               m_txOkCallback ((*queueIt).hdr);
                             }
-                          RemoveFromRetryQueue (recipient, tid, currentSeq);
+                          RemoveFromRetryQueue (index, currentSeq);
                           queueIt = it->second.second.erase (queueIt);
                         }
                     }
@@ -620,9 +603,9 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                         {
                           m_txFailedCallback ((*queueIt).hdr);
                         }
-                      if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
+                      if (index.slots[(*queueIt).hdr.GetSequenceNumber ()] == m_retryPackets.end ())
                         {
-                          InsertInRetryQueue (queueIt);
+                          InsertInRetryQueue (queueIt, index);
                         }
                       queueIt++;
                     }
@@ -806,24 +789,42 @@ bool BlockAckManager::NeedBarRetransmission (uint8_t tid, uint16_t seqNumber, Ma
 
 void
 BlockAckManager::RemoveFromRetryQueue (Mac48Address address, uint8_t tid, uint16_t seq)
+{
+  RetryIndexes::iterator index = m_retryIndexes.find (std::make_pair (address, tid));
+  if (index != m_retryIndexes.end ())
+    {
+      RemoveFromRetryQueue (index->second, seq);
+    }
+}
+
+void
+BlockAckManager::RemoveFromRetryQueue (RetryIndex &index, uint16_t seq)
 {
   /* remove retry packet iterator if it's present in retry queue */
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
+  RetryQueueI it = index.slots[seq % 4096];
+  if (it != m_retryPackets.end ())
     {
-      if ((*it)->hdr.GetAddr1 () == address
-          && (*it)->hdr.GetQosTid () == tid
-          && (*it)->hdr.GetSequenceNumber () == seq)
-        {
-          it = m_retryPackets.erase (it);
-        }
-      else
-        {
-          it++;
-        }
+      EraseFromRetryQueue (it, index);
     }
 }
 
+BlockAckManager::RetryQueueI
+BlockAckManager::EraseFromRetryQueue (RetryQueue::const_iterator it)
+{
+  RetryIndexes::iterator index = m_retryIndexes.find (std::make_pair ((*it)->hdr.GetAddr1 (), (*it)->hdr.GetQosTid ()));
+  NS_ASSERT (index != m_retryIndexes.end ());
+  return EraseFromRetryQueue (it, index->second);
+}
+
+BlockAckManager::RetryQueueI
+BlockAckManager::EraseFromRetryQueue (RetryQueue::const_iterator it, RetryIndex &index)
+{
+  NS_ASSERT (index.nPackets > 0);
+  index.slots[(*it)->hdr.GetSequenceNumber ()] = m_retryPackets.end ();
+  index.nPackets--;
+  return m_retryPackets.erase (it);
+}
+
 void
 BlockAckManager::CleanupBuffers (void)
 {
@@ -835,6 +836,7 @@ BlockAckManager::CleanupBuffers (void)
           continue;
         }
       Time now = Simulator::Now ();
+      RetryIndex &index = m_retryIndexes.find (j->first)->second;
       PacketQueueI end = j->second.second.begin ();
       for (PacketQueueI i = j->second.second.begin (); i != j->second.second.end (); i++)
         {
@@ -845,9 +847,7 @@ BlockAckManager::CleanupBuffers (void)
             }
           else
             {
-              RemoveFromRetryQueue (j->second.first.GetPeer (),
-                                    j->second.first.GetTid (),
-                                    i->hdr.GetSequenceNumber ());
+              RemoveFromRetryQueue (index, i->hdr.GetSequenceNumber ());
             }
         }
       j->second.second.erase (j->second.second.begin (), end);
@@ -894,7 +894,7 @@ uint16_t
 BlockAckManager::GetSeqNumOfNextRetryPacket (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << +tid);
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
+  RetryQueue::const_iterator it = m_retryPackets.begin ();
   while (it != m_retryPackets.end ())
     {
       if (!(*it)->hdr.IsQosData ())
@@ -923,32 +923,30 @@ BlockAckManager::SetTxFailedCallback (TxFailed callback)
 }
 
 void
-BlockAckManager::InsertInRetryQueue (PacketQueueI item)
+BlockAckManager::InsertInRetryQueue (PacketQueueI item, RetryIndex &index)
 {
   NS_LOG_INFO ("Adding to retry queue " << (*item).hdr.GetSequenceNumber ());
-  if (m_retryPackets.size () == 0)
+  RetryQueueI inserted;
+  if (m_retryPackets.size () == 0
+      || (index.nPackets == m_retryPackets.size ()
+          && ((item->hdr.GetSequenceNumber () - m_retryPackets.back ()->hdr.GetSequenceNumber () + 4096) % 4096) <= 2047))
     {
-      m_retryPackets.push_back (item);
+      /* the retransmission queue only holds packets of this agreement, sorted by
+         sequence number, and item comes after all of them */
+      inserted = m_retryPackets.insert (m_retryPackets.end (), item);
     }
   else
     {
-      for (std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin (); it != m_retryPackets.end (); )
+      RetryQueueI it = m_retryPackets.begin ();
+      while (it != m_retryPackets.end ()
+             && ((item->hdr.GetSequenceNumber () - (*it)->hdr.GetSequenceNumber () + 4096) % 4096) <= 2047)
         {
-          if (((item->hdr.GetSequenceNumber () - (*it)->hdr.GetSequenceNumber () + 4096) % 4096) > 2047)
-            {
-              it = m_retryPackets.insert (it, item);
-              break;
-            }
-          else
-            {
-              it++;
-              if (it == m_retryPackets.end ())
-                {
-                  m_retryPackets.push_back (item);
-                }
-            }
+          it++;
         }
+      inserted = m_retryPackets.insert (it, item);
     }
+  index.slots[item->hdr.GetSequenceNumber ()] = inserted;
+  index.nPackets++;
 }
 
 } //namespace ns3
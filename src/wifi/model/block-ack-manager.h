@@ -22,6 +22,7 @@
 #define BLOCK_ACK_MANAGER_H
 
 #include <map>
+#include <vector>
 #include "ns3/nstime.h"
 #include "wifi-mac-header.h"
 #include "originator-block-ack-agreement.h"
@@ -458,13 +459,63 @@ private:
     WifiMacHeader hdr; ///< header
     Time timestamp; ///< timestamp
   };
+  /**
+   * typedef for a list of iterators to stored packets that need to be retransmitted.
+   */
+  typedef std::list<PacketQueueI> RetryQueue;
+  /**
+   * typedef for an iterator for RetryQueue.
+   */
+  typedef RetryQueue::iterator RetryQueueI;
+
+  /**
+   * Index of the packets of a block ack agreement that are in the
+   * retransmission queue. The index is a ring with one slot per sequence
+   * number, so that checking, inserting and removing a retry packet given
+   * its sequence number does not require to walk the retransmission queue.
+   */
+  struct RetryIndex
+  {
+    /**
+     * Constructor
+     *
+     * \param none the iterator stored in the slots of the sequence numbers
+     *             that are not in the retransmission queue
+     */
+    RetryIndex (RetryQueueI none);
+    std::vector<RetryQueueI> slots; ///< position in the retransmission queue, indexed by sequence number
+    uint32_t nPackets; ///< number of packets of the agreement in the retransmission queue
+  };
+  /**
+   * typedef for a map between MAC address and TID and retransmission index.
+   */
+  typedef std::map<std::pair<Mac48Address, uint8_t>, RetryIndex> RetryIndexes;
+
   /**
    * \param item
+   * \param index the retransmission index of the agreement the item belongs to
    *
    * Insert item in retransmission queue.
    * This method ensures packets are retransmitted in the correct order.
    */
-  void InsertInRetryQueue (PacketQueueI item);
+  void InsertInRetryQueue (PacketQueueI item, RetryIndex &index);
+  /**
+   * Remove an item from the retransmission queue.
+   *
+   * \param it the item in the retransmission queue
+   * \param index the retransmission index of the agreement the item belongs to
+   *
+   * \return the item following the removed one in the retransmission queue
+   */
+  RetryQueueI EraseFromRetryQueue (RetryQueue::const_iterator it, RetryIndex &index);
+  /**
+   * Remove an item from the retransmission queue.
+   *
+   * \param it the item in the retransmission queue
+   *
+   * \return the item following the removed one in the retransmission queue
+   */
+  RetryQueueI EraseFromRetryQueue (RetryQueue::const_iterator it);
 
   /**
    * Remove items from retransmission queue.
@@ -475,6 +526,13 @@ private:
    * \param seq sequence number of the packet to be removed
    */
   void RemoveFromRetryQueue (Mac48Address address, uint8_t tid, uint16_t seq);
+  /**
+   * Remove items from retransmission queue.
+   *
+   * \param index the retransmission index of the agreement of the packet to be removed
+   * \param seq sequence number of the packet to be removed
+   */
+  void RemoveFromRetryQueue (RetryIndex &index, uint16_t seq);
 
   /**
    * This data structure contains, for each block ack agreement (recipient, tid), a set of packets
@@ -489,7 +547,8 @@ private:
    * A packet needs retransmission if it's indicated as not correctly received in a block ack
    * frame.
    */
-  std::list<PacketQueueI> m_retryPackets;
+  RetryQueue m_retryPackets;
+  RetryIndexes m_retryIndexes; ///< for each block ack agreement, the index of its packets in m_retryPackets
   std::list<Bar> m_bars; ///< list of BARs
 
   uint8_t m_blockAckThreshold; ///< block ack threshold
@@ -25,6 +25,7 @@
 #include "interference-helper.h"
 #include "wifi-phy.h"
 #include "error-rate-model.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -321,6 +322,73 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
   return per;
 }
 
+void
+InterferenceHelper::CalculatePlcpPayloadPers (Ptr<const Event> event, NiChanges *ni,
+                                              const std::vector<uint32_t> &sizes, std::vector<double> &pers) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!sizes.empty ());
+  const WifiTxVector txVector = event->GetTxVector ();
+  auto j = ni->begin ();
+  Time previous = j->first;
+  WifiMode payloadMode = event->GetPayloadMode ();
+  WifiPreamble preamble = txVector.GetPreambleType ();
+  Time plcpHeaderStart = j->first + WifiPhy::GetPlcpPreambleDuration (txVector); //packet start time + preamble
+  Time plcpHsigHeaderStart = plcpHeaderStart + WifiPhy::GetPlcpHeaderDuration (txVector); //packet start time + preamble + L-SIG
+  Time plcpTrainingSymbolsStart = plcpHsigHeaderStart + WifiPhy::GetPlcpHtSigHeaderDuration (preamble) + WifiPhy::GetPlcpSigA1Duration (preamble) + WifiPhy::GetPlcpSigA2Duration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A
+  Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
+
+  //the end of each MPDU, obtained by sharing the payload duration in proportion to the MPDU sizes
+  uint64_t totalSize = 0;
+  for (auto size : sizes)
+    {
+      totalSize += size;
+    }
+  Time payloadDuration = event->GetEndTime () - plcpPayloadStart;
+  std::vector<Time> mpduEnd (sizes.size ());
+  uint64_t cumulatedSize = 0;
+  for (std::size_t k = 0; k < sizes.size (); k++)
+    {
+      cumulatedSize += sizes[k];
+      mpduEnd[k] = plcpPayloadStart + NanoSeconds (payloadDuration.GetNanoSeconds () * cumulatedSize / totalSize);
+    }
+  mpduEnd.back () = event->GetEndTime ();
+
+  std::vector<double> psrs (sizes.size (), 1.0); /* MPDU Success Rates */
+  std::size_t mpdu = 0;
+  double noiseInterferenceW = m_firstPower;
+  double powerW = event->GetRxPowerW ();
+  while (++j != ni->end ())
+    {
+      Time current = j->first;
+      NS_ASSERT (current >= previous);
+      Time chunkStart = std::max (previous, plcpPayloadStart);
+      if (current > chunkStart)
+        {
+          double snr = CalculateSnr (powerW, noiseInterferenceW, txVector.GetChannelWidth ());
+          //split the chunk among the MPDUs it overlaps
+          while (chunkStart < current && mpdu < sizes.size ())
+            {
+              Time chunkEnd = std::min (current, mpduEnd[mpdu]);
+              psrs[mpdu] *= CalculateChunkSuccessRate (snr, chunkEnd - chunkStart, payloadMode, txVector);
+              chunkStart = chunkEnd;
+              if (chunkEnd == mpduEnd[mpdu])
+                {
+                  mpdu++;
+                }
+            }
+        }
+      noiseInterferenceW = j->second.GetPower () - powerW;
+      previous = j->first;
+    }
+  pers.resize (sizes.size ());
+  for (std::size_t k = 0; k < sizes.size (); k++)
+    {
+      pers[k] = 1 - psrs[k];
+      NS_LOG_DEBUG ("MPDU " << k << ": size=" << sizes[k] << ", per=" << pers[k]);
+    }
+}
+
 double
 InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const
 {
@@ -756,6 +824,19 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
   return snrPer;
 }
 
+double
+InterferenceHelper::CalculatePlcpPayloadSnrPers (Ptr<Event> event, const std::vector<uint32_t> &sizes,
+                                                 std::vector<double> &pers) const
+{
+  NiChanges ni;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  double snr = CalculateSnr (event->GetRxPowerW (),
+                             noiseInterferenceW,
+                             event->GetTxVector ().GetChannelWidth ());
+  CalculatePlcpPayloadPers (event, &ni, sizes, pers);
+  return snr;
+}
+
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
 {
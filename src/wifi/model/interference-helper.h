@@ -24,6 +24,7 @@
 #include "ns3/nstime.h"
 #include "wifi-tx-vector.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -180,6 +181,20 @@ public:
    * \return struct of SNR and PER
    */
   struct InterferenceHelper::SnrPer CalculatePlcpPayloadSnrPer (Ptr<Event> event) const;
+  /**
+   * Calculate the SNIR at the start of the plcp payload and the error rate
+   * of each MPDU of an A-MPDU carried in the plcp payload. The payload
+   * duration is shared among the MPDUs in proportion to their size, and
+   * the SNIR changes are walked once for the whole A-MPDU.
+   *
+   * \param event the event corresponding to the first time the corresponding packet arrives
+   * \param sizes the size in bytes of each A-MPDU subframe
+   * \param pers the vector filled with the error rate of each MPDU
+   *
+   * \eturn the SNR at the start of the plcp payload
+   */
+  double CalculatePlcpPayloadSnrPers (Ptr<Event> event, const std::vector<uint32_t> &sizes,
+                                      std::vector<double> &pers) const;
   /**
    * Calculate the SNIR at the start of the plcp header and accumulate
    * all SNIR changes in the snir vector.
@@ -296,6 +311,18 @@ private:
    * \return the error rate of the packet
    */
   double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const;
+  /**
+   * Calculate the error rate of each MPDU of an A-MPDU carried in the plcp
+   * payload. The plcp payload can be divided into multiple chunks (e.g. due
+   * to interference from other transmissions).
+   *
+   * \param event
+   * \param ni
+   * \param sizes the size in bytes of each A-MPDU subframe
+   * \param pers the vector filled with the error rate of each MPDU
+   */
+  void CalculatePlcpPayloadPers (Ptr<const Event> event, NiChanges *ni,
+                                 const std::vector<uint32_t> &sizes, std::vector<double> &pers) const;
   /**
    * Calculate the error rate of the plcp header. The plcp header can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
@@ -27,6 +27,7 @@
 #include "qos-txop.h"
 #include "snr-tag.h"
 #include "ampdu-tag.h"
+#include "ampdu-descriptor-tag.h"
 #include "wifi-mac-queue.h"
 #include "wifi-utils.h"
 #include "ctrl-headers.h"
@@ -124,6 +125,7 @@ MacLow::MacLow ()
     m_ampdu (false),
     m_phyMacLowListener (0),
     m_ctsToSelfSupported (false),
+    m_ampduAbstraction (false),
     m_cfAckInfo ()
 {
   NS_LOG_FUNCTION (this);
@@ -312,6 +314,12 @@ MacLow::GetCtsToSelfSupported () const
   return m_ctsToSelfSupported;
 }
 
+void
+MacLow::SetAmpduAbstraction (bool enable)
+{
+  m_ampduAbstraction = enable;
+}
+
 void
 MacLow::SetCtsTimeout (Time ctsTimeout)
 {
@@ -1410,6 +1418,10 @@ MacLow::ForwardDown (Ptr<const Packet> packet, const WifiMacHeader* hdr, WifiTxV
         {
           txVector.SetAggregation (true);
         }
+      //with the A-MPDU abstraction, the subframes are sent as a single packet
+      bool abstracted = m_ampduAbstraction && !singleMpdu;
+      Ptr<Packet> ampduPacket = Create<Packet> ();
+      AmpduDescriptorTag descriptor;
       for (; queueSize > 0; queueSize--)
         {
           dequeuedItem = m_aggregateQueue[GetTid (packet, *hdr)]->Dequeue ();
@@ -1426,6 +1438,13 @@ MacLow::ForwardDown (Ptr<const Packet> packet, const WifiMacHeader* hdr, WifiTxV
 
           edcaIt->second->GetMpduAggregator ()->AddHeaderAndPad (newPacket, last, singleMpdu);
 
+          if (abstracted)
+            {
+              descriptor.AddSubframe (newPacket->GetSize ());
+              ampduPacket->AddAtEnd (newPacket);
+              continue;
+            }
+
           if (delay.IsZero ())
             {
               if (!singleMpdu)
@@ -1470,6 +1489,15 @@ MacLow::ForwardDown (Ptr<const Packet> packet, const WifiMacHeader* hdr, WifiTxV
 
           txVector.SetPreambleType (WIFI_PREAMBLE_NONE);
         }
+      if (abstracted)
+        {
+          NS_LOG_DEBUG ("Sending A-MPDU of " << descriptor.GetNSubframes () << " MPDUs as a single packet");
+          ampdutag.SetRemainingNbOfMpdus (0);
+          ampdutag.SetRemainingAmpduDuration (NanoSeconds (0));
+          ampduPacket->AddPacketTag (ampdutag);
+          ampduPacket->AddPacketTag (descriptor);
+          m_phy->SendPacket (ampduPacket, txVector, NORMAL_MPDU);
+        }
     }
 }
 
@@ -2448,16 +2476,35 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
   if (aggregatedPacket->RemovePacketTag (ampdu))
     {
       ampduSubframe = true;
+      AmpduDescriptorTag descriptor;
+      bool abstracted = aggregatedPacket->RemovePacketTag (descriptor);
       MpduAggregator::DeaggregatedMpdus packets = MpduAggregator::Deaggregate (aggregatedPacket);
-      MpduAggregator::DeaggregatedMpdusCI n = packets.begin ();
-
-      WifiMacHeader firsthdr;
-      (*n).first->PeekHeader (firsthdr);
-      NS_LOG_DEBUG ("duration/id=" << firsthdr.GetDuration ());
-      NotifyNav ((*n).first, firsthdr);
+      if (abstracted)
+        {
+          //the whole A-MPDU has been received as a single packet: only keep
+          //the MPDUs the PHY has received successfully
+          NS_ASSERT (packets.size () == descriptor.GetNSubframes ());
+          std::size_t k = 0;
+          for (MpduAggregator::DeaggregatedMpdus::iterator n = packets.begin (); n != packets.end (); k++)
+            {
+              n = descriptor.IsSuccess (k) ? std::next (n) : packets.erase (n);
+            }
+          NS_LOG_DEBUG ("Received " << packets.size () << " MPDUs out of " << descriptor.GetNSubframes ());
+        }
 
-      if (firsthdr.GetAddr1 () == m_self)
+      for (MpduAggregator::DeaggregatedMpdusCI n = packets.begin (); n != packets.end (); n++)
         {
+          bool first = (n == packets.begin ());
+          bool last = (std::next (n) == packets.end ());
+          WifiMacHeader firsthdr;
+          (*n).first->PeekHeader (firsthdr);
+          NS_LOG_DEBUG ("duration/id=" << firsthdr.GetDuration ());
+          NotifyNav ((*n).first, firsthdr);
+
+          if (firsthdr.GetAddr1 () != m_self)
+            {
+              continue;
+            }
           bool singleMpdu = (*n).second.GetEof ();
           if (singleMpdu)
             {
@@ -2465,7 +2512,7 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
               NS_LOG_DEBUG ("Receive S-MPDU");
               ampduSubframe = false;
             }
-          else if (txVector.GetPreambleType () != WIFI_PREAMBLE_NONE || !m_sendAckEvent.IsRunning ())
+          else if ((first && txVector.GetPreambleType () != WIFI_PREAMBLE_NONE) || !m_sendAckEvent.IsRunning ())
             {
               m_sendAckEvent = Simulator::Schedule (ampdu.GetRemainingAmpduDuration () + GetSifs (),
                                                     &MacLow::SendBlockAckAfterAmpdu, this,
@@ -2495,7 +2542,7 @@ MacLow::DeaggregateAmpduAndReceive (Ptr<Packet> aggregatedPacket, double rxSnr,
               NS_FATAL_ERROR ("Received A-MPDU with invalid first MPDU type");
             }
 
-          if (ampdu.GetRemainingNbOfMpdus () == 0 && !singleMpdu)
+          if (ampdu.GetRemainingNbOfMpdus () == 0 && last && !singleMpdu)
             {
               if (normalAck)
                 {
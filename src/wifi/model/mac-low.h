@@ -126,6 +126,15 @@ public:
    * \param enable Enable or disable CTS-to-self capability
    */
   void SetCtsToSelfSupported (bool enable);
+  /**
+   * Enable or disable the A-MPDU abstraction. When enabled, an A-MPDU is
+   * sent to the PHY as a single packet carrying an AmpduDescriptorTag
+   * instead of one packet per MPDU, and the receiving PHY takes an error
+   * decision for each MPDU at the end of the A-MPDU.
+   *
+   * \param enable Enable or disable the A-MPDU abstraction
+   */
+  void SetAmpduAbstraction (bool enable);
   /**
    * Set CTS timeout of this MacLow.
    *
@@ -955,6 +964,7 @@ private:
   QueueEdcas m_edca; //!< EDCA queues
 
   bool m_ctsToSelfSupported;             //!< Flag whether CTS-to-self is supported
+  bool m_ampduAbstraction;               //!< Flag whether A-MPDUs are sent as a single packet
   Ptr<WifiMacQueue> m_aggregateQueue[8]; //!< Queues per TID used for MPDU aggregation
   std::vector<Item> m_txPackets[8];      //!< Contain temporary items to be sent with the next A-MPDU transmission for a given TID, once RTS/CTS exchange has succeeded.
   WifiTxVector m_currentTxVector;        //!< TXVECTOR used for the current packet transmission
@@ -27,6 +27,13 @@
 
 namespace ns3 {
 
+std::size_t
+WifiAddressTidHash::operator() (const WifiAddressTidPair& addressTidPair) const
+{
+  // TIDs only take 4 bits
+  return (Mac48AddressHash () (addressTidPair.first) << 4) | (addressTidPair.second & 0x0f);
+}
+
 AcIndex
 QosUtilsMapTidToAc (uint8_t tid)
 {
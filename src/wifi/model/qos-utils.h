@@ -22,12 +22,34 @@
 #define QOS_UTILS_H
 
 #include "ns3/ptr.h"
+#include "ns3/mac48-address.h"
 
 namespace ns3 {
 
 class Packet;
 class WifiMacHeader;
 
+/**
+ * \ingroup wifi
+ * (MAC address, TID) pair
+ */
+typedef std::pair<Mac48Address, uint8_t> WifiAddressTidPair;
+
+/**
+ * \ingroup wifi
+ * Function object that computes the hash of a (MAC address, TID) pair
+ */
+struct WifiAddressTidHash
+{
+  /**
+   * Functional operator for (MAC address, TID) hash computation.
+   *
+   * \param addressTidPair the (MAC address, TID) pair
+   * \return the hash
+   */
+  std::size_t operator() (const WifiAddressTidPair& addressTidPair) const;
+};
+
 /**
  * \ingroup wifi
  * This enumeration defines the Access Categories as an enumeration
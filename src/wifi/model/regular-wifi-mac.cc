@@ -689,6 +689,13 @@ RegularWifiMac::SetCtsToSelfSupported (bool enable)
   m_low->SetCtsToSelfSupported (enable);
 }
 
+void
+RegularWifiMac::SetAmpduAbstraction (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_low->SetAmpduAbstraction (enable);
+}
+
 void
 RegularWifiMac::SetSlot (Time slotTime)
 {
@@ -1108,6 +1115,14 @@ RegularWifiMac::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&RegularWifiMac::SetCtsToSelfSupported),
                    MakeBooleanChecker ())
+    .AddAttribute ("AmpduAbstraction",
+                   "If true, an A-MPDU is handed to the PHY as a single packet and the "
+                   "receiver takes one error decision per MPDU at the end of the A-MPDU, "
+                   "instead of the MPDUs being sent and received one by one. This reduces "
+                   "the number of events per A-MPDU, but sniffers see a single frame.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RegularWifiMac::SetAmpduAbstraction),
+                   MakeBooleanChecker ())
     .AddAttribute ("VO_MaxAmsduSize",
                    "Maximum length in bytes of an A-MSDU for AC_VO access class. "
                    "Value 0 means A-MSDU is disabled for that AC.",
@@ -119,6 +119,14 @@ public:
    */
   void SetCtsToSelfSupported (bool enable);
 
+  /**
+   * Enable or disable the A-MPDU abstraction.
+   *
+   * \param enable true if A-MPDUs are to be sent to the PHY as a single packet,
+   *               false otherwise
+   */
+  void SetAmpduAbstraction (bool enable);
+
   /**
    * Enable or disable short slot time feature.
    *
@@ -75,19 +75,98 @@ WifiMacQueue::GetMaxDelay (void) const
 }
 
 bool
-WifiMacQueue::TtlExceeded (ConstIterator &it)
+WifiMacQueue::IsExpired (ConstIterator it) const
+{
+  return Simulator::Now () > (*it)->GetTimeStamp () + m_maxDelay;
+}
+
+void
+WifiMacQueue::RemoveExpired (void)
 {
   NS_LOG_FUNCTION (this);
 
-  if (Simulator::Now () > (*it)->GetTimeStamp () + m_maxDelay)
+  while (!m_expiry.empty () && IsExpired (m_expiry.begin ()->second))
     {
+      ConstIterator it = m_expiry.begin ()->second;
       NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" <<
                     Simulator::Now () - (*it)->GetTimeStamp () << ")");
-      auto curr = it++;
-      DoRemove (curr);
-      return true;
+      Unindex (it);
+      DoRemove (it);
+    }
+}
+
+bool
+WifiMacQueue::Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (!DoEnqueue (pos, item))
+    {
+      return false;
+    }
+
+  // the item has been inserted right before pos
+  ConstIterator it = std::prev (pos);
+  const WifiMacHeader &hdr = item->GetHeader ();
+  ItemHandles handles;
+  handles.byAddress = 0;
+  handles.byAddressTid = 0;
+
+  if (hdr.IsData ())
+    {
+      handles.byAddress = &m_byAddress[hdr.GetAddr1 ()];
+      handles.byAddressIt = handles.byAddress->insert (pos == Tail () ? handles.byAddress->end ()
+                                                                      : handles.byAddress->begin (),
+                                                       it);
+    }
+  if (hdr.IsQosData ())
+    {
+      handles.byAddressTid = &m_byAddressTid[std::make_pair (hdr.GetAddr1 (), hdr.GetQosTid ())];
+      handles.byAddressTidIt = handles.byAddressTid->insert (pos == Tail () ? handles.byAddressTid->end ()
+                                                                            : handles.byAddressTid->begin (),
+                                                             it);
+    }
+  handles.expiryIt = m_expiry.insert (std::make_pair (item->GetTimeStamp (), it));
+
+  bool inserted = m_handles.insert (std::make_pair (PeekPointer (item), handles)).second;
+  NS_ASSERT_MSG (inserted, "The same item cannot be enqueued twice");
+  NS_UNUSED (inserted);
+  return true;
+}
+
+template <typename Index>
+void
+WifiMacQueue::EraseFromSubQueue (Index &index, const typename Index::key_type &key,
+                                 SubQueue *subQueue, SubQueue::iterator it)
+{
+  subQueue->erase (it);
+  if (subQueue->empty ())
+    {
+      index.erase (key);
     }
-  return false;
+}
+
+void
+WifiMacQueue::Unindex (ConstIterator pos)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto handlesIt = m_handles.find (PeekPointer (*pos));
+  NS_ASSERT (handlesIt != m_handles.end ());
+  const ItemHandles &handles = handlesIt->second;
+  const WifiMacHeader &hdr = (*pos)->GetHeader ();
+
+  if (handles.byAddress != 0)
+    {
+      EraseFromSubQueue (m_byAddress, hdr.GetAddr1 (), handles.byAddress, handles.byAddressIt);
+    }
+  if (handles.byAddressTid != 0)
+    {
+      EraseFromSubQueue (m_byAddressTid, std::make_pair (hdr.GetAddr1 (), hdr.GetQosTid ()),
+                         handles.byAddressTid, handles.byAddressTidIt);
+    }
+  m_expiry.erase (handles.expiryIt);
+  m_handles.erase (handlesIt);
 }
 
 bool
@@ -97,24 +176,21 @@ WifiMacQueue::Enqueue (Ptr<WifiMacQueueItem> item)
   NS_ASSERT_MSG (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS,
                  "WifiMacQueues must be in packet mode");
 
-  // if the queue is full, remove the first stale packet (if any) encountered
-  // starting from the head of the queue, in order to make room for the new packet.
+  // if the queue is full, remove the stale packets (if any) in order to make
+  // room for the new packet.
   if (QueueBase::GetNPackets () == GetMaxSize ().GetValue ())
     {
-      auto it = Head ();
-      while (it != Tail () && !TtlExceeded (it))
-        {
-          it++;
-        }
+      RemoveExpired ();
     }
 
   if (QueueBase::GetNPackets () == GetMaxSize ().GetValue () && m_dropPolicy == DROP_OLDEST)
     {
       NS_LOG_DEBUG ("Remove the oldest item in the queue");
+      Unindex (Head ());
       DoRemove (Head ());
     }
 
-  return DoEnqueue (Tail (), item);
+  return Insert (Tail (), item);
 }
 
 bool
@@ -124,36 +200,32 @@ WifiMacQueue::PushFront (Ptr<WifiMacQueueItem> item)
   NS_ASSERT_MSG (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS,
                  "WifiMacQueues must be in packet mode");
 
-  // if the queue is full, remove the first stale packet (if any) encountered
-  // starting from the head of the queue, in order to make room for the new packet.
+  // if the queue is full, remove the stale packets (if any) in order to make
+  // room for the new packet.
   if (QueueBase::GetNPackets () == GetMaxSize ().GetValue ())
     {
-      auto it = Head ();
-      while (it != Tail () && !TtlExceeded (it))
-        {
-          it++;
-        }
+      RemoveExpired ();
     }
 
   if (QueueBase::GetNPackets () == GetMaxSize ().GetValue () && m_dropPolicy == DROP_OLDEST)
     {
       NS_LOG_DEBUG ("Remove the oldest item in the queue");
+      Unindex (Head ());
       DoRemove (Head ());
     }
 
-  return DoEnqueue (Head (), item);
+  return Insert (Head (), item);
 }
 
 Ptr<WifiMacQueueItem>
 WifiMacQueue::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  if (Head () != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          return DoDequeue (it);
-        }
+      Unindex (Head ());
+      return DoDequeue (Head ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -163,18 +235,13 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::DequeueByAddress (Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  auto subQueue = m_byAddress.find (dest);
+  if (subQueue != m_byAddress.end ())
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
-        }
+      ConstIterator it = subQueue->second.front ();
+      Unindex (it);
+      return DoDequeue (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -184,18 +251,13 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::DequeueByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  auto subQueue = m_byAddressTid.find (std::make_pair (dest, tid));
+  if (subQueue != m_byAddressTid.end ())
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
-        }
+      ConstIterator it = subQueue->second.front ();
+      Unindex (it);
+      return DoDequeue (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -205,17 +267,15 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::DequeueFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  // unless some destinations are blocked, the head of the queue is returned
+  for (auto it = Head (); it != Tail (); it++)
     {
-      if (!TtlExceeded (it))
+      if (!(*it)->GetHeader ().IsQosData ()
+          || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
         {
-          if (!(*it)->GetHeader ().IsQosData ()
-              || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
+          Unindex (it);
+          return DoDequeue (it);
         }
     }
   NS_LOG_DEBUG ("The queue is empty");
@@ -230,7 +290,7 @@ WifiMacQueue::Peek (void) const
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (Simulator::Now () <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsExpired (it))
         {
           return DoPeek (it);
         }
@@ -243,18 +303,11 @@ Ptr<const WifiMacQueueItem>
 WifiMacQueue::PeekByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  auto subQueue = m_byAddressTid.find (std::make_pair (dest, tid));
+  if (subQueue != m_byAddressTid.end ())
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return DoPeek (it);
-            }
-
-          it++;
-        }
+      return DoPeek (subQueue->second.front ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -264,17 +317,13 @@ Ptr<const WifiMacQueueItem>
 WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  for (auto it = Head (); it != Tail (); it++)
     {
-      if (!TtlExceeded (it))
+      if (!(*it)->GetHeader ().IsQosData ()
+          || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
         {
-          if (!(*it)->GetHeader ().IsQosData ()
-              || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
-            {
-              return DoPeek (it);
-            }
-
-          it++;
+          return DoPeek (it);
         }
     }
   NS_LOG_DEBUG ("The queue is empty");
@@ -285,13 +334,11 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::Remove (void)
 {
   NS_LOG_FUNCTION (this);
-
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  if (Head () != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          return DoRemove (it);
-        }
+      Unindex (Head ());
+      return DoRemove (Head ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -301,17 +348,14 @@ bool
 WifiMacQueue::Remove (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet);
-  for (auto it = Head (); it != Tail (); )
+  RemoveExpired ();
+  for (auto it = Head (); it != Tail (); it++)
     {
-      if (!TtlExceeded (it))
+      if ((*it)->GetPacket () == packet)
         {
-          if ((*it)->GetPacket () == packet)
-            {
-              DoRemove (it);
-              return true;
-            }
-
-          it++;
+          Unindex (it);
+          DoRemove (it);
+          return true;
         }
     }
   NS_LOG_DEBUG ("Packet " << packet << " not found in the queue");
@@ -322,21 +366,9 @@ uint32_t
 WifiMacQueue::GetNPacketsByAddress (Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-
-  uint32_t nPackets = 0;
-
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
-    }
+  RemoveExpired ();
+  auto subQueue = m_byAddress.find (dest);
+  uint32_t nPackets = (subQueue != m_byAddress.end () ? subQueue->second.size () : 0);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -345,20 +377,9 @@ uint32_t
 WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  uint32_t nPackets = 0;
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
-    }
+  RemoveExpired ();
+  auto subQueue = m_byAddressTid.find (std::make_pair (dest, tid));
+  uint32_t nPackets = (subQueue != m_byAddressTid.end () ? subQueue->second.size () : 0);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -367,16 +388,10 @@ bool
 WifiMacQueue::IsEmpty (void)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          NS_LOG_DEBUG ("returns false");
-          return false;
-        }
-    }
-  NS_LOG_DEBUG ("returns true");
-  return true;
+  RemoveExpired ();
+  bool empty = QueueBase::IsEmpty ();
+  NS_LOG_DEBUG ("returns " << empty);
+  return empty;
 }
 
 uint32_t
@@ -384,13 +399,7 @@ WifiMacQueue::GetNPackets (void)
 {
   NS_LOG_FUNCTION (this);
   // remove packets that stayed in the queue for too long
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  RemoveExpired ();
   return QueueBase::GetNPackets ();
 }
 
@@ -399,13 +408,7 @@ WifiMacQueue::GetNBytes (void)
 {
   NS_LOG_FUNCTION (this);
   // remove packets that stayed in the queue for too long
-  for (auto it = Head (); it != Tail (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  RemoveExpired ();
   return QueueBase::GetNBytes ();
 }
 
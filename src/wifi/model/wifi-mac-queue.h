@@ -25,6 +25,9 @@
 #define WIFI_MAC_QUEUE_H
 
 #include "wifi-mac-queue-item.h"
+#include "qos-utils.h"
+#include <unordered_map>
+#include <map>
 
 namespace ns3 {
 
@@ -44,6 +47,12 @@ class QosBlockedDestinations;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * Besides the FIFO list inherited from Queue, data frames are indexed by
+ * receiver address (and by receiver address and TID for QoS data frames),
+ * and all frames are indexed by timestamp. Hence, the operations searching
+ * for a given destination and the removal of expired packets do not need
+ * to scan the whole queue.
  */
 class WifiMacQueue : public Queue<WifiMacQueueItem>
 {
@@ -169,8 +178,8 @@ public:
   Ptr<WifiMacQueueItem> Remove (void);
   /**
    * If exists, removes <i>packet</i> from queue and returns true. Otherwise it
-   * takes no effects and return false. Deletion of the packet is
-   * performed in linear time (O(n)).
+   * takes no effects and return false. The packet is searched for in linear
+   * time (O(n)).
    *
    * \param packet the packet to be removed
    *
@@ -219,18 +228,72 @@ public:
   uint32_t GetNBytes (void);
 
 private:
+  /// A list of positions in the queue, kept in the same order as the queue
+  typedef std::list<ConstIterator> SubQueue;
+  /// Sub-queues of data frames indexed by receiver address
+  typedef std::unordered_map<Mac48Address, SubQueue, Mac48AddressHash> AddressIndex;
+
+  /// Sub-queues of QoS data frames indexed by (receiver address, TID)
+  typedef std::unordered_map<WifiAddressTidPair, SubQueue, WifiAddressTidHash> AddressTidIndex;
+  /// Positions in the queue ordered by the timestamp of the item
+  typedef std::multimap<Time, ConstIterator> ExpiryIndex;
+
+  /// Positions of an item in the indexes
+  struct ItemHandles
+  {
+    SubQueue *byAddress;                     //!< the sub-queue by address, if any
+    SubQueue::iterator byAddressIt;          //!< the position in the sub-queue by address
+    SubQueue *byAddressTid;                  //!< the sub-queue by (address, TID), if any
+    SubQueue::iterator byAddressTidIt;       //!< the position in the sub-queue by (address, TID)
+    ExpiryIndex::iterator expiryIt;          //!< the position in the expiry index
+  };
+
   /**
-   * Remove the item pointed to by the iterator <i>it</i> if it has been in the
-   * queue for too long. If the item is removed, the iterator is updated to
-   * point to the item that followed the erased one.
+   * Enqueue the given item before the given position and, if successful,
+   * add it to the indexes.
    *
-   * \param it an iterator pointing to the item
-   * \return true if the item is removed, false otherwise
+   * \param pos the position before which the item is inserted
+   * \param item the item to enqueue
+   * \return true if success, false if the packet has been dropped
+   */
+  bool Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item);
+  /**
+   * Remove the item at the given position from the indexes. This method
+   * must be called before the item is removed from the queue.
+   *
+   * \param pos the position of the item
+   */
+  void Unindex (ConstIterator pos);
+  /**
+   * Remove from the given sub-queue the entry pointed to by the given iterator.
+   * The sub-queue is erased from the given index if it becomes empty.
+   *
+   * \param index the index containing the sub-queue
+   * \param key the key of the sub-queue
+   * \param subQueue the sub-queue
+   * \param it the entry to remove
+   */
+  template <typename Index>
+  static void EraseFromSubQueue (Index &index, const typename Index::key_type &key,
+                                 SubQueue *subQueue, SubQueue::iterator it);
+  /**
+   * Remove all the items that have been in the queue for too long, oldest
+   * first. Only the items at the beginning of the expiry index are visited.
+   */
+  void RemoveExpired (void);
+  /**
+   * \param it an iterator pointing to an item
+   * \return true if the item has been in the queue for too long
    */
-  bool TtlExceeded (ConstIterator &it);
+  bool IsExpired (ConstIterator it) const;
 
   Time m_maxDelay;                          //!< Time to live for packets in the queue
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
+  AddressIndex m_byAddress;                 //!< data frames by receiver address
+  AddressTidIndex m_byAddressTid;           //!< QoS data frames by (receiver address, TID)
+  ExpiryIndex m_expiry;                     //!< all frames by timestamp
+  /// index positions of the items in the queue
+  std::unordered_map<const WifiMacQueueItem *, ItemHandles> m_handles;
 
   NS_LOG_TEMPLATE_DECLARE;                  //!< redefinition of the log component
 };
@@ -27,6 +27,7 @@
 #include "wifi-phy.h"
 #include "wifi-phy-tag.h"
 #include "ampdu-tag.h"
+#include "ampdu-descriptor-tag.h"
 #include "wifi-utils.h"
 #include "frame-capture-model.h"
 #include "wifi-radio-energy-model.h"
@@ -2544,6 +2545,13 @@ WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutyp
   NS_ASSERT (IsStateRx ());
   NS_ASSERT (event->GetEndTime () == Simulator::Now ());
 
+  AmpduDescriptorTag descriptor;
+  if (packet->RemovePacketTag (descriptor))
+    {
+      EndReceiveAmpdu (packet, descriptor, event);
+      return;
+    }
+
   InterferenceHelper::SnrPer snrPer;
   snrPer = m_interference.CalculatePlcpPayloadSnrPer (event);
   m_interference.NotifyRxEnd ();
@@ -2585,6 +2593,55 @@ WifiPhy::EndReceive (Ptr<Packet> packet, WifiPreamble preamble, MpduType mpdutyp
 
 }
 
+void
+WifiPhy::EndReceiveAmpdu (Ptr<Packet> packet, AmpduDescriptorTag descriptor, Ptr<Event> event)
+{
+  NS_LOG_FUNCTION (this << packet << event);
+  std::vector<uint32_t> sizes (descriptor.GetNSubframes ());
+  for (std::size_t k = 0; k < sizes.size (); k++)
+    {
+      sizes[k] = descriptor.GetSubframeSize (k);
+    }
+  std::vector<double> pers;
+  double snr = m_interference.CalculatePlcpPayloadSnrPers (event, sizes, pers);
+  m_interference.NotifyRxEnd ();
+  m_currentEvent = 0;
+
+  bool success = false;
+  if (m_plcpSuccess == true)
+    {
+      for (std::size_t k = 0; k < pers.size (); k++)
+        {
+          bool mpduSuccess = (m_random->GetValue () > pers[k]);
+          descriptor.SetSuccess (k, mpduSuccess);
+          success = success || mpduSuccess;
+        }
+      NS_LOG_DEBUG ("mode=" << (event->GetPayloadMode ().GetDataRate (event->GetTxVector ())) <<
+                    ", snr(dB)=" << RatioToDb (snr) << ", size=" << packet->GetSize () <<
+                    ", nMpdus=" << pers.size () << ", success=" << success);
+    }
+  if (success)
+    {
+      NotifyRxEnd (packet);
+      SignalNoiseDbm signalNoise;
+      signalNoise.signal = WToDbm (event->GetRxPowerW ());
+      signalNoise.noise = WToDbm (event->GetRxPowerW () / snr);
+      MpduInfo aMpdu;
+      aMpdu.type = NORMAL_MPDU;
+      aMpdu.mpduRefNumber = m_rxMpduReferenceNumber;
+      NotifyMonitorSniffRx (packet, GetFrequency (), event->GetTxVector (), aMpdu, signalNoise);
+      packet->AddPacketTag (descriptor);
+      m_state->SwitchFromRxEndOk (packet, snr, event->GetTxVector ());
+    }
+  else
+    {
+      if (m_plcpSuccess == true)
+        {
+          NotifyRxDrop (packet);
+        }
+      m_state->SwitchFromRxEndError (packet, snr);
+    }
+}
 
 // Clause 15 rates (DSSS)
 
@@ -41,6 +41,7 @@ class WifiPhyStateHelper;
 class FrameCaptureModel;
 class WifiRadioEnergyModel;
 class UniformRandomVariable;
+class AmpduDescriptorTag;
 
 /// SignalNoiseDbm structure
 struct SignalNoiseDbm
@@ -1613,6 +1614,17 @@ private:
    */
   void MaybeCcaBusyDuration (void);
 
+  /**
+   * The last bit of an A-MPDU sent as a single packet has arrived: take an
+   * error decision for each MPDU and forward the A-MPDU up if at least one
+   * MPDU has been received successfully.
+   *
+   * \param packet the A-MPDU that the last bit has arrived
+   * \param descriptor the descriptor of the A-MPDU subframes
+   * \param event the corresponding event of the first time the packet arrives
+   */
+  void EndReceiveAmpdu (Ptr<Packet> packet, AmpduDescriptorTag descriptor, Ptr<Event> event);
+
   /**
    * Starting receiving the packet after having detected the medium is idle or after a reception switch.
    *
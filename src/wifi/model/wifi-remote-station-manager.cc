@@ -1641,13 +1641,11 @@ WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
   NS_LOG_FUNCTION (this << address);
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  StationStates::const_iterator i = m_states.find (address);
+  if (i != m_states.end ())
     {
-      if ((*i)->m_address == address)
-        {
-          NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
-          return (*i);
-        }
+      NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
+      return i->second;
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
@@ -1667,7 +1665,7 @@ WifiRemoteStationManager::LookupState (Mac48Address address) const
   state->m_htSupported = false;
   state->m_vhtSupported = false;
   state->m_heSupported = false;
-  const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  const_cast<WifiRemoteStationManager *> (this)->m_states.insert (std::make_pair (address, state));
   NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning new state");
   return state;
 }
@@ -1691,13 +1689,10 @@ WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << address << +tid);
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  Stations::const_iterator i = m_stations.find (std::make_pair (address, tid));
+  if (i != m_stations.end ())
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
-        {
-          return (*i);
-        }
+      return i->second;
     }
   WifiRemoteStationState *state = LookupState (address);
 
@@ -1706,7 +1701,7 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_tid = tid;
   station->m_ssrc = 0;
   station->m_slrc = 0;
-  const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  const_cast<WifiRemoteStationManager *> (this)->m_stations.insert (std::make_pair (std::make_pair (address, tid), station));
   return station;
 }
 
@@ -1869,12 +1864,12 @@ WifiRemoteStationManager::Reset (void)
   NS_LOG_FUNCTION (this);
   for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_states.clear ();
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_stations.clear ();
   m_bssBasicRateSet.clear ();
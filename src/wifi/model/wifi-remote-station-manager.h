@@ -26,7 +26,9 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/mac48-address.h"
+#include <unordered_map>
 #include "wifi-mode.h"
+#include "qos-utils.h"
 #include "wifi-preamble.h"
 
 namespace ns3 {
@@ -1387,13 +1389,13 @@ private:
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
   /**
-   * A vector of WifiRemoteStations
+   * A hash table of WifiRemoteStations indexed by (address, TID)
    */
-  typedef std::vector <WifiRemoteStation *> Stations;
+  typedef std::unordered_map <WifiAddressTidPair, WifiRemoteStation *, WifiAddressTidHash> Stations;
   /**
-   * A vector of WifiRemoteStationStates
+   * A hash table of WifiRemoteStationStates indexed by address
    */
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  typedef std::unordered_map <Mac48Address, WifiRemoteStationState *, Mac48AddressHash> StationStates;
 
   /**
    * This is a pointer to the WifiPhy associated with this
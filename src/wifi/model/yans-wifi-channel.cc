@@ -27,6 +27,14 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <mutex>
+#include <condition_variable>
+#endif
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
@@ -37,6 +45,207 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
+#ifdef HAVE_PTHREAD_H
+/// Minimum number of PHYs per thread for the received power to be computed in parallel
+static const uint32_t FAN_OUT_MIN_PHYS_PER_THREAD = 16;
+
+/**
+ * \ingroup wifi
+ *
+ * Pool of threads computing the received power at the receivers of a
+ * transmission on behalf of a YansWifiChannel.
+ *
+ * The receivers are split in as many contiguous chunks as threads, the
+ * first chunk being processed by the simulation thread itself. Each chunk
+ * owns the mobility models that are passed to the propagation loss model,
+ * so that the threads never share a reference counted object.
+ */
+class YansWifiChannelFanOut
+{
+public:
+  /**
+   * Create and start the threads
+   *
+   * \param nThreads the number of threads, including the simulation thread
+   */
+  YansWifiChannelFanOut (uint32_t nThreads);
+  /**
+   * Stop and join the threads
+   */
+  ~YansWifiChannelFanOut ();
+
+  /**
+   * \return the number of threads, including the simulation thread
+   */
+  uint32_t GetNThreads (void) const;
+  /**
+   * Compute the received power at each of the given receiver positions.
+   * Returns when all the chunks have been processed.
+   *
+   * \param loss the propagation loss model, which must only depend on the positions of the nodes
+   * \param txPowerDbm the tx power, in dBm
+   * \param sender the position of the sender
+   * \param receivers the positions of the receivers
+   * \param rxPowersDbm the received powers, in dBm, in the order of the receivers
+   */
+  void Run (const PropagationLossModel *loss, double txPowerDbm, const Vector &sender,
+            const std::vector<Vector> &receivers, std::vector<double> &rxPowersDbm);
+
+private:
+  /**
+   * Compute the received power at the receivers of the given chunk
+   *
+   * \param chunk the index of the chunk
+   */
+  void Process (uint32_t chunk);
+  /**
+   * Body of the threads: wait for a new transmission, process the chunk
+   * assigned to the thread and notify the simulation thread.
+   */
+  void DoWork (void);
+
+  uint32_t m_nThreads;                                        //!< number of threads, including the simulation thread
+  std::vector<Ptr<SystemThread> > m_threads;                  //!< the threads other than the simulation thread
+  std::vector<Ptr<MobilityModel> > m_senderMobility;          //!< position of the sender, per chunk
+  std::vector<Ptr<MobilityModel> > m_receiverMobility;        //!< position of the receiver, per chunk
+  std::mutex m_mutex;                                         //!< protects the state below
+  std::condition_variable m_start;                            //!< notified when a transmission has to be processed, or the threads stopped
+  std::condition_variable m_done;                             //!< notified when all the chunks have been processed
+  uint64_t m_generation;                                      //!< number of transmissions processed so far
+  uint32_t m_pending;                                         //!< number of chunks being processed by the threads
+  uint32_t m_nStarted;                                        //!< number of threads started so far
+  bool m_stop;                                                //!< whether the threads have to terminate
+  const PropagationLossModel *m_loss;                         //!< loss model of the current transmission
+  double m_txPowerDbm;                                        //!< tx power of the current transmission
+  const std::vector<Vector> *m_receivers;                     //!< receiver positions of the current transmission
+  std::vector<double> *m_rxPowersDbm;                         //!< received powers of the current transmission
+};
+
+YansWifiChannelFanOut::YansWifiChannelFanOut (uint32_t nThreads)
+  : m_nThreads (nThreads),
+    m_generation (0),
+    m_pending (0),
+    m_nStarted (0),
+    m_stop (false),
+    m_loss (0),
+    m_txPowerDbm (0),
+    m_receivers (0),
+    m_rxPowersDbm (0)
+{
+  NS_LOG_FUNCTION (this << nThreads);
+  NS_ASSERT (nThreads > 1);
+  for (uint32_t i = 0; i < m_nThreads; i++)
+    {
+      m_senderMobility.push_back (CreateObject<ConstantPositionMobilityModel> ());
+      m_receiverMobility.push_back (CreateObject<ConstantPositionMobilityModel> ());
+    }
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&YansWifiChannelFanOut::DoWork, this));
+      m_threads.push_back (thread);
+      thread->Start ();
+    }
+}
+
+YansWifiChannelFanOut::~YansWifiChannelFanOut ()
+{
+  NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+    m_start.notify_all ();
+  }
+  for (std::vector<Ptr<SystemThread> >::iterator it = m_threads.begin (); it != m_threads.end (); it++)
+    {
+      (*it)->Join ();
+    }
+  m_threads.clear ();
+}
+
+uint32_t
+YansWifiChannelFanOut::GetNThreads (void) const
+{
+  return m_nThreads;
+}
+
+void
+YansWifiChannelFanOut::Run (const PropagationLossModel *loss, double txPowerDbm, const Vector &sender,
+                            const std::vector<Vector> &receivers, std::vector<double> &rxPowersDbm)
+{
+  NS_LOG_FUNCTION (this << loss << txPowerDbm << sender << receivers.size ());
+  rxPowersDbm.resize (receivers.size ());
+  for (uint32_t i = 0; i < m_nThreads; i++)
+    {
+      m_senderMobility[i]->SetPosition (sender);
+    }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_loss = loss;
+    m_txPowerDbm = txPowerDbm;
+    m_receivers = &receivers;
+    m_rxPowersDbm = &rxPowersDbm;
+    m_pending = m_nThreads - 1;
+    m_generation++;
+    m_start.notify_all ();
+  }
+
+  Process (0);
+
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (m_pending > 0)
+    {
+      m_done.wait (lock);
+    }
+  m_loss = 0;
+  m_receivers = 0;
+  m_rxPowersDbm = 0;
+}
+
+void
+YansWifiChannelFanOut::Process (uint32_t chunk)
+{
+  std::size_t n = m_receivers->size ();
+  std::size_t begin = n * chunk / m_nThreads;
+  std::size_t end = n * (chunk + 1) / m_nThreads;
+  Ptr<MobilityModel> senderMobility = m_senderMobility[chunk];
+  Ptr<MobilityModel> receiverMobility = m_receiverMobility[chunk];
+  for (std::size_t i = begin; i < end; i++)
+    {
+      receiverMobility->SetPosition ((*m_receivers)[i]);
+      (*m_rxPowersDbm)[i] = m_loss->CalcRxPower (m_txPowerDbm, senderMobility, receiverMobility);
+    }
+}
+
+void
+YansWifiChannelFanOut::DoWork (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  uint32_t chunk = ++m_nStarted;
+  uint64_t generation = 0;
+  while (true)
+    {
+      while (m_generation == generation && !m_stop)
+        {
+          m_start.wait (lock);
+        }
+      if (m_stop)
+        {
+          break;
+        }
+      generation = m_generation;
+      lock.unlock ();
+
+      Process (chunk);
+
+      lock.lock ();
+      if (--m_pending == 0)
+        {
+          m_done.notify_one ();
+        }
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
 TypeId
 YansWifiChannel::GetTypeId (void)
 {
@@ -52,11 +261,23 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("FanOutThreads",
+                   "The number of threads computing the received power at the receivers of a "
+                   "transmission. A value of one disables the parallel computation, which is "
+                   "also skipped when the propagation loss models do not only depend on the "
+                   "positions of the nodes, when the PropagationLossModel log component is "
+                   "enabled (the logging is not thread-safe) or when there are less than 16 "
+                   "PHYs per thread.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&YansWifiChannel::m_fanOutThreads),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_fanOutThreads (1),
+    m_fanOut (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -65,6 +286,21 @@ YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+#ifdef HAVE_PTHREAD_H
+  delete m_fanOut;
+  m_fanOut = 0;
+#endif
+}
+
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  delete m_fanOut;
+  m_fanOut = 0;
+#endif
+  Channel::DoDispose ();
 }
 
 void
@@ -87,6 +323,23 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
+#ifdef HAVE_PTHREAD_H
+  if (m_fanOutThreads > 1
+      && m_phyList.size () >= m_fanOutThreads * FAN_OUT_MIN_PHYS_PER_THREAD
+      && m_loss->IsPositionOnly ())
+    {
+      PhyList receivers;
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          if (sender != (*i) && (*i)->GetChannelNumber () == sender->GetChannelNumber ())
+            {
+              receivers.push_back (*i);
+            }
+        }
+      SendInParallel (sender, receivers, packet, txPowerDbm, duration);
+      return;
+    }
+#endif
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
     {
       if (sender != (*i))
@@ -102,25 +355,75 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
-            }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+          ScheduleReceive ((*i), packet, rxPowerDbm, delay, duration);
         }
     }
 }
 
+#ifdef HAVE_PTHREAD_H
+void
+YansWifiChannel::SendInParallel (Ptr<YansWifiPhy> sender, const PhyList &receivers,
+                                 Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+{
+  NS_LOG_FUNCTION (this << sender << receivers.size () << packet << txPowerDbm << duration.GetSeconds ());
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ();
+  //The positions and the propagation delays are obtained by the simulation
+  //thread, in the order of the PHY list, since mobility and delay models
+  //may update their state or draw random variables
+  std::vector<Vector> positions;
+  std::vector<Time> delays;
+  positions.reserve (receivers.size ());
+  delays.reserve (receivers.size ());
+  for (PhyList::const_iterator i = receivers.begin (); i != receivers.end (); i++)
+    {
+      Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+      delays.push_back (m_delay->GetDelay (senderMobility, receiverMobility));
+      positions.push_back (receiverMobility->GetPosition ());
+    }
+
+  if (m_fanOut != 0 && m_fanOut->GetNThreads () != m_fanOutThreads)
+    {
+      delete m_fanOut;
+      m_fanOut = 0;
+    }
+  if (m_fanOut == 0)
+    {
+      m_fanOut = new YansWifiChannelFanOut (m_fanOutThreads);
+    }
+  std::vector<double> rxPowersDbm;
+  m_fanOut->Run (PeekPointer (m_loss), txPowerDbm, senderMobility->GetPosition (), positions, rxPowersDbm);
+
+  for (std::size_t i = 0; i < receivers.size (); i++)
+    {
+      NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowersDbm[i] << "dbm, " <<
+                    "distance=" << CalculateDistance (senderMobility->GetPosition (), positions[i]) <<
+                    "m, delay=" << delays[i]);
+      ScheduleReceive (receivers[i], packet, rxPowersDbm[i], delays[i], duration);
+    }
+}
+#endif
+
+void
+YansWifiChannel::ScheduleReceive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet,
+                                  double rxPowerDbm, Time delay, Time duration)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm, duration);
+}
+
 void
 YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
 {
@@ -31,6 +31,7 @@ class PropagationDelayModel;
 class YansWifiPhy;
 class Packet;
 class Time;
+class YansWifiChannelFanOut;
 
 /**
  * \brief a channel to interconnect ns3::YansWifiPhy objects.
@@ -40,6 +41,15 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the FanOutThreads attribute is larger than one and the propagation
+ * loss models only depend on the positions of the nodes (see
+ * PropagationLossModel::IsPositionOnly), the received power at each
+ * receiver of a transmission is computed by a pool of threads, provided
+ * that there are enough PHYs attached to the channel. The
+ * receptions are then scheduled by the simulation thread in the order of
+ * the PHY list, so that the simulation results do not depend on the
+ * number of threads.
  */
 class YansWifiChannel : public Channel
 {
@@ -116,9 +126,39 @@ private:
    */
   static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
 
+  /**
+   * Schedule the reception of a copy of the given packet by the given
+   * receiver after the given propagation delay.
+   *
+   * \param receiver the device to which the packet is destined
+   * \param packet the packet being sent
+   * \param rxPowerDbm the received power (dBm)
+   * \param delay the propagation delay
+   * \param duration the transmission duration associated with the packet being sent
+   */
+  static void ScheduleReceive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet,
+                               double rxPowerDbm, Time delay, Time duration);
+
+  /**
+   * Compute the received power at all the receivers of the given transmission
+   * by means of the pool of threads, and schedule the receptions.
+   *
+   * \param sender the phy object from which the packet is originating
+   * \param receivers the phy objects that receive the packet
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendInParallel (Ptr<YansWifiPhy> sender, const PhyList &receivers,
+                       Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+
+  virtual void DoDispose (void);
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  uint32_t m_fanOutThreads;            //!< Number of threads computing the received power
+  mutable YansWifiChannelFanOut *m_fanOut; //!< Pool of threads computing the received power
 };
 
 } //namespace ns3
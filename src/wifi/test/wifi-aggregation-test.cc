@@ -30,6 +30,16 @@
 #include "ns3/mpdu-aggregator.h"
 #include "ns3/mgt-headers.h"
 #include "ns3/wifi-remote-station-manager.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/packet-socket-server.h"
+#include "ns3/packet-socket-client.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -404,6 +414,162 @@ TwoLevelAggregationTest::DoRun (void)
   m_txop = 0;
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief A-MPDU abstraction test
+ *
+ * An AP sends saturated traffic to a station using A-MPDUs, once with the
+ * MPDUs sent one by one and once with the A-MPDU abstraction enabled. The
+ * test checks that the abstraction reduces the number of receptions handled
+ * by the PHY of the station while the number of MPDUs delivered to the
+ * station stays within a few percent of the one obtained when the MPDUs are
+ * sent one by one, both on an error-free link and on a lossy link.
+ */
+class AmpduAbstractionTest : public TestCase
+{
+public:
+  AmpduAbstractionTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the scenario
+   * \param abstraction whether the A-MPDU abstraction is enabled
+   * \param distance the distance in meters between the AP and the station
+   */
+  void RunOne (bool abstraction, double distance);
+  /**
+   * Callback invoked when the server application receives a packet
+   * \param p the packet
+   * \param addr the address of the sender
+   */
+  void Receive (Ptr<const Packet> p, const Address &addr);
+  /**
+   * Callback invoked when the PHY of the station ends the reception of a packet
+   * \param p the packet
+   */
+  void PhyRxEnd (Ptr<const Packet> p);
+
+  uint32_t m_received;  ///< number of packets received by the server application
+  uint32_t m_phyRxEnd;  ///< number of successful receptions by the PHY of the station
+};
+
+AmpduAbstractionTest::AmpduAbstractionTest ()
+  : TestCase ("Check that the A-MPDU abstraction reduces the PHY receptions and preserves the throughput"),
+    m_received (0),
+    m_phyRxEnd (0)
+{
+}
+
+void
+AmpduAbstractionTest::Receive (Ptr<const Packet> p, const Address &addr)
+{
+  m_received++;
+}
+
+void
+AmpduAbstractionTest::PhyRxEnd (Ptr<const Packet> p)
+{
+  m_phyRxEnd++;
+}
+
+void
+AmpduAbstractionTest::RunOne (bool abstraction, double distance)
+{
+  m_received = 0;
+  m_phyRxEnd = 0;
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+
+  NodeContainer wifiStaNode;
+  wifiStaNode.Create (1);
+  NodeContainer wifiApNode;
+  wifiApNode.Create (1);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("HtMcs7"),
+                                "ControlMode", StringValue ("HtMcs0"));
+
+  WifiMacHelper mac;
+  Ssid ssid = Ssid ("ampdu-abstraction");
+  mac.SetType ("ns3::StaWifiMac",
+               "Ssid", SsidValue (ssid),
+               "AmpduAbstraction", BooleanValue (abstraction));
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, wifiStaNode);
+
+  mac.SetType ("ns3::ApWifiMac",
+               "Ssid", SsidValue (ssid),
+               "AmpduAbstraction", BooleanValue (abstraction));
+  NetDeviceContainer apDevices = wifi.Install (phy, mac, wifiApNode);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (distance, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiApNode);
+  mobility.Install (wifiStaNode);
+
+  Ptr<WifiNetDevice> apDevice = DynamicCast<WifiNetDevice> (apDevices.Get (0));
+  Ptr<WifiNetDevice> staDevice = DynamicCast<WifiNetDevice> (staDevices.Get (0));
+  staDevice->GetPhy ()->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&AmpduAbstractionTest::PhyRxEnd, this));
+
+  PacketSocketAddress socket;
+  socket.SetSingleDevice (apDevice->GetIfIndex ());
+  socket.SetPhysicalAddress (staDevice->GetAddress ());
+  socket.SetProtocol (1);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (wifiStaNode);
+  packetSocket.Install (wifiApNode);
+
+  Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient> ();
+  client->SetAttribute ("PacketSize", UintegerValue (1000));
+  client->SetAttribute ("MaxPackets", UintegerValue (0));
+  client->SetAttribute ("Interval", TimeValue (MicroSeconds (50)));
+  client->SetRemote (socket);
+  wifiApNode.Get (0)->AddApplication (client);
+  client->SetStartTime (Seconds (0.5));
+  client->SetStopTime (Seconds (1.0));
+
+  Ptr<PacketSocketServer> server = CreateObject<PacketSocketServer> ();
+  server->SetLocal (socket);
+  wifiStaNode.Get (0)->AddApplication (server);
+  server->SetStartTime (Seconds (0.0));
+  server->SetStopTime (Seconds (1.0));
+  server->TraceConnectWithoutContext ("Rx", MakeCallback (&AmpduAbstractionTest::Receive, this));
+
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+AmpduAbstractionTest::DoRun (void)
+{
+  //error-free link, then lossy link where about one MPDU out of seven is lost
+  for (double distance : {5.0, 21.0})
+    {
+      RunOne (false, distance);
+      uint32_t received = m_received;
+      uint32_t phyRxEnd = m_phyRxEnd;
+      RunOne (true, distance);
+      NS_TEST_ASSERT_MSG_GT (received, 0, "No packet received at distance " << distance);
+      NS_TEST_EXPECT_MSG_LT (m_phyRxEnd, phyRxEnd, "The abstraction should reduce the number of PHY receptions at distance " << distance);
+      NS_TEST_EXPECT_MSG_EQ_TOL (static_cast<double> (m_received), static_cast<double> (received), 0.05 * received,
+                                 "Unexpected number of packets received with the abstraction at distance " << distance);
+    }
+}
+
 
 /**
  * \ingroup wifi-test
@@ -422,6 +588,7 @@ WifiAggregationTestSuite::WifiAggregationTestSuite ()
 {
   AddTestCase (new AmpduAggregationTest, TestCase::QUICK);
   AddTestCase (new TwoLevelAggregationTest, TestCase::QUICK);
+  AddTestCase (new AmpduAbstractionTest, TestCase::QUICK);
 }
 
 static WifiAggregationTestSuite g_wifiAggregationTestSuite; ///< the test suite
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/qos-blocked-destinations.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi MAC queue indexes test
+ *
+ * This test enqueues QoS data frames for several (receiver, TID) pairs and
+ * non-QoS data frames, then checks that the lookups by address and by TID
+ * and address return the frames in FIFO order, also after PushFront.
+ */
+class WifiMacQueueIndexTest : public TestCase
+{
+public:
+  WifiMacQueueIndexTest ();
+  virtual ~WifiMacQueueIndexTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a data frame
+   * \param dest the receiver address
+   * \param tid the TID, or a negative value for a non-QoS data frame
+   * \param seq the sequence number, used to identify the frame
+   * \return the queue item
+   */
+  Ptr<WifiMacQueueItem> CreateItem (Mac48Address dest, int tid, uint16_t seq);
+};
+
+WifiMacQueueIndexTest::WifiMacQueueIndexTest ()
+  : TestCase ("Check the lookups by address and by TID and address")
+{
+}
+
+WifiMacQueueIndexTest::~WifiMacQueueIndexTest ()
+{
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueueIndexTest::CreateItem (Mac48Address dest, int tid, uint16_t seq)
+{
+  WifiMacHeader hdr;
+  if (tid < 0)
+    {
+      hdr.SetType (WIFI_MAC_DATA);
+    }
+  else
+    {
+      hdr.SetType (WIFI_MAC_QOSDATA);
+      hdr.SetQosTid (tid);
+    }
+  hdr.SetAddr1 (dest);
+  hdr.SetSequenceNumber (seq);
+  return Create<WifiMacQueueItem> (Create<Packet> (100), hdr);
+}
+
+void
+WifiMacQueueIndexTest::DoRun (void)
+{
+  Ptr<WifiMacQueue> queue = CreateObject<WifiMacQueue> ();
+  queue->SetMaxSize (QueueSize ("100p"));
+  Mac48Address a1 ("00:00:00:00:00:01");
+  Mac48Address a2 ("00:00:00:00:00:02");
+
+  queue->Enqueue (CreateItem (a1, 0, 1));
+  queue->Enqueue (CreateItem (a2, 0, 2));
+  queue->Enqueue (CreateItem (a1, 5, 3));
+  queue->Enqueue (CreateItem (a1, -1, 4));
+  queue->Enqueue (CreateItem (a1, 0, 5));
+  queue->PushFront (CreateItem (a1, 5, 6));
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 6, "Unexpected number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByAddress (a1), 5, "Unexpected number of packets for a1");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByAddress (a2), 1, "Unexpected number of packets for a2");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (0, a1), 2, "Unexpected number of packets for (a1, 0)");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (5, a1), 2, "Unexpected number of packets for (a1, 5)");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (5, a2), 0, "Unexpected number of packets for (a2, 5)");
+
+  NS_TEST_EXPECT_MSG_EQ (queue->PeekByTidAndAddress (5, a1)->GetHeader ().GetSequenceNumber (), 6,
+                         "PeekByTidAndAddress should return the frame pushed at the front");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueByTidAndAddress (0, a1)->GetHeader ().GetSequenceNumber (), 1,
+                         "DequeueByTidAndAddress should return the oldest frame");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueByAddress (a1)->GetHeader ().GetSequenceNumber (), 6,
+                         "DequeueByAddress should return the first frame in the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueByAddress (a1)->GetHeader ().GetSequenceNumber (), 3,
+                         "DequeueByAddress should return the first frame in the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (5, a1), 0, "Unexpected number of packets for (a1, 5)");
+  NS_TEST_EXPECT_MSG_EQ (queue->PeekByTidAndAddress (5, a1), 0, "No frame expected for (a1, 5)");
+
+  Ptr<QosBlockedDestinations> blocked = Create<QosBlockedDestinations> ();
+  blocked->Block (a2, 0);
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetHeader ().GetSequenceNumber (), 4,
+                         "DequeueFirstAvailable should skip blocked destinations");
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue ()->GetHeader ().GetSequenceNumber (), 2,
+                         "Dequeue should return the head of the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByAddress (a1), 1, "Unexpected number of packets for a1");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByAddress (a2), 0, "Unexpected number of packets for a2");
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue ()->GetHeader ().GetSequenceNumber (), 5,
+                         "Dequeue should return the head of the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi MAC queue lifetime test
+ *
+ * This test checks that the frames that stayed in the queue longer than
+ * MaxDelay are removed, regardless of their position in the queue.
+ */
+class WifiMacQueueLifetimeTest : public TestCase
+{
+public:
+  WifiMacQueueLifetimeTest ();
+  virtual ~WifiMacQueueLifetimeTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a QoS data frame to the given receiver
+   * \param dest the receiver address
+   * \param front whether to push the frame at the front of the queue
+   */
+  void EnqueueItem (Mac48Address dest, bool front);
+  /**
+   * Check the number of packets in the queue
+   * \param total the expected number of packets
+   * \param dest the receiver address
+   * \param byAddress the expected number of packets for the given receiver
+   */
+  void CheckPackets (uint32_t total, Mac48Address dest, uint32_t byAddress);
+
+  Ptr<WifiMacQueue> m_queue; ///< the queue under test
+};
+
+WifiMacQueueLifetimeTest::WifiMacQueueLifetimeTest ()
+  : TestCase ("Check the removal of expired frames")
+{
+}
+
+WifiMacQueueLifetimeTest::~WifiMacQueueLifetimeTest ()
+{
+}
+
+void
+WifiMacQueueLifetimeTest::EnqueueItem (Mac48Address dest, bool front)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetQosTid (0);
+  hdr.SetAddr1 (dest);
+  Ptr<WifiMacQueueItem> item = Create<WifiMacQueueItem> (Create<Packet> (100), hdr);
+  if (front)
+    {
+      m_queue->PushFront (item);
+    }
+  else
+    {
+      m_queue->Enqueue (item);
+    }
+}
+
+void
+WifiMacQueueLifetimeTest::CheckPackets (uint32_t total, Mac48Address dest, uint32_t byAddress)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, dest), byAddress,
+                         "Unexpected number of packets for " << dest << " at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), total,
+                         "Unexpected number of packets at " << Simulator::Now ());
+}
+
+void
+WifiMacQueueLifetimeTest::DoRun (void)
+{
+  m_queue = CreateObject<WifiMacQueue> ();
+  m_queue->SetMaxSize (QueueSize ("100p"));
+  m_queue->SetMaxDelay (MilliSeconds (10));
+  Mac48Address a1 ("00:00:00:00:00:01");
+  Mac48Address a2 ("00:00:00:00:00:02");
+
+  Simulator::Schedule (MilliSeconds (0), &WifiMacQueueLifetimeTest::EnqueueItem, this, a1, false);
+  Simulator::Schedule (MilliSeconds (4), &WifiMacQueueLifetimeTest::EnqueueItem, this, a2, false);
+  // pushed at the front but younger than the other frames
+  Simulator::Schedule (MilliSeconds (8), &WifiMacQueueLifetimeTest::EnqueueItem, this, a2, true);
+  Simulator::Schedule (MilliSeconds (9), &WifiMacQueueLifetimeTest::CheckPackets, this, 3, a2, 2);
+  Simulator::Schedule (MilliSeconds (11), &WifiMacQueueLifetimeTest::CheckPackets, this, 2, a1, 0);
+  Simulator::Schedule (MilliSeconds (15), &WifiMacQueueLifetimeTest::CheckPackets, this, 1, a2, 1);
+  Simulator::Schedule (MilliSeconds (19), &WifiMacQueueLifetimeTest::CheckPackets, this, 0, a2, 0);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_queue = 0;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi MAC Queue Test Suite
+ */
+class WifiMacQueueTestSuite : public TestSuite
+{
+public:
+  WifiMacQueueTestSuite ();
+};
+
+WifiMacQueueTestSuite::WifiMacQueueTestSuite ()
+  : TestSuite ("wifi-mac-queue", UNIT)
+{
+  AddTestCase (new WifiMacQueueIndexTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueLifetimeTest, TestCase::QUICK);
+}
+
+static WifiMacQueueTestSuite g_wifiMacQueueTestSuite; ///< the test suite
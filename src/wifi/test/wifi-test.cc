@@ -21,6 +21,7 @@
  *          Sébastien Deronne <sebastien.deronne@gmail.com>
  */
 
+#include "ns3/log.h"
 #include "ns3/string.h"
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/mobility-helper.h"
@@ -43,6 +44,8 @@
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/yans-wifi-channel.h"
+#include <iomanip>
 
 using namespace ns3;
 
@@ -1690,6 +1693,163 @@ StaWifiMacScanningTestCase::DoRun (void)
   }
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the received power at the receivers of a YansWifiChannel is
+ * the same whether it is computed by the simulation thread only or by a pool
+ * of threads (FanOutThreads attribute), and that the receptions occur in the
+ * same order.
+ *
+ * Two adhoc nodes broadcast frames to many receivers placed on a grid; some
+ * of them are out of range. The signal power of all the frames received by
+ * all the nodes is recorded, together with the time and the node, and the
+ * records obtained with one and with several threads are compared.
+ */
+
+class YansWifiChannelFanOutTest : public TestCase
+{
+public:
+  YansWifiChannelFanOutTest ();
+  virtual ~YansWifiChannelFanOutTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Run the simulation
+   * \param nThreads the value of the FanOutThreads attribute of the channel
+   * \return the records of the received frames
+   */
+  std::string RunSimulation (uint32_t nThreads);
+  /**
+   * Callback invoked when a PHY receives a frame
+   * \param context the context
+   * \param p the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TXVECTOR
+   * \param aMpdu the A-MPDU info
+   * \param signalNoise the signal and noise power
+   */
+  void MonitorSnifferRx (std::string context, Ptr<const Packet> p, uint16_t channelFreqMhz,
+                         WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise);
+
+  std::ostringstream m_records; ///< records of the received frames
+  uint32_t m_nRecords;          ///< number of received frames
+};
+
+YansWifiChannelFanOutTest::YansWifiChannelFanOutTest ()
+  : TestCase ("Test case for the parallel computation of the received power by YansWifiChannel"),
+    m_nRecords (0)
+{
+}
+
+YansWifiChannelFanOutTest::~YansWifiChannelFanOutTest ()
+{
+}
+
+void
+YansWifiChannelFanOutTest::MonitorSnifferRx (std::string context, Ptr<const Packet> p, uint16_t channelFreqMhz,
+                                             WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise)
+{
+  m_records << Simulator::Now ().GetNanoSeconds () << " " << context << " "
+            << std::setprecision (17) << signalNoise.signal << " " << signalNoise.noise << std::endl;
+  m_nRecords++;
+}
+
+std::string
+YansWifiChannelFanOutTest::RunSimulation (uint32_t nThreads)
+{
+  m_records.str ("");
+  m_nRecords = 0;
+  uint32_t nReceivers = 64;
+
+  NodeContainer senders;
+  senders.Create (2);
+  NodeContainer receivers;
+  receivers.Create (nReceivers);
+  NodeContainer allNodes = NodeContainer (senders, receivers);
+
+  YansWifiChannelHelper channelHelper = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> channel = channelHelper.Create ();
+  channel->SetAttribute ("FanOutThreads", UintegerValue (nThreads));
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, allNodes);
+  wifi.AssignStreams (devices, 100);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (-200.0),
+                                 "MinY", DoubleValue (-100.0),
+                                 "DeltaX", DoubleValue (50.0),
+                                 "DeltaY", DoubleValue (40.0),
+                                 "GridWidth", UintegerValue (8),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (receivers);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (15.0, 5.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (senders);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (allNodes);
+  for (uint32_t i = 0; i < senders.GetN (); i++)
+    {
+      PacketSocketAddress socket;
+      socket.SetSingleDevice (devices.Get (i)->GetIfIndex ());
+      socket.SetPhysicalAddress (Mac48Address::GetBroadcast ());
+      socket.SetProtocol (1);
+
+      Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient> ();
+      client->SetAttribute ("PacketSize", UintegerValue (500));
+      client->SetAttribute ("MaxPackets", UintegerValue (20));
+      client->SetAttribute ("Interval", TimeValue (MicroSeconds (700)));
+      client->SetRemote (socket);
+      senders.Get (i)->AddApplication (client);
+      client->SetStartTime (Seconds (0.1));
+      client->SetStopTime (Seconds (0.5));
+    }
+
+  Config::Connect ("/NodeList/*/DeviceList/*/Phy/MonitorSnifferRx",
+                   MakeCallback (&YansWifiChannelFanOutTest::MonitorSnifferRx, this));
+
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  return m_records.str ();
+}
+
+void
+YansWifiChannelFanOutTest::DoRun (void)
+{
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  if (GetLogComponent ("PropagationLossModel").IsNoneEnabled ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (logDistance->IsPositionOnly (), true, "Log distance model only depends on positions");
+      LogComponentEnable ("PropagationLossModel", LOG_LEVEL_DEBUG);
+      NS_TEST_EXPECT_MSG_EQ (logDistance->IsPositionOnly (), false, "The logging is not thread-safe");
+      LogComponentDisable ("PropagationLossModel", LOG_LEVEL_ALL);
+    }
+  logDistance->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  NS_TEST_ASSERT_MSG_EQ (logDistance->IsPositionOnly (), false, "Nakagami model draws random variables");
+
+  std::string serial = RunSimulation (1);
+  uint32_t nSerial = m_nRecords;
+  NS_TEST_ASSERT_MSG_GT (nSerial, 0, "No frame received");
+  std::string parallel = RunSimulation (4);
+  NS_TEST_ASSERT_MSG_EQ (m_nRecords, nSerial, "Different number of received frames");
+  NS_TEST_ASSERT_MSG_EQ ((serial == parallel), true, "Received frames differ with multiple threads");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1715,6 +1875,7 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new YansWifiChannelFanOutTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite